@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicTypes.h"
+#include "InputController.hpp"
+
+namespace Diligent
+{
+
+// Frame-by-frame recording of the input state and the frame time.
+//
+// Sample cameras are driven only by the input controller and the elapsed time, so replaying
+// the recorded input with the recorded time steps reproduces the camera path exactly,
+// independent of the camera type and of the frame rate of the replay.
+class CameraPath
+{
+public:
+    struct Frame
+    {
+        double     ElapsedTime = 0;
+        MouseState Mouse;
+        Uint16     KeysDown    = 0; // Keys with INPUT_KEY_STATE_FLAG_KEY_IS_DOWN flag, one bit per key
+        Uint16     KeysWasDown = 0; // Keys with INPUT_KEY_STATE_FLAG_KEY_WAS_DOWN flag, one bit per key
+    };
+    static_assert(static_cast<int>(InputKeys::TotalKeys) <= 16, "Key masks are too small");
+
+    // Clears the path and starts a new recording.
+    // StartTime is the current time of the first frame; Width and Height are the
+    // swap chain size, which must match on replay for the frames to be identical.
+    void Reset(double StartTime, Uint32 Width, Uint32 Height);
+
+    // Appends the current controller state and the elapsed time of the frame.
+    void AddFrame(double ElapsedTime, InputController& Controller);
+
+    // Sets the controller state to the recorded state of the frame.
+    void ApplyFrame(Uint32 FrameIdx, InputController& Controller) const;
+
+    bool Save(const char* FilePath) const;
+    bool Load(const char* FilePath);
+
+    Uint32       GetNumFrames() const { return static_cast<Uint32>(m_Frames.size()); }
+    const Frame& GetFrame(Uint32 FrameIdx) const { return m_Frames[FrameIdx]; }
+    double       GetStartTime() const { return m_StartTime; }
+    Uint32       GetWidth() const { return m_Width; }
+    Uint32       GetHeight() const { return m_Height; }
+
+private:
+    double             m_StartTime = 0;
+    Uint32             m_Width     = 0;
+    Uint32             m_Height    = 0;
+    std::vector<Frame> m_Frames;
+};
+
+} // namespace Diligent
@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Linear allocator for transient CPU data that only lives within a frame.
+//
+// Allocations bump a pointer in the current memory block and are never freed individually.
+// All memory is reclaimed at once by Reset(). If the data of a frame did not fit into one block,
+// the blocks are merged into a single larger block on reset, so that in the steady state
+// the arena does not touch the heap at all.
+//
+// Every thread has its own arena returned by GetThreadArena(). SampleApp resets all thread arenas
+// at the start of every frame, so data allocated from them must not be kept across frames.
+class FrameArena
+{
+public:
+    static constexpr size_t DefaultBlockSize = size_t{64} << 10;
+
+    explicit FrameArena(size_t BlockSize = DefaultBlockSize);
+
+    // clang-format off
+    FrameArena           (const FrameArena&)  = delete;
+    FrameArena           (      FrameArena&&) = delete;
+    FrameArena& operator=(const FrameArena&)  = delete;
+    FrameArena& operator=(      FrameArena&&) = delete;
+    // clang-format on
+
+    void* Allocate(size_t Size, size_t Alignment);
+
+    template <typename T>
+    T* Allocate(size_t Count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * Count, alignof(T)));
+    }
+
+    // Formats the string in the arena memory
+    const char* Format(const char* Fmt, ...);
+
+    void Reset();
+
+    // Number of bytes allocated since the last reset
+    size_t GetUsedSize() const { return m_UsedSize; }
+
+    // Total size of all memory blocks
+    size_t GetCapacity() const;
+
+    // Returns the arena of the calling thread
+    static FrameArena& GetThreadArena();
+
+    // Resets the arenas of all threads. Must only be called when no other thread
+    // allocates from its arena.
+    static void ResetThreadArenas();
+
+    struct FrameStatistics
+    {
+        size_t ArenaBytes         = 0; // Bytes allocated from all thread arenas
+        size_t ArenaCapacity      = 0; // Total capacity of all thread arenas
+        Uint64 NumHeapAllocations = 0; // Number of global heap allocations, only counted if MemoryProfiler::IsEnabled()
+        Uint64 HeapBytes          = 0; // Bytes allocated from the global heap, only counted if MemoryProfiler::IsEnabled()
+    };
+    // Returns the statistics of the last frame, which are collected by ResetThreadArenas()
+    static FrameStatistics GetFrameStats();
+
+private:
+    struct Block
+    {
+        std::unique_ptr<Uint8[]> pData;
+        size_t                   Size = 0;
+    };
+    void AddBlock(size_t Size);
+
+    const size_t m_BlockSize;
+
+    std::vector<Block> m_Blocks;
+
+    size_t m_Offset   = 0; // Offset in the last block
+    size_t m_UsedSize = 0;
+};
+
+// STL-compatible allocator that allocates memory from the frame arena.
+// Deallocation is a no-op; the memory is reclaimed when the arena is reset.
+template <typename T>
+class FrameArenaAllocator
+{
+public:
+    using value_type = T;
+
+    // Uses the arena of the calling thread
+    FrameArenaAllocator() noexcept :
+        m_pArena{&FrameArena::GetThreadArena()}
+    {}
+
+    explicit FrameArenaAllocator(FrameArena& Arena) noexcept :
+        m_pArena{&Arena}
+    {}
+
+    template <typename U>
+    FrameArenaAllocator(const FrameArenaAllocator<U>& Other) noexcept :
+        m_pArena{Other.GetArena()}
+    {}
+
+    T* allocate(size_t Count)
+    {
+        return m_pArena->Allocate<T>(Count);
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    FrameArena* GetArena() const noexcept { return m_pArena; }
+
+    template <typename U>
+    bool operator==(const FrameArenaAllocator<U>& Other) const noexcept
+    {
+        return m_pArena == Other.GetArena();
+    }
+
+    template <typename U>
+    bool operator!=(const FrameArenaAllocator<U>& Other) const noexcept
+    {
+        return m_pArena != Other.GetArena();
+    }
+
+private:
+    FrameArena* m_pArena;
+};
+
+// Vector that allocates its memory from the frame arena of the calling thread
+template <typename T>
+using FrameVector = std::vector<T, FrameArenaAllocator<T>>;
+
+} // namespace Diligent
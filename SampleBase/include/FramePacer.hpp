@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace Diligent
+{
+
+// Limits the frame rate of the application main loop and measures input-to-present latency.
+//
+// The main loop should call BeginFrame() before starting the CPU work of a frame,
+// and EndFrame() right after the frame has been presented. EndFrame() sleeps until
+// the next frame should start:
+//  - In TargetFPS mode, frames start at a fixed rate given by the target FPS.
+//  - In LowLatency mode, the next frame starts as late as possible so that it is presented right
+//    before the predicted next vertical blank (or the next target FPS deadline if the target FPS is set).
+//    The vertical blank interval is estimated from the intervals between blocking presents.
+class FramePacer
+{
+public:
+    enum class MODE : int
+    {
+        None,
+        TargetFPS,
+        LowLatency,
+        Count
+    };
+
+    using ClockType = std::chrono::steady_clock;
+
+    void SetMode(MODE Mode) { m_Mode = Mode; }
+    MODE GetMode() const { return m_Mode; }
+
+    // Zero target FPS disables the frame rate limit in TargetFPS mode
+    void   SetTargetFPS(double TargetFPS) { m_TargetFPS = TargetFPS; }
+    double GetTargetFPS() const { return m_TargetFPS; }
+
+    // Sets the initial estimate of the vertical blank interval, e.g. from the display refresh rate
+    void SetRefreshRate(double RefreshRate);
+
+    // The application should not render frames while the window is occluded,
+    // but wait for window system events instead.
+    void SetOccluded(bool Occluded) { m_Occluded = Occluded; }
+    bool IsOccluded() const { return m_Occluded; }
+
+    // Marks the start of the CPU work of a frame
+    void BeginFrame();
+
+    // Marks the moment when the frame is about to be presented
+    void BeforePresent();
+
+    // Marks the moment when the frame has been presented and sleeps until the next frame should start
+    void EndFrame();
+
+    // Records the time of an input event. The latency is measured from the first
+    // input event received after the previous present until the next present.
+    void OnInput();
+
+    // All times are in milliseconds
+    struct Statistics
+    {
+        double FrameTime       = 0; // Time between two consecutive presents
+        double CPUTime         = 0; // Time from the start of the frame to present
+        double SleepTime       = 0; // Time spent sleeping in EndFrame()
+        double RefreshInterval = 0; // Estimated vertical blank interval
+        double InputLatency    = 0; // Average input-to-present latency
+        double MaxInputLatency = 0; // Maximum input-to-present latency since the last ResetStats()
+    };
+    const Statistics& GetStats() const { return m_Stats; }
+
+    void ResetStats() { m_Stats.MaxInputLatency = 0; }
+
+private:
+    ClockType::time_point ComputeNextFrameStart(ClockType::time_point Now) const;
+
+    MODE   m_Mode      = MODE::None;
+    double m_TargetFPS = 0;
+    bool   m_Occluded  = false;
+
+    ClockType::time_point m_FrameStart;
+    ClockType::time_point m_PresentStart;
+    ClockType::time_point m_LastPresentEnd;
+    ClockType::time_point m_NextFrameStart;
+    ClockType::time_point m_FirstInput;
+    bool                  m_HasPendingInput = false;
+
+    // Exponential moving averages, in seconds
+    double m_AvgCPUTime         = 0;
+    double m_CPUTimeDeviation   = 0;
+    double m_AvgRefreshInterval = 1.0 / 60.0;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
@@ -96,6 +96,17 @@ public:
         return (GetKeyState(Key) & INPUT_KEY_STATE_FLAG_KEY_IS_DOWN) != 0;
     }
 
+    // Overrides the state, for instance to replay recorded input
+    void SetMouseState(const MouseState& State)
+    {
+        m_MouseState = State;
+    }
+
+    void SetKeyState(InputKeys Key, INPUT_KEY_STATE_FLAGS State)
+    {
+        m_Keys[static_cast<size_t>(Key)] = State;
+    }
+
     void ClearState()
     {
         m_MouseState.WheelDelta = 0;
@@ -172,6 +183,10 @@ protected:
 
             bool IsKeyDown(InputKeys Key)const{return false;}
 
+            void SetMouseState(const MouseState& State){m_MouseState = State;}
+
+            void SetKeyState(InputKeys Key, INPUT_KEY_STATE_FLAGS State){}
+
             void ClearState(){}
 
         private:
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+struct IRenderDevice;
+
+// Tracks CPU heap activity and memory usage of the process.
+//
+// Global operator new and delete are replaced to count allocations. Allocations are attributed
+// to the calling thread and to the innermost named scope that is active on that thread.
+// The replacement is only compiled in debug builds and in builds configured with
+// DILIGENT_SAMPLES_MEMORY_PROFILER, and counts every allocation from the start of the process.
+// Allocations that bypass operator new, for instance engine objects that use malloc directly,
+// are not counted, but are included in the resident memory size reported by the OS.
+class MemoryProfiler
+{
+public:
+    // Returns true if heap allocations are counted in this build
+    static bool IsEnabled();
+
+    // Attributes allocations on the calling thread to the named scope while the object is alive.
+    // Scope names must be string literals or otherwise outlive the profiler. The number
+    // of distinct scopes is limited; allocations in excess scopes are attributed to "Other".
+    class Scope
+    {
+    public:
+        explicit Scope(const char* Name);
+        ~Scope();
+
+        // clang-format off
+        Scope           (const Scope&)  = delete;
+        Scope           (      Scope&&) = delete;
+        Scope& operator=(const Scope&)  = delete;
+        Scope& operator=(      Scope&&) = delete;
+        // clang-format on
+
+    private:
+        int m_PrevScope;
+    };
+
+    // Sets the name of the calling thread in the statistics. The name must be a string literal
+    // or otherwise outlive the profiler.
+    static void SetThreadName(const char* Name);
+
+    // Finishes the frame statistics. Must be called from one thread only.
+    static void EndFrame();
+
+    struct AllocationStats
+    {
+        Uint64 NumAllocations = 0;
+        Uint64 Bytes          = 0;
+    };
+
+    struct NamedAllocationStats
+    {
+        const char*     Name = nullptr;
+        AllocationStats Frame; // Last frame
+        AllocationStats Total; // Since the start
+    };
+
+    // All sizes are in bytes
+    struct Statistics
+    {
+        Uint32 NumFrames = 0;
+
+        AllocationStats Frame;    // Allocations in the last frame
+        AllocationStats MaxFrame; // Maximum number of allocations and bytes allocated in one frame
+        AllocationStats Total;    // All allocations since the start
+
+        Uint64 CurrentHeapBytes = 0; // Bytes allocated with operator new and not yet freed
+        Uint64 PeakHeapBytes    = 0;
+
+        Uint64 ResidentBytes     = 0; // Resident memory of the process reported by the OS, if available
+        Uint64 PeakResidentBytes = 0;
+
+        std::vector<NamedAllocationStats> Threads;
+        std::vector<NamedAllocationStats> Scopes;
+    };
+    // Reuses the memory of the vectors in Stats, so that polling the statistics every frame
+    // does not allocate memory itself.
+    static void GetStats(Statistics& Stats);
+
+    // Returns all allocations since the start. Does not allocate memory.
+    static AllocationStats GetTotalAllocations();
+
+    // Queries the video memory usage and budget of the device's adapter.
+    // Returns false if the query is not supported by the device type.
+    static bool QueryDeviceMemory(IRenderDevice* pDevice, Uint64& Usage, Uint64& Budget);
+};
+
+} // namespace Diligent
@@ -40,6 +40,10 @@
 #include "SampleBase.hpp"
 #include "ScreenCapture.hpp"
 #include "Image.h"
+#include "FramePacer.hpp"
+#include "MemoryProfiler.hpp"
+#include "CameraPath.hpp"
+#include "VideoStreamWriter.hpp"
 
 namespace Diligent
 {
@@ -87,10 +91,24 @@ public:
         return m_pDeviceContexts[Ind];
     }
 
+    // Initializes the engine without a window. The sample renders into an offscreen swap chain.
+    bool InitializeHeadless();
+
+    // Returns true when the number of frames requested with --frames has been rendered,
+    // or when the camera path replay has finished. Used by the headless main loop.
+    bool IsFinished() const
+    {
+        return (m_MaxFrames != 0 && m_FrameCount >= m_MaxFrames) || m_CameraPath.ReplayFinished;
+    }
+
 protected:
     void InitializeDiligentEngine(const NativeWindow* pWindow);
     void InitializeSample();
     void UpdateAdaptersDialog();
+    void UpdateMemoryProfilerDialog();
+    void UpdateMemoryStats();
+    void WriteBenchmarkReport();
+    void FinishCameraPathReplay();
     void UpdateAppSettings(bool IsInitialization);
 
     virtual void SetFullscreenMode(const DisplayModeAttribs& DisplayMode)
@@ -104,8 +122,12 @@ protected:
         m_pSwapChain->SetWindowedMode();
     }
 
-    void CompareGoldenImage(const std::string& FileName, ScreenCapture::CaptureInfo& Capture);
-    void SaveScreenCapture(const std::string& FileName, ScreenCapture::CaptureInfo& Capture);
+    void CreateStateCache();
+    void SaveStateCache();
+
+    void CompareGoldenImage(const char* FileName, ScreenCapture::CaptureInfo& Capture);
+    void SaveScreenCapture(const char* FileName, ScreenCapture::CaptureInfo& Capture);
+    void StreamScreenCapture(ScreenCapture::CaptureInfo& Capture);
 
     RENDER_DEVICE_TYPE                         m_DeviceType = RENDER_DEVICE_TYPE_UNDEFINED;
     RefCntAutoPtr<IEngineFactory>              m_pEngineFactory;
@@ -133,6 +155,70 @@ protected:
     bool         m_bForceNonSeprblProgs = false;
     double       m_CurrentTime          = 0;
     Uint32       m_MaxFrameLatency      = SwapChainDesc{}.BufferCount;
+    Uint32       m_FrameCount           = 0;
+    Uint32       m_MaxFrames            = 0;
+
+    // Render state cache shared by the sample. The cache file is specific to the sample,
+    // device type and build configuration, is loaded at startup and is saved on exit.
+    bool                             m_bUseStateCache = true;
+    RefCntAutoPtr<IRenderStateCache> m_pStateCache;
+    std::string                      m_StateCachePath;
+    bool                             m_StateCacheLoaded    = false;
+    size_t                           m_EmptyStateCacheSize = 0; // Size of the data written by an empty cache
+
+    // Limits the frame rate and measures input-to-present latency.
+    // Platform-specific applications report input events and window occlusion to the pacer.
+    FramePacer m_FramePacer;
+
+    // Heap allocation and memory usage statistics, see MemoryProfiler
+    struct MemoryProfilerInfo
+    {
+        bool                       ShowDialog = false;
+        MemoryProfiler::Statistics Stats;
+
+        bool   DeviceMemoryAvailable = false;
+        Uint64 DeviceMemoryUsage     = 0;
+        Uint64 DeviceMemoryBudget    = 0;
+        Uint64 PeakDeviceMemoryUsage = 0;
+    } m_MemoryProfiler;
+
+    // Frame time and memory statistics written to a JSON file on exit
+    struct BenchmarkInfo
+    {
+        std::string ReportPath;
+        Uint32      NumFrames      = 0;
+        double      TotalFrameTime = 0;
+        double      MaxFrameTime   = 0;
+    } m_Benchmark;
+
+    // Records the input of every frame to a file, or replays a recorded file using the recorded
+    // time steps instead of the wall clock, so that every replay renders identical frames.
+    struct CameraPathInfo
+    {
+        enum class MODE
+        {
+            None,
+            Record,
+            Replay
+        };
+        MODE        Mode = MODE::None;
+        std::string FilePath;
+        std::string TimingsPath; // CSV file with the timings of every replayed frame
+        CameraPath  Path;
+
+        // Replay state
+        Uint32 CurrentFrame   = 0;
+        double CurrentTime    = 0;
+        bool   ReplayFinished = false;
+
+        struct FrameTiming
+        {
+            double Time      = 0; // Replayed time of the frame, in seconds
+            double FrameTime = 0; // Measured frame time, in milliseconds
+            double CPUTime   = 0; // Measured CPU time, in milliseconds
+        };
+        std::vector<FrameTiming> Timings;
+    } m_CameraPath;
 
     // We will need this when we have to recreate the swap chain (on Android)
     SwapChainDesc m_SwapChainInitDesc;
@@ -150,8 +236,12 @@ protected:
         int               JpegQuality     = 95;
         bool              KeepAlpha       = false;
 
+        // When set, captured frames are written to a single video stream instead of image files
+        std::string               StreamPath;
+        VideoStreamWriter::FORMAT StreamFormat = VideoStreamWriter::FORMAT::Y4M;
     } m_ScreenCaptureInfo;
     std::unique_ptr<ScreenCapture> m_pScreenCapture;
+    VideoStreamWriter              m_CaptureStream;
 
     std::unique_ptr<ImGuiImplDiligent> m_pImGui;
 
@@ -37,7 +37,11 @@
 #include "InputController.hpp"
 #include "BasicMath.hpp"
 #include "AppBase.hpp"
+#include "RenderStateCache.h"
 #include "FlagEnum.h"
+#include "FrameArena.hpp"
+#include "TextureLoadService.hpp"
+#include "TransientTexturePool.hpp"
 
 namespace Diligent
 {
@@ -53,6 +57,7 @@ struct SampleInitInfo
     Uint32             NumDeferredCtx  = 0;
     ISwapChain*        pSwapChain      = nullptr;
     ImGuiImplDiligent* pImGui          = nullptr;
+    IRenderStateCache* pStateCache     = nullptr;
 };
 
 struct DesiredApplicationSettings
@@ -190,6 +195,16 @@ public:
         m_pSwapChain = pNewSwapChain;
     }
 
+    const TextureLoadService& GetTextureLoadService() const
+    {
+        return m_TextureLoadService;
+    }
+
+    const TransientTexturePool& GetTransientTexturePool() const
+    {
+        return m_TransientTextures;
+    }
+
 protected:
     // Returns projection matrix adjusted to the current screen orientation
     float4x4 GetAdjustedProjectionMatrix(float FOV, float NearPlane, float FarPlane) const;
@@ -197,6 +212,13 @@ protected:
     // Returns pretransform matrix that matches the current screen rotation
     float4x4 GetSurfacePretransformMatrix(const float3& f3CameraViewAxis) const;
 
+    // Create shaders and pipeline states through the render state cache, if it is enabled,
+    // or directly through the render device otherwise. Pipeline states must only use shaders
+    // that were created by CreateShader().
+    RefCntAutoPtr<IShader>        CreateShader(const ShaderCreateInfo& ShaderCI) const;
+    RefCntAutoPtr<IPipelineState> CreateGraphicsPipelineState(const GraphicsPipelineStateCreateInfo& PSOCreateInfo) const;
+    RefCntAutoPtr<IPipelineState> CreateComputePipelineState(const ComputePipelineStateCreateInfo& PSOCreateInfo) const;
+
     RefCntAutoPtr<IEngineFactory>              m_pEngineFactory;
     RefCntAutoPtr<IRenderDevice>               m_pDevice;
     RefCntAutoPtr<IDeviceContext>              m_pImmediateContext;
@@ -204,6 +226,11 @@ protected:
     RefCntAutoPtr<ISwapChain>                  m_pSwapChain;
     ImGuiImplDiligent*                         m_pImGui = nullptr;
 
+    // Render state cache shared by the application. May be null if the cache is disabled.
+    // Shaders and pipeline states created through the cache are loaded from the cache file
+    // on the next run instead of being compiled from source.
+    RefCntAutoPtr<IRenderStateCache> m_pStateCache;
+
     float  m_fSmoothFPS         = 0;
     double m_LastFPSTime        = 0;
     Uint32 m_NumFramesRendered  = 0;
@@ -213,12 +240,21 @@ protected:
     bool m_ConvertPSOutputToGamma = false;
 
     InputController m_InputController;
+
+    // Decodes textures on worker threads. Samples request textures early in Initialize()
+    // and create GPU textures after other initialization work is done.
+    TextureLoadService m_TextureLoadService;
+
+    // Window-size render targets that are recycled across resizes. Textures released
+    // to the pool are reused by later requests with the same description.
+    TransientTexturePool m_TransientTextures;
 };
 
 inline void SampleBase::Update(double CurrTime, double ElapsedTime)
 {
     ++m_NumFramesRendered;
     ++m_CurrentFrameNumber;
+    m_TransientTextures.NextFrame();
     static const double dFPSInterval = 0.5;
     if (CurrTime - m_LastFPSTime > dFPSInterval)
     {
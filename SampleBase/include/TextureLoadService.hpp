@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "TextureLoader.h"
+
+namespace Diligent
+{
+
+// Decodes texture files and generates their mip levels on a pool of worker threads.
+//
+// Texture loading is split into two parts: LoadAsync() requests that run concurrently on the worker
+// threads and return futures, and CreateTexture()/CreateTextureArray() that wait for the results
+// and create GPU resources. This lets samples overlap decoding with other initialization work,
+// such as pipeline state creation.
+class TextureLoadService
+{
+public:
+    using LoaderFuture = std::shared_future<RefCntAutoPtr<ITextureLoader>>;
+
+    // Zero number of threads means one thread per hardware thread.
+    // Worker threads are started on the first request.
+    explicit TextureLoadService(Uint32 NumThreads = 0);
+    ~TextureLoadService();
+
+    // clang-format off
+    TextureLoadService           (const TextureLoadService&)  = delete;
+    TextureLoadService           (      TextureLoadService&&) = delete;
+    TextureLoadService& operator=(const TextureLoadService&)  = delete;
+    TextureLoadService& operator=(      TextureLoadService&&) = delete;
+    // clang-format on
+
+    // Requests the texture file to be decoded on a worker thread.
+    // If the file can't be loaded, the future holds a null loader.
+    LoaderFuture LoadAsync(const char* FilePath, const TextureLoadInfo& LoadInfo);
+
+    // Requests all files to be decoded, one future per file.
+    std::vector<LoaderFuture> LoadAsync(const std::vector<std::string>& FilePaths, const TextureLoadInfo& LoadInfo);
+
+    // Requests NumFiles numbered files to be decoded, one future per file. The file path of every file
+    // is produced by substituting the file index for the %u placeholder in FilePathFormat, e.g. "DGLogo%u.png".
+    std::vector<LoaderFuture> LoadAsync(const char* FilePathFormat, Uint32 NumFiles, const TextureLoadInfo& LoadInfo);
+
+    // Waits for the loader to finish and returns it.
+    RefCntAutoPtr<ITextureLoader> Wait(const LoaderFuture& Loader);
+
+    // Waits for the loader to finish and creates the texture.
+    RefCntAutoPtr<ITexture> CreateTexture(IRenderDevice* pDevice, const LoaderFuture& Loader);
+
+    // Waits for all loaders to finish and creates one texture per loader.
+    std::vector<RefCntAutoPtr<ITexture>> CreateTextures(IRenderDevice* pDevice, const std::vector<LoaderFuture>& Loaders);
+
+    // Waits for all loaders to finish and creates a 2D texture array with one slice per loader,
+    // initializing all slices in a single call. All textures must have the same size and format.
+    RefCntAutoPtr<ITexture> CreateTextureArray(IRenderDevice*                   pDevice,
+                                               const std::vector<LoaderFuture>& Loaders,
+                                               const char*                      Name      = nullptr,
+                                               BIND_FLAGS                       BindFlags = BIND_SHADER_RESOURCE);
+
+    // All times are in milliseconds
+    struct Statistics
+    {
+        Uint32 NumThreads  = 0;
+        Uint32 NumTextures = 0; // Number of decoded textures
+        double DecodeTime  = 0; // Total decode time on all worker threads
+        double LoadTime    = 0; // Wall time between the first request and the last decoded texture
+        double WaitTime    = 0; // Time the calling threads were blocked waiting for the results
+        double CreateTime  = 0; // Time spent creating GPU textures
+    };
+    Statistics GetStats() const;
+
+private:
+    struct LoadTask
+    {
+        std::string     FilePath;
+        std::string     Name;
+        TextureLoadInfo LoadInfo;
+
+        std::promise<RefCntAutoPtr<ITextureLoader>> Promise;
+    };
+
+    void StartThreads();
+    void WorkerThreadProc();
+
+    using ClockType = std::chrono::high_resolution_clock;
+
+    const Uint32 m_NumThreads;
+
+    std::vector<std::thread> m_WorkerThreads;
+
+    mutable std::mutex      m_Mtx;
+    std::condition_variable m_CondVar;
+
+    // The following members are protected by m_Mtx
+    std::deque<LoadTask>  m_Tasks;
+    bool                  m_Quit = false;
+    ClockType::time_point m_FirstRequestTime;
+    ClockType::time_point m_LastCompletionTime;
+    Statistics            m_Stats;
+};
+
+} // namespace Diligent
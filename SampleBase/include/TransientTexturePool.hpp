@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "Texture.h"
+
+namespace Diligent
+{
+
+// Recycles render targets, such as G-buffers, accumulation and post-process targets, across window resizes.
+//
+// Textures are requested by description with Acquire() and returned to the pool with Release().
+// A released texture is handed out again to the next Acquire() call with the same description
+// (the name is ignored). Every texture is a separate committed resource: the pool does not alias
+// memory between textures, and textures with different descriptions never share memory.
+// When a frame creates new textures, for instance after the window is resized, free textures
+// that were not acquired in that frame are destroyed at the end of it, so that the previous
+// targets do not stay alive next to the new ones. Other free textures that were not acquired
+// for a number of frames are destroyed as well.
+//
+// The contents of an acquired texture are undefined. All textures must be used in the same
+// immediate context, and the pool must only be accessed from the render thread.
+class TransientTexturePool
+{
+public:
+    explicit TransientTexturePool(Uint32 MaxUnusedFrames = 8);
+
+    // clang-format off
+    TransientTexturePool           (const TransientTexturePool&)  = delete;
+    TransientTexturePool           (      TransientTexturePool&&) = delete;
+    TransientTexturePool& operator=(const TransientTexturePool&)  = delete;
+    TransientTexturePool& operator=(      TransientTexturePool&&) = delete;
+    // clang-format on
+
+    // Returns a free texture that matches the description, or creates a new one.
+    RefCntAutoPtr<ITexture> Acquire(IRenderDevice* pDevice, const TextureDesc& Desc);
+
+    // Returns the texture to the pool and resets the pointer. Null pointers are ignored.
+    void Release(RefCntAutoPtr<ITexture>& pTexture);
+
+    // Finishes the frame statistics and destroys textures that have not been used
+    // for more than MaxUnusedFrames frames.
+    void NextFrame();
+
+    // Destroys all free textures.
+    void ReleaseUnused();
+
+    // All sizes are in bytes. Memoryless textures take no memory.
+    struct Statistics
+    {
+        Uint32 NumTextures    = 0; // Number of textures allocated by the pool
+        Uint32 NumInUse       = 0; // Number of textures currently acquired
+        Uint64 AllocatedBytes = 0; // Total memory of all textures allocated by the pool
+        Uint64 InUseBytes     = 0; // Memory of the currently acquired textures
+        Uint64 PeakBytes      = 0; // Peak memory of all textures allocated by the pool at the same time
+        Uint64 RequestedBytes = 0; // Memory of all textures used in the last frame
+        Uint32 NumCreated     = 0; // Total number of textures created by the pool
+        Uint32 NumReused      = 0; // Total number of Acquire() calls that returned an existing texture
+    };
+    const Statistics& GetStats() const { return m_Stats; }
+
+    static Uint64 GetTextureSize(const TextureDesc& Desc);
+
+private:
+    struct Entry
+    {
+        RefCntAutoPtr<ITexture> pTexture;
+
+        Uint64 Size              = 0;
+        Uint64 LastUsedFrame     = 0;
+        Uint64 LastAcquiredFrame = 0;
+        bool   InUse             = false;
+    };
+
+    const Uint32 m_MaxUnusedFrames;
+
+    std::vector<Entry> m_Entries;
+
+    Uint64 m_FrameNumber          = 0;
+    Uint64 m_FrameRequestedBytes  = 0;
+    bool   m_FrameCreatedTextures = false;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
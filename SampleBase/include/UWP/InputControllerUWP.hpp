@@ -46,6 +46,18 @@ public:
             return (GetKeyState(Key) & INPUT_KEY_STATE_FLAG_KEY_IS_DOWN) != 0;
         }
 
+        void SetMouseState(const MouseState& State)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            InputControllerBase::SetMouseState(State);
+        }
+
+        void SetKeyState(InputKeys Key, INPUT_KEY_STATE_FLAGS State)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            InputControllerBase::SetKeyState(Key, State);
+        }
+
         void ClearState()
         {
             std::lock_guard<std::mutex> lock(mtx);
@@ -114,6 +126,16 @@ public:
         return m_SharedState->IsKeyDown(Key);
     }
 
+    void SetMouseState(const MouseState& State)
+    {
+        m_SharedState->SetMouseState(State);
+    }
+
+    void SetKeyState(InputKeys Key, INPUT_KEY_STATE_FLAGS State)
+    {
+        m_SharedState->SetKeyState(Key, State);
+    }
+
     std::shared_ptr<SharedControllerState> GetSharedState()
     {
         return m_SharedState;
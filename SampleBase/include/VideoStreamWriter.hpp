@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "GraphicsTypes.h"
+
+namespace Diligent
+{
+
+// Writes uncompressed video frames to a single file or pipe, so that
+// an external encoder can consume them at full rate.
+class VideoStreamWriter
+{
+public:
+    enum class FORMAT
+    {
+        Y4M, // 8-bit YUV 4:2:0 frames (full-range BT.601) in a YUV4MPEG2 stream
+        RGBA // 8-bit RGBA frames without a header
+    };
+
+    VideoStreamWriter() = default;
+    ~VideoStreamWriter();
+
+    // clang-format off
+    VideoStreamWriter           (const VideoStreamWriter&)  = delete;
+    VideoStreamWriter           (      VideoStreamWriter&&) = delete;
+    VideoStreamWriter& operator=(const VideoStreamWriter&)  = delete;
+    VideoStreamWriter& operator=(      VideoStreamWriter&&) = delete;
+    // clang-format on
+
+    // Opens the output file. If Path starts with '|', the rest of the string is a command
+    // that receives the stream through its standard input, e.g. "|ffmpeg -i - video.mp4".
+    // FrameRate is only written to the Y4M header.
+    bool Open(const char* Path, FORMAT Format, double FrameRate);
+    void Close();
+
+    bool IsOpen() const { return m_pFile != nullptr; }
+
+    // Converts the frame and writes it to the stream. All frames must have the same size.
+    // RGBA8 and BGRA8 formats (UNORM and SRGB) are supported.
+    bool WriteFrame(const void* pData, size_t Stride, Uint32 Width, Uint32 Height, TEXTURE_FORMAT Format);
+
+    Uint32 GetNumFrames() const { return m_NumFrames; }
+
+private:
+    FILE*  m_pFile     = nullptr;
+    bool   m_IsPipe    = false;
+    FORMAT m_Format    = FORMAT::Y4M;
+    double m_FrameRate = 30;
+    Uint32 m_Width     = 0;
+    Uint32 m_Height    = 0;
+    Uint32 m_NumFrames = 0;
+
+    // Converted frame data, reused between frames
+    std::vector<Uint8> m_FrameData;
+};
+
+} // namespace Diligent
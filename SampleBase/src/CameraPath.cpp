@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "CameraPath.hpp"
+
+#include <cstring>
+
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+#include "FileWrapper.hpp"
+#include "DataBlobImpl.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// File layout (all values are little-endian):
+//
+//      Magic, Version, Width, Height, StartTime, NumFrames
+//      NumFrames x {ElapsedTime, PosX, PosY, WheelDelta, ButtonFlags, KeysDown, KeysWasDown}
+//
+constexpr Uint32 CameraPathMagic   = 0x50434744; // "DGCP"
+constexpr Uint32 CameraPathVersion = 1;
+
+// ElapsedTime (8 bytes), PosX, PosY, WheelDelta (4 bytes each), ButtonFlags (1 byte), KeysDown, KeysWasDown (2 bytes each)
+constexpr size_t CameraPathFrameSize = 25;
+
+template <typename T>
+void WriteValue(std::vector<Uint8>& Data, const T& Value)
+{
+    const auto* pBytes = reinterpret_cast<const Uint8*>(&Value);
+    Data.insert(Data.end(), pBytes, pBytes + sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(const Uint8*& pData, const Uint8* pEnd, T& Value)
+{
+    if (static_cast<size_t>(pEnd - pData) < sizeof(T))
+        return false;
+
+    std::memcpy(&Value, pData, sizeof(T));
+    pData += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+void CameraPath::Reset(double StartTime, Uint32 Width, Uint32 Height)
+{
+    m_StartTime = StartTime;
+    m_Width     = Width;
+    m_Height    = Height;
+    m_Frames.clear();
+}
+
+void CameraPath::AddFrame(double ElapsedTime, InputController& Controller)
+{
+    Frame NewFrame;
+    NewFrame.ElapsedTime = ElapsedTime;
+    NewFrame.Mouse       = Controller.GetMouseState();
+    for (Uint32 Key = 0; Key < static_cast<Uint32>(InputKeys::TotalKeys); ++Key)
+    {
+        const auto KeyState = Controller.GetKeyState(static_cast<InputKeys>(Key));
+        if (KeyState & INPUT_KEY_STATE_FLAG_KEY_IS_DOWN)
+            NewFrame.KeysDown |= static_cast<Uint16>(1u << Key);
+        if (KeyState & INPUT_KEY_STATE_FLAG_KEY_WAS_DOWN)
+            NewFrame.KeysWasDown |= static_cast<Uint16>(1u << Key);
+    }
+    m_Frames.push_back(NewFrame);
+}
+
+void CameraPath::ApplyFrame(Uint32 FrameIdx, InputController& Controller) const
+{
+    VERIFY_EXPR(FrameIdx < m_Frames.size());
+    const auto& SrcFrame = m_Frames[FrameIdx];
+
+    Controller.SetMouseState(SrcFrame.Mouse);
+    for (Uint32 Key = 0; Key < static_cast<Uint32>(InputKeys::TotalKeys); ++Key)
+    {
+        auto KeyState = INPUT_KEY_STATE_FLAG_KEY_NONE;
+        if (SrcFrame.KeysDown & (1u << Key))
+            KeyState |= INPUT_KEY_STATE_FLAG_KEY_IS_DOWN;
+        if (SrcFrame.KeysWasDown & (1u << Key))
+            KeyState |= INPUT_KEY_STATE_FLAG_KEY_WAS_DOWN;
+        Controller.SetKeyState(static_cast<InputKeys>(Key), KeyState);
+    }
+}
+
+bool CameraPath::Save(const char* FilePath) const
+{
+    std::vector<Uint8> Data;
+    Data.reserve(32 + m_Frames.size() * CameraPathFrameSize);
+
+    WriteValue(Data, CameraPathMagic);
+    WriteValue(Data, CameraPathVersion);
+    WriteValue(Data, m_Width);
+    WriteValue(Data, m_Height);
+    WriteValue(Data, m_StartTime);
+    WriteValue(Data, static_cast<Uint32>(m_Frames.size()));
+    for (const auto& SrcFrame : m_Frames)
+    {
+        WriteValue(Data, SrcFrame.ElapsedTime);
+        WriteValue(Data, SrcFrame.Mouse.PosX);
+        WriteValue(Data, SrcFrame.Mouse.PosY);
+        WriteValue(Data, SrcFrame.Mouse.WheelDelta);
+        WriteValue(Data, static_cast<Uint8>(SrcFrame.Mouse.ButtonFlags));
+        WriteValue(Data, SrcFrame.KeysDown);
+        WriteValue(Data, SrcFrame.KeysWasDown);
+    }
+
+    FileWrapper File{FilePath, EFileAccessMode::Overwrite};
+    if (!File || !File->Write(Data.data(), Data.size()))
+    {
+        LOG_ERROR_MESSAGE("Failed to write camera path file ", FilePath);
+        return false;
+    }
+    return true;
+}
+
+bool CameraPath::Load(const char* FilePath)
+{
+    auto pData = DataBlobImpl::Create();
+    {
+        FileWrapper File{FilePath};
+        if (!File || !File->Read(pData))
+        {
+            LOG_ERROR_MESSAGE("Failed to read camera path file ", FilePath);
+            return false;
+        }
+    }
+
+    const auto* pBytes = static_cast<const Uint8*>(pData->GetConstDataPtr());
+    const auto* pEnd   = pBytes + pData->GetSize();
+
+    Uint32 Magic     = 0;
+    Uint32 Version   = 0;
+    Uint32 NumFrames = 0;
+    if (!ReadValue(pBytes, pEnd, Magic) || Magic != CameraPathMagic ||
+        !ReadValue(pBytes, pEnd, Version) || Version != CameraPathVersion ||
+        !ReadValue(pBytes, pEnd, m_Width) ||
+        !ReadValue(pBytes, pEnd, m_Height) ||
+        !ReadValue(pBytes, pEnd, m_StartTime) ||
+        !ReadValue(pBytes, pEnd, NumFrames))
+    {
+        LOG_ERROR_MESSAGE("File ", FilePath, " is not a valid camera path file");
+        return false;
+    }
+
+    // Do not allocate frames for a corrupted frame count
+    if (static_cast<size_t>(pEnd - pBytes) < size_t{NumFrames} * CameraPathFrameSize)
+    {
+        LOG_ERROR_MESSAGE("Camera path file ", FilePath, " is truncated");
+        return false;
+    }
+
+    m_Frames.resize(NumFrames);
+    for (auto& DstFrame : m_Frames)
+    {
+        Uint8 ButtonFlags = 0;
+        if (!ReadValue(pBytes, pEnd, DstFrame.ElapsedTime) ||
+            !ReadValue(pBytes, pEnd, DstFrame.Mouse.PosX) ||
+            !ReadValue(pBytes, pEnd, DstFrame.Mouse.PosY) ||
+            !ReadValue(pBytes, pEnd, DstFrame.Mouse.WheelDelta) ||
+            !ReadValue(pBytes, pEnd, ButtonFlags) ||
+            !ReadValue(pBytes, pEnd, DstFrame.KeysDown) ||
+            !ReadValue(pBytes, pEnd, DstFrame.KeysWasDown))
+        {
+            LOG_ERROR_MESSAGE("Camera path file ", FilePath, " is truncated");
+            m_Frames.clear();
+            return false;
+        }
+        DstFrame.Mouse.ButtonFlags = static_cast<MouseState::BUTTON_FLAGS>(ButtonFlags);
+    }
+
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,207 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "FrameArena.hpp"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+#include "DebugUtilities.hpp"
+#include "Align.hpp"
+#include "MemoryProfiler.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+struct ThreadArenaRegistry
+{
+    std::mutex               Mtx;
+    std::vector<FrameArena*> Arenas;
+
+    FrameArena::FrameStatistics LastFrameStats;
+
+    Uint64 NumHeapAllocations = 0;
+    Uint64 HeapBytes          = 0;
+};
+
+ThreadArenaRegistry& GetThreadArenaRegistry()
+{
+    static ThreadArenaRegistry Registry;
+    return Registry;
+}
+
+// Registers the arena of the thread on creation and removes it when the thread exits
+struct ThreadArenaHolder
+{
+    FrameArena Arena;
+
+    ThreadArenaHolder()
+    {
+        auto&                       Registry = GetThreadArenaRegistry();
+        std::lock_guard<std::mutex> Lock{Registry.Mtx};
+        Registry.Arenas.push_back(&Arena);
+    }
+
+    ~ThreadArenaHolder()
+    {
+        auto&                       Registry = GetThreadArenaRegistry();
+        std::lock_guard<std::mutex> Lock{Registry.Mtx};
+        Registry.Arenas.erase(std::find(Registry.Arenas.begin(), Registry.Arenas.end(), &Arena));
+    }
+};
+
+} // namespace
+
+FrameArena::FrameArena(size_t BlockSize) :
+    m_BlockSize{BlockSize}
+{
+    VERIFY_EXPR(m_BlockSize > 0);
+}
+
+void FrameArena::AddBlock(size_t Size)
+{
+    Block NewBlock;
+    NewBlock.pData.reset(new Uint8[Size]);
+    NewBlock.Size = Size;
+    m_Blocks.emplace_back(std::move(NewBlock));
+    m_Offset = 0;
+}
+
+void* FrameArena::Allocate(size_t Size, size_t Alignment)
+{
+    VERIFY(IsPowerOfTwo(Alignment), "Alignment (", Alignment, ") must be a power of two");
+
+    if (!m_Blocks.empty())
+    {
+        const auto& CurrBlock = m_Blocks.back();
+
+        const auto BlockStart = reinterpret_cast<uintptr_t>(CurrBlock.pData.get());
+        const auto AllocStart = AlignUp(BlockStart + m_Offset, static_cast<uintptr_t>(Alignment));
+        if (AllocStart + Size <= BlockStart + CurrBlock.Size)
+        {
+            const auto NewOffset = static_cast<size_t>(AllocStart + Size - BlockStart);
+            m_UsedSize += NewOffset - m_Offset;
+            m_Offset = NewOffset;
+            return reinterpret_cast<void*>(AllocStart);
+        }
+    }
+
+    // The allocation does not fit into the current block
+    AddBlock(std::max(m_BlockSize, Size + Alignment));
+
+    return Allocate(Size, Alignment);
+}
+
+const char* FrameArena::Format(const char* Fmt, ...)
+{
+    va_list Args;
+    va_start(Args, Fmt);
+
+    va_list ArgsCopy;
+    va_copy(ArgsCopy, Args);
+    const auto Len = std::vsnprintf(nullptr, 0, Fmt, ArgsCopy);
+    va_end(ArgsCopy);
+
+    char* Str = nullptr;
+    if (Len >= 0)
+    {
+        Str = Allocate<char>(static_cast<size_t>(Len) + 1);
+        std::vsnprintf(Str, static_cast<size_t>(Len) + 1, Fmt, Args);
+    }
+    va_end(Args);
+
+    return Str != nullptr ? Str : "";
+}
+
+void FrameArena::Reset()
+{
+    if (m_Blocks.size() > 1)
+    {
+        // Merge all blocks into one, so that the next frame fits into a single block
+        const auto Capacity = GetCapacity();
+        m_Blocks.clear();
+        AddBlock(Capacity);
+    }
+
+    m_Offset   = 0;
+    m_UsedSize = 0;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+    size_t Capacity = 0;
+    for (const auto& CurrBlock : m_Blocks)
+        Capacity += CurrBlock.Size;
+    return Capacity;
+}
+
+FrameArena& FrameArena::GetThreadArena()
+{
+    thread_local ThreadArenaHolder Holder;
+    return Holder.Arena;
+}
+
+void FrameArena::ResetThreadArenas()
+{
+    auto&                       Registry = GetThreadArenaRegistry();
+    std::lock_guard<std::mutex> Lock{Registry.Mtx};
+
+    FrameStatistics Stats;
+    for (auto* pArena : Registry.Arenas)
+    {
+        Stats.ArenaBytes += pArena->GetUsedSize();
+        pArena->Reset();
+        Stats.ArenaCapacity += pArena->GetCapacity();
+    }
+
+    if (MemoryProfiler::IsEnabled())
+    {
+        const auto HeapTotal = MemoryProfiler::GetTotalAllocations();
+
+        Stats.NumHeapAllocations = HeapTotal.NumAllocations - Registry.NumHeapAllocations;
+        Stats.HeapBytes          = HeapTotal.Bytes - Registry.HeapBytes;
+
+        Registry.NumHeapAllocations = HeapTotal.NumAllocations;
+        Registry.HeapBytes          = HeapTotal.Bytes;
+    }
+
+    Registry.LastFrameStats = Stats;
+}
+
+FrameArena::FrameStatistics FrameArena::GetFrameStats()
+{
+    auto&                       Registry = GetThreadArenaRegistry();
+    std::lock_guard<std::mutex> Lock{Registry.Mtx};
+    return Registry.LastFrameStats;
+}
+
+} // namespace Diligent
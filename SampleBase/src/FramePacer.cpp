@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr double AvgWeight = 0.1;
+
+// Safety margin that accounts for the sleep timer resolution and scheduling jitter, in seconds
+constexpr double SleepMargin = 0.001;
+
+double ToSeconds(FramePacer::ClockType::duration Duration)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(Duration).count();
+}
+
+FramePacer::ClockType::duration FromSeconds(double Seconds)
+{
+    return std::chrono::duration_cast<FramePacer::ClockType::duration>(std::chrono::duration<double>{Seconds});
+}
+
+} // namespace
+
+void FramePacer::SetRefreshRate(double RefreshRate)
+{
+    if (RefreshRate > 0)
+        m_AvgRefreshInterval = 1.0 / RefreshRate;
+}
+
+void FramePacer::BeginFrame()
+{
+    m_FrameStart = ClockType::now();
+}
+
+void FramePacer::BeforePresent()
+{
+    m_PresentStart = ClockType::now();
+
+    const double CPUTime = ToSeconds(m_PresentStart - m_FrameStart);
+    m_AvgCPUTime += (CPUTime - m_AvgCPUTime) * AvgWeight;
+    m_CPUTimeDeviation += (std::abs(CPUTime - m_AvgCPUTime) - m_CPUTimeDeviation) * AvgWeight;
+
+    m_Stats.CPUTime = CPUTime * 1000.0;
+}
+
+void FramePacer::OnInput()
+{
+    if (!m_HasPendingInput)
+    {
+        m_FirstInput      = ClockType::now();
+        m_HasPendingInput = true;
+    }
+}
+
+void FramePacer::EndFrame()
+{
+    const auto PresentEnd = ClockType::now();
+
+    if (m_LastPresentEnd != ClockType::time_point{})
+    {
+        const double FrameTime   = ToSeconds(PresentEnd - m_LastPresentEnd);
+        const double PresentTime = ToSeconds(PresentEnd - m_PresentStart);
+        m_Stats.FrameTime        = FrameTime * 1000.0;
+
+        // When present blocks, it returns shortly after the vertical blank, so the interval between
+        // consecutive presents is a good estimate of the refresh interval. Intervals that differ
+        // too much from the current estimate are missed vertical blanks or hitches and are ignored.
+        if (PresentTime > SleepMargin && FrameTime > m_AvgRefreshInterval * 0.5 && FrameTime < m_AvgRefreshInterval * 1.5)
+            m_AvgRefreshInterval += (FrameTime - m_AvgRefreshInterval) * AvgWeight;
+    }
+    m_LastPresentEnd        = PresentEnd;
+    m_Stats.RefreshInterval = m_AvgRefreshInterval * 1000.0;
+
+    if (m_HasPendingInput)
+    {
+        const double Latency    = ToSeconds(PresentEnd - m_FirstInput) * 1000.0;
+        m_Stats.InputLatency    = m_Stats.InputLatency > 0 ? m_Stats.InputLatency + (Latency - m_Stats.InputLatency) * AvgWeight : Latency;
+        m_Stats.MaxInputLatency = std::max(m_Stats.MaxInputLatency, Latency);
+        m_HasPendingInput       = false;
+    }
+
+    m_NextFrameStart = ComputeNextFrameStart(PresentEnd);
+    if (m_NextFrameStart > PresentEnd)
+    {
+        std::this_thread::sleep_until(m_NextFrameStart);
+        m_Stats.SleepTime = ToSeconds(ClockType::now() - PresentEnd) * 1000.0;
+    }
+    else
+    {
+        m_Stats.SleepTime = 0;
+    }
+}
+
+FramePacer::ClockType::time_point FramePacer::ComputeNextFrameStart(ClockType::time_point Now) const
+{
+    switch (m_Mode)
+    {
+        case MODE::None:
+            return Now;
+
+        case MODE::TargetFPS:
+        {
+            if (m_TargetFPS <= 0)
+                return Now;
+
+            // Advance the deadline by a fixed period so that the sleep error does not accumulate.
+            // If the application fell behind by more than a frame, restart from the current time.
+            const auto Period = FromSeconds(1.0 / m_TargetFPS);
+            const auto Next   = m_NextFrameStart + Period;
+            return Next + Period > Now ? Next : Now;
+        }
+
+        case MODE::LowLatency:
+        {
+            // The next frame should be presented right before the next vertical blank.
+            // Start it as late as possible, leaving enough time for the CPU work.
+            double Interval = m_AvgRefreshInterval;
+            if (m_TargetFPS > 0)
+                Interval = std::max(Interval, 1.0 / m_TargetFPS);
+            const double WorkTime = m_AvgCPUTime + 2.0 * m_CPUTimeDeviation + SleepMargin;
+            return Now + FromSeconds(std::max(Interval - WorkTime, 0.0));
+        }
+
+        default:
+            return Now;
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,92 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+// Main loop for Linux samples built with DILIGENT_BUILD_HEADLESS_SAMPLES.
+// The application does not open a window or connect to a display: the engine is initialized
+// in Vulkan mode, which also works with software implementations, and the sample renders
+// into an offscreen swap chain as fast as the device allows.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <memory>
+
+#include "SampleApp.hpp"
+#include "Errors.hpp"
+
+namespace
+{
+
+std::atomic<bool> g_QuitRequested{false};
+
+void OnQuitSignal(int)
+{
+    g_QuitRequested.store(true);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    using namespace Diligent;
+
+    std::unique_ptr<SampleApp> pApp{static_cast<SampleApp*>(CreateApplication())};
+    if (pApp->ProcessCommandLine(argc, argv) != NativeAppBase::CommandLineStatus::OK)
+        return -1;
+
+    if (!pApp->InitializeHeadless())
+    {
+        LOG_ERROR_MESSAGE("Failed to initialize the application in headless mode");
+        return -1;
+    }
+
+    // Exit the loop on Ctrl+C so that reports are written when the application is destroyed
+    std::signal(SIGINT, OnQuitSignal);
+    std::signal(SIGTERM, OnQuitSignal);
+
+    using ClockType = std::chrono::high_resolution_clock;
+
+    const auto StartTime = ClockType::now();
+    auto       PrevTime  = StartTime;
+    while (!g_QuitRequested.load())
+    {
+        const auto CurrTime = ClockType::now();
+        pApp->Update(std::chrono::duration<double>(CurrTime - StartTime).count(),
+                     std::chrono::duration<double>(CurrTime - PrevTime).count());
+        PrevTime = CurrTime;
+
+        pApp->Render();
+        pApp->Present();
+
+        // Golden image modes render a single frame
+        if (pApp->GetGoldenImageMode() != NativeAppBase::GoldenImageMode::None || pApp->IsFinished())
+            break;
+    }
+
+    const auto ExitCode = pApp->GetExitCode();
+    pApp.reset();
+    return ExitCode;
+}
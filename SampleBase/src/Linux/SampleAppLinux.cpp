@@ -23,6 +23,9 @@
 *  of the possibility of such damages.
 */
 
+#include <cstdlib>
+#include <poll.h>
+
 #include "SampleApp.hpp"
 #if VULKAN_SUPPORTED
 #    include "ImGuiImplLinuxXCB.hpp"
@@ -51,6 +54,14 @@ public:
             LinuxWindow.pDisplay = display;
             LinuxWindow.WindowId = window;
             InitializeDiligentEngine(&LinuxWindow);
+
+            // Track window visibility to idle while the window is occluded
+            XWindowAttributes WindowAttribs = {};
+            XGetWindowAttributes(display, window, &WindowAttribs);
+            XSelectInput(display, window, WindowAttribs.your_event_mask | VisibilityChangeMask);
+            m_pDisplay     = display;
+            m_ConnectionFd = ConnectionNumber(display);
+
             const auto& SCDesc = m_pSwapChain->GetDesc();
             m_pImGui           = ImGuiImplLinuxX11::Create(ImGuiDiligentCreateInfo{m_pDevice, SCDesc}, SCDesc.Width, SCDesc.Height);
             InitializeSample();
@@ -64,6 +75,24 @@ public:
 
     virtual int HandleXEvent(XEvent* xev) override final
     {
+        switch (xev->type)
+        {
+            case KeyPress:
+            case KeyRelease:
+            case ButtonPress:
+            case ButtonRelease:
+            case MotionNotify:
+                m_FramePacer.OnInput();
+                break;
+
+            case VisibilityNotify:
+                m_FramePacer.SetOccluded(xev->xvisibility.state == VisibilityFullyObscured);
+                break;
+
+            case MapNotify: m_FramePacer.SetOccluded(false); break;
+            case UnmapNotify: m_FramePacer.SetOccluded(true); break;
+        }
+
         auto handled = static_cast<ImGuiImplLinuxX11*>(m_pImGui.get())->HandleXEvent(xev);
         // Always handle mouse move, button release and key release events
         if (!handled || xev->type == ButtonRelease || xev->type == MotionNotify || xev->type == KeyRelease)
@@ -86,6 +115,19 @@ public:
             const auto& SCDesc = m_pSwapChain->GetDesc();
             m_pImGui           = ImGuiImplLinuxXCB::Create(ImGuiDiligentCreateInfo{m_pDevice, SCDesc}, connection, SCDesc.Width, SCDesc.Height);
             m_TheSample->GetInputController().InitXCBKeysms(connection);
+
+            // Track window visibility to idle while the window is occluded
+            auto  AttribsCookie = xcb_get_window_attributes(connection, window);
+            auto* pAttribs      = xcb_get_window_attributes_reply(connection, AttribsCookie, nullptr);
+            if (pAttribs != nullptr)
+            {
+                uint32_t EventMask = pAttribs->your_event_mask | XCB_EVENT_MASK_VISIBILITY_CHANGE;
+                xcb_change_window_attributes(connection, window, XCB_CW_EVENT_MASK, &EventMask);
+                xcb_flush(connection);
+                free(pAttribs);
+            }
+            m_ConnectionFd = xcb_get_file_descriptor(connection);
+
             InitializeSample();
             return true;
         }
@@ -98,6 +140,24 @@ public:
     {
         auto handled   = static_cast<ImGuiImplLinuxXCB*>(m_pImGui.get())->HandleXCBEvent(event);
         auto EventType = event->response_type & 0x7f;
+        switch (EventType)
+        {
+            case XCB_KEY_PRESS:
+            case XCB_KEY_RELEASE:
+            case XCB_BUTTON_PRESS:
+            case XCB_BUTTON_RELEASE:
+            case XCB_MOTION_NOTIFY:
+                m_FramePacer.OnInput();
+                break;
+
+            case XCB_VISIBILITY_NOTIFY:
+                m_FramePacer.SetOccluded(reinterpret_cast<const xcb_visibility_notify_event_t*>(event)->state == XCB_VISIBILITY_FULLY_OBSCURED);
+                break;
+
+            case XCB_MAP_NOTIFY: m_FramePacer.SetOccluded(false); break;
+            case XCB_UNMAP_NOTIFY: m_FramePacer.SetOccluded(true); break;
+        }
+
         // Always handle mouse move, button release and key release events
         if (!handled || EventType == XCB_MOTION_NOTIFY || EventType == XCB_BUTTON_RELEASE || EventType == XCB_KEY_RELEASE)
         {
@@ -105,6 +165,39 @@ public:
         }
     }
 #endif
+
+    virtual void Present() override final
+    {
+        if (m_FramePacer.IsOccluded())
+        {
+            // Nothing is rendered while the window is occluded. Instead of spinning
+            // the main loop, block until the window system sends more events.
+            WaitForWindowEvents();
+            return;
+        }
+
+        SampleApp::Present();
+    }
+
+private:
+    void WaitForWindowEvents()
+    {
+        if (m_ConnectionFd < 0)
+            return;
+
+        // Xlib may have already read events from the connection into its queue
+        if (m_pDisplay != nullptr && XPending(m_pDisplay) > 0)
+            return;
+
+        // Wake up periodically in case events were queued by the connection library
+        pollfd PollFd = {};
+        PollFd.fd     = m_ConnectionFd;
+        PollFd.events = POLLIN;
+        poll(&PollFd, 1, 100);
+    }
+
+    Display* m_pDisplay     = nullptr;
+    int      m_ConnectionFd = -1;
 };
 
 NativeAppBase* CreateApplication()
@@ -0,0 +1,522 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "MemoryProfiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include "PlatformDefinitions.h"
+
+#if PLATFORM_MACOS || PLATFORM_IOS || PLATFORM_TVOS
+#    include <malloc/malloc.h>
+#    include <mach/mach.h>
+#else
+#    include <malloc.h>
+#endif
+
+#if PLATFORM_WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <Windows.h>
+#    include <Psapi.h>
+#endif
+
+#if PLATFORM_WIN32 && (D3D11_SUPPORTED || D3D12_SUPPORTED)
+#    define DXGI_MEMORY_QUERY_SUPPORTED 1
+#    include <dxgi1_4.h>
+#    include <wrl/client.h>
+#else
+#    define DXGI_MEMORY_QUERY_SUPPORTED 0
+#endif
+
+#if DXGI_MEMORY_QUERY_SUPPORTED && D3D11_SUPPORTED
+#    include <d3d11.h>
+#    include "RenderDeviceD3D11.h"
+#endif
+
+#if DXGI_MEMORY_QUERY_SUPPORTED && D3D12_SUPPORTED
+#    include <d3d12.h>
+#    include "RenderDeviceD3D12.h"
+#endif
+
+#include "RenderDevice.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Global operator new and delete are only replaced when allocation counting is compiled in.
+// The counters are then updated from the first allocation of the process, so every block
+// that is freed through operator delete was counted when it was allocated.
+#if defined(DILIGENT_DEBUG) || DILIGENT_MEMORY_PROFILER
+#    define HEAP_ALLOCATION_COUNTING 1
+#else
+#    define HEAP_ALLOCATION_COUNTING 0
+#endif
+
+// The last thread slot and the last scope slot collect the allocations that don't fit
+constexpr int MaxThreads = 64;
+constexpr int MaxScopes  = 32;
+
+// Resident memory is queried from the OS every ResidentQueryInterval frames
+constexpr Uint32 ResidentQueryInterval = 30;
+
+struct CounterSlot
+{
+    std::atomic<const char*> Name{nullptr};
+    std::atomic<Uint64>      NumAllocations{0};
+    std::atomic<Uint64>      Bytes{0};
+
+    // Only accessed under ProfilerState::Mtx
+    MemoryProfiler::AllocationStats PrevTotal;
+    MemoryProfiler::AllocationStats Frame;
+};
+
+// These variables are used by operator new and are constant-initialized,
+// so they are valid before any dynamic initialization takes place.
+std::atomic<Int64> g_CurrentBytes{0};
+std::atomic<Int64> g_PeakBytes{0};
+std::atomic<int>   g_NumThreadSlots{0};
+std::atomic<int>   g_NumScopes{0};
+CounterSlot        g_ThreadSlots[MaxThreads];
+CounterSlot        g_ScopeSlots[MaxScopes];
+std::mutex         g_ScopeMtx;
+
+thread_local int t_ThreadSlot = -1;
+thread_local int t_Scope      = -1;
+
+struct ProfilerState
+{
+    std::mutex Mtx;
+
+    Uint32                          NumFrames = 0;
+    MemoryProfiler::AllocationStats Frame;
+    MemoryProfiler::AllocationStats MaxFrame;
+
+    Uint64 ResidentBytes     = 0;
+    Uint64 PeakResidentBytes = 0;
+
+    char UnnamedThreadNames[MaxThreads][24] = {};
+};
+
+ProfilerState& GetProfilerState()
+{
+    static ProfilerState State;
+    return State;
+}
+
+int GetThreadSlot()
+{
+    if (t_ThreadSlot < 0)
+        t_ThreadSlot = std::min(g_NumThreadSlots.fetch_add(1, std::memory_order_relaxed), MaxThreads - 1);
+    return t_ThreadSlot;
+}
+
+int FindScope(const char* Name, int NumScopes)
+{
+    for (int i = 0; i < NumScopes; ++i)
+    {
+        const char* ScopeName = g_ScopeSlots[i].Name.load(std::memory_order_relaxed);
+        if (ScopeName == Name || std::strcmp(ScopeName, Name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int FindOrAddScope(const char* Name)
+{
+    // Scopes are never removed, so the lock is only needed to add a new one
+    int Scope = FindScope(Name, g_NumScopes.load(std::memory_order_acquire));
+    if (Scope >= 0)
+        return Scope;
+
+    std::lock_guard<std::mutex> Lock{g_ScopeMtx};
+
+    const auto NumScopes = g_NumScopes.load(std::memory_order_relaxed);
+
+    Scope = FindScope(Name, NumScopes);
+    if (Scope >= 0)
+        return Scope;
+
+    if (NumScopes >= MaxScopes - 1)
+        return MaxScopes - 1;
+
+    g_ScopeSlots[NumScopes].Name.store(Name, std::memory_order_relaxed);
+    g_NumScopes.store(NumScopes + 1, std::memory_order_release);
+    return NumScopes;
+}
+
+int GetNumThreadSlots()
+{
+    return std::min(g_NumThreadSlots.load(std::memory_order_relaxed), MaxThreads);
+}
+
+int GetNumScopeSlots()
+{
+    // The overflow slot is only used when all other slots are taken
+    const auto NumScopes = g_NumScopes.load(std::memory_order_acquire);
+    return NumScopes >= MaxScopes - 1 ? MaxScopes : NumScopes;
+}
+
+MemoryProfiler::AllocationStats GetTotal(const CounterSlot& Slot)
+{
+    MemoryProfiler::AllocationStats Total;
+    Total.NumAllocations = Slot.NumAllocations.load(std::memory_order_relaxed);
+    Total.Bytes          = Slot.Bytes.load(std::memory_order_relaxed);
+    return Total;
+}
+
+void UpdateFrameCounters(CounterSlot& Slot)
+{
+    const auto Total = GetTotal(Slot);
+
+    Slot.Frame.NumAllocations = Total.NumAllocations - Slot.PrevTotal.NumAllocations;
+    Slot.Frame.Bytes          = Total.Bytes - Slot.PrevTotal.Bytes;
+    Slot.PrevTotal            = Total;
+}
+
+bool QueryResidentMemory(Uint64& Resident, Uint64& PeakResident)
+{
+#if PLATFORM_WIN32
+    PROCESS_MEMORY_COUNTERS Counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+    {
+        Resident     = Counters.WorkingSetSize;
+        PeakResident = Counters.PeakWorkingSetSize;
+        return true;
+    }
+#elif PLATFORM_MACOS || PLATFORM_IOS || PLATFORM_TVOS
+    mach_task_basic_info_data_t Info{};
+    mach_msg_type_number_t      Count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&Info), &Count) == KERN_SUCCESS)
+    {
+        Resident     = Info.resident_size;
+        PeakResident = Info.resident_size_max;
+        return true;
+    }
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+    if (FILE* pFile = std::fopen("/proc/self/status", "r"))
+    {
+        char Line[256];
+        while (std::fgets(Line, sizeof(Line), pFile) != nullptr)
+        {
+            if (std::strncmp(Line, "VmRSS:", 6) == 0)
+                Resident = std::strtoull(Line + 6, nullptr, 10) * 1024;
+            else if (std::strncmp(Line, "VmHWM:", 6) == 0)
+                PeakResident = std::strtoull(Line + 6, nullptr, 10) * 1024;
+        }
+        std::fclose(pFile);
+        return true;
+    }
+#endif
+    (void)Resident;
+    (void)PeakResident;
+    return false;
+}
+
+#if HEAP_ALLOCATION_COUNTING
+
+size_t GetAllocationSize(void* Ptr)
+{
+#    if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+    return _msize(Ptr);
+#    elif PLATFORM_MACOS || PLATFORM_IOS || PLATFORM_TVOS
+    return malloc_size(Ptr);
+#    else
+    return malloc_usable_size(Ptr);
+#    endif
+}
+
+void OnAllocate(size_t Size)
+{
+    auto& Thread = g_ThreadSlots[GetThreadSlot()];
+    Thread.NumAllocations.fetch_add(1, std::memory_order_relaxed);
+    Thread.Bytes.fetch_add(Size, std::memory_order_relaxed);
+
+    if (t_Scope >= 0)
+    {
+        auto& Scope = g_ScopeSlots[t_Scope];
+        Scope.NumAllocations.fetch_add(1, std::memory_order_relaxed);
+        Scope.Bytes.fetch_add(Size, std::memory_order_relaxed);
+    }
+
+    const auto CurrentBytes = g_CurrentBytes.fetch_add(static_cast<Int64>(Size), std::memory_order_relaxed) + static_cast<Int64>(Size);
+
+    auto PeakBytes = g_PeakBytes.load(std::memory_order_relaxed);
+    while (CurrentBytes > PeakBytes && !g_PeakBytes.compare_exchange_weak(PeakBytes, CurrentBytes, std::memory_order_relaxed))
+    {
+    }
+}
+
+void* ProfiledMalloc(size_t Size) noexcept
+{
+    void* Ptr = std::malloc(Size != 0 ? Size : 1);
+    if (Ptr != nullptr)
+        OnAllocate(GetAllocationSize(Ptr));
+    return Ptr;
+}
+
+void* ProfiledNew(size_t Size)
+{
+    while (true)
+    {
+        if (void* Ptr = ProfiledMalloc(Size))
+            return Ptr;
+
+        auto Handler = std::get_new_handler();
+        if (Handler == nullptr)
+            throw std::bad_alloc{};
+        Handler();
+    }
+}
+
+void ProfiledFree(void* Ptr) noexcept
+{
+    if (Ptr != nullptr)
+        g_CurrentBytes.fetch_sub(static_cast<Int64>(GetAllocationSize(Ptr)), std::memory_order_relaxed);
+    std::free(Ptr);
+}
+
+#endif
+
+} // namespace
+
+bool MemoryProfiler::IsEnabled()
+{
+    return HEAP_ALLOCATION_COUNTING != 0;
+}
+
+MemoryProfiler::Scope::Scope(const char* Name) :
+    m_PrevScope{t_Scope}
+{
+    t_Scope = FindOrAddScope(Name);
+}
+
+MemoryProfiler::Scope::~Scope()
+{
+    t_Scope = m_PrevScope;
+}
+
+void MemoryProfiler::SetThreadName(const char* Name)
+{
+    const auto Slot = GetThreadSlot();
+    // Threads in the overflow slot remain unnamed
+    if (Slot < MaxThreads - 1)
+        g_ThreadSlots[Slot].Name.store(Name, std::memory_order_relaxed);
+}
+
+void MemoryProfiler::EndFrame()
+{
+    auto&                       State = GetProfilerState();
+    std::lock_guard<std::mutex> Lock{State.Mtx};
+
+    AllocationStats Frame;
+    for (int i = 0; i < GetNumThreadSlots(); ++i)
+    {
+        auto& Slot = g_ThreadSlots[i];
+        UpdateFrameCounters(Slot);
+        Frame.NumAllocations += Slot.Frame.NumAllocations;
+        Frame.Bytes += Slot.Frame.Bytes;
+    }
+
+    for (int i = 0; i < GetNumScopeSlots(); ++i)
+        UpdateFrameCounters(g_ScopeSlots[i]);
+
+    State.Frame                   = Frame;
+    State.MaxFrame.NumAllocations = std::max(State.MaxFrame.NumAllocations, Frame.NumAllocations);
+    State.MaxFrame.Bytes          = std::max(State.MaxFrame.Bytes, Frame.Bytes);
+
+    if (State.NumFrames % ResidentQueryInterval == 0)
+    {
+        Uint64 Resident     = 0;
+        Uint64 PeakResident = 0;
+        if (QueryResidentMemory(Resident, PeakResident))
+        {
+            State.ResidentBytes     = Resident;
+            State.PeakResidentBytes = std::max({State.PeakResidentBytes, PeakResident, Resident});
+        }
+    }
+
+    ++State.NumFrames;
+}
+
+void MemoryProfiler::GetStats(Statistics& Stats)
+{
+    auto&                       State = GetProfilerState();
+    std::lock_guard<std::mutex> Lock{State.Mtx};
+
+    Stats.NumFrames = State.NumFrames;
+    Stats.Frame     = State.Frame;
+    Stats.MaxFrame  = State.MaxFrame;
+
+    Stats.CurrentHeapBytes = static_cast<Uint64>(g_CurrentBytes.load(std::memory_order_relaxed));
+    Stats.PeakHeapBytes    = static_cast<Uint64>(g_PeakBytes.load(std::memory_order_relaxed));
+
+    Stats.ResidentBytes     = State.ResidentBytes;
+    Stats.PeakResidentBytes = State.PeakResidentBytes;
+
+    Stats.Total = {};
+    Stats.Threads.clear();
+    for (int i = 0; i < GetNumThreadSlots(); ++i)
+    {
+        const auto& Slot = g_ThreadSlots[i];
+
+        NamedAllocationStats ThreadStats;
+        ThreadStats.Name  = Slot.Name.load(std::memory_order_relaxed);
+        ThreadStats.Frame = Slot.Frame;
+        ThreadStats.Total = GetTotal(Slot);
+        if (ThreadStats.Name == nullptr)
+        {
+            if (i == MaxThreads - 1)
+            {
+                ThreadStats.Name = "Other threads";
+            }
+            else
+            {
+                auto& Name = State.UnnamedThreadNames[i];
+                if (Name[0] == '\0')
+                    std::snprintf(Name, sizeof(Name), "Thread %d", i);
+                ThreadStats.Name = Name;
+            }
+        }
+        Stats.Threads.push_back(ThreadStats);
+
+        Stats.Total.NumAllocations += ThreadStats.Total.NumAllocations;
+        Stats.Total.Bytes += ThreadStats.Total.Bytes;
+    }
+
+    Stats.Scopes.clear();
+    for (int i = 0; i < GetNumScopeSlots(); ++i)
+    {
+        const auto& Slot = g_ScopeSlots[i];
+
+        NamedAllocationStats ScopeStats;
+        ScopeStats.Name  = i < MaxScopes - 1 ? Slot.Name.load(std::memory_order_relaxed) : "Other";
+        ScopeStats.Frame = Slot.Frame;
+        ScopeStats.Total = GetTotal(Slot);
+        Stats.Scopes.push_back(ScopeStats);
+    }
+}
+
+MemoryProfiler::AllocationStats MemoryProfiler::GetTotalAllocations()
+{
+    AllocationStats Total;
+    for (int i = 0; i < GetNumThreadSlots(); ++i)
+    {
+        const auto ThreadTotal = GetTotal(g_ThreadSlots[i]);
+        Total.NumAllocations += ThreadTotal.NumAllocations;
+        Total.Bytes += ThreadTotal.Bytes;
+    }
+    return Total;
+}
+
+bool MemoryProfiler::QueryDeviceMemory(IRenderDevice* pDevice, Uint64& Usage, Uint64& Budget)
+{
+#if DXGI_MEMORY_QUERY_SUPPORTED
+    Microsoft::WRL::ComPtr<IDXGIAdapter3> pAdapter3;
+    switch (pDevice->GetDeviceInfo().Type)
+    {
+#    if D3D11_SUPPORTED
+        case RENDER_DEVICE_TYPE_D3D11:
+        {
+            RefCntAutoPtr<IRenderDeviceD3D11>    pDeviceD3D11{pDevice, IID_RenderDeviceD3D11};
+            Microsoft::WRL::ComPtr<IDXGIDevice>  pDXGIDevice;
+            Microsoft::WRL::ComPtr<IDXGIAdapter> pAdapter;
+            if (pDeviceD3D11 &&
+                SUCCEEDED(pDeviceD3D11->GetD3D11Device()->QueryInterface(IID_PPV_ARGS(&pDXGIDevice))) &&
+                SUCCEEDED(pDXGIDevice->GetAdapter(&pAdapter)))
+            {
+                pAdapter.As(&pAdapter3);
+            }
+            break;
+        }
+#    endif
+
+#    if D3D12_SUPPORTED
+        case RENDER_DEVICE_TYPE_D3D12:
+        {
+            RefCntAutoPtr<IRenderDeviceD3D12>     pDeviceD3D12{pDevice, IID_RenderDeviceD3D12};
+            Microsoft::WRL::ComPtr<IDXGIFactory4> pFactory;
+            if (pDeviceD3D12 && SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&pFactory))))
+                pFactory->EnumAdapterByLuid(pDeviceD3D12->GetD3D12Device()->GetAdapterLuid(), IID_PPV_ARGS(&pAdapter3));
+            break;
+        }
+#    endif
+
+        default:
+            break;
+    }
+
+    if (pAdapter3)
+    {
+        DXGI_QUERY_VIDEO_MEMORY_INFO Info{};
+        if (SUCCEEDED(pAdapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &Info)))
+        {
+            Usage  = Info.CurrentUsage;
+            Budget = Info.Budget;
+            return true;
+        }
+    }
+#endif
+
+    (void)pDevice;
+    (void)Usage;
+    (void)Budget;
+    return false;
+}
+
+} // namespace Diligent
+
+#if HEAP_ALLOCATION_COUNTING
+
+// Global allocation functions that count allocations.
+// Aligned overloads are not replaced and are not counted.
+
+// clang-format off
+void* operator new  (size_t Size)                                 { return Diligent::ProfiledNew(Size); }
+void* operator new[](size_t Size)                                 { return Diligent::ProfiledNew(Size); }
+void* operator new  (size_t Size, const std::nothrow_t&) noexcept { return Diligent::ProfiledMalloc(Size); }
+void* operator new[](size_t Size, const std::nothrow_t&) noexcept { return Diligent::ProfiledMalloc(Size); }
+
+void operator delete  (void* Ptr) noexcept                        { Diligent::ProfiledFree(Ptr); }
+void operator delete[](void* Ptr) noexcept                        { Diligent::ProfiledFree(Ptr); }
+void operator delete  (void* Ptr, size_t) noexcept                { Diligent::ProfiledFree(Ptr); }
+void operator delete[](void* Ptr, size_t) noexcept                { Diligent::ProfiledFree(Ptr); }
+void operator delete  (void* Ptr, const std::nothrow_t&) noexcept { Diligent::ProfiledFree(Ptr); }
+void operator delete[](void* Ptr, const std::nothrow_t&) noexcept { Diligent::ProfiledFree(Ptr); }
+// clang-format on
+
+#endif
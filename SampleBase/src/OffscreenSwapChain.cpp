@@ -0,0 +1,213 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "OffscreenSwapChain.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ObjectBase.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "RefCountedObjectImpl.hpp"
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+class OffscreenSwapChain final : public ObjectBase<ISwapChain>
+{
+public:
+    using TBase = ObjectBase<ISwapChain>;
+
+    OffscreenSwapChain(IReferenceCounters*  pRefCounters,
+                       IRenderDevice*       pDevice,
+                       IDeviceContext*      pContext,
+                       const SwapChainDesc& SCDesc) :
+        TBase{pRefCounters},
+        m_pDevice{pDevice},
+        m_pContext{pContext},
+        m_SwapChainDesc{SCDesc}
+    {
+        m_SwapChainDesc.BufferCount  = std::max(m_SwapChainDesc.BufferCount, 1u);
+        m_SwapChainDesc.PreTransform = SURFACE_TRANSFORM_IDENTITY;
+
+        FenceDesc Desc;
+        Desc.Name = "Offscreen swap chain fence";
+        Desc.Type = FENCE_TYPE_CPU_WAIT_ONLY;
+        m_pDevice->CreateFence(Desc, &m_pFence);
+        if (!m_pFence)
+            LOG_ERROR_AND_THROW("Failed to create offscreen swap chain fence");
+
+        CreateBuffers();
+    }
+
+    IMPLEMENT_QUERY_INTERFACE_IN_PLACE(IID_SwapChain, TBase)
+
+    virtual void DILIGENT_CALL_TYPE Present(Uint32 SyncInterval) override final
+    {
+        m_pContext->EnqueueSignal(m_pFence, m_NextFenceValue);
+        m_BufferFenceValues[m_BackBufferIndex] = m_NextFenceValue++;
+
+        m_pContext->Flush();
+        // Release stale resources as there is no real swap chain to do this
+        m_pContext->FinishFrame();
+
+        m_BackBufferIndex = (m_BackBufferIndex + 1) % m_SwapChainDesc.BufferCount;
+
+        // Wait for the frame that last rendered into the next buffer
+        m_pFence->Wait(m_BufferFenceValues[m_BackBufferIndex]);
+    }
+
+    virtual const SwapChainDesc& DILIGENT_CALL_TYPE GetDesc() const override final
+    {
+        return m_SwapChainDesc;
+    }
+
+    virtual void DILIGENT_CALL_TYPE Resize(Uint32 NewWidth, Uint32 NewHeight, SURFACE_TRANSFORM NewPreTransform) override final
+    {
+        if (NewWidth == 0 || NewHeight == 0 ||
+            (NewWidth == m_SwapChainDesc.Width && NewHeight == m_SwapChainDesc.Height))
+            return;
+
+        m_SwapChainDesc.Width  = NewWidth;
+        m_SwapChainDesc.Height = NewHeight;
+        // Old buffers are released by the device when the GPU no longer uses them
+        CreateBuffers();
+    }
+
+    virtual void DILIGENT_CALL_TYPE SetFullscreenMode(const DisplayModeAttribs& DisplayMode) override final
+    {
+        LOG_WARNING_MESSAGE("Fullscreen mode is not supported by the offscreen swap chain");
+    }
+
+    virtual void DILIGENT_CALL_TYPE SetWindowedMode() override final
+    {
+    }
+
+    virtual void DILIGENT_CALL_TYPE SetMaximumFrameLatency(Uint32 MaxLatency) override final
+    {
+    }
+
+    virtual ITextureView* DILIGENT_CALL_TYPE GetCurrentBackBufferRTV() override final
+    {
+        return m_BackBufferRTVs[m_BackBufferIndex];
+    }
+
+    virtual ITextureView* DILIGENT_CALL_TYPE GetDepthBufferDSV() override final
+    {
+        return m_pDepthBufferDSV;
+    }
+
+private:
+    void CreateBuffers()
+    {
+        m_BackBufferRTVs.clear();
+        m_pDepthBufferDSV.Release();
+
+        TextureDesc ColorDesc;
+        ColorDesc.Type      = RESOURCE_DIM_TEX_2D;
+        ColorDesc.Width     = m_SwapChainDesc.Width;
+        ColorDesc.Height    = m_SwapChainDesc.Height;
+        ColorDesc.Format    = m_SwapChainDesc.ColorBufferFormat;
+        ColorDesc.BindFlags = BIND_RENDER_TARGET;
+        if (m_SwapChainDesc.Usage & SWAP_CHAIN_USAGE_SHADER_RESOURCE)
+            ColorDesc.BindFlags |= BIND_SHADER_RESOURCE;
+        if (m_SwapChainDesc.Usage & SWAP_CHAIN_USAGE_INPUT_ATTACHMENT)
+            ColorDesc.BindFlags |= BIND_INPUT_ATTACHMENT;
+
+        for (Uint32 i = 0; i < m_SwapChainDesc.BufferCount; ++i)
+        {
+            const auto Name = std::string{"Offscreen back buffer "} + std::to_string(i);
+            ColorDesc.Name  = Name.c_str();
+
+            RefCntAutoPtr<ITexture> pBackBuffer;
+            m_pDevice->CreateTexture(ColorDesc, nullptr, &pBackBuffer);
+            if (!pBackBuffer)
+                LOG_ERROR_AND_THROW("Failed to create offscreen back buffer");
+            m_BackBufferRTVs.emplace_back(pBackBuffer->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET));
+        }
+        m_BufferFenceValues.assign(m_SwapChainDesc.BufferCount, 0);
+        m_BackBufferIndex = 0;
+
+        if (m_SwapChainDesc.DepthBufferFormat != TEX_FORMAT_UNKNOWN)
+        {
+            TextureDesc DepthDesc;
+            DepthDesc.Name      = "Offscreen depth buffer";
+            DepthDesc.Type      = RESOURCE_DIM_TEX_2D;
+            DepthDesc.Width     = m_SwapChainDesc.Width;
+            DepthDesc.Height    = m_SwapChainDesc.Height;
+            DepthDesc.Format    = m_SwapChainDesc.DepthBufferFormat;
+            DepthDesc.BindFlags = BIND_DEPTH_STENCIL;
+
+            RefCntAutoPtr<ITexture> pDepthBuffer;
+            m_pDevice->CreateTexture(DepthDesc, nullptr, &pDepthBuffer);
+            if (!pDepthBuffer)
+                LOG_ERROR_AND_THROW("Failed to create offscreen depth buffer");
+            m_pDepthBufferDSV = pDepthBuffer->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+        }
+    }
+
+    RefCntAutoPtr<IRenderDevice>  m_pDevice;
+    RefCntAutoPtr<IDeviceContext> m_pContext;
+    RefCntAutoPtr<IFence>         m_pFence;
+    SwapChainDesc                 m_SwapChainDesc;
+
+    // Views keep their textures alive
+    std::vector<RefCntAutoPtr<ITextureView>> m_BackBufferRTVs;
+    std::vector<Uint64>                      m_BufferFenceValues;
+    RefCntAutoPtr<ITextureView>              m_pDepthBufferDSV;
+
+    Uint32 m_BackBufferIndex = 0;
+    Uint64 m_NextFenceValue  = 1;
+};
+
+} // namespace
+
+void CreateOffscreenSwapChain(IRenderDevice*       pDevice,
+                              IDeviceContext*      pContext,
+                              const SwapChainDesc& SCDesc,
+                              ISwapChain**         ppSwapChain)
+{
+    DEV_CHECK_ERR(pDevice != nullptr && pContext != nullptr, "Device and context must not be null");
+    DEV_CHECK_ERR(ppSwapChain != nullptr && *ppSwapChain == nullptr, "ppSwapChain must not be null and must point to null");
+
+    try
+    {
+        auto* pSwapChain = MakeNewRCObj<OffscreenSwapChain>()(pDevice, pContext, SCDesc);
+        pSwapChain->QueryInterface(IID_SwapChain, reinterpret_cast<IObject**>(ppSwapChain));
+    }
+    catch (...)
+    {
+        LOG_ERROR_MESSAGE("Failed to create offscreen swap chain");
+    }
+}
+
+} // namespace Diligent
@@ -29,6 +29,11 @@
 #include <iomanip>
 #include <cstdlib>
 #include <cmath>
+#include <chrono>
+#include <fstream>
+#include <cctype>
+#include <limits>
+#include <cstdio>
 
 #include "PlatformDefinitions.h"
 #include "SampleApp.hpp"
@@ -39,6 +44,14 @@
 #include "FileWrapper.hpp"
 #include "CommandLineParser.hpp"
 #include "GraphicsAccessories.hpp"
+#include "DataBlobImpl.hpp"
+#include "OffscreenSwapChain.hpp"
+
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+#    include "WinHPreface.h"
+#    include <Windows.h>
+#    include "WinHPostface.h"
+#endif
 
 #if D3D11_SUPPORTED
 #    include "EngineFactoryD3D11.h"
@@ -71,11 +84,36 @@ SampleApp::SampleApp() :
     m_TheSample{CreateSample()},
     m_AppTitle{m_TheSample->GetSampleName()}
 {
+    MemoryProfiler::SetThreadName("Main");
     UpdateAppSettings(true);
 }
 
 SampleApp::~SampleApp()
 {
+    if (m_CameraPath.Mode == CameraPathInfo::MODE::Record)
+    {
+        if (m_CameraPath.Path.Save(m_CameraPath.FilePath.c_str()))
+            LOG_INFO_MESSAGE("Recorded ", m_CameraPath.Path.GetNumFrames(), " frames to ", m_CameraPath.FilePath);
+    }
+    else if (m_CameraPath.Mode == CameraPathInfo::MODE::Replay)
+    {
+        // Write the timings of the frames replayed so far
+        FinishCameraPathReplay();
+    }
+
+    if (!m_Benchmark.ReportPath.empty())
+        WriteBenchmarkReport();
+
+    if (m_CaptureStream.IsOpen())
+    {
+        LOG_INFO_MESSAGE("Streamed ", m_CaptureStream.GetNumFrames(), " frames to ", m_ScreenCaptureInfo.StreamPath);
+        m_CaptureStream.Close();
+    }
+
+    SaveStateCache();
+    // The cache keeps references to the device and the objects it created
+    m_pStateCache.Release();
+
     m_pImGui.reset();
     m_TheSample.reset();
 
@@ -460,9 +498,149 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
             // Capture only one frame
             m_ScreenCaptureInfo.FramesToCapture = 1;
         }
+        else if (!m_ScreenCaptureInfo.StreamPath.empty())
+        {
+            if (m_CaptureStream.Open(m_ScreenCaptureInfo.StreamPath.c_str(), m_ScreenCaptureInfo.StreamFormat, m_ScreenCaptureInfo.CaptureFPS))
+            {
+                // Stream frames until the app exits unless the number of frames is given
+                if (m_ScreenCaptureInfo.FramesToCapture == 0)
+                    m_ScreenCaptureInfo.FramesToCapture = std::numeric_limits<Uint32>::max();
+            }
+            else
+            {
+                m_ExitCode = 6;
+            }
+        }
 
         m_pScreenCapture.reset(new ScreenCapture(m_pDevice));
     }
+
+    if (m_bUseStateCache)
+        CreateStateCache();
+}
+
+void SampleApp::CreateStateCache()
+{
+    RenderStateCacheCreateInfo CacheCI;
+    CacheCI.pDevice = m_pDevice;
+    CreateRenderStateCache(CacheCI, &m_pStateCache);
+    if (!m_pStateCache)
+    {
+        LOG_ERROR_MESSAGE("Failed to create render state cache");
+        return;
+    }
+
+    // Remember the size of the empty cache data to skip saving the cache if the sample does not use it
+    {
+        RefCntAutoPtr<IDataBlob> pEmptyCacheData;
+        if (m_pStateCache->WriteToBlob(0, &pEmptyCacheData) && pEmptyCacheData)
+            m_EmptyStateCacheSize = pEmptyCacheData->GetSize();
+    }
+
+    m_StateCachePath = FileSystem::GetLocalAppDataDirectory("DiligentEngine-Samples");
+    if (!FileSystem::PathExists(m_StateCachePath.c_str()))
+        FileSystem::CreateDirectory(m_StateCachePath.c_str());
+    if (!FileSystem::IsSlash(m_StateCachePath.back()))
+        m_StateCachePath.push_back(FileSystem::SlashSymbol);
+
+    // Shaders are compiled differently for every device type and build configuration,
+    // so every sample uses a separate cache file for each combination.
+    for (const char* c = m_TheSample->GetSampleName(); *c != '\0'; ++c)
+        m_StateCachePath.push_back(isalnum(static_cast<unsigned char>(*c)) ? *c : '_');
+    m_StateCachePath += '_';
+    m_StateCachePath += GetRenderDeviceTypeShortString(m_DeviceType);
+#ifdef DILIGENT_DEBUG
+    m_StateCachePath += "_d";
+#else
+    m_StateCachePath += "_r";
+#endif
+    m_StateCachePath += ".bin";
+
+    if (!FileSystem::FileExists(m_StateCachePath.c_str()))
+        return;
+
+    auto pCacheData = DataBlobImpl::Create();
+    {
+        FileWrapper CacheDataFile{m_StateCachePath.c_str()};
+        if (!CacheDataFile->Read(pCacheData))
+        {
+            LOG_ERROR_MESSAGE("Failed to read state cache file ", m_StateCachePath);
+            return;
+        }
+    }
+
+    m_StateCacheLoaded = m_pStateCache->Load(pCacheData);
+    if (!m_StateCacheLoaded)
+        LOG_ERROR_MESSAGE("Failed to load state cache file ", m_StateCachePath);
+}
+
+void SampleApp::SaveStateCache()
+{
+    if (!m_pStateCache || m_StateCachePath.empty())
+        return;
+
+    RefCntAutoPtr<IDataBlob> pCacheData;
+    if (!m_pStateCache->WriteToBlob(0, &pCacheData) || !pCacheData)
+        return;
+
+    // Do not write the file if the cache holds nothing
+    if (pCacheData->GetSize() <= m_EmptyStateCacheSize)
+        return;
+
+    // Write a temporary file first, so that a failed write does not destroy the existing cache file
+    const auto TmpFilePath = m_StateCachePath + ".tmp";
+    {
+        FileWrapper CacheDataFile{TmpFilePath.c_str(), EFileAccessMode::Overwrite};
+        if (!CacheDataFile || !CacheDataFile->Write(pCacheData->GetConstDataPtr(), pCacheData->GetSize()))
+        {
+            LOG_ERROR_MESSAGE("Failed to write state cache file ", TmpFilePath);
+            return;
+        }
+    }
+
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+    // std::rename fails on Windows if the destination exists
+    const auto Replaced = MoveFileExA(TmpFilePath.c_str(), m_StateCachePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+#else
+    const auto Replaced = std::rename(TmpFilePath.c_str(), m_StateCachePath.c_str()) == 0;
+#endif
+    if (!Replaced)
+        LOG_ERROR_MESSAGE("Failed to replace state cache file ", m_StateCachePath);
+}
+
+bool SampleApp::InitializeHeadless()
+{
+#if VULKAN_SUPPORTED
+    // Vulkan is the only backend that can create a device without a window
+    if (m_DeviceType != RENDER_DEVICE_TYPE_VULKAN)
+    {
+        LOG_INFO_MESSAGE("Headless mode uses Vulkan backend");
+        m_DeviceType = RENDER_DEVICE_TYPE_VULKAN;
+    }
+
+    try
+    {
+        InitializeDiligentEngine(nullptr);
+
+        m_SwapChainInitDesc.Width  = m_InitialWindowWidth > 0 ? m_InitialWindowWidth : 1280;
+        m_SwapChainInitDesc.Height = m_InitialWindowHeight > 0 ? m_InitialWindowHeight : 1024;
+        CreateOffscreenSwapChain(m_pDevice, GetImmediateContext(), m_SwapChainInitDesc, &m_pSwapChain);
+        if (!m_pSwapChain)
+            return false;
+
+        const auto& SCDesc = m_pSwapChain->GetDesc();
+        m_pImGui.reset(new ImGuiImplDiligent{ImGuiDiligentCreateInfo{m_pDevice, SCDesc}});
+        InitializeSample();
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+#else
+    LOG_ERROR_MESSAGE("Headless mode requires Vulkan backend");
+    return false;
+#endif
 }
 
 void SampleApp::InitializeSample()
@@ -504,9 +682,69 @@ void SampleApp::InitializeSample()
     InitInfo.NumDeferredCtx = static_cast<Uint32>(m_pDeviceContexts.size()) - m_NumImmediateContexts;
     InitInfo.pSwapChain     = m_pSwapChain;
     InitInfo.pImGui         = m_pImGui.get();
+    InitInfo.pStateCache    = m_pStateCache;
+
+    const auto InitStartTime = std::chrono::high_resolution_clock::now();
     m_TheSample->Initialize(InitInfo);
+    const auto InitEndTime = std::chrono::high_resolution_clock::now();
+
+    // Print the startup-phase timing breakdown
+    const auto InitTime     = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(InitEndTime - InitStartTime).count();
+    const auto TexLoadStats = m_TheSample->GetTextureLoadService().GetStats();
+    if (TexLoadStats.NumTextures > 0)
+    {
+        LOG_INFO_MESSAGE("Sample initialized in ", std::fixed, std::setprecision(1), InitTime, " ms. ",
+                         TexLoadStats.NumTextures, " textures decoded on ", TexLoadStats.NumThreads, " threads: ",
+                         TexLoadStats.DecodeTime, " ms decode time, ", TexLoadStats.LoadTime, " ms wall time, ",
+                         TexLoadStats.WaitTime, " ms waited, ", TexLoadStats.CreateTime, " ms texture creation");
+    }
+    else
+    {
+        LOG_INFO_MESSAGE("Sample initialized in ", std::fixed, std::setprecision(1), InitTime, " ms");
+    }
+
+    if (m_pStateCache)
+    {
+        // The initialization time of the run that populated the cache is stored next to the cache file
+        const auto ColdInitTimePath = m_StateCachePath + ".time";
+        if (m_StateCacheLoaded)
+        {
+            double        ColdInitTime = 0;
+            std::ifstream ColdInitTimeFile{ColdInitTimePath};
+            if (ColdInitTimeFile >> ColdInitTime)
+            {
+                LOG_INFO_MESSAGE("Render state cache: ", std::fixed, std::setprecision(1), ColdInitTime - InitTime,
+                                 " ms saved compared to the cold start (", ColdInitTime, " ms)");
+            }
+        }
+        else
+        {
+            std::ofstream{ColdInitTimePath, std::ios::trunc} << InitTime;
+        }
+    }
 
     m_TheSample->WindowResize(SCDesc.Width, SCDesc.Height);
+
+    if (m_CameraPath.Mode == CameraPathInfo::MODE::Replay)
+    {
+        auto& Path = m_CameraPath.Path;
+        if (Path.Load(m_CameraPath.FilePath.c_str()) && Path.GetNumFrames() > 0)
+        {
+            if (Path.GetWidth() != SCDesc.Width || Path.GetHeight() != SCDesc.Height)
+            {
+                LOG_WARNING_MESSAGE("Camera path was recorded at ", Path.GetWidth(), "x", Path.GetHeight(),
+                                    " while the current resolution is ", SCDesc.Width, "x", SCDesc.Height,
+                                    ". Mouse input may not be reproduced exactly.");
+            }
+            m_CameraPath.CurrentTime = Path.GetStartTime();
+            m_CameraPath.Timings.reserve(Path.GetNumFrames());
+            LOG_INFO_MESSAGE("Replaying ", Path.GetNumFrames(), " frames from ", m_CameraPath.FilePath);
+        }
+        else
+        {
+            m_CameraPath.Mode = CameraPathInfo::MODE::None;
+        }
+    }
 }
 
 void SampleApp::UpdateAdaptersDialog()
@@ -572,6 +810,57 @@ void SampleApp::UpdateAdaptersDialog()
 
         ImGui::Checkbox("VSync", &m_bVSync);
 
+        {
+            auto FramePacingMode = m_FramePacer.GetMode();
+            ImGui::SetNextItemWidth(120);
+            if (ImGui::Combo("Frame pacing", reinterpret_cast<int*>(&FramePacingMode), "None\0Target FPS\0Low latency\0\0"))
+                m_FramePacer.SetMode(FramePacingMode);
+
+            if (FramePacingMode != FramePacer::MODE::None)
+            {
+                auto TargetFPS = static_cast<float>(m_FramePacer.GetTargetFPS());
+                ImGui::SetNextItemWidth(120);
+                if (ImGui::SliderFloat("Target FPS", &TargetFPS, 0, 240, TargetFPS > 0 ? "%.0f" : "Off"))
+                    m_FramePacer.SetTargetFPS(TargetFPS);
+            }
+
+            const auto& PacerStats = m_FramePacer.GetStats();
+            ImGui::TextDisabled("Frame: %.2f ms (CPU %.2f, sleep %.2f)", PacerStats.FrameTime, PacerStats.CPUTime, PacerStats.SleepTime);
+            ImGui::TextDisabled("Refresh interval: %.2f ms", PacerStats.RefreshInterval);
+            ImGui::TextDisabled("Input latency: %.2f ms (max %.2f)", PacerStats.InputLatency, PacerStats.MaxInputLatency);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Reset"))
+                m_FramePacer.ResetStats();
+        }
+
+        {
+            const auto& TransientStats = m_TheSample->GetTransientTexturePool().GetStats();
+            if (TransientStats.NumTextures > 0)
+            {
+                static constexpr double MB = 1 << 20;
+                ImGui::TextDisabled("Recycled render targets: %u (%u in use)", TransientStats.NumTextures, TransientStats.NumInUse);
+                ImGui::TextDisabled("Allocated: %.1f MB, peak: %.1f MB, used: %.1f MB",
+                                    static_cast<double>(TransientStats.AllocatedBytes) / MB,
+                                    static_cast<double>(TransientStats.PeakBytes) / MB,
+                                    static_cast<double>(TransientStats.RequestedBytes) / MB);
+            }
+        }
+
+        {
+            const auto FrameStats = FrameArena::GetFrameStats();
+            ImGui::TextDisabled("Frame arena: %.1f KB (capacity %.1f KB)",
+                                static_cast<double>(FrameStats.ArenaBytes) / 1024.0,
+                                static_cast<double>(FrameStats.ArenaCapacity) / 1024.0);
+            if (MemoryProfiler::IsEnabled())
+            {
+                ImGui::TextDisabled("Heap allocations: %llu (%.1f KB)",
+                                    static_cast<unsigned long long>(FrameStats.NumHeapAllocations),
+                                    static_cast<double>(FrameStats.HeapBytes) / 1024.0);
+            }
+        }
+
+        ImGui::Checkbox("Memory profiler", &m_MemoryProfiler.ShowDialog);
+
         if (m_pDevice->GetDeviceInfo().IsD3DDevice())
         {
             // clang-format off
@@ -609,6 +898,213 @@ void SampleApp::UpdateAdaptersDialog()
 #endif
 }
 
+void SampleApp::UpdateMemoryStats()
+{
+    if (!m_MemoryProfiler.ShowDialog && m_Benchmark.ReportPath.empty())
+        return;
+
+    auto& Stats = m_MemoryProfiler.Stats;
+    MemoryProfiler::GetStats(Stats);
+
+    // Video memory queries go to the driver, so they are not done every frame
+    static constexpr Uint32 DeviceMemoryQueryInterval = 30;
+    if (m_pDevice && Stats.NumFrames % DeviceMemoryQueryInterval == 1)
+    {
+        auto& Info = m_MemoryProfiler;
+
+        Info.DeviceMemoryAvailable = MemoryProfiler::QueryDeviceMemory(m_pDevice, Info.DeviceMemoryUsage, Info.DeviceMemoryBudget);
+        if (Info.DeviceMemoryAvailable)
+            Info.PeakDeviceMemoryUsage = std::max(Info.PeakDeviceMemoryUsage, Info.DeviceMemoryUsage);
+    }
+}
+
+void SampleApp::UpdateMemoryProfilerDialog()
+{
+    const auto& Info  = m_MemoryProfiler;
+    const auto& Stats = Info.Stats;
+
+    static constexpr double KB = 1 << 10;
+    static constexpr double MB = 1 << 20;
+
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+    ImGui::SetNextWindowPos(ImVec2(10, static_cast<float>(SCDesc.Height) - 10), ImGuiCond_FirstUseEver, ImVec2(0, 1));
+    ImGui::SetNextWindowSize(ImVec2(380, 0), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Memory", &m_MemoryProfiler.ShowDialog))
+    {
+        if (Stats.ResidentBytes > 0)
+        {
+            ImGui::Text("Resident: %.1f MB (peak %.1f MB)",
+                        static_cast<double>(Stats.ResidentBytes) / MB,
+                        static_cast<double>(Stats.PeakResidentBytes) / MB);
+        }
+
+        if (Info.DeviceMemoryAvailable)
+        {
+            ImGui::Text("Video memory: %.1f MB (peak %.1f MB), budget: %.1f MB",
+                        static_cast<double>(Info.DeviceMemoryUsage) / MB,
+                        static_cast<double>(Info.PeakDeviceMemoryUsage) / MB,
+                        static_cast<double>(Info.DeviceMemoryBudget) / MB);
+        }
+
+        if (MemoryProfiler::IsEnabled())
+        {
+            ImGui::Text("Heap: %.1f MB (peak %.1f MB)",
+                        static_cast<double>(Stats.CurrentHeapBytes) / MB,
+                        static_cast<double>(Stats.PeakHeapBytes) / MB);
+            ImGui::Text("Frame allocations: %llu, %.1f KB (max %llu, %.1f KB)",
+                        static_cast<unsigned long long>(Stats.Frame.NumAllocations),
+                        static_cast<double>(Stats.Frame.Bytes) / KB,
+                        static_cast<unsigned long long>(Stats.MaxFrame.NumAllocations),
+                        static_cast<double>(Stats.MaxFrame.Bytes) / KB);
+            ImGui::Text("Total allocations: %llu, %.1f MB",
+                        static_cast<unsigned long long>(Stats.Total.NumAllocations),
+                        static_cast<double>(Stats.Total.Bytes) / MB);
+
+            // Allocations in the last frame and since the start
+            const auto ShowAllocations = [](const char* Label, const std::vector<MemoryProfiler::NamedAllocationStats>& Entries) {
+                if (Entries.empty() || !ImGui::CollapsingHeader(Label, ImGuiTreeNodeFlags_DefaultOpen))
+                    return;
+
+                for (const auto& Entry : Entries)
+                {
+                    ImGui::Text("%s: %llu, %.1f KB (total %llu, %.1f MB)", Entry.Name,
+                                static_cast<unsigned long long>(Entry.Frame.NumAllocations),
+                                static_cast<double>(Entry.Frame.Bytes) / KB,
+                                static_cast<unsigned long long>(Entry.Total.NumAllocations),
+                                static_cast<double>(Entry.Total.Bytes) / MB);
+                }
+            };
+            ShowAllocations("Threads", Stats.Threads);
+            ShowAllocations("Scopes", Stats.Scopes);
+        }
+        else
+        {
+            ImGui::TextDisabled("Allocation counting is only available in debug builds and with DILIGENT_SAMPLES_MEMORY_PROFILER");
+        }
+    }
+    ImGui::End();
+}
+
+void SampleApp::WriteBenchmarkReport()
+{
+    std::ofstream Report{m_Benchmark.ReportPath};
+    if (!Report)
+    {
+        LOG_ERROR_MESSAGE("Failed to open benchmark report file ", m_Benchmark.ReportPath);
+        return;
+    }
+
+    auto& Stats = m_MemoryProfiler.Stats;
+    MemoryProfiler::GetStats(Stats);
+
+    const auto WriteString = [&Report](const char* Str) {
+        Report << '"';
+        for (const char* c = Str; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                Report << '\\';
+            Report << *c;
+        }
+        Report << '"';
+    };
+
+    const auto WriteAllocations = [&Report](const MemoryProfiler::AllocationStats& Allocations) {
+        Report << "{\"allocations\": " << Allocations.NumAllocations << ", \"bytes\": " << Allocations.Bytes << "}";
+    };
+
+    const auto WriteNamedAllocations = [&](const char* Name, const std::vector<MemoryProfiler::NamedAllocationStats>& Entries) {
+        Report << "    \"" << Name << "\": [";
+        for (size_t i = 0; i < Entries.size(); ++i)
+        {
+            Report << (i > 0 ? ",\n" : "\n") << "      {\"name\": ";
+            WriteString(Entries[i].Name);
+            Report << ", \"total\": ";
+            WriteAllocations(Entries[i].Total);
+            Report << "}";
+        }
+        Report << (Entries.empty() ? "]" : "\n    ]");
+    };
+
+    const auto NumFrames = m_Benchmark.NumFrames;
+
+    Report << "{\n";
+    Report << "  \"sample\": ";
+    WriteString(m_TheSample->GetSampleName());
+    Report << ",\n  \"device\": ";
+    WriteString(GetRenderDeviceTypeShortString(m_DeviceType));
+    Report << ",\n  \"adapter\": ";
+    WriteString(m_AdapterAttribs.Description);
+    Report << ",\n  \"frames\": " << NumFrames << ",\n";
+    Report << "  \"frame_time_ms\": {\"avg\": " << (NumFrames > 0 ? m_Benchmark.TotalFrameTime / NumFrames : 0.0)
+           << ", \"max\": " << m_Benchmark.MaxFrameTime << "},\n";
+
+    Report << "  \"memory\": {\n";
+    Report << "    \"resident_bytes\": " << Stats.ResidentBytes << ",\n";
+    Report << "    \"peak_resident_bytes\": " << Stats.PeakResidentBytes << ",\n";
+    if (m_MemoryProfiler.DeviceMemoryAvailable)
+    {
+        Report << "    \"device_bytes\": " << m_MemoryProfiler.DeviceMemoryUsage << ",\n";
+        Report << "    \"peak_device_bytes\": " << m_MemoryProfiler.PeakDeviceMemoryUsage << ",\n";
+        Report << "    \"device_budget_bytes\": " << m_MemoryProfiler.DeviceMemoryBudget << ",\n";
+    }
+    Report << "    \"heap_profiler\": " << (MemoryProfiler::IsEnabled() ? "true" : "false");
+    if (MemoryProfiler::IsEnabled())
+    {
+        Report << ",\n    \"heap_bytes\": " << Stats.CurrentHeapBytes << ",\n";
+        Report << "    \"peak_heap_bytes\": " << Stats.PeakHeapBytes << ",\n";
+        Report << "    \"max_frame\": ";
+        WriteAllocations(Stats.MaxFrame);
+        Report << ",\n    \"total\": ";
+        WriteAllocations(Stats.Total);
+        Report << ",\n";
+        WriteNamedAllocations("threads", Stats.Threads);
+        Report << ",\n";
+        WriteNamedAllocations("scopes", Stats.Scopes);
+    }
+    Report << "\n  }\n}\n";
+
+    LOG_INFO_MESSAGE("Benchmark report is written to ", m_Benchmark.ReportPath);
+}
+
+void SampleApp::FinishCameraPathReplay()
+{
+    const auto& Timings = m_CameraPath.Timings;
+    if (!Timings.empty())
+    {
+        double TotalFrameTime = 0;
+        double MaxFrameTime   = 0;
+        for (const auto& Timing : Timings)
+        {
+            TotalFrameTime += Timing.FrameTime;
+            MaxFrameTime = std::max(MaxFrameTime, Timing.FrameTime);
+        }
+        LOG_INFO_MESSAGE("Camera path replay: ", Timings.size(), " frames, frame time: ", std::fixed, std::setprecision(2),
+                         TotalFrameTime / static_cast<double>(Timings.size()), " ms average, ", MaxFrameTime, " ms max");
+    }
+
+    if (!m_CameraPath.TimingsPath.empty())
+    {
+        std::ofstream TimingsFile{m_CameraPath.TimingsPath, std::ios::trunc};
+        if (TimingsFile)
+        {
+            TimingsFile << "frame,time,frame_time_ms,cpu_time_ms\n";
+            for (size_t i = 0; i < Timings.size(); ++i)
+            {
+                const auto& Timing = Timings[i];
+                TimingsFile << i << ',' << Timing.Time << ',' << Timing.FrameTime << ',' << Timing.CPUTime << '\n';
+            }
+        }
+        else
+        {
+            LOG_ERROR_MESSAGE("Failed to open replay timings file ", m_CameraPath.TimingsPath);
+        }
+    }
+
+    // Continue with live input
+    m_CameraPath.Mode           = CameraPathInfo::MODE::None;
+    m_CameraPath.ReplayFinished = true;
+}
+
 
 // Command line example to capture frames:
 //
@@ -728,6 +1224,19 @@ SampleApp::CommandLineStatus SampleApp::ProcessCommandLine(int argc, const char*
 
     ArgsParser.Parse("capture_quality", m_ScreenCaptureInfo.JpegQuality);
     ArgsParser.Parse("capture_alpha", m_ScreenCaptureInfo.KeepAlpha);
+
+    if (ArgsParser.Parse("capture_stream", m_ScreenCaptureInfo.StreamPath))
+        m_ScreenCaptureInfo.AllowCapture = true;
+
+    {
+        const std::vector<std::pair<const char*, VideoStreamWriter::FORMAT>> StreamFmtEnumVals =
+            {
+                {"y4m", VideoStreamWriter::FORMAT::Y4M},
+                {"rgba", VideoStreamWriter::FORMAT::RGBA} //
+            };
+        ArgsParser.ParseEnum("capture_stream_format", '\0', StreamFmtEnumVals, m_ScreenCaptureInfo.StreamFormat);
+    }
+
     ArgsParser.Parse("width", 'w', m_InitialWindowWidth);
     ArgsParser.Parse("height", 'h', m_InitialWindowHeight);
     ArgsParser.Parse("validation", m_ValidationLevel);
@@ -763,6 +1272,37 @@ SampleApp::CommandLineStatus SampleApp::ProcessCommandLine(int argc, const char*
 
     ArgsParser.Parse("golden_image_tolerance", m_GoldenImgPixelTolerance);
     ArgsParser.Parse("vsync", m_bVSync);
+    ArgsParser.Parse("state_cache", m_bUseStateCache);
+
+    ArgsParser.Parse("memory_profiler", m_MemoryProfiler.ShowDialog);
+    ArgsParser.Parse("benchmark_json", m_Benchmark.ReportPath);
+
+    if (ArgsParser.Parse("record_camera", m_CameraPath.FilePath))
+        m_CameraPath.Mode = CameraPathInfo::MODE::Record;
+    if (ArgsParser.Parse("replay_camera", m_CameraPath.FilePath))
+        m_CameraPath.Mode = CameraPathInfo::MODE::Replay;
+    ArgsParser.Parse("replay_timings", m_CameraPath.TimingsPath);
+    ArgsParser.Parse("frames", m_MaxFrames);
+
+    {
+        const std::vector<std::pair<const char*, FramePacer::MODE>> FramePacingEnumVals =
+            {
+                {"none", FramePacer::MODE::None},
+                {"fps", FramePacer::MODE::TargetFPS},
+                {"latency", FramePacer::MODE::LowLatency} //
+            };
+        auto FramePacingMode = FramePacer::MODE::None;
+        if (ArgsParser.ParseEnum("frame_pacing", '\0', FramePacingEnumVals, FramePacingMode))
+            m_FramePacer.SetMode(FramePacingMode);
+
+        double TargetFPS = 0;
+        if (ArgsParser.Parse("target_fps", TargetFPS))
+        {
+            m_FramePacer.SetTargetFPS(TargetFPS);
+            if (m_FramePacer.GetMode() == FramePacer::MODE::None)
+                m_FramePacer.SetMode(FramePacer::MODE::TargetFPS);
+        }
+    }
     ArgsParser.Parse("non_separable_progs", m_bForceNonSeprblProgs);
 
 
@@ -800,21 +1340,82 @@ void SampleApp::WindowResize(int width, int height)
 
 void SampleApp::Update(double CurrTime, double ElapsedTime)
 {
+    // Skip the frame entirely while the window is occluded.
+    // Platform-specific applications wait for window events instead.
+    if (m_FramePacer.IsOccluded())
+        return;
+
+    m_FramePacer.BeginFrame();
+
+    // Transient data of the previous frame is no longer used
+    FrameArena::ResetThreadArenas();
+
+    // Allocation statistics of the previous frame are complete
+    MemoryProfiler::EndFrame();
+    UpdateMemoryStats();
+
+    if (!m_Benchmark.ReportPath.empty())
+    {
+        const auto FrameTime = ElapsedTime * 1000.0;
+        ++m_Benchmark.NumFrames;
+        m_Benchmark.TotalFrameTime += FrameTime;
+        m_Benchmark.MaxFrameTime = std::max(m_Benchmark.MaxFrameTime, FrameTime);
+    }
+
+    // The last replayed frame may have not been presented
+    if (m_CameraPath.Mode == CameraPathInfo::MODE::Replay && m_CameraPath.CurrentFrame == m_CameraPath.Path.GetNumFrames())
+        FinishCameraPathReplay();
+
+    Uint32 ReplayFrame = 0;
+    if (m_CameraPath.Mode == CameraPathInfo::MODE::Replay)
+    {
+        // Advance the frame index and the time together, so that every recorded step is applied
+        // exactly once even if the frame is not presented.
+        // The time is advanced by the recorded step rather than by the wall clock.
+        ReplayFrame = m_CameraPath.CurrentFrame++;
+        ElapsedTime = m_CameraPath.Path.GetFrame(ReplayFrame).ElapsedTime;
+        m_CameraPath.CurrentTime += ElapsedTime;
+        CurrTime = m_CameraPath.CurrentTime;
+    }
+
     m_CurrentTime = CurrTime;
 
     UpdateAppSettings(false);
 
     if (m_pImGui)
     {
+        MemoryProfiler::Scope ProfilerScope{"UI"};
+
         const auto& SCDesc = m_pSwapChain->GetDesc();
         m_pImGui->NewFrame(SCDesc.Width, SCDesc.Height, SCDesc.PreTransform);
         if (m_bShowAdaptersDialog)
         {
             UpdateAdaptersDialog();
         }
+        if (m_MemoryProfiler.ShowDialog)
+        {
+            UpdateMemoryProfilerDialog();
+        }
     }
     if (m_pDevice)
     {
+        MemoryProfiler::Scope ProfilerScope{"Sample update"};
+
+        auto& Controller = m_TheSample->GetInputController();
+        if (m_CameraPath.Mode == CameraPathInfo::MODE::Replay)
+        {
+            m_CameraPath.Path.ApplyFrame(ReplayFrame, Controller);
+        }
+        else if (m_CameraPath.Mode == CameraPathInfo::MODE::Record)
+        {
+            if (m_CameraPath.Path.GetNumFrames() == 0)
+            {
+                const auto& SCDesc = m_pSwapChain->GetDesc();
+                m_CameraPath.Path.Reset(CurrTime - ElapsedTime, SCDesc.Width, SCDesc.Height);
+            }
+            m_CameraPath.Path.AddFrame(ElapsedTime, Controller);
+        }
+
         m_TheSample->Update(CurrTime, ElapsedTime);
         m_TheSample->GetInputController().ClearState();
     }
@@ -825,17 +1426,26 @@ void SampleApp::Render()
     if (m_NumImmediateContexts == 0 || !m_pSwapChain)
         return;
 
+    // Nothing is visible, so there is no reason to render
+    if (m_FramePacer.IsOccluded())
+        return;
+
     auto* pCtx = GetImmediateContext();
     auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
     auto* pDSV = m_pSwapChain->GetDepthBufferDSV();
     pCtx->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    m_TheSample->Render();
+    {
+        MemoryProfiler::Scope ProfilerScope{"Sample render"};
+        m_TheSample->Render();
+    }
 
     // Restore default render target in case the sample has changed it
     pCtx->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     if (m_pImGui)
     {
+        MemoryProfiler::Scope ProfilerScope{"UI"};
+
         if (m_bShowUI)
         {
             // No need to call EndFrame as ImGui::Render calls it automatically
@@ -848,10 +1458,10 @@ void SampleApp::Render()
     }
 }
 
-void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::CaptureInfo& Capture)
+void SampleApp::CompareGoldenImage(const char* FileName, ScreenCapture::CaptureInfo& Capture)
 {
     RefCntAutoPtr<Image> pGoldenImg;
-    CreateImageFromFile(FileName.c_str(), &pGoldenImg, nullptr);
+    CreateImageFromFile(FileName, &pGoldenImg, nullptr);
     if (!pGoldenImg)
     {
         LOG_ERROR_MESSAGE("Failed to load golden image from file ", FileName);
@@ -935,7 +1545,7 @@ void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::C
     m_ExitCode = NumBadPixels > 0 ? 10 : 0;
 }
 
-void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::CaptureInfo& Capture)
+void SampleApp::SaveScreenCapture(const char* FileName, ScreenCapture::CaptureInfo& Capture)
 {
     auto* const pCtx = GetImmediateContext();
 
@@ -957,7 +1567,7 @@ void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::Ca
     Image::Encode(Info, &pEncodedImage);
     pCtx->UnmapTextureSubresource(Capture.pTexture, 0, 0);
 
-    FileWrapper pFile(FileName.c_str(), EFileAccessMode::Overwrite);
+    FileWrapper pFile(FileName, EFileAccessMode::Overwrite);
     if (pFile)
     {
         auto res = pFile->Write(pEncodedImage->GetDataPtr(), pEncodedImage->GetSize());
@@ -977,11 +1587,34 @@ void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::Ca
     // Do NOT set exit code to 0! We must not clear the previous error code.
 }
 
+void SampleApp::StreamScreenCapture(ScreenCapture::CaptureInfo& Capture)
+{
+    auto* const pCtx = GetImmediateContext();
+
+    // Convert the frame directly from the mapped staging texture to avoid an extra copy
+    MappedTextureSubresource TexData;
+    pCtx->MapTextureSubresource(Capture.pTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, TexData);
+    const auto& TexDesc = Capture.pTexture->GetDesc();
+
+    const auto res = m_CaptureStream.WriteFrame(TexData.pData, static_cast<size_t>(TexData.Stride), TexDesc.Width, TexDesc.Height, TexDesc.Format);
+    pCtx->UnmapTextureSubresource(Capture.pTexture, 0, 0);
+
+    if (!res)
+    {
+        // Stop capturing as all subsequent frames would fail too
+        m_CaptureStream.Close();
+        m_ScreenCaptureInfo.FramesToCapture = 0;
+        m_ExitCode                          = 5;
+    }
+}
+
 void SampleApp::Present()
 {
-    if (!m_pSwapChain)
+    if (!m_pSwapChain || m_FramePacer.IsOccluded())
         return;
 
+    MemoryProfiler::Scope ProfilerScope{"Present"};
+
     auto* const pCtx = GetImmediateContext();
 
     if (m_pScreenCapture && m_ScreenCaptureInfo.FramesToCapture > 0)
@@ -1010,28 +1643,31 @@ void SampleApp::Present()
         }
     }
 
+    m_FramePacer.BeforePresent();
     m_pSwapChain->Present(m_bVSync ? 1 : 0);
 
     if (m_pScreenCapture)
     {
         while (auto Capture = m_pScreenCapture->GetCapture())
         {
-            std::string FileName;
+            if (m_CaptureStream.IsOpen())
             {
-                std::stringstream FileNameSS;
-                if (!m_ScreenCaptureInfo.Directory.empty())
-                {
-                    FileNameSS << m_ScreenCaptureInfo.Directory;
-                    if (m_ScreenCaptureInfo.Directory.back() != '/')
-                        FileNameSS << '/';
-                }
-                FileNameSS << m_ScreenCaptureInfo.FileName;
+                StreamScreenCapture(Capture);
+                m_pScreenCapture->RecycleStagingTexture(std::move(Capture.pTexture));
+                continue;
+            }
+
+            const char* FileName = nullptr;
+            {
+                const auto& Dir       = m_ScreenCaptureInfo.Directory;
+                const char* Separator = (!Dir.empty() && Dir.back() != '/') ? "/" : "";
+                const char* Extension = m_ScreenCaptureInfo.FileFormat == IMAGE_FILE_FORMAT_JPEG ? ".jpg" : ".png";
+
+                auto& Arena = FrameArena::GetThreadArena();
                 if (m_GoldenImgMode == GoldenImageMode::None)
-                {
-                    FileNameSS << std::setw(3) << std::setfill('0') << Capture.Id;
-                }
-                FileNameSS << (m_ScreenCaptureInfo.FileFormat == IMAGE_FILE_FORMAT_JPEG ? ".jpg" : ".png");
-                FileName = FileNameSS.str();
+                    FileName = Arena.Format("%s%s%s%03u%s", Dir.c_str(), Separator, m_ScreenCaptureInfo.FileName.c_str(), Capture.Id, Extension);
+                else
+                    FileName = Arena.Format("%s%s%s%s", Dir.c_str(), Separator, m_ScreenCaptureInfo.FileName.c_str(), Extension);
             }
 
             if (m_GoldenImgMode == GoldenImageMode::Compare || m_GoldenImgMode == GoldenImageMode::CompareUpdate)
@@ -1049,6 +1685,23 @@ void SampleApp::Present()
             m_pScreenCapture->RecycleStagingTexture(std::move(Capture.pTexture));
         }
     }
+
+    m_FramePacer.EndFrame();
+    ++m_FrameCount;
+
+    if (m_CameraPath.Mode == CameraPathInfo::MODE::Replay)
+    {
+        const auto& PacerStats = m_FramePacer.GetStats();
+
+        CameraPathInfo::FrameTiming Timing;
+        Timing.Time      = m_CameraPath.CurrentTime;
+        Timing.FrameTime = PacerStats.FrameTime;
+        Timing.CPUTime   = PacerStats.CPUTime;
+        m_CameraPath.Timings.push_back(Timing);
+
+        if (m_CameraPath.CurrentFrame == m_CameraPath.Path.GetNumFrames())
+            FinishCameraPathReplay();
+    }
 }
 
 } // namespace Diligent
@@ -172,7 +172,8 @@ void SampleBase::Initialize(const SampleInitInfo& InitInfo)
     m_pDeferredContexts.resize(InitInfo.NumDeferredCtx);
     for (Uint32 ctx = 0; ctx < InitInfo.NumDeferredCtx; ++ctx)
         m_pDeferredContexts[ctx] = InitInfo.ppContexts[InitInfo.NumImmediateCtx + ctx];
-    m_pImGui = InitInfo.pImGui;
+    m_pImGui      = InitInfo.pImGui;
+    m_pStateCache = InitInfo.pStateCache;
     ImGui::StyleColorsDiligent();
 
     const auto& SCDesc = m_pSwapChain->GetDesc();
@@ -182,4 +183,34 @@ void SampleBase::Initialize(const SampleInitInfo& InitInfo)
                                 SCDesc.ColorBufferFormat == TEX_FORMAT_BGRA8_UNORM);
 }
 
+RefCntAutoPtr<IShader> SampleBase::CreateShader(const ShaderCreateInfo& ShaderCI) const
+{
+    RefCntAutoPtr<IShader> pShader;
+    if (m_pStateCache)
+        m_pStateCache->CreateShader(ShaderCI, &pShader);
+    else
+        m_pDevice->CreateShader(ShaderCI, &pShader);
+    return pShader;
+}
+
+RefCntAutoPtr<IPipelineState> SampleBase::CreateGraphicsPipelineState(const GraphicsPipelineStateCreateInfo& PSOCreateInfo) const
+{
+    RefCntAutoPtr<IPipelineState> pPSO;
+    if (m_pStateCache)
+        m_pStateCache->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+    else
+        m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+    return pPSO;
+}
+
+RefCntAutoPtr<IPipelineState> SampleBase::CreateComputePipelineState(const ComputePipelineStateCreateInfo& PSOCreateInfo) const
+{
+    RefCntAutoPtr<IPipelineState> pPSO;
+    if (m_pStateCache)
+        m_pStateCache->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+    else
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+    return pPSO;
+}
+
 } // namespace Diligent
@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "TextureLoadService.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+#include "GraphicsAccessories.hpp"
+#include "MemoryProfiler.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+double ToMilliseconds(std::chrono::high_resolution_clock::duration Duration)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(Duration).count();
+}
+
+} // namespace
+
+TextureLoadService::TextureLoadService(Uint32 NumThreads) :
+    m_NumThreads{NumThreads != 0 ? NumThreads : std::max(std::thread::hardware_concurrency(), 1u)}
+{
+}
+
+TextureLoadService::~TextureLoadService()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Quit = true;
+    }
+    m_CondVar.notify_all();
+
+    for (auto& Thread : m_WorkerThreads)
+        Thread.join();
+}
+
+void TextureLoadService::StartThreads()
+{
+    m_WorkerThreads.reserve(m_NumThreads);
+    for (Uint32 i = 0; i < m_NumThreads; ++i)
+        m_WorkerThreads.emplace_back(&TextureLoadService::WorkerThreadProc, this);
+}
+
+TextureLoadService::LoaderFuture TextureLoadService::LoadAsync(const char* FilePath, const TextureLoadInfo& LoadInfo)
+{
+    VERIFY_EXPR(FilePath != nullptr);
+
+    LoadTask Task;
+    Task.FilePath = FilePath;
+    Task.LoadInfo = LoadInfo;
+    if (LoadInfo.Name != nullptr)
+        Task.Name = LoadInfo.Name;
+
+    LoaderFuture Future = Task.Promise.get_future().share();
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (m_WorkerThreads.empty())
+            StartThreads();
+
+        if (m_FirstRequestTime == ClockType::time_point{})
+            m_FirstRequestTime = ClockType::now();
+
+        m_Tasks.emplace_back(std::move(Task));
+    }
+    m_CondVar.notify_one();
+
+    return Future;
+}
+
+std::vector<TextureLoadService::LoaderFuture> TextureLoadService::LoadAsync(const std::vector<std::string>& FilePaths, const TextureLoadInfo& LoadInfo)
+{
+    std::vector<LoaderFuture> Loaders;
+    Loaders.reserve(FilePaths.size());
+    for (const auto& FilePath : FilePaths)
+        Loaders.emplace_back(LoadAsync(FilePath.c_str(), LoadInfo));
+    return Loaders;
+}
+
+std::vector<TextureLoadService::LoaderFuture> TextureLoadService::LoadAsync(const char* FilePathFormat, Uint32 NumFiles, const TextureLoadInfo& LoadInfo)
+{
+    VERIFY_EXPR(FilePathFormat != nullptr);
+
+    std::vector<std::string> FilePaths(NumFiles);
+    for (Uint32 i = 0; i < NumFiles; ++i)
+    {
+        char FilePath[256];
+        snprintf(FilePath, sizeof(FilePath), FilePathFormat, i);
+        FilePaths[i] = FilePath;
+    }
+    return LoadAsync(FilePaths, LoadInfo);
+}
+
+void TextureLoadService::WorkerThreadProc()
+{
+    MemoryProfiler::SetThreadName("Texture loader");
+
+    while (true)
+    {
+        LoadTask Task;
+        {
+            std::unique_lock<std::mutex> Lock{m_Mtx};
+            m_CondVar.wait(Lock, [this] { return m_Quit || !m_Tasks.empty(); });
+            if (m_Quit)
+                break;
+
+            Task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+
+        Task.LoadInfo.Name = !Task.Name.empty() ? Task.Name.c_str() : nullptr;
+
+        // Decode the image and generate the mip levels
+        const auto StartTime = ClockType::now();
+
+        RefCntAutoPtr<ITextureLoader> pLoader;
+        CreateTextureLoaderFromFile(Task.FilePath.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, Task.LoadInfo, &pLoader);
+        if (!pLoader)
+            LOG_ERROR_MESSAGE("Failed to load texture '", Task.FilePath, "'");
+
+        const auto EndTime = ClockType::now();
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            ++m_Stats.NumTextures;
+            m_Stats.DecodeTime += ToMilliseconds(EndTime - StartTime);
+            m_LastCompletionTime = std::max(m_LastCompletionTime, EndTime);
+        }
+
+        Task.Promise.set_value(std::move(pLoader));
+    }
+}
+
+RefCntAutoPtr<ITextureLoader> TextureLoadService::Wait(const LoaderFuture& Loader)
+{
+    const auto StartTime = ClockType::now();
+    Loader.wait();
+    const auto EndTime = ClockType::now();
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Stats.WaitTime += ToMilliseconds(EndTime - StartTime);
+    }
+    return Loader.get();
+}
+
+RefCntAutoPtr<ITexture> TextureLoadService::CreateTexture(IRenderDevice* pDevice, const LoaderFuture& Loader)
+{
+    auto pLoader = Wait(Loader);
+    if (!pLoader)
+        return {};
+
+    const auto StartTime = ClockType::now();
+
+    RefCntAutoPtr<ITexture> pTexture;
+    pLoader->CreateTexture(pDevice, &pTexture);
+
+    const auto EndTime = ClockType::now();
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Stats.CreateTime += ToMilliseconds(EndTime - StartTime);
+    }
+
+    return pTexture;
+}
+
+std::vector<RefCntAutoPtr<ITexture>> TextureLoadService::CreateTextures(IRenderDevice* pDevice, const std::vector<LoaderFuture>& Loaders)
+{
+    std::vector<RefCntAutoPtr<ITexture>> Textures;
+    Textures.reserve(Loaders.size());
+    for (const auto& Loader : Loaders)
+        Textures.emplace_back(CreateTexture(pDevice, Loader));
+    return Textures;
+}
+
+RefCntAutoPtr<ITexture> TextureLoadService::CreateTextureArray(IRenderDevice*                   pDevice,
+                                                               const std::vector<LoaderFuture>& Loaders,
+                                                               const char*                      Name,
+                                                               BIND_FLAGS                       BindFlags)
+{
+    if (Loaders.empty())
+        return {};
+
+    std::vector<RefCntAutoPtr<ITextureLoader>> TexLoaders(Loaders.size());
+    for (size_t i = 0; i < Loaders.size(); ++i)
+    {
+        TexLoaders[i] = Wait(Loaders[i]);
+        if (!TexLoaders[i])
+            return {};
+    }
+
+    const auto StartTime = ClockType::now();
+
+    auto TexArrDesc = TexLoaders[0]->GetTextureDesc();
+    for (size_t i = 1; i < TexLoaders.size(); ++i)
+    {
+        const auto& SliceDesc = TexLoaders[i]->GetTextureDesc();
+        if (SliceDesc.Width != TexArrDesc.Width || SliceDesc.Height != TexArrDesc.Height ||
+            SliceDesc.Format != TexArrDesc.Format || SliceDesc.MipLevels != TexArrDesc.MipLevels)
+        {
+            LOG_ERROR_MESSAGE("Texture array slice ", i, " (", SliceDesc.Width, "x", SliceDesc.Height, ' ', GetTextureFormatAttribs(SliceDesc.Format).Name,
+                              ") does not match the first slice (", TexArrDesc.Width, "x", TexArrDesc.Height, ' ', GetTextureFormatAttribs(TexArrDesc.Format).Name, ')');
+            return {};
+        }
+    }
+
+    if (Name != nullptr)
+        TexArrDesc.Name = Name;
+    TexArrDesc.ArraySize = static_cast<Uint32>(TexLoaders.size());
+    TexArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+    TexArrDesc.Usage     = USAGE_DEFAULT;
+    TexArrDesc.BindFlags = BindFlags;
+
+    // Initialize all slices with a single call
+    std::vector<TextureSubResData> SubresData(TexArrDesc.ArraySize * TexArrDesc.MipLevels);
+    for (Uint32 slice = 0; slice < TexArrDesc.ArraySize; ++slice)
+    {
+        for (Uint32 mip = 0; mip < TexArrDesc.MipLevels; ++mip)
+        {
+            SubresData[slice * TexArrDesc.MipLevels + mip] = TexLoaders[slice]->GetSubresourceData(mip, 0);
+        }
+    }
+    TextureData InitData{SubresData.data(), TexArrDesc.MipLevels * TexArrDesc.ArraySize};
+
+    RefCntAutoPtr<ITexture> pTexArray;
+    pDevice->CreateTexture(TexArrDesc, &InitData, &pTexArray);
+
+    const auto EndTime = ClockType::now();
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Stats.CreateTime += ToMilliseconds(EndTime - StartTime);
+    }
+
+    return pTexArray;
+}
+
+TextureLoadService::Statistics TextureLoadService::GetStats() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    auto Stats       = m_Stats;
+    Stats.NumThreads = static_cast<Uint32>(m_WorkerThreads.size());
+    if (Stats.NumTextures > 0)
+        Stats.LoadTime = ToMilliseconds(m_LastCompletionTime - m_FirstRequestTime);
+    return Stats;
+}
+
+} // namespace Diligent
@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "TransientTexturePool.hpp"
+
+#include <algorithm>
+
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+TransientTexturePool::TransientTexturePool(Uint32 MaxUnusedFrames) :
+    m_MaxUnusedFrames{MaxUnusedFrames}
+{
+}
+
+Uint64 TransientTexturePool::GetTextureSize(const TextureDesc& Desc)
+{
+    if ((Desc.MiscFlags & MISC_TEXTURE_FLAG_MEMORYLESS) != 0)
+        return 0;
+
+    Uint64 Size = 0;
+    for (Uint32 Mip = 0; Mip < Desc.MipLevels; ++Mip)
+        Size += GetMipLevelProperties(Desc, Mip).MipSize;
+
+    return Size * Desc.GetArraySize() * Desc.SampleCount;
+}
+
+RefCntAutoPtr<ITexture> TransientTexturePool::Acquire(IRenderDevice* pDevice, const TextureDesc& Desc)
+{
+    // Texture description of a created texture contains the actual number of mip levels,
+    // so zero would never match
+    VERIFY(Desc.MipLevels != 0, "Transient textures must specify the number of mip levels explicitly");
+
+    // Note that TextureDesc comparison ignores the name
+    auto EntryIt = std::find_if(m_Entries.begin(), m_Entries.end(),
+                                [&Desc](const Entry& Candidate) {
+                                    return !Candidate.InUse && Candidate.pTexture->GetDesc() == Desc;
+                                });
+    if (EntryIt != m_Entries.end())
+    {
+        ++m_Stats.NumReused;
+    }
+    else
+    {
+        RefCntAutoPtr<ITexture> pTexture;
+        pDevice->CreateTexture(Desc, nullptr, &pTexture);
+        if (!pTexture)
+        {
+            LOG_ERROR_MESSAGE("Failed to create transient texture '", (Desc.Name != nullptr ? Desc.Name : ""), "'");
+            return {};
+        }
+
+        Entry NewEntry;
+        NewEntry.pTexture = std::move(pTexture);
+        NewEntry.Size     = GetTextureSize(Desc);
+        m_Entries.emplace_back(std::move(NewEntry));
+        EntryIt = m_Entries.end() - 1;
+
+        ++m_Stats.NumCreated;
+        ++m_Stats.NumTextures;
+        m_Stats.AllocatedBytes += EntryIt->Size;
+        m_Stats.PeakBytes = std::max(m_Stats.PeakBytes, m_Stats.AllocatedBytes);
+
+        m_FrameCreatedTextures = true;
+    }
+
+    EntryIt->InUse             = true;
+    EntryIt->LastUsedFrame     = m_FrameNumber;
+    EntryIt->LastAcquiredFrame = m_FrameNumber;
+
+    ++m_Stats.NumInUse;
+    m_Stats.InUseBytes += EntryIt->Size;
+    m_FrameRequestedBytes += EntryIt->Size;
+
+    return EntryIt->pTexture;
+}
+
+void TransientTexturePool::Release(RefCntAutoPtr<ITexture>& pTexture)
+{
+    if (!pTexture)
+        return;
+
+    auto EntryIt = std::find_if(m_Entries.begin(), m_Entries.end(),
+                                [&pTexture](const Entry& Candidate) {
+                                    return Candidate.pTexture == pTexture;
+                                });
+    if (EntryIt != m_Entries.end())
+    {
+        VERIFY(EntryIt->InUse, "Texture '", pTexture->GetDesc().Name, "' has already been released");
+        if (EntryIt->InUse)
+        {
+            EntryIt->InUse         = false;
+            EntryIt->LastUsedFrame = m_FrameNumber;
+
+            --m_Stats.NumInUse;
+            m_Stats.InUseBytes -= EntryIt->Size;
+        }
+    }
+    else
+    {
+        UNEXPECTED("Texture '", pTexture->GetDesc().Name, "' was not acquired from the pool");
+    }
+
+    pTexture.Release();
+}
+
+void TransientTexturePool::NextFrame()
+{
+    m_Stats.RequestedBytes = m_FrameRequestedBytes;
+
+    // New textures replace the free textures that were not acquired in this frame,
+    // for instance the targets released after the window was resized
+    const auto LastFrame          = m_FrameNumber;
+    const auto ReleaseNotAcquired = m_FrameCreatedTextures;
+
+    ++m_FrameNumber;
+
+    // Textures that are held across frames are used by the next frame as well
+    m_FrameRequestedBytes  = m_Stats.InUseBytes;
+    m_FrameCreatedTextures = false;
+
+    auto EntryIt = m_Entries.begin();
+    while (EntryIt != m_Entries.end())
+    {
+        if (EntryIt->InUse)
+        {
+            EntryIt->LastUsedFrame = m_FrameNumber;
+            ++EntryIt;
+        }
+        else if ((ReleaseNotAcquired && EntryIt->LastAcquiredFrame < LastFrame) || m_FrameNumber - EntryIt->LastUsedFrame > m_MaxUnusedFrames)
+        {
+            --m_Stats.NumTextures;
+            m_Stats.AllocatedBytes -= EntryIt->Size;
+            EntryIt = m_Entries.erase(EntryIt);
+        }
+        else
+        {
+            ++EntryIt;
+        }
+    }
+}
+
+void TransientTexturePool::ReleaseUnused()
+{
+    auto EntryIt = m_Entries.begin();
+    while (EntryIt != m_Entries.end())
+    {
+        if (!EntryIt->InUse)
+        {
+            --m_Stats.NumTextures;
+            m_Stats.AllocatedBytes -= EntryIt->Size;
+            EntryIt = m_Entries.erase(EntryIt);
+        }
+        else
+        {
+            ++EntryIt;
+        }
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,260 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "VideoStreamWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PlatformDefinitions.h"
+#include "Errors.hpp"
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Converts RGBA8 or BGRA8 pixels to planar YUV 4:2:0 using full-range BT.601 coefficients.
+// Chroma is computed from the average color of every 2x2 block.
+void ConvertToYUV420(const Uint8* pSrc, size_t Stride, Uint32 Width, Uint32 Height, bool IsBGRA, Uint8* pDst)
+{
+    const Uint32 R = IsBGRA ? 2 : 0;
+    const Uint32 G = 1;
+    const Uint32 B = IsBGRA ? 0 : 2;
+
+    const Uint32 ChromaWidth  = (Width + 1) / 2;
+    const Uint32 ChromaHeight = (Height + 1) / 2;
+
+    Uint8* pY = pDst;
+    Uint8* pU = pY + size_t{Width} * Height;
+    Uint8* pV = pU + size_t{ChromaWidth} * ChromaHeight;
+
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        const Uint8* pRow  = pSrc + y * Stride;
+        Uint8*       pYRow = pY + size_t{y} * Width;
+        for (Uint32 x = 0; x < Width; ++x)
+        {
+            const Uint8* pPixel = pRow + x * 4;
+            pYRow[x]            = static_cast<Uint8>((77 * pPixel[R] + 150 * pPixel[G] + 29 * pPixel[B] + 128) >> 8);
+        }
+    }
+
+    for (Uint32 cy = 0; cy < ChromaHeight; ++cy)
+    {
+        for (Uint32 cx = 0; cx < ChromaWidth; ++cx)
+        {
+            int SumR = 0, SumG = 0, SumB = 0, NumPixels = 0;
+            for (Uint32 y = cy * 2; y < std::min(cy * 2 + 2, Height); ++y)
+            {
+                for (Uint32 x = cx * 2; x < std::min(cx * 2 + 2, Width); ++x)
+                {
+                    const Uint8* pPixel = pSrc + y * Stride + x * 4;
+                    SumR += pPixel[R];
+                    SumG += pPixel[G];
+                    SumB += pPixel[B];
+                    ++NumPixels;
+                }
+            }
+            const int AvgR = (SumR + NumPixels / 2) / NumPixels;
+            const int AvgG = (SumG + NumPixels / 2) / NumPixels;
+            const int AvgB = (SumB + NumPixels / 2) / NumPixels;
+
+            // The 128 * 256 offset keeps the sums non-negative before the shift
+            const int U = (-43 * AvgR - 85 * AvgG + 128 * AvgB + 128 * 256 + 128) >> 8;
+            const int V = (128 * AvgR - 107 * AvgG - 21 * AvgB + 128 * 256 + 128) >> 8;
+
+            const size_t Idx = size_t{cy} * ChromaWidth + cx;
+            pU[Idx]          = static_cast<Uint8>(std::min(U, 255));
+            pV[Idx]          = static_cast<Uint8>(std::min(V, 255));
+        }
+    }
+}
+
+} // namespace
+
+VideoStreamWriter::~VideoStreamWriter()
+{
+    Close();
+}
+
+bool VideoStreamWriter::Open(const char* Path, FORMAT Format, double FrameRate)
+{
+    Close();
+
+    if (Path[0] == '|')
+    {
+#if PLATFORM_WIN32
+        m_pFile = _popen(Path + 1, "wb");
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+        m_pFile = popen(Path + 1, "w");
+#else
+        LOG_ERROR_MESSAGE("Piping the video stream to a command is not supported on this platform");
+#endif
+        m_IsPipe = true;
+    }
+    else
+    {
+        m_pFile  = std::fopen(Path, "wb");
+        m_IsPipe = false;
+    }
+
+    if (m_pFile == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to open video stream '", Path, "'");
+        return false;
+    }
+
+    // Frame headers and frame data are small and large writes, respectively;
+    // a large buffer lets the stream pass both to the OS in few calls.
+    std::setvbuf(m_pFile, nullptr, _IOFBF, size_t{1} << 20);
+
+    m_Format    = Format;
+    m_FrameRate = FrameRate > 0 ? FrameRate : 30;
+    m_Width     = 0;
+    m_Height    = 0;
+    m_NumFrames = 0;
+    return true;
+}
+
+void VideoStreamWriter::Close()
+{
+    if (m_pFile == nullptr)
+        return;
+
+    if (m_IsPipe)
+    {
+#if PLATFORM_WIN32
+        _pclose(m_pFile);
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+        pclose(m_pFile);
+#endif
+    }
+    else
+    {
+        std::fclose(m_pFile);
+    }
+    m_pFile = nullptr;
+}
+
+bool VideoStreamWriter::WriteFrame(const void* pData, size_t Stride, Uint32 Width, Uint32 Height, TEXTURE_FORMAT Format)
+{
+    if (m_pFile == nullptr)
+        return false;
+
+    bool IsBGRA = false;
+    switch (Format)
+    {
+        case TEX_FORMAT_RGBA8_UNORM:
+        case TEX_FORMAT_RGBA8_UNORM_SRGB:
+            break;
+
+        case TEX_FORMAT_BGRA8_UNORM:
+        case TEX_FORMAT_BGRA8_UNORM_SRGB:
+            IsBGRA = true;
+            break;
+
+        default:
+            LOG_ERROR_MESSAGE("Video stream does not support ", GetTextureFormatAttribs(Format).Name, " format");
+            return false;
+    }
+
+    if (m_NumFrames == 0)
+    {
+        m_Width  = Width;
+        m_Height = Height;
+        if (m_Format == FORMAT::Y4M)
+        {
+            std::fprintf(m_pFile, "YUV4MPEG2 W%u H%u F%u:1000 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n",
+                         Width, Height, static_cast<Uint32>(m_FrameRate * 1000 + 0.5));
+        }
+    }
+    else if (Width != m_Width || Height != m_Height)
+    {
+        LOG_ERROR_MESSAGE("Video stream frame size changed from ", m_Width, "x", m_Height, " to ", Width, "x", Height);
+        return false;
+    }
+
+    const auto*  pSrc      = static_cast<const Uint8*>(pData);
+    const Uint8* pFrame    = nullptr;
+    size_t       FrameSize = 0;
+    if (m_Format == FORMAT::Y4M)
+    {
+        FrameSize = size_t{Width} * Height + size_t{2} * ((Width + 1) / 2) * ((Height + 1) / 2);
+        m_FrameData.resize(FrameSize);
+        ConvertToYUV420(pSrc, Stride, Width, Height, IsBGRA, m_FrameData.data());
+        pFrame = m_FrameData.data();
+
+        std::fputs("FRAME\n", m_pFile);
+    }
+    else
+    {
+        const size_t RowSize = size_t{Width} * 4;
+        FrameSize            = RowSize * Height;
+        if (!IsBGRA && Stride == RowSize)
+        {
+            // Write the mapped data directly
+            pFrame = pSrc;
+        }
+        else
+        {
+            m_FrameData.resize(FrameSize);
+            for (Uint32 y = 0; y < Height; ++y)
+            {
+                const Uint8* pSrcRow = pSrc + y * Stride;
+                Uint8*       pDstRow = m_FrameData.data() + y * RowSize;
+                if (IsBGRA)
+                {
+                    for (Uint32 x = 0; x < Width; ++x)
+                    {
+                        pDstRow[x * 4 + 0] = pSrcRow[x * 4 + 2];
+                        pDstRow[x * 4 + 1] = pSrcRow[x * 4 + 1];
+                        pDstRow[x * 4 + 2] = pSrcRow[x * 4 + 0];
+                        pDstRow[x * 4 + 3] = pSrcRow[x * 4 + 3];
+                    }
+                }
+                else
+                {
+                    std::memcpy(pDstRow, pSrcRow, RowSize);
+                }
+            }
+            pFrame = m_FrameData.data();
+        }
+    }
+
+    if (std::fwrite(pFrame, 1, FrameSize, m_pFile) != FrameSize)
+    {
+        LOG_ERROR_MESSAGE("Failed to write frame ", m_NumFrames, " to the video stream");
+        return false;
+    }
+
+    ++m_NumFrames;
+    return true;
+}
+
+} // namespace Diligent
@@ -21,12 +21,14 @@
 #include <map>
 #include <vector>
 #include <iostream>
+#include <chrono>
 
 #include "asteroids_d3d11.h"
 #include "asteroids_d3d12.h"
 #include "asteroids_DE.h"
 #include "camera.h"
 #include "gui.h"
+#include "texture.h"
 
 using namespace DirectX;
 
@@ -193,7 +195,7 @@ LRESULT CALLBACK WindowProc(
                 return 0;
             case 'B':
                 if (gSettings.mode == Settings::RenderMode::DiligentD3D12 || gSettings.mode == Settings::RenderMode::DiligentVulkan) {
-                    gSettings.resourceBindingMode = (gSettings.resourceBindingMode + 1) % 4;
+                    gSettings.resourceBindingMode = (gSettings.resourceBindingMode + 1) % 5;
                     gUpdateWorkload = true;
                 }
                 return 0;
@@ -376,6 +378,8 @@ void CreateDemoWindow(HWND& hWnd)
 
 int main(int argc, char** argv)
 {
+    auto startupTime = std::chrono::high_resolution_clock::now();
+
 #if defined(_DEBUG) || defined(DEBUG)
     _CrtSetDbgFlag( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
 #endif
@@ -386,6 +390,8 @@ int main(int argc, char** argv)
     gVulkanAvailable = CheckDll("vulkan-1.dll");
 #endif
 
+    bool useAssetCache = true;
+
     gSettings.mode = Settings::RenderMode::Undefined;
     for (int a = 1; a < argc; ++a) {
         if (_stricmp(argv[a], "-close_after") == 0 && a + 1 < argc) {
@@ -415,6 +421,11 @@ int main(int argc, char** argv)
             gSettings.mode = gd3d12Available ? Settings::RenderMode::DiligentD3D12 : Settings::RenderMode::Undefined;
         } else if (_stricmp(argv[a], "-vk") == 0) {
             gSettings.mode = gVulkanAvailable ? Settings::RenderMode::DiligentVulkan : Settings::RenderMode::Undefined;
+        } else if (_stricmp(argv[a], "-no_asset_cache") == 0) {
+            useAssetCache = false;
+        } else if (_stricmp(argv[a], "-texture_benchmark") == 0) {
+            BenchmarkNoiseTextures_RGBA8(TEXTURE_DIM, NUM_UNIQUE_TEXTURES * 3);
+            return 0;
         } else {
             fprintf(stderr, "error: unrecognized argument '%s'\n", argv[a]);
             fprintf(stderr, "usage: asteroids_d3d12 [options]\n");
@@ -427,6 +438,8 @@ int main(int argc, char** argv)
             fprintf(stderr, "  -render_scale [scale]\n");
             fprintf(stderr, "  -locked_fps [fps]\n");
             fprintf(stderr, "  -warp\n");
+            fprintf(stderr, "  -texture_benchmark\n");
+            fprintf(stderr, "  -no_asset_cache\n");
             return -1;
         }
     }
@@ -450,7 +463,9 @@ int main(int argc, char** argv)
     ResetCameraView();
     // Camera projection set up in WM_SIZE
 
-    AsteroidsSimulation asteroids(1337, NUM_ASTEROIDS, NUM_UNIQUE_MESHES, MESH_MAX_SUBDIV_LEVELS, NUM_UNIQUE_TEXTURES);
+    // Generated meshes and textures are cached in the working directory
+    AsteroidsSimulation asteroids(1337, NUM_ASTEROIDS, NUM_UNIQUE_MESHES, MESH_MAX_SUBDIV_LEVELS, NUM_UNIQUE_TEXTURES,
+                                  useAssetCache ? "asteroids_cache.bin" : nullptr);
 
     if (gSettings.mode == Settings::RenderMode::Undefined)
     {
@@ -492,6 +507,7 @@ int main(int argc, char** argv)
     float filteredUpdateTime = 0.0f;
     float filteredRenderTime = 0.0f;
     float filteredFrameTime = 0.0f;
+    bool firstFrameRendered = false;
     for (;;)
     {
         MSG msg = {};
@@ -580,6 +596,7 @@ int main(int argc, char** argv)
                         case 1: resBindModeStr = "-mut";break;
                         case 2: resBindModeStr = "-tex_mut";break;
                         case 3: resBindModeStr = "-bindless";break;
+                        case 4: resBindModeStr = "-streamed";break;
                     }
                 break;
             }
@@ -593,6 +610,14 @@ int main(int argc, char** argv)
             sprintf_s(buffer, "Asteroids %s%s (%dt) - %4.1f ms (%4.1f ms / %4.1f ms)", ModeStr, resBindModeStr, (gSettings.multithreadedRendering ? gSettings.numThreads : 1), 
                               1000.f * filteredFrameTime, 1000.f * filteredUpdateTime, 1000.f * filteredRenderTime);
 
+            // Per-frame API call counts of the asteroids pass
+            if (gWorkloadDE != nullptr) {
+                Diligent::Uint32 numMaps = 0, numCommits = 0, numDraws = 0;
+                gWorkloadDE->GetDrawCounters(numMaps, numCommits, numDraws);
+                auto len = strlen(buffer);
+                sprintf_s(buffer + len, sizeof(buffer) - len, " - %u maps, %u commits, %u draws", numMaps, numCommits, numDraws);
+            }
+
             SetWindowText(hWnd, buffer);
 
             if (gSettings.lockFrameRate) {
@@ -623,6 +648,14 @@ int main(int argc, char** argv)
             break;
         }
 
+        if (!firstFrameRendered) {
+            std::cout
+                << "Startup time (first frame): "
+                << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startupTime).count()
+                << " ms" << std::endl;
+            firstFrameRendered = true;
+        }
+
         if (gSettings.lockFrameRate) {
 
             UINT64 afterRenderCount;
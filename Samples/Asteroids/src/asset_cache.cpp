@@ -0,0 +1,193 @@
+// Copyright 2014 Intel Corporation All Rights Reserved
+//
+// Intel makes no representations about the suitability of this software for any purpose.
+// THIS SOFTWARE IS PROVIDED ""AS IS."" INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES,
+// EXPRESS OR IMPLIED, AND ALL LIABILITY, INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES,
+// FOR THE USE OF THIS SOFTWARE, INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY
+// RIGHTS, AND INCLUDING THE WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// Intel does not assume any responsibility for any errors which may appear in this software
+// nor any responsibility to update it.
+
+#include "asset_cache.h"
+
+#include "WinHPreface.h"
+#include <windows.h>
+#include "WinHPostface.h"
+
+#include <string.h>
+#include <string>
+#include <fstream>
+
+namespace {
+
+enum : uint32_t { CACHE_FILE_MAGIC = 0x43545341 }; // 'ASTC'
+enum : uint64_t { CACHE_DATA_ALIGNMENT = 64 };
+
+struct CacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    AssetCacheKey key;
+    uint32_t sectionCount;
+    uint64_t checksum; // Covers the section table and section data
+};
+
+struct CacheSectionDesc
+{
+    uint64_t offset; // From the start of the file
+    uint64_t size;
+};
+
+const uint64_t CHECKSUM_SEED = 14695981039346656037ull;
+
+// FNV-1a style hash over 64-bit words, with an extra fold so that high bits affect the whole value
+uint64_t UpdateChecksum(uint64_t hash, const void* data, size_t size)
+{
+    const uint64_t prime = 1099511628211ull;
+    auto bytes = static_cast<const uint8_t*>(data);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * prime;
+    }
+    return hash;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+
+bool AssetCacheFile::Open(const char* path, const AssetCacheKey& key)
+{
+    Close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    mFile = file;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || uint64_t(fileSize.QuadPart) < sizeof(CacheFileHeader)) {
+        Close();
+        return false;
+    }
+    auto size = uint64_t(fileSize.QuadPart);
+
+    mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMapping != nullptr)
+        mView = static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (mView == nullptr) {
+        Close();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const CacheFileHeader*>(mView);
+    if (header->magic != CACHE_FILE_MAGIC ||
+        header->version != ASSET_CACHE_VERSION ||
+        memcmp(&header->key, &key, sizeof(key)) != 0 ||
+        header->sectionCount > (size - sizeof(CacheFileHeader)) / sizeof(CacheSectionDesc)) {
+        Close();
+        return false;
+    }
+
+    const auto* sectionDescs = reinterpret_cast<const CacheSectionDesc*>(mView + sizeof(CacheFileHeader));
+    uint64_t checksum = UpdateChecksum(CHECKSUM_SEED, sectionDescs, header->sectionCount * sizeof(CacheSectionDesc));
+    for (uint32_t s = 0; s < header->sectionCount; ++s) {
+        const auto& desc = sectionDescs[s];
+        if (desc.offset > size || desc.size > size - desc.offset) {
+            Close();
+            return false;
+        }
+        AssetCacheSection section = {mView + desc.offset, size_t(desc.size)};
+        checksum = UpdateChecksum(checksum, section.data, section.size);
+        mSections.push_back(section);
+    }
+
+    if (checksum != header->checksum) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void AssetCacheFile::Close()
+{
+    mSections.clear();
+    if (mView != nullptr) {
+        UnmapViewOfFile(mView);
+        mView = nullptr;
+    }
+    if (mMapping != nullptr) {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+    if (mFile != nullptr) {
+        CloseHandle(mFile);
+        mFile = nullptr;
+    }
+}
+
+
+bool WriteAssetCache(const char* path, const AssetCacheKey& key, const AssetCacheSection* sections, size_t sectionCount)
+{
+    std::vector<CacheSectionDesc> sectionDescs(sectionCount);
+    uint64_t offset = sizeof(CacheFileHeader) + sectionCount * sizeof(CacheSectionDesc);
+    for (size_t s = 0; s < sectionCount; ++s) {
+        offset = AlignUp(offset, CACHE_DATA_ALIGNMENT);
+        sectionDescs[s].offset = offset;
+        sectionDescs[s].size   = sections[s].size;
+        offset += sections[s].size;
+    }
+
+    CacheFileHeader header = {};
+    header.magic        = CACHE_FILE_MAGIC;
+    header.version      = ASSET_CACHE_VERSION;
+    header.key          = key;
+    header.sectionCount = uint32_t(sectionCount);
+    header.checksum     = UpdateChecksum(CHECKSUM_SEED, sectionDescs.data(), sectionCount * sizeof(CacheSectionDesc));
+    for (size_t s = 0; s < sectionCount; ++s) {
+        header.checksum = UpdateChecksum(header.checksum, sections[s].data, sections[s].size);
+    }
+
+    std::string tmpPath = std::string(path) + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(sectionDescs.data()), sectionCount * sizeof(CacheSectionDesc));
+
+        const char padding[CACHE_DATA_ALIGNMENT] = {};
+        uint64_t position = sizeof(CacheFileHeader) + sectionCount * sizeof(CacheSectionDesc);
+        for (size_t s = 0; s < sectionCount; ++s) {
+            file.write(padding, std::streamsize(sectionDescs[s].offset - position));
+            file.write(static_cast<const char*>(sections[s].data), std::streamsize(sections[s].size));
+            position = sectionDescs[s].offset + sectionDescs[s].size;
+        }
+
+        file.close();
+        if (!file) {
+            DeleteFileA(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    if (!MoveFileExA(tmpPath.c_str(), path, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+// Copyright 2014 Intel Corporation All Rights Reserved
+//
+// Intel makes no representations about the suitability of this software for any purpose.
+// THIS SOFTWARE IS PROVIDED ""AS IS."" INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES,
+// EXPRESS OR IMPLIED, AND ALL LIABILITY, INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES,
+// FOR THE USE OF THIS SOFTWARE, INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY
+// RIGHTS, AND INCLUDING THE WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// Intel does not assume any responsibility for any errors which may appear in this software
+// nor any responsibility to update it.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Persistent cache of procedurally generated meshes and textures.
+// A cache file is only used when its version, key and checksum match.
+// Files are memory-mapped, so data can be used in place without parsing.
+
+enum { ASSET_CACHE_VERSION = 1 };
+
+// Settings that affect the generated data
+struct AssetCacheKey
+{
+    uint32_t rngSeed;
+    uint32_t meshInstanceCount;
+    uint32_t subdivCount;
+    uint32_t textureCount;
+    uint32_t textureDim;
+    uint32_t vertexSize;
+    uint32_t indexSize;
+};
+
+struct AssetCacheSection
+{
+    const void* data;
+    size_t size;
+};
+
+// Read-only view of a cache file
+class AssetCacheFile
+{
+public:
+    AssetCacheFile() = default;
+    ~AssetCacheFile() { Close(); }
+
+    AssetCacheFile(const AssetCacheFile&) = delete;
+    AssetCacheFile& operator=(const AssetCacheFile&) = delete;
+
+    // Maps the file and validates it. Returns false if the file is missing, stale or corrupt.
+    bool Open(const char* path, const AssetCacheKey& key);
+    void Close();
+
+    size_t SectionCount() const { return mSections.size(); }
+    const AssetCacheSection& Section(size_t index) const { return mSections[index]; }
+
+private:
+    void* mFile = nullptr;
+    void* mMapping = nullptr;
+    const uint8_t* mView = nullptr;
+    std::vector<AssetCacheSection> mSections;
+};
+
+// Writes sections to a temporary file and then replaces the cache file,
+// so that an interrupted write never leaves a partial cache behind.
+bool WriteAssetCache(const char* path, const AssetCacheKey& key, const AssetCacheSection* sections, size_t sectionCount);
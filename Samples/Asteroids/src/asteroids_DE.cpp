@@ -84,14 +84,8 @@ struct DrawConstantBuffer
     float             unused1;
 };
 
-struct AsteroidData
-{
-    DirectX::XMFLOAT4X4 mWorld;
-    DirectX::XMFLOAT3   mSurfaceColor;
-    float               unused0;
-    DirectX::XMFLOAT3   mDeepColor;
-    Uint32              mTextureIndex;
-};
+// Per-asteroid data of the bindless and streamed modes is defined by the simulation
+using AsteroidData = AsteroidDrawData;
 
 struct SkyboxConstantBuffer
 {
@@ -221,9 +215,11 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
     InitDevice(hWnd, DevType);
 
     m_BindingMode = static_cast<BindingMode>(settings.resourceBindingMode);
-    if (m_BindingMode == BindingMode::Bindless && !mDevice->GetDeviceInfo().Features.BindlessResources)
+    if (UsesAsteroidDataBuffers() && !mDevice->GetDeviceInfo().Features.BindlessResources)
         m_BindingMode = BindingMode::TextureMutable;
 
+    mSubsets.resize(mNumSubsets);
+
     mCmdLists.resize(mDeferredCtxt.size());
     mWorkerThreads.resize(mNumSubsets - 1);
     for (auto& thread : mWorkerThreads)
@@ -254,17 +250,17 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
         BufferDesc desc;
         desc.Name = "Asteroids constant buffer";
         // In bindless mode we will be updating the buffer with UpdateBuffer method
-        desc.Usage          = (m_BindingMode == BindingMode::Bindless) ? USAGE_DEFAULT : USAGE_DYNAMIC;
+        desc.Usage          = UsesAsteroidDataBuffers() ? USAGE_DEFAULT : USAGE_DYNAMIC;
         desc.CPUAccessFlags = desc.Usage == USAGE_DYNAMIC ? CPU_ACCESS_WRITE : CPU_ACCESS_NONE;
         desc.BindFlags      = BIND_UNIFORM_BUFFER;
         // In bindless mode, we will only write view-projection matrix
-        desc.Size = static_cast<Uint32>((m_BindingMode == BindingMode::Bindless) ? sizeof(DirectX::XMFLOAT4X4) : sizeof(DrawConstantBuffer));
+        desc.Size = static_cast<Uint32>(UsesAsteroidDataBuffers() ? sizeof(DirectX::XMFLOAT4X4) : sizeof(DrawConstantBuffer));
         mDevice->CreateBuffer(desc, nullptr, &mDrawConstantBuffer);
-        if (m_BindingMode != BindingMode::Bindless)
+        if (!UsesAsteroidDataBuffers())
             Barriers.emplace_back(mDrawConstantBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
     }
 
-    if (m_BindingMode == BindingMode::Bindless)
+    if (UsesAsteroidDataBuffers())
     {
         {
             // In Direct3D there is no easy way to pass draw call number into the shader,
@@ -319,7 +315,7 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
 
         GraphicsPipeline.InputLayout.LayoutElements = inputDesc;
         // In bindless mode we will use instance ID buffer as the third input
-        GraphicsPipeline.InputLayout.NumElements = (m_BindingMode == BindingMode::Bindless) ? 3 : 2;
+        GraphicsPipeline.InputLayout.NumElements = UsesAsteroidDataBuffers() ? 3 : 2;
 
         GraphicsPipeline.DepthStencilDesc.DepthFunc = COMPARISON_FUNC_GREATER_EQUAL;
 
@@ -333,7 +329,7 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
             attribs.pShaderSourceStreamFactory = pShaderSourceFactory;
 
             ShaderMacro Macros[] = {{"BINDLESS", "1"}};
-            if (m_BindingMode == BindingMode::Bindless)
+            if (UsesAsteroidDataBuffers())
             {
                 attribs.Macros = {Macros, _countof(Macros)};
             }
@@ -350,7 +346,7 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
             attribs.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
 
             ShaderMacro Macros[] = {{"BINDLESS", "1"}};
-            if (m_BindingMode == BindingMode::Bindless)
+            if (UsesAsteroidDataBuffers())
             {
                 attribs.Macros = {Macros, _countof(Macros)};
             }
@@ -379,7 +375,7 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
         std::vector<ShaderResourceVariableDesc> Variables =
             {
                 {SHADER_TYPE_PIXEL, "Tex", m_BindingMode == BindingMode::Dynamic ? SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC : SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
-        if (m_BindingMode == BindingMode::Bindless)
+        if (UsesAsteroidDataBuffers())
             Variables.emplace_back(SHADER_TYPE_VERTEX, "g_Data", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE);
 
         PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
@@ -416,9 +412,9 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
             PSODesc.SRBAllocationGranularity = NUM_UNIQUE_TEXTURES;
             NumSRBs                          = NUM_UNIQUE_TEXTURES;
         }
-        else if (m_BindingMode == BindingMode::Bindless)
+        else if (UsesAsteroidDataBuffers())
         {
-            // Create one SRB per subset for bindless mode
+            // Create one SRB per subset for bindless and streamed modes
             NumSRBs = mNumSubsets;
         }
         mAsteroidsSRBs.resize(NumSRBs);
@@ -630,7 +626,7 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
             mAsteroidsSRBs[srb]->GetVariableByName(SHADER_TYPE_PIXEL, "Tex")->Set(mTextureSRVs[srb]);
         }
     }
-    else if (m_BindingMode == BindingMode::Bindless)
+    else if (UsesAsteroidDataBuffers())
     {
         // Bind all textures to every subset's SRB. The textures will be dynamically indexed in the shader.
         IDeviceObject* SRVArray[NUM_UNIQUE_TEXTURES];
@@ -833,7 +829,7 @@ void Asteroids::WorkerThreadFunc(Asteroids* pThis, Uint32 ThreadNum)
         auto  SubsetStart  = SubsetSize * (ThreadNum + 1);
         auto& FrameAttribs = pThis->mFrameAttribs;
 
-        pThis->mAsteroids->Update(FrameAttribs.frameTime, FrameAttribs.camera->Eye(), *FrameAttribs.settings, SubsetStart, SubsetSize);
+        pThis->UpdateSubset(1 + ThreadNum, pThis->mDeferredCtxt[ThreadNum], FrameAttribs, SubsetStart, SubsetSize);
 
         // Increment number of completed threads
         ++pThis->m_NumThreadsCompleted;
@@ -853,13 +849,43 @@ void Asteroids::WorkerThreadFunc(Asteroids* pThis, Uint32 ThreadNum)
     }
 }
 
+void Asteroids::UpdateSubset(Uint32              SubsetNum,
+                             IDeviceContext*     pCtx,
+                             const FrameAttribs& frameAttribs,
+                             Uint32              startIdx,
+                             Uint32              numAsteroids)
+{
+    if (m_BindingMode != BindingMode::Streamed)
+    {
+        mAsteroids->Update(frameAttribs.frameTime, frameAttribs.camera->Eye(), *frameAttribs.settings, startIdx, numAsteroids);
+        return;
+    }
+
+    // The buffer must be mapped in the context that renders the subset,
+    // so the deferred context has to begin recording here
+    if (pCtx->GetDesc().IsDeferred)
+        pCtx->Begin(0);
+
+    // Map the instance data buffer once and let the simulation write draw data directly into it.
+    // The buffer stays mapped until the subset is rendered.
+    auto& subset = mSubsets[SubsetNum];
+    subset.InstanceData.Map(pCtx, mAsteroidsDataBuffers[SubsetNum], MAP_WRITE, MAP_FLAG_DISCARD);
+    ++subset.NumMaps;
+
+    mAsteroids->Update(frameAttribs.frameTime, frameAttribs.camera->Eye(), *frameAttribs.settings, startIdx, numAsteroids,
+                       subset.InstanceData, &subset.Batches);
+}
+
 void Asteroids::RenderSubset(Uint32             SubsetNum,
                              IDeviceContext*    pCtx,
                              const OrbitCamera& camera,
                              Uint32             startIdx,
                              Uint32             numAsteroids)
 {
-    if (pCtx->GetDesc().IsDeferred)
+    auto& subset = mSubsets[SubsetNum];
+
+    // In streamed mode, recording was started by UpdateSubset
+    if (pCtx->GetDesc().IsDeferred && m_BindingMode != BindingMode::Streamed)
         pCtx->Begin(0);
 
     auto* pRTV = mSwapChain->GetCurrentBackBufferRTV();
@@ -875,10 +901,33 @@ void Asteroids::RenderSubset(Uint32             SubsetNum,
     {
         IBuffer* ia_buffers[] = {mVertexBuffer, mInstanceIDBuffer};
         // Bind instance data buffer in bindless mode
-        pCtx->SetVertexBuffers(0, (m_BindingMode == BindingMode::Bindless) ? 2 : 1, ia_buffers, nullptr, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_NONE);
+        pCtx->SetVertexBuffers(0, UsesAsteroidDataBuffers() ? 2 : 1, ia_buffers, nullptr, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_NONE);
         pCtx->SetIndexBuffer(mIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
     }
 
+    if (m_BindingMode == BindingMode::Streamed)
+    {
+        // Instance data was written by the simulation
+        subset.InstanceData.Unmap();
+
+        StateTransitionDesc Barrier{mAsteroidsDataBuffers[SubsetNum], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
+        pCtx->TransitionResourceStates(1, &Barrier);
+
+        pCtx->CommitShaderResources(mAsteroidsSRBs[SubsetNum], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+        ++subset.NumCommits;
+
+        for (const auto& batch : subset.Batches)
+        {
+            DrawIndexedAttribs attribs(batch.indexCount, VT_UINT16, DRAW_FLAG_VERIFY_ALL | DRAW_FLAG_DYNAMIC_RESOURCE_BUFFERS_INTACT, batch.instanceCount);
+            attribs.FirstIndexLocation    = batch.indexStart;
+            attribs.BaseVertex            = batch.vertexStart;
+            attribs.FirstInstanceLocation = batch.firstInstance;
+            pCtx->DrawIndexed(attribs);
+        }
+        subset.NumDraws += static_cast<Uint32>(subset.Batches.size());
+        return;
+    }
+
     if (m_BindingMode == BindingMode::Bindless)
     {
         {
@@ -890,18 +939,20 @@ void Asteroids::RenderSubset(Uint32             SubsetNum,
                 const auto staticData  = &staticAsteroidData[drawIdx];
                 const auto dynamicData = &dynamicAsteroidData[drawIdx];
 
-                XMStoreFloat4x4(&asteroidData[i].mWorld, dynamicData->world);
-                asteroidData[i].mSurfaceColor = staticData->surfaceColor;
-                asteroidData[i].mDeepColor    = staticData->deepColor;
-                asteroidData[i].mTextureIndex = staticData->textureIndex;
+                XMStoreFloat4x4(&asteroidData[i].world, dynamicData->world);
+                asteroidData[i].surfaceColor = staticData->surfaceColor;
+                asteroidData[i].deepColor    = staticData->deepColor;
+                asteroidData[i].textureIndex = staticData->textureIndex;
             }
         }
+        ++subset.NumMaps;
 
         StateTransitionDesc Barrier{mAsteroidsDataBuffers[SubsetNum], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
         pCtx->TransitionResourceStates(1, &Barrier);
 
         // Commit and verify resources
         pCtx->CommitShaderResources(mAsteroidsSRBs[SubsetNum], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+        ++subset.NumCommits;
     }
 
     const auto& viewProjection = camera.ViewProjection();
@@ -918,6 +969,7 @@ void Asteroids::RenderSubset(Uint32             SubsetNum,
             XMStoreFloat4x4(&drawConstants->mViewProjection, viewProjection);
             drawConstants->mSurfaceColor = staticData->surfaceColor;
             drawConstants->mDeepColor    = staticData->deepColor;
+            ++subset.NumMaps;
         }
         // No need to update the buffer in bindless mode
 
@@ -925,14 +977,17 @@ void Asteroids::RenderSubset(Uint32             SubsetNum,
         {
             pVar->Set(mTextureSRVs[staticData->textureIndex]);
             pCtx->CommitShaderResources(mAsteroidsSRBs[SubsetNum], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            ++subset.NumCommits;
         }
         else if (m_BindingMode == BindingMode::Mutable)
         {
             pCtx->CommitShaderResources(mAsteroidsSRBs[drawIdx], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            ++subset.NumCommits;
         }
         else if (m_BindingMode == BindingMode::TextureMutable)
         {
             pCtx->CommitShaderResources(mAsteroidsSRBs[staticData->textureIndex], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            ++subset.NumCommits;
         }
 
         DrawIndexedAttribs attribs(dynamicData->indexCount, VT_UINT16, DRAW_FLAG_VERIFY_ALL);
@@ -949,6 +1004,7 @@ void Asteroids::RenderSubset(Uint32             SubsetNum,
 
         pCtx->DrawIndexed(attribs);
     }
+    subset.NumDraws += numAsteroids;
 }
 
 void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Settings& settings)
@@ -971,7 +1027,7 @@ void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Setting
 
     auto SubsetSize = NUM_ASTEROIDS / mNumSubsets;
 
-    if (m_BindingMode == BindingMode::Bindless)
+    if (UsesAsteroidDataBuffers())
     {
         // Write view-projection matrix into the buffer
         const auto& viewProjection = camera.ViewProjection();
@@ -989,7 +1045,7 @@ void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Setting
 
     // Update all subsets in this thread when multithreadedRendering is false
     for (Uint32 i = 0; i < (!settings.multithreadedRendering ? mNumSubsets : 1); ++i)
-        mAsteroids->Update(frameTime, camera.Eye(), settings, SubsetSize * i, SubsetSize);
+        UpdateSubset(i, mDeviceCtxt, mFrameAttribs, SubsetSize * i, SubsetSize);
 
     if (settings.multithreadedRendering)
     {
@@ -1047,6 +1103,20 @@ void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Setting
     QueryPerformanceCounter((LARGE_INTEGER*)&currCounter);
     mRenderTicks = currCounter - mRenderTicks;
 
+    // All subsets are complete at this point
+    mNumMaps    = 0;
+    mNumCommits = 0;
+    mNumDraws   = 0;
+    for (auto& subset : mSubsets)
+    {
+        mNumMaps += subset.NumMaps;
+        mNumCommits += subset.NumCommits;
+        mNumDraws += subset.NumDraws;
+        subset.NumMaps    = 0;
+        subset.NumCommits = 0;
+        subset.NumDraws   = 0;
+    }
+
     mDeviceCtxt->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
     // Draw skybox
@@ -1123,4 +1193,11 @@ void Asteroids::GetPerfCounters(float& UpdateTime, float& RenderTime)
     RenderTime = (float)mRenderTicks / (float)mPerfCounterFreq;
 }
 
+void Asteroids::GetDrawCounters(Uint32& NumMaps, Uint32& NumCommits, Uint32& NumDraws)
+{
+    NumMaps    = mNumMaps;
+    NumCommits = mNumCommits;
+    NumDraws   = mNumDraws;
+}
+
 } // namespace AsteroidsDE
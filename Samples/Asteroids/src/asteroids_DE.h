@@ -14,6 +14,7 @@
 #include "SwapChain.h"
 #include "DeviceContext.h"
 #include "RefCntAutoPtr.hpp"
+#include "MapHelper.hpp"
 #include "ThreadSignal.hpp"
 #include <map>
 #include <mutex>
@@ -39,10 +40,21 @@ public:
 
     void GetPerfCounters(float &UpdateTime, float &RenderTime);
 
+    // Number of buffer maps, resource commits and draw calls issued for asteroids in the last frame
+    void GetDrawCounters(Diligent::Uint32 &NumMaps, Diligent::Uint32 &NumCommits, Diligent::Uint32 &NumDraws);
+
 private:
+    struct FrameAttribs
+    {
+        float frameTime;
+        const OrbitCamera* camera;
+        const Settings* settings;
+    };
+
     void CreateMeshes();
     void InitializeTextureData();
     void CreateGUIResources();
+    void UpdateSubset(Diligent::Uint32 SubsetNum, Diligent::IDeviceContext *pCtx, const FrameAttribs& frameAttribs, Diligent::Uint32 startIdx, Diligent::Uint32 numAsteroids);
     void RenderSubset(Diligent::Uint32 SubsetNum, Diligent::IDeviceContext *pCtx, const OrbitCamera& camera, Diligent::Uint32 startIdx, Diligent::Uint32 numAsteroids);
     void InitDevice(HWND hWnd, Diligent::RENDER_DEVICE_TYPE DevType);
 
@@ -51,9 +63,15 @@ private:
         Dynamic = 0,
         Mutable,
         TextureMutable,
-        Bindless
+        Bindless,
+        // Same resources as Bindless, but the simulation writes instance data directly into
+        // mapped buffers and asteroids that share a mesh and LOD are drawn with one instanced draw
+        Streamed
     }m_BindingMode = BindingMode::TextureMutable;
 
+    // Bindless and Streamed modes read per-asteroid data from structured buffers
+    bool UsesAsteroidDataBuffers() const { return m_BindingMode == BindingMode::Bindless || m_BindingMode == BindingMode::Streamed; }
+
     AsteroidsSimulation*        mAsteroids = nullptr;
     GUI*                        mGUI = nullptr;
 
@@ -75,12 +93,7 @@ private:
     std::atomic_int m_NumThreadsCompleted;
     static void WorkerThreadFunc(Asteroids *pThis, Diligent::Uint32 ThreadNum);
 
-    struct FrameAttribs
-    {
-        float frameTime;
-        const OrbitCamera* camera;
-        const Settings* settings;
-    }mFrameAttribs;
+    FrameAttribs mFrameAttribs;
 
     Diligent::RefCntAutoPtr<Diligent::IBuffer>  mIndexBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer>  mVertexBuffer;
@@ -110,6 +123,21 @@ private:
     Diligent::RefCntAutoPtr<Diligent::ITextureView> mTextureSRVs[NUM_UNIQUE_TEXTURES];
     Diligent::RefCntAutoPtr<Diligent::ISampler> mSamplerState;
 
+    // Per-subset state, every subset is only accessed by the thread that renders it
+    struct SubsetData
+    {
+        // Streamed mode: instance data buffer mapped during the update and draw batches written by the simulation
+        Diligent::MapHelper<AsteroidDrawData> InstanceData;
+        std::vector<AsteroidDrawBatch>         Batches;
+
+        Diligent::Uint32 NumMaps    = 0;
+        Diligent::Uint32 NumCommits = 0;
+        Diligent::Uint32 NumDraws   = 0;
+    };
+    std::vector<SubsetData> mSubsets;
+
+    Diligent::Uint32 mNumMaps = 0, mNumCommits = 0, mNumDraws = 0;
+
     std::unique_ptr<GUISprite> mSprite;
     UINT64 mPerfCounterFreq = 0;
     volatile LONG64 mUpdateTicks = 0, mRenderTicks = 0;
@@ -10,8 +10,10 @@
 
 #include "mesh.h"
 #include "noise.h"
-#include <map>
+#include <algorithm>
+#include <cstdint>
 #include <random>
+#include <ppl.h>
 
 using namespace DirectX;
 
@@ -68,65 +70,109 @@ void CreateIcosahedron(Mesh *outMesh)
 }
 
 
-// Maps edge (lower index first!) to
-struct Edge
+// Open-addressing hash table that maps edges to their midpoint vertex indices.
+// Subdivision inserts every edge exactly once, so the table is sized up front and never rehashes.
+class MidpointTable
 {
-    Edge(IndexType i0, IndexType i1)
-        : v0(i0), v1(i1)
+public:
+    explicit MidpointTable(size_t edgeCount)
     {
-        if (v0 > v1)
-            std::swap(v0, v1);
+        // Keep load factor below 0.5
+        size_t capacity = 16;
+        while (capacity < edgeCount * 2)
+            capacity *= 2;
+        mKeys.resize(capacity, uint32_t{EMPTY_KEY});
+        mValues.resize(capacity);
+        mMask = capacity - 1;
     }
-    IndexType v0;
-    IndexType v1;
 
-    bool operator<(const Edge &c) const
+    // Returns the slot of the edge; sets *found if the edge is already in the table
+    size_t Find(IndexType i0, IndexType i1, bool *found) const
     {
-        return v0 < c.v0 || (v0 == c.v0 && v1 < c.v1);
+        auto key = MakeKey(i0, i1);
+        // Fibonacci hashing spreads consecutive vertex indices well
+        auto slot = static_cast<size_t>((uint64_t{key} * 0x9E3779B97F4A7C15ull) >> 32) & mMask;
+        for (;;) {
+            if (mKeys[slot] == key) {
+                *found = true;
+                return slot;
+            }
+            if (mKeys[slot] == EMPTY_KEY) {
+                *found = false;
+                return slot;
+            }
+            slot = (slot + 1) & mMask;
+        }
     }
-};
 
-typedef std::map<Edge, IndexType> MidpointMap;
+    IndexType Get(size_t slot) const { return mValues[slot]; }
 
-inline IndexType EdgeMidpoint(Mesh *mesh, MidpointMap *midpoints, Edge e)
-{
-    auto index = midpoints->find(e);
-    if (index == midpoints->end())
+    void Insert(size_t slot, IndexType i0, IndexType i1, IndexType midpoint)
     {
-        auto a = mesh->vertices[e.v0];
-        auto b = mesh->vertices[e.v1];
-
-        Vertex m;
-        m.x = (a.x + b.x) * 0.5f;
-        m.y = (a.y + b.y) * 0.5f;
-        m.z = (a.z + b.z) * 0.5f;
+        mKeys[slot] = MakeKey(i0, i1);
+        mValues[slot] = midpoint;
+    }
 
-        index = midpoints->insert(std::make_pair(e, static_cast<IndexType>(mesh->vertices.size()))).first;
-        mesh->vertices.push_back(m);
+private:
+    // Lower index first
+    static uint32_t MakeKey(IndexType i0, IndexType i1)
+    {
+        if (i0 > i1)
+            std::swap(i0, i1);
+        return (uint32_t{i0} << 16) | uint32_t{i1};
     }
-    return index->second;
+
+    // Edges never connect a vertex to itself, so this key is never used
+    static const uint32_t EMPTY_KEY = 0xFFFFFFFFu;
+
+    std::vector<uint32_t> mKeys;
+    std::vector<IndexType> mValues;
+    size_t mMask = 0;
+};
+
+inline IndexType EdgeMidpoint(Mesh *mesh, MidpointTable *midpoints, IndexType i0, IndexType i1)
+{
+    bool found = false;
+    auto slot = midpoints->Find(i0, i1, &found);
+    if (found)
+        return midpoints->Get(slot);
+
+    auto a = mesh->vertices[i0];
+    auto b = mesh->vertices[i1];
+
+    Vertex m;
+    m.x = (a.x + b.x) * 0.5f;
+    m.y = (a.y + b.y) * 0.5f;
+    m.z = (a.z + b.z) * 0.5f;
+
+    auto index = static_cast<IndexType>(mesh->vertices.size());
+    midpoints->Insert(slot, i0, i1, index);
+    mesh->vertices.push_back(m);
+    return index;
 }
 
 
 void SubdivideInPlace(Mesh *outMesh)
 {
-    MidpointMap midpoints;
+    assert(outMesh->indices.size() % 3 == 0); // trilist
+    size_t triangles = outMesh->indices.size() / 3;
+
+    // Each edge of a closed mesh is shared by two triangles
+    MidpointTable midpoints(triangles * 3 / 2 + 1);
 
     std::vector<IndexType> newIndices;
     newIndices.reserve(outMesh->indices.size() * 4);
-    outMesh->vertices.reserve(outMesh->vertices.size() * 2);
+    outMesh->vertices.reserve(outMesh->vertices.size() + triangles * 3 / 2 + 1);
 
-    assert(outMesh->indices.size() % 3 == 0); // trilist
-    size_t triangles = outMesh->indices.size() / 3;
     for (size_t t = 0; t < triangles; ++t)
     {
         auto t0 = outMesh->indices[t*3+0];
         auto t1 = outMesh->indices[t*3+1];
         auto t2 = outMesh->indices[t*3+2];
 
-        auto m0 = EdgeMidpoint(outMesh, &midpoints, Edge(t0, t1));
-        auto m1 = EdgeMidpoint(outMesh, &midpoints, Edge(t1, t2));
-        auto m2 = EdgeMidpoint(outMesh, &midpoints, Edge(t2, t0));
+        auto m0 = EdgeMidpoint(outMesh, &midpoints, t0, t1);
+        auto m1 = EdgeMidpoint(outMesh, &midpoints, t1, t2);
+        auto m2 = EdgeMidpoint(outMesh, &midpoints, t2, t0);
 
         IndexType indices[] = {
             t0, m0, m2,
@@ -152,21 +198,21 @@ void SpherifyInPlace(Mesh *outMesh, float radius)
 }
 
 
-void ComputeAvgNormalsInPlace(Mesh *outMesh)
+void ComputeAvgNormals(Vertex *vertices, size_t vertexCount, const IndexType *indices, size_t indexCount)
 {
-    for (auto &v : outMesh->vertices) {
-        v.nx = 0.0f;
-        v.ny = 0.0f;
-        v.nz = 0.0f;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        vertices[i].nx = 0.0f;
+        vertices[i].ny = 0.0f;
+        vertices[i].nz = 0.0f;
     }
 
-    assert(outMesh->indices.size() % 3 == 0); // trilist
-    size_t triangles = outMesh->indices.size() / 3;
+    assert(indexCount % 3 == 0); // trilist
+    size_t triangles = indexCount / 3;
     for (size_t t = 0; t < triangles; ++t)
     {
-        auto v1 = &outMesh->vertices[outMesh->indices[t*3+0]];
-        auto v2 = &outMesh->vertices[outMesh->indices[t*3+1]];
-        auto v3 = &outMesh->vertices[outMesh->indices[t*3+2]];
+        auto v1 = &vertices[indices[t*3+0]];
+        auto v2 = &vertices[indices[t*3+1]];
+        auto v3 = &vertices[indices[t*3+2]];
 
         // Two edge vectors u,v
         auto ux = v2->x - v1->x;
@@ -188,7 +234,8 @@ void ComputeAvgNormalsInPlace(Mesh *outMesh)
     }
 
     // Normalize
-    for (auto &v : outMesh->vertices) {
+    for (size_t i = 0; i < vertexCount; ++i) {
+        auto &v = vertices[i];
         float n = 1.0f / std::sqrt(v.nx*v.nx + v.ny*v.ny + v.nz*v.nz);
         v.nx *= n;
         v.ny *= n;
@@ -197,6 +244,13 @@ void ComputeAvgNormalsInPlace(Mesh *outMesh)
 }
 
 
+void ComputeAvgNormalsInPlace(Mesh *outMesh)
+{
+    ComputeAvgNormals(outMesh->vertices.data(), outMesh->vertices.size(),
+                      outMesh->indices.data(), outMesh->indices.size());
+}
+
+
 void CreateGeospheres(Mesh *outMesh, unsigned int subdivLevelCount, unsigned int* outSubdivIndexOffsets)
 {
     CreateIcosahedron(outMesh);
@@ -241,9 +295,8 @@ void CreateAsteroidsFromGeospheres(Mesh *outMesh,
     CreateGeospheres(&baseMesh, subdivLevelCount, outSubdivIndexOffsets);
 
     // Per unique mesh
-    *vertexCountPerMesh = (unsigned int)baseMesh.vertices.size();
-    std::vector<Vertex> vertices;
-    vertices.reserve(meshInstanceCount * baseMesh.vertices.size());
+    auto baseVertexCount = baseMesh.vertices.size();
+    *vertexCountPerMesh = (unsigned int)baseVertexCount;
     // Reuse indices for the different unique meshes
 
     auto randomNoise = std::uniform_real_distribution<float>(0.0f, 10000.0f);
@@ -252,24 +305,40 @@ void CreateAsteroidsFromGeospheres(Mesh *outMesh,
     float radiusScale = 0.9f;
     float radiusBias = 0.3f;
 
-    // Create and randomize unique vertices for each mesh instance
+    // Draw the random parameters serially to keep the meshes independent of the thread count
+    std::vector<float> persistences(meshInstanceCount);
+    std::vector<float> noiseOffsets(meshInstanceCount);
     for (unsigned int m = 0; m < meshInstanceCount; ++m) {
-        Mesh newMesh(baseMesh);
-        NoiseOctaves<4> textureNoise(randomPersistence(rng));
-        float noise = randomNoise(rng);
-
-        for (auto &v : newMesh.vertices) {
-            float radius = textureNoise(v.x*noiseScale, v.y*noiseScale, v.z*noiseScale, noise);
-            radius = radius * radiusScale + radiusBias;
-            v.x *= radius;
-            v.y *= radius;
-            v.z *= radius;
-        }
-        ComputeAvgNormalsInPlace(&newMesh);
-
-        vertices.insert(vertices.end(), newMesh.vertices.begin(), newMesh.vertices.end());
+        persistences[m] = randomPersistence(rng);
+        noiseOffsets[m] = randomNoise(rng);
     }
 
+    // Create and randomize unique vertices for each mesh instance.
+    // Meshes are processed in parallel chunks and are written straight into the final vertex array.
+    std::vector<Vertex> vertices(meshInstanceCount * baseVertexCount);
+
+    const unsigned int meshesPerChunk = 16;
+    const unsigned int chunkCount = (meshInstanceCount + meshesPerChunk - 1) / meshesPerChunk;
+    concurrency::parallel_for(0u, chunkCount, [&](unsigned int chunk) {
+        auto lastMesh = std::min(meshInstanceCount, (chunk + 1) * meshesPerChunk);
+        for (unsigned int m = chunk * meshesPerChunk; m < lastMesh; ++m) {
+            NoiseOctaves<4> textureNoise(persistences[m]);
+            float noise = noiseOffsets[m];
+
+            auto meshVertices = vertices.data() + m * baseVertexCount;
+            for (size_t i = 0; i < baseVertexCount; ++i) {
+                auto v = baseMesh.vertices[i];
+                float radius = textureNoise(v.x*noiseScale, v.y*noiseScale, v.z*noiseScale, noise);
+                radius = radius * radiusScale + radiusBias;
+                v.x *= radius;
+                v.y *= radius;
+                v.z *= radius;
+                meshVertices[i] = v;
+            }
+            ComputeAvgNormals(meshVertices, baseVertexCount, baseMesh.indices.data(), baseMesh.indices.size());
+        }
+    });
+
     // Copy to output
     std::swap(outMesh->indices, baseMesh.indices);
     std::swap(outMesh->vertices, vertices);
@@ -47,6 +47,9 @@ void SpherifyInPlace(Mesh *outMesh, float radius = 1.0f);
 
 void ComputeAvgNormalsInPlace(Mesh *outMesh);
 
+// Same as above, but operates on raw arrays so that meshes can be written in place into a larger vertex array
+void ComputeAvgNormals(Vertex *vertices, size_t vertexCount, const IndexType *indices, size_t indexCount);
+
 // subdivIndexOffset array should be [subdivLevels+2] in size
 void CreateGeospheres(Mesh *outMesh, unsigned int subdivLevelCount, unsigned int* outSubdivIndexOffsets);
 
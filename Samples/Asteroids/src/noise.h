@@ -11,6 +11,7 @@
 #pragma once
 
 #include "simplexnoise1234.h"
+#include "simplexnoise_sse.h"
 
 // Very simple multi-octave simplex noise helper
 // Returns noise in the range [0, 1] vs. the usual [-1, 1]
@@ -44,6 +45,18 @@ public:
         return r * mWeightNorm + 0.5f;
     }
 
+    // Evaluates four points at once; returns [0, 1]
+    __m128 operator()(__m128 x, __m128 y, __m128 z) const
+    {
+        const __m128 two = _mm_set1_ps(2.0f);
+        __m128 r = _mm_setzero_ps();
+        for (size_t i = 0; i < N; ++i) {
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(mWeights[i]), snoise3_sse(x, y, z)));
+            x = _mm_mul_ps(x, two); y = _mm_mul_ps(y, two); z = _mm_mul_ps(z, two);
+        }
+        return _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(mWeightNorm)), _mm_set1_ps(0.5f));
+    }
+
     // Returns [0, 1]
     float operator()(float x, float y, float z, float w) const
     {
@@ -75,7 +75,7 @@ struct Settings
         DiligentVulkan
     }mode = DiligentD3D11;
        
-    int resourceBindingMode = 3;  // Only for DiligentD3D12 and DiligentVk modes
+    int resourceBindingMode = 3;  // Only for DiligentD3D12 and DiligentVk modes: 0 - dynamic, 1 - mutable, 2 - texture mutable, 3 - bindless, 4 - streamed
 
     bool lockFrameRate = false;
     bool animate = true;
@@ -0,0 +1,150 @@
+// Copyright 2014 Intel Corporation All Rights Reserved
+//
+// Intel makes no representations about the suitability of this software for any purpose.
+// THIS SOFTWARE IS PROVIDED ""AS IS."" INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES,
+// EXPRESS OR IMPLIED, AND ALL LIABILITY, INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES,
+// FOR THE USE OF THIS SOFTWARE, INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY
+// RIGHTS, AND INCLUDING THE WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// Intel does not assume any responsibility for any errors which may appear in this software
+// nor any responsibility to update it.
+
+#include "simplexnoise_sse.h"
+
+#include <stdint.h>
+
+// Permutation table from simplexnoise1234.c
+extern "C" unsigned char perm[512];
+
+// Matches FASTFLOOR() from simplexnoise1234.c, which also decrements non-positive integer values
+static inline __m128i FastFloor(__m128 v)
+{
+    __m128i t = _mm_cvttps_epi32(v);
+    return _mm_add_epi32(t, _mm_castps_si128(_mm_cmple_ps(v, _mm_setzero_ps())));
+}
+
+// snoise3() mixes float values with double constants. Doing the same here makes
+// the results bit-identical to the scalar version.
+static inline __m128 MulDouble(__m128 a, double b)
+{
+    __m128d lo = _mm_mul_pd(_mm_cvtps_pd(a), _mm_set1_pd(b));
+    __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), _mm_set1_pd(b));
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+static inline __m128 AddDouble(__m128 a, double b)
+{
+    __m128d lo = _mm_add_pd(_mm_cvtps_pd(a), _mm_set1_pd(b));
+    __m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), _mm_set1_pd(b));
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Same as grad3() from simplexnoise1234.c
+static inline __m128 Grad3(__m128i hash, __m128 x, __m128 y, __m128 z)
+{
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+
+    __m128 hLess8  = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+    __m128 hLess4  = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 h12or14 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(13)), _mm_set1_epi32(12)));
+
+    __m128 u = Select(hLess8, x, y);
+    __m128 v = Select(hLess4, y, Select(h12or14, x, z));
+
+    // Flip signs using bits 0 and 1 of the hash
+    __m128 uSign = _mm_castsi128_ps(_mm_slli_epi32(h, 31));
+    __m128 vSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h, 1), 31));
+    return _mm_add_ps(_mm_xor_ps(u, uSign), _mm_xor_ps(v, vSign));
+}
+
+static inline __m128 CornerContribution(__m128i hash, __m128 x, __m128 y, __m128 z)
+{
+    __m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.6f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    t        = _mm_max_ps(t, _mm_setzero_ps());
+    t        = _mm_mul_ps(t, t);
+    return _mm_mul_ps(_mm_mul_ps(t, t), Grad3(hash, x, y, z));
+}
+
+__m128 snoise3_sse(__m128 x, __m128 y, __m128 z)
+{
+    const double F3 = 0.333333333;
+    const double G3 = 0.166666667;
+
+    // Skew the input space to determine which simplex cell we're in
+    __m128  s = MulDouble(_mm_add_ps(_mm_add_ps(x, y), z), F3);
+    __m128i i = FastFloor(_mm_add_ps(x, s));
+    __m128i j = FastFloor(_mm_add_ps(y, s));
+    __m128i k = FastFloor(_mm_add_ps(z, s));
+
+    // Unskew the cell origin back to (x,y,z) space
+    __m128 fi = _mm_cvtepi32_ps(i);
+    __m128 fj = _mm_cvtepi32_ps(j);
+    __m128 fk = _mm_cvtepi32_ps(k);
+    __m128 t  = MulDouble(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(i, j), k)), G3);
+    __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(fi, t));
+    __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(fj, t));
+    __m128 z0 = _mm_sub_ps(z, _mm_sub_ps(fk, t));
+
+    // Determine which simplex we are in without branching. The masks
+    // reproduce the six cases of the if/else chain in snoise3().
+    const __m128 AllOnes = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+    __m128 xy = _mm_cmpge_ps(x0, y0);
+    __m128 yz = _mm_cmpge_ps(y0, z0);
+    __m128 xz = _mm_cmpge_ps(x0, z0);
+
+    __m128 i1 = _mm_and_ps(xy, _mm_or_ps(yz, xz));
+    __m128 j1 = _mm_andnot_ps(xy, yz);
+    __m128 k1 = _mm_andnot_ps(_mm_or_ps(yz, _mm_and_ps(xy, xz)), AllOnes);
+    __m128 i2 = _mm_or_ps(xy, _mm_and_ps(yz, xz));
+    __m128 j2 = _mm_andnot_ps(_mm_andnot_ps(yz, xy), AllOnes);
+    __m128 k2 = _mm_andnot_ps(_mm_and_ps(yz, _mm_or_ps(xy, xz)), AllOnes);
+
+    const __m128 One = _mm_set1_ps(1.0f);
+
+    // Offsets for the remaining corners in (x,y,z) coords
+    __m128 x1 = AddDouble(_mm_sub_ps(x0, _mm_and_ps(i1, One)), G3);
+    __m128 y1 = AddDouble(_mm_sub_ps(y0, _mm_and_ps(j1, One)), G3);
+    __m128 z1 = AddDouble(_mm_sub_ps(z0, _mm_and_ps(k1, One)), G3);
+    __m128 x2 = AddDouble(_mm_sub_ps(x0, _mm_and_ps(i2, One)), 2.0f * G3);
+    __m128 y2 = AddDouble(_mm_sub_ps(y0, _mm_and_ps(j2, One)), 2.0f * G3);
+    __m128 z2 = AddDouble(_mm_sub_ps(z0, _mm_and_ps(k2, One)), 2.0f * G3);
+    __m128 x3 = AddDouble(_mm_sub_ps(x0, One), 3.0f * G3);
+    __m128 y3 = AddDouble(_mm_sub_ps(y0, One), 3.0f * G3);
+    __m128 z3 = AddDouble(_mm_sub_ps(z0, One), 3.0f * G3);
+
+    // Permutation table lookups have no SSE2 equivalent and are done per lane
+    alignas(16) int32_t ii[4], jj[4], kk[4];
+    alignas(16) int32_t offsets[6][4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(ii), _mm_and_si128(i, _mm_set1_epi32(0xff)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(jj), _mm_and_si128(j, _mm_set1_epi32(0xff)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(kk), _mm_and_si128(k, _mm_set1_epi32(0xff)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(offsets[0]), _mm_castps_si128(i1));
+    _mm_store_si128(reinterpret_cast<__m128i*>(offsets[1]), _mm_castps_si128(j1));
+    _mm_store_si128(reinterpret_cast<__m128i*>(offsets[2]), _mm_castps_si128(k1));
+    _mm_store_si128(reinterpret_cast<__m128i*>(offsets[3]), _mm_castps_si128(i2));
+    _mm_store_si128(reinterpret_cast<__m128i*>(offsets[4]), _mm_castps_si128(j2));
+    _mm_store_si128(reinterpret_cast<__m128i*>(offsets[5]), _mm_castps_si128(k2));
+
+    alignas(16) int32_t gi[4][4];
+    for (int l = 0; l < 4; ++l) {
+        // Masks are 0 or -1
+        int i1l = -offsets[0][l], j1l = -offsets[1][l], k1l = -offsets[2][l];
+        int i2l = -offsets[3][l], j2l = -offsets[4][l], k2l = -offsets[5][l];
+        gi[0][l] = perm[ii[l] +       perm[jj[l] +       perm[kk[l]      ]]];
+        gi[1][l] = perm[ii[l] + i1l + perm[jj[l] + j1l + perm[kk[l] + k1l]]];
+        gi[2][l] = perm[ii[l] + i2l + perm[jj[l] + j2l + perm[kk[l] + k2l]]];
+        gi[3][l] = perm[ii[l] + 1   + perm[jj[l] + 1   + perm[kk[l] + 1  ]]];
+    }
+
+    // Add contributions from each corner to get the final noise value
+    __m128 n0 = CornerContribution(_mm_load_si128(reinterpret_cast<const __m128i*>(gi[0])), x0, y0, z0);
+    __m128 n1 = CornerContribution(_mm_load_si128(reinterpret_cast<const __m128i*>(gi[1])), x1, y1, z1);
+    __m128 n2 = CornerContribution(_mm_load_si128(reinterpret_cast<const __m128i*>(gi[2])), x2, y2, z2);
+    __m128 n3 = CornerContribution(_mm_load_si128(reinterpret_cast<const __m128i*>(gi[3])), x3, y3, z3);
+    return _mm_mul_ps(_mm_set1_ps(32.0f), _mm_add_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), n3));
+}
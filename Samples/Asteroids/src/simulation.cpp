@@ -17,6 +17,8 @@
 #include <limits>
 #include <algorithm>
 #include <iostream>
+#include <chrono>
+#include <cstring>
 #include <ppl.h>
 
 using namespace DirectX;
@@ -58,7 +60,7 @@ static inline float VeryApproxLog2f(float x)
 
 AsteroidsSimulation::AsteroidsSimulation(unsigned int rngSeed, unsigned int asteroidCount,
                                          unsigned int meshInstanceCount, unsigned int subdivCount,
-                                         unsigned int textureCount)
+                                         unsigned int textureCount, const char* cachePath)
     : mAsteroidStatic(asteroidCount)
     , mAsteroidDynamic(asteroidCount)
     , mIndexOffsets(size_t{subdivCount} + 2) // Mesh subdivs are inclusive on both ends and need forward differencing for count
@@ -66,15 +68,47 @@ AsteroidsSimulation::AsteroidsSimulation(unsigned int rngSeed, unsigned int aste
 {
     std::mt19937 rng(rngSeed);
 
-    // Create meshes
-    std::cout
-        << "Creating " << meshInstanceCount << " meshes, each with "
-        << subdivCount << " subdivision levels..." << std::endl;
-
-    CreateAsteroidsFromGeospheres(&mMeshes, mSubdivCount, meshInstanceCount,
-                                  rng(), mIndexOffsets.data(), &mVertexCountPerMesh);
-
-    CreateTextures(textureCount, rng());
+    // Always draw the seeds so that the asteroids below are the same with and without the cache
+    auto meshSeed = rng();
+    auto textureSeed = rng();
+
+    InitTextureLayout(textureCount);
+
+    AssetCacheKey cacheKey = {};
+    cacheKey.rngSeed           = rngSeed;
+    cacheKey.meshInstanceCount = meshInstanceCount;
+    cacheKey.subdivCount       = subdivCount;
+    cacheKey.textureCount      = textureCount;
+    cacheKey.textureDim        = mTextureDim;
+    cacheKey.vertexSize        = sizeof(Vertex);
+    cacheKey.indexSize         = sizeof(IndexType);
+
+    if (cachePath == nullptr || !LoadFromCache(cachePath, cacheKey)) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        // Create meshes
+        std::cout
+            << "Creating " << meshInstanceCount << " meshes, each with "
+            << subdivCount << " subdivision levels..." << std::endl;
+
+        auto meshStartTime = std::chrono::high_resolution_clock::now();
+        CreateAsteroidsFromGeospheres(&mMeshes, mSubdivCount, meshInstanceCount,
+                                      meshSeed, mIndexOffsets.data(), &mVertexCountPerMesh);
+        std::cout
+            << "Meshes created in "
+            << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - meshStartTime).count()
+            << " ms" << std::endl;
+
+        CreateTextures(textureSeed);
+
+        std::cout
+            << "Meshes and textures generated in "
+            << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count()
+            << " ms (cold start)" << std::endl;
+
+        if (cachePath != nullptr)
+            SaveToCache(cachePath, cacheKey);
+    }
 
     // Constants
     std::normal_distribution<float> orbitRadiusDist(SIM_ORBIT_RADIUS, 0.6f * SIM_DISC_RADIUS);
@@ -136,7 +170,8 @@ AsteroidsSimulation::AsteroidsSimulation(unsigned int rngSeed, unsigned int aste
 
 
 void AsteroidsSimulation::Update(float frameTime, DirectX::XMVECTOR cameraEye, const Settings& settings,
-                                 size_t startIndex, size_t count)
+                                 size_t startIndex, size_t count,
+                                 AsteroidDrawData* drawData, std::vector<AsteroidDrawBatch>* batches)
 {
     bool animate = settings.animate;
 
@@ -167,10 +202,58 @@ void AsteroidsSimulation::Update(float frameTime, DirectX::XMVECTOR cameraEye, c
         dynamicData.indexStart = mIndexOffsets[subdiv];
         dynamicData.indexCount = mIndexOffsets[subdiv+1] - dynamicData.indexStart;
     }
+
+    if (drawData != nullptr) {
+        assert(batches != nullptr);
+        WriteDrawData(startIndex, last, drawData, batches);
+    }
 }
 
 
-void AsteroidsSimulation::CreateTextures(unsigned int textureCount, unsigned int rngSeed)
+void AsteroidsSimulation::WriteDrawData(size_t first, size_t last, AsteroidDrawData* drawData, std::vector<AsteroidDrawBatch>* batches) const
+{
+    batches->clear();
+
+    unsigned int slot = 0;
+    for (size_t runStart = first; runStart < last;) {
+        // Asteroids that use the same mesh are stored consecutively
+        auto vertexStart = mAsteroidStatic[runStart].vertexStart;
+        auto runEnd = runStart + 1;
+        while (runEnd < last && mAsteroidStatic[runEnd].vertexStart == vertexStart) ++runEnd;
+
+        // One batch for every subdivision level used in the run
+        for (unsigned int subdiv = 0; subdiv <= mSubdivCount; ++subdiv) {
+            auto batchStart = slot;
+            for (auto i = runStart; i < runEnd; ++i) {
+                const AsteroidStatic& staticData = mAsteroidStatic[i];
+                const AsteroidDynamic& dynamicData = mAsteroidDynamic[i];
+                if (dynamicData.indexStart != mIndexOffsets[subdiv])
+                    continue;
+
+                auto& data = drawData[slot++];
+                XMStoreFloat4x4(&data.world, dynamicData.world);
+                data.surfaceColor = staticData.surfaceColor;
+                data.deepColor    = staticData.deepColor;
+                data.textureIndex = staticData.textureIndex;
+            }
+
+            if (slot > batchStart) {
+                AsteroidDrawBatch batch = {};
+                batch.indexStart    = mIndexOffsets[subdiv];
+                batch.indexCount    = mIndexOffsets[subdiv+1] - mIndexOffsets[subdiv];
+                batch.vertexStart   = vertexStart;
+                batch.firstInstance = batchStart;
+                batch.instanceCount = slot - batchStart;
+                batches->push_back(batch);
+            }
+        }
+
+        runStart = runEnd;
+    }
+}
+
+
+void AsteroidsSimulation::InitTextureLayout(unsigned int textureCount)
 {
     mTextureDim = TEXTURE_DIM;
     mTextureCount = textureCount;
@@ -184,67 +267,185 @@ void AsteroidsSimulation::CreateTextures(unsigned int textureCount, unsigned int
 
     assert((mTextureDim & (mTextureDim-1)) == 0); // Must be pow2 currently; we don't handle wacky mip chains
 
-    std::cout
-        << "Creating " << textureCount << " "
-        << mTextureDim << "x" << mTextureDim << " textures..." << std::endl;
-    
-    // Allocate space
     UINT texelSizeInBytes = 4; // RGBA8
     UINT extraSpaceForMips = 2;
     UINT totalTextureSizeInBytes = texelSizeInBytes * mTextureDim * mTextureDim * mTextureArraySize * extraSpaceForMips;
     totalTextureSizeInBytes = AlignUp(totalTextureSizeInBytes, 64U); // Avoid false sharing
+    mTextureSizeInBytes = totalTextureSizeInBytes;
 
-    mTextureDataBuffer.resize(size_t{totalTextureSizeInBytes} * size_t{textureCount});
     mTextureSubresources.resize(size_t{mTextureArraySize} * size_t{mTextureMipLevels} * size_t{textureCount});
-    
-    // Parallel over textures
-    std::vector<unsigned int> rngSeeds(textureCount);
-    {
-        std::mt19937 seeds;
-        for (auto &i : rngSeeds) i = seeds();
-    }
+}
 
-    concurrency::parallel_for(UINT(0), textureCount, [&](UINT t) {
-        std::mt19937 rng(rngSeeds[t]);
-        auto randomNoise = std::uniform_real_distribution<float>(0.0f, 10000.0f);
-        auto randomNoiseScale = std::uniform_real_distribution<float>(100, 150);
-        auto randomPersistence = std::normal_distribution<float>(0.9f, 0.2f);
 
-        BYTE* data = mTextureDataBuffer.data() + t * size_t{totalTextureSizeInBytes};
+void AsteroidsSimulation::SetTextureData(const BYTE* data)
+{
+    UINT texelSizeInBytes = 4; // RGBA8
+    for (UINT t = 0; t < mTextureCount; ++t) {
+        auto textureData = data + t * mTextureSizeInBytes;
         for (UINT a = 0; a < mTextureArraySize; ++a) {
             for (UINT m = 0; m < mTextureMipLevels; ++m) {
                 auto width  = mTextureDim >> m;
                 auto height = mTextureDim >> m;
 
                 D3D11_SUBRESOURCE_DATA initialData = {};
-                initialData.pSysMem = data;
+                initialData.pSysMem = textureData;
                 initialData.SysMemPitch = width * texelSizeInBytes;
                 mTextureSubresources[SubresourceIndex(t, a, m)] = initialData;
 
-                data += size_t{initialData.SysMemPitch} * size_t{height};
+                textureData += size_t{initialData.SysMemPitch} * size_t{height};
             }
         }
+    }
+}
+
+
+void AsteroidsSimulation::CreateTextures(unsigned int rngSeed)
+{
+    auto textureCount = mTextureCount;
+
+    std::cout
+        << "Creating " << textureCount << " "
+        << mTextureDim << "x" << mTextureDim << " textures..." << std::endl;
+    
+    // Allocate space
+    mTextureDataBuffer.resize(mTextureSizeInBytes * size_t{textureCount});
+    SetTextureData(mTextureDataBuffer.data());
+    
+    // Draw per-texture parameters up front so that slices can be generated in any order
+    std::vector<unsigned int> rngSeeds(textureCount);
+    {
+        std::mt19937 seeds;
+        for (auto &i : rngSeeds) i = seeds();
+    }
+
+    struct SliceParams
+    {
+        float seed;
+        float persistence;
+        float noiseScale;
+    };
+    std::vector<SliceParams> sliceParams(size_t{textureCount} * size_t{mTextureArraySize});
+
+    for (UINT t = 0; t < textureCount; ++t) {
+        std::mt19937 rng(rngSeeds[t]);
+        auto randomNoise = std::uniform_real_distribution<float>(0.0f, 10000.0f);
+        auto randomNoiseScale = std::uniform_real_distribution<float>(100, 150);
+        auto randomPersistence = std::normal_distribution<float>(0.9f, 0.2f);
 
         // Use same parameters for each of the tri-planar projection planes/cube map faces/etc.
         float noiseScale = randomNoiseScale(rng) / float(mTextureDim);
         float persistence = randomPersistence(rng);
-        float strength = 1.5f;
 
         for (UINT a = 0; a < mTextureArraySize; ++a) {
-            float redScale   = 255.0f;
-            float greenScale = 255.0f;
-            float blueScale  = 255.0f;
+            auto& params = sliceParams[t * mTextureArraySize + a];
+            params.seed        = randomNoise(rng);
+            params.persistence = persistence;
+            params.noiseScale  = noiseScale;
+        }
+    }
 
-            // DEBUG colors
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Parallel over texture array slices
+    concurrency::parallel_for(UINT(0), UINT(sliceParams.size()), [&](UINT s) {
+        UINT t = s / mTextureArraySize;
+        UINT a = s % mTextureArraySize;
+        const auto& params = sliceParams[s];
+
+        float strength = 1.5f;
+
+        float redScale   = 255.0f;
+        float greenScale = 255.0f;
+        float blueScale  = 255.0f;
+
+        // DEBUG colors
 #if 0
-            redScale   = t & 1 ? 255.0f : 0.0f;
-            greenScale = t & 2 ? 255.0f : 0.0f;
-            blueScale  = t & 4 ? 255.0f : 0.0f;
+        redScale   = t & 1 ? 255.0f : 0.0f;
+        greenScale = t & 2 ? 255.0f : 0.0f;
+        blueScale  = t & 4 ? 255.0f : 0.0f;
 #endif
 
-            FillNoise2D_RGBA8(&mTextureSubresources[SubresourceIndex(t, a)], mTextureDim, mTextureDim, mTextureMipLevels,
-                              randomNoise(rng), persistence, noiseScale, strength,
-                              redScale, greenScale, blueScale);
-        }
+        FillNoise2D_RGBA8(&mTextureSubresources[SubresourceIndex(t, a)], mTextureDim, mTextureDim, mTextureMipLevels,
+                          params.seed, params.persistence, params.noiseScale, strength,
+                          redScale, greenScale, blueScale);
     }); // parallel_for
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    double texels    = double(sliceParams.size()) * double(mTextureDim) * double(mTextureDim);
+    std::cout
+        << "Textures created in " << elapsedMs << " ms ("
+        << texels / (elapsedMs * 1000.0) << " Mtexels/s)" << std::endl;
+}
+
+
+// Cache file sections
+enum
+{
+    CACHE_SECTION_INDEX_OFFSETS,
+    CACHE_SECTION_VERTEX_COUNT,
+    CACHE_SECTION_VERTICES,
+    CACHE_SECTION_INDICES,
+    CACHE_SECTION_TEXTURES,
+    CACHE_SECTION_COUNT
+};
+
+bool AsteroidsSimulation::LoadFromCache(const char* path, const AssetCacheKey& key)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    if (!mAssetCache.Open(path, key)) {
+        std::cout << "Asset cache '" << path << "' is missing or out of date" << std::endl;
+        return false;
+    }
+
+    auto section = [&](size_t index) { return mAssetCache.Section(index); };
+    if (mAssetCache.SectionCount() != CACHE_SECTION_COUNT ||
+        section(CACHE_SECTION_INDEX_OFFSETS).size != mIndexOffsets.size() * sizeof(mIndexOffsets[0]) ||
+        section(CACHE_SECTION_VERTEX_COUNT).size != sizeof(mVertexCountPerMesh) ||
+        section(CACHE_SECTION_VERTICES).size % sizeof(Vertex) != 0 ||
+        section(CACHE_SECTION_INDICES).size % sizeof(IndexType) != 0 ||
+        section(CACHE_SECTION_TEXTURES).size != mTextureSizeInBytes * mTextureCount) {
+        std::cout << "Asset cache '" << path << "' has unexpected layout" << std::endl;
+        mAssetCache.Close();
+        return false;
+    }
+
+    memcpy(mIndexOffsets.data(), section(CACHE_SECTION_INDEX_OFFSETS).data, section(CACHE_SECTION_INDEX_OFFSETS).size);
+    memcpy(&mVertexCountPerMesh, section(CACHE_SECTION_VERTEX_COUNT).data, sizeof(mVertexCountPerMesh));
+
+    // Mesh data is owned by std::vector, so it is copied. Texture data is used in place.
+    auto vertices = static_cast<const Vertex*>(section(CACHE_SECTION_VERTICES).data);
+    auto indices = static_cast<const IndexType*>(section(CACHE_SECTION_INDICES).data);
+    mMeshes.vertices.assign(vertices, vertices + section(CACHE_SECTION_VERTICES).size / sizeof(Vertex));
+    mMeshes.indices.assign(indices, indices + section(CACHE_SECTION_INDICES).size / sizeof(IndexType));
+    SetTextureData(static_cast<const BYTE*>(section(CACHE_SECTION_TEXTURES).data));
+
+    std::cout
+        << "Meshes and textures loaded from '" << path << "' in "
+        << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count()
+        << " ms (warm start)" << std::endl;
+    return true;
+}
+
+
+void AsteroidsSimulation::SaveToCache(const char* path, const AssetCacheKey& key)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    AssetCacheSection sections[CACHE_SECTION_COUNT] = {};
+    sections[CACHE_SECTION_INDEX_OFFSETS] = {mIndexOffsets.data(), mIndexOffsets.size() * sizeof(mIndexOffsets[0])};
+    sections[CACHE_SECTION_VERTEX_COUNT]  = {&mVertexCountPerMesh, sizeof(mVertexCountPerMesh)};
+    sections[CACHE_SECTION_VERTICES]      = {mMeshes.vertices.data(), mMeshes.vertices.size() * sizeof(Vertex)};
+    sections[CACHE_SECTION_INDICES]       = {mMeshes.indices.data(), mMeshes.indices.size() * sizeof(IndexType)};
+    sections[CACHE_SECTION_TEXTURES]      = {mTextureDataBuffer.data(), mTextureDataBuffer.size()};
+
+    if (!WriteAssetCache(path, key, sections, CACHE_SECTION_COUNT)) {
+        std::cout << "Failed to write asset cache '" << path << "'" << std::endl;
+        return;
+    }
+
+    std::cout
+        << "Asset cache saved to '" << path << "' in "
+        << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count()
+        << " ms" << std::endl;
 }
@@ -18,6 +18,7 @@
 
 #include "mesh.h"
 #include "settings.h"
+#include "asset_cache.h"
 
 // We may want to ISPC-ify this down the road and just let it own the data structure in AoSoA format or similar
 // For now we'll just do the dumb thing and see if it's fast enough
@@ -41,6 +42,26 @@ struct AsteroidStatic
     unsigned int textureIndex;
 };
 
+// Per-asteroid draw data in the layout of the AsteroidData structure in asteroid_vs_diligent.vsh
+struct AsteroidDrawData
+{
+    DirectX::XMFLOAT4X4 world;
+    DirectX::XMFLOAT3 surfaceColor;
+    float unused0;
+    DirectX::XMFLOAT3 deepColor;
+    unsigned int textureIndex;
+};
+
+// Instanced draw of asteroids that share a mesh and subdivision level
+struct AsteroidDrawBatch
+{
+    unsigned int indexStart;
+    unsigned int indexCount;
+    unsigned int vertexStart;
+    unsigned int firstInstance; // Relative to the drawData array passed to Update()
+    unsigned int instanceCount;
+};
+
 class AsteroidsSimulation
 {
 private:
@@ -57,20 +78,31 @@ private:
     unsigned int mTextureCount;
     unsigned int mTextureArraySize;
     unsigned int mTextureMipLevels;
+    size_t mTextureSizeInBytes; // Per texture, including all array slices and mips
     std::vector<BYTE> mTextureDataBuffer;
     std::vector<D3D11_SUBRESOURCE_DATA> mTextureSubresources;
 
+    // When loaded from the cache, texture subresources point directly into the mapped file
+    AssetCacheFile mAssetCache;
+
     unsigned int SubresourceIndex(unsigned int texture, unsigned int arrayElement = 0, unsigned int mip = 0)
     {
         return mip + mTextureMipLevels * (arrayElement + mTextureArraySize * texture);
     }
 
-    void CreateTextures(unsigned int textureCount, unsigned int rngSeed);
+    void InitTextureLayout(unsigned int textureCount);
+    void SetTextureData(const BYTE* data);
+    void CreateTextures(unsigned int rngSeed);
+    void WriteDrawData(size_t first, size_t last, AsteroidDrawData* drawData, std::vector<AsteroidDrawBatch>* batches) const;
+
+    bool LoadFromCache(const char* path, const AssetCacheKey& key);
+    void SaveToCache(const char* path, const AssetCacheKey& key);
     
 public:
+    // Generated meshes and textures are loaded from and saved to cachePath, unless it is null
     AsteroidsSimulation(unsigned int rngSeed, unsigned int asteroidCount,
                         unsigned int meshInstanceCount, unsigned int subdivCount,
-                        unsigned int textureCount);
+                        unsigned int textureCount, const char* cachePath = nullptr);
 
     const Mesh* Meshes() { return &mMeshes; }
     const D3D11_SUBRESOURCE_DATA* TextureData(unsigned int textureIndex)
@@ -85,6 +117,9 @@ public:
 
     // Can optionally provide a range of asteroids to update; count = 0 => to the end
     // This is useful for multithreading
+    // If drawData is not null, draw data for the range is written to it (typically mapped GPU memory),
+    // grouped so that asteroids with the same mesh and subdivision level are drawn with one instanced draw.
     void Update(float frameTime, DirectX::XMVECTOR cameraEye, const Settings& settings,
-                size_t startIndex = 0, size_t count = 0);
+                size_t startIndex = 0, size_t count = 0,
+                AsteroidDrawData* drawData = nullptr, std::vector<AsteroidDrawBatch>* batches = nullptr);
 };
@@ -14,12 +14,17 @@
 #include <d3dx12.h>
 #include <d3d11.h>
 
-void GenerateMips2D_XXXX8(D3D11_SUBRESOURCE_DATA* subresources, size_t widthLevel0, size_t heightLevel0, size_t mipLevels);
+// SSE2 paths process four texels at a time; useSIMD = false selects the scalar reference implementation
+void GenerateMips2D_XXXX8(D3D11_SUBRESOURCE_DATA* subresources, size_t widthLevel0, size_t heightLevel0, size_t mipLevels, bool useSIMD = true);
 
 // Will generate mips (into subresources array) is mipLevels > 0
 void FillNoise2D_RGBA8(D3D11_SUBRESOURCE_DATA* subresources, size_t width, size_t height, size_t mipLevels,
                        float seed, float persistence, float noiseScale, float noiseStrength,
-					   float redScale = 255.0f, float greenScale = 255.0f, float blueScale = 255.0f);
+					   float redScale = 255.0f, float greenScale = 255.0f, float blueScale = 255.0f, bool useSIMD = true);
+
+
+// Generates sliceCount noise textures with the scalar and SIMD paths and prints their throughput
+void BenchmarkNoiseTextures_RGBA8(size_t dim, size_t sliceCount);
 
 
 // Helper for uploading initial texture data in D3D12; as with D3D11, one initialData structure per subresource
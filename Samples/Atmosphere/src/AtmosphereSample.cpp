@@ -889,8 +889,10 @@ void AtmosphereSample::WindowResize(Uint32 Width, Uint32 Height)
     // not by Intel driver, which results in memory exhaustion.
     m_pImmediateContext->Flush();
 
-    m_pOffscreenColorBuffer.Release();
-    m_pOffscreenDepthBuffer.Release();
+    // Return the previous buffers to the pool. They are destroyed at the end
+    // of the frame as the new buffers have a different size
+    m_TransientTextures.Release(m_pOffscreenColorBuffer);
+    m_TransientTextures.Release(m_pOffscreenDepthBuffer);
 
     TextureDesc ColorBuffDesc;
     ColorBuffDesc.Name      = "Offscreen color buffer";
@@ -900,13 +902,13 @@ void AtmosphereSample::WindowResize(Uint32 Width, Uint32 Height)
     ColorBuffDesc.MipLevels = 1;
     ColorBuffDesc.Format    = TEX_FORMAT_R11G11B10_FLOAT;
     ColorBuffDesc.BindFlags = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
-    m_pDevice->CreateTexture(ColorBuffDesc, nullptr, &m_pOffscreenColorBuffer);
+    m_pOffscreenColorBuffer = m_TransientTextures.Acquire(m_pDevice, ColorBuffDesc);
 
     TextureDesc DepthBuffDesc = ColorBuffDesc;
     DepthBuffDesc.Name        = "Offscreen depth buffer";
     DepthBuffDesc.Format      = TEX_FORMAT_D32_FLOAT;
     DepthBuffDesc.BindFlags   = BIND_SHADER_RESOURCE | BIND_DEPTH_STENCIL;
-    m_pDevice->CreateTexture(DepthBuffDesc, nullptr, &m_pOffscreenDepthBuffer);
+    m_pOffscreenDepthBuffer = m_TransientTextures.Acquire(m_pDevice, DepthBuffDesc);
 }
 
 } // namespace Diligent
@@ -0,0 +1,200 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "DistanceTransform.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Large finite value is used instead of infinity to avoid NaNs in parabola intersections
+constexpr float DistInf = 1e20f;
+
+// Scratch buffers of the 1D distance transform
+struct DistanceTransformScratch
+{
+    explicit DistanceTransformScratch(Uint32 Count) :
+        f(Count),
+        v(Count),
+        z(size_t{Count} + 1)
+    {}
+
+    std::vector<float> f; // Input samples
+    std::vector<int>   v; // Locations of parabolas in the lower envelope
+    std::vector<float> z; // Boundaries between parabolas
+};
+
+// Computes the squared distance transform of Count samples located Stride elements apart.
+// Each sample contains 0 at feature locations and DistInf elsewhere.
+void DistanceTransform1D(float* Data, size_t Stride, Uint32 Count, DistanceTransformScratch& Scratch)
+{
+    auto& f = Scratch.f;
+    auto& v = Scratch.v;
+    auto& z = Scratch.z;
+
+    for (Uint32 q = 0; q < Count; ++q)
+        f[q] = Data[q * Stride];
+
+    // Compute the lower envelope of parabolas rooted at (q, f[q])
+    int k = 0;
+    v[0]  = 0;
+    z[0]  = -DistInf;
+    z[1]  = +DistInf;
+    for (int q = 1; q < static_cast<int>(Count); ++q)
+    {
+        float s = 0;
+        for (;;)
+        {
+            const int p = v[k];
+            s           = ((f[q] + static_cast<float>(q * q)) - (f[p] + static_cast<float>(p * p))) / static_cast<float>(2 * (q - p));
+            if (s > z[k])
+                break;
+            VERIFY_EXPR(k > 0);
+            --k;
+        }
+        ++k;
+        v[k]     = q;
+        z[k]     = s;
+        z[k + 1] = +DistInf;
+    }
+
+    // Sample the lower envelope
+    k = 0;
+    for (int q = 0; q < static_cast<int>(Count); ++q)
+    {
+        while (z[k + 1] < static_cast<float>(q))
+            ++k;
+        const int p = v[k];
+
+        Data[q * Stride] = static_cast<float>((q - p) * (q - p)) + f[p];
+    }
+}
+
+// Calls Handler(First, Last) for subranges of [0, Count) on multiple threads
+template <typename HandlerType>
+void ParallelFor(Uint32 Count, HandlerType&& Handler)
+{
+    // Do not spawn threads for small workloads
+    constexpr Uint32 MinItemsPerThread = 32;
+
+    const Uint32 NumThreads = std::max(std::min(std::thread::hardware_concurrency(), Count / MinItemsPerThread), 1u);
+    if (NumThreads == 1)
+    {
+        Handler(0u, Count);
+        return;
+    }
+
+    std::vector<std::thread> Threads;
+    Threads.reserve(NumThreads - 1);
+    for (Uint32 t = 1; t < NumThreads; ++t)
+        Threads.emplace_back(Handler, Count * t / NumThreads, Count * (t + 1) / NumThreads);
+
+    // The first range is processed by this thread
+    Handler(0u, Count / NumThreads);
+
+    for (auto& Thread : Threads)
+        Thread.join();
+}
+
+// Computes squared distances from every texel to the nearest feature texel
+void SquaredDistanceTransform2D(std::vector<float>& Data, const uint2& Dim)
+{
+    // Transform columns
+    ParallelFor(Dim.x, [&](Uint32 FirstCol, Uint32 LastCol) {
+        DistanceTransformScratch Scratch{Dim.y};
+        for (Uint32 x = FirstCol; x < LastCol; ++x)
+            DistanceTransform1D(&Data[x], Dim.x, Dim.y, Scratch);
+    });
+
+    // Transform rows
+    ParallelFor(Dim.y, [&](Uint32 FirstRow, Uint32 LastRow) {
+        DistanceTransformScratch Scratch{Dim.x};
+        for (Uint32 y = FirstRow; y < LastRow; ++y)
+            DistanceTransform1D(&Data[size_t{y} * size_t{Dim.x}], 1, Dim.x, Scratch);
+    });
+}
+
+} // namespace
+
+void ComputeSignedDistanceField(const std::vector<bool>& MapData, const uint2& MapDim, Uint32 Scale, std::vector<float>& SDF)
+{
+    VERIFY_EXPR(MapData.size() == size_t{MapDim.x} * size_t{MapDim.y});
+    VERIFY_EXPR(Scale > 0);
+
+    // Add one texel border around the map to treat everything outside as a wall
+    const uint2  Dim{MapDim.x * Scale + 2, MapDim.y * Scale + 2};
+    const size_t NumTexels = size_t{Dim.x} * size_t{Dim.y};
+
+    const auto IsWall = [&](Uint32 x, Uint32 y) {
+        if (x == 0 || y == 0 || x == Dim.x - 1 || y == Dim.y - 1)
+            return true;
+        return static_cast<bool>(MapData[(x - 1) / Scale + (y - 1) / Scale * MapDim.x]);
+    };
+
+    // Squared distances to the nearest wall texel and to the nearest empty texel
+    std::vector<float> DistToWall(NumTexels);
+    std::vector<float> DistToEmpty(NumTexels);
+    for (Uint32 y = 0; y < Dim.y; ++y)
+    {
+        for (Uint32 x = 0; x < Dim.x; ++x)
+        {
+            const size_t Idx  = x + size_t{y} * Dim.x;
+            const bool   Wall = IsWall(x, y);
+            DistToWall[Idx]   = Wall ? 0.f : DistInf;
+            DistToEmpty[Idx]  = Wall ? DistInf : 0.f;
+        }
+    }
+
+    SquaredDistanceTransform2D(DistToWall, Dim);
+    SquaredDistanceTransform2D(DistToEmpty, Dim);
+
+    // Distances between texel centers are converted to the distances to the wall boundary
+    // that lies half a texel away from the nearest texel center.
+    const float TexelSize = 1.0f / static_cast<float>(Scale);
+
+    SDF.resize(size_t{MapDim.x} * size_t{MapDim.y} * Scale * Scale);
+    for (Uint32 y = 0; y < Dim.y - 2; ++y)
+    {
+        for (Uint32 x = 0; x < Dim.x - 2; ++x)
+        {
+            const size_t SrcIdx = (x + 1) + size_t{y + 1} * Dim.x;
+            const float  Dist   = IsWall(x + 1, y + 1) ?
+                -std::sqrt(DistToEmpty[SrcIdx]) :
+                std::sqrt(DistToWall[SrcIdx]);
+
+            SDF[x + size_t{y} * (Dim.x - 2)] = (Dist - (Dist > 0 ? 0.5f : -0.5f)) * TexelSize;
+        }
+    }
+}
+
+} // namespace Diligent
@@ -130,7 +130,7 @@ bool GLFWDemo::CreateWindow(const char* Title, int Width, int Height, int GlfwAp
     glfwWindowHint(GLFW_CLIENT_API, GlfwApiHint);
     if (GlfwApiHint == GLFW_OPENGL_API)
     {
-        // We need compute shaders, so request OpenGL 4.2 at least
+        // The default context may be too old for the engine, so request OpenGL 4.2 at least
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
     }
@@ -29,8 +29,9 @@
 #include <vector>
 
 #include "Game.hpp"
-#include "ShaderMacroHelper.hpp"
+#include "DistanceTransform.hpp"
 #include "CallbackWrapper.hpp"
+#include "Float16.hpp"
 
 namespace Diligent
 {
@@ -101,38 +102,21 @@ void Game::Update(float dt)
     {
         const float2 StartPos = m_Player.Pos;
         const float2 Dir      = (m_Player.PendingPos / PosDeltaLen);
-        const float2 EndPos   = m_Player.Pos + Dir * dt * Constants.PlayerVelocity;
-        const uint2  TexDim   = Constants.MapTexDim;
+        const float  PathLen  = dt * Constants.PlayerVelocity;
 
-        const auto ReadMap = [&](int x, int y) //
+        // check collisions with walls using sphere tracing:
+        // the player can safely move by the distance to the nearest wall minus the player radius
+        float t = 0.0f;
+        for (Uint32 i = 0; i < Constants.MaxCollisionSteps && t < PathLen; ++i)
         {
-            if (x >= 0 && x < static_cast<int>(TexDim.x) &&
-                y >= 0 && y < static_cast<int>(TexDim.y))
-            {
-                return m_Map.MapData[x + y * TexDim.x] ? 1.0f : 0.0f;
-            }
-            else
-                return 1.0f;
-        };
+            const float Clearance = ReadSDF(StartPos + Dir * t) - Constants.PlayerRadius;
 
-        // check collisions with walls
-        for (Uint32 i = 0; i < Constants.MaxCollisionSteps; ++i)
-        {
-            const float2 Pos      = lerp(StartPos, EndPos, static_cast<float>(i) / (Constants.MaxCollisionSteps - 1));
-            const float2 FetchPos = Pos - float2(0.5f, 0.5f);
-
-            // MapData is a 1 bit distance field, use bilinear filter to calculate distance from nearest wall to player position
-            int   x    = static_cast<int>(FetchPos.x);
-            int   y    = static_cast<int>(FetchPos.y);
-            float c00  = ReadMap(x, y);
-            float c10  = ReadMap(x + 1, y);
-            float c01  = ReadMap(x, y + 1);
-            float c11  = ReadMap(x + 1, y + 1);
-            float dist = lerp(lerp(c00, c10, fract(FetchPos.x)), lerp(c01, c11, fract(FetchPos.x)), fract(FetchPos.y));
-
-            if (dist > Constants.PlayerRadius)
+            const float  NextT = std::min(t + std::max(Clearance, Constants.MinCollisionStep), PathLen);
+            const float2 Pos   = StartPos + Dir * NextT;
+            if (ReadSDF(Pos) < Constants.PlayerRadius)
                 break; // intersection found
 
+            t            = NextT;
             m_Player.Pos = Pos;
         }
 
@@ -244,6 +228,29 @@ void Game::GetScreenTransform(float2& XRange, float2& YRange)
     YRange.x = -YRange.y;
 }
 
+float Game::ReadSDF(float2 Pos) const
+{
+    // SDF is sampled with bilinear filter, the same way the shader does it
+    const uint2  TexDim   = Constants.SDFTexDim;
+    const float2 FetchPos = Pos * static_cast<float>(Constants.SDFTexScale) - float2(0.5f, 0.5f);
+
+    const auto ReadTexel = [&](int x, int y) //
+    {
+        x = clamp(x, 0, static_cast<int>(TexDim.x) - 1);
+        y = clamp(y, 0, static_cast<int>(TexDim.y) - 1);
+        return m_Map.SDF[x + y * TexDim.x];
+    };
+
+    const int x = static_cast<int>(floor(FetchPos.x));
+    const int y = static_cast<int>(floor(FetchPos.y));
+
+    const float c00 = ReadTexel(x, y);
+    const float c10 = ReadTexel(x + 1, y);
+    const float c01 = ReadTexel(x, y + 1);
+    const float c11 = ReadTexel(x + 1, y + 1);
+    return lerp(lerp(c00, c10, fract(FetchPos.x)), lerp(c01, c11, fract(FetchPos.x)), fract(FetchPos.y));
+}
+
 void Game::KeyEvent(Key key, KeyState state)
 {
     if (state == KeyState::Press || state == KeyState::Repeat)
@@ -435,93 +442,39 @@ void Game::GenerateMap()
 
 void Game::CreateSDFMap()
 {
-    const uint2 SrcTexDim = Constants.MapTexDim;
-    const uint2 DstTexDim = Constants.SDFTexDim;
-
-    // Create Src and Dst textures.
-    RefCntAutoPtr<ITexture> pSrcTex;
-    {
-        TextureDesc TexDesc;
-        TexDesc.Name      = "SDF Map texture";
-        TexDesc.Type      = RESOURCE_DIM_TEX_2D;
-        TexDesc.Width     = DstTexDim.x;
-        TexDesc.Height    = DstTexDim.y;
-        TexDesc.Format    = TEX_FORMAT_R16_FLOAT;
-        TexDesc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
-
-        m_Map.pMapTex = nullptr;
-        GetDevice()->CreateTexture(TexDesc, nullptr, &m_Map.pMapTex);
-        CHECK_THROW(m_Map.pMapTex != nullptr);
-
-        TexDesc.Name      = "Src texture";
-        TexDesc.Width     = SrcTexDim.x;
-        TexDesc.Height    = SrcTexDim.y;
-        TexDesc.Format    = TEX_FORMAT_R8_UNORM;
-        TexDesc.BindFlags = BIND_SHADER_RESOURCE;
-
-        GetDevice()->CreateTexture(TexDesc, nullptr, &pSrcTex);
-        CHECK_THROW(pSrcTex != nullptr);
-    }
-
-
-    RefCntAutoPtr<IPipelineState>         pGenSdfPSO;
-    RefCntAutoPtr<IShaderResourceBinding> pGenSdfSRB;
-    {
-        {
-            ShaderMacroHelper Macros;
-            Macros.AddShaderMacro("RADIUS", Constants.TexFilterRadius);
-            Macros.AddShaderMacro("DIST_SCALE", 1.0f / float(Constants.SDFTexScale));
-
-            auto Callback = MakeCallback([&](ShaderCreateInfo& ShaderCI, SHADER_TYPE ShaderType, bool& IsAddToCache) {
-                ShaderCI.Macros = Macros;
-            });
-
-            m_pRSNLoader->LoadPipelineState({"Generate SDF map PSO", PIPELINE_TYPE_COMPUTE, true, nullptr, nullptr, Callback, Callback}, &pGenSdfPSO);
-            CHECK_THROW(pGenSdfPSO != nullptr);
-        }
-
-        pGenSdfPSO->CreateShaderResourceBinding(&pGenSdfSRB, true);
-        CHECK_THROW(pGenSdfSRB != nullptr);
-
-        pGenSdfSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_SrcTex")->Set(pSrcTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
-        pGenSdfSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DstTex")->Set(m_Map.pMapTex->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
-    }
-
-    // Generate signed distance field (SDF)
-    auto* pContext = GetContext();
-
-    // upload map to pSrcTex
-    {
-        std::vector<Uint8> MapData(m_Map.MapData.size());
-        VERIFY_EXPR(MapData.size() == (size_t{SrcTexDim.x} * size_t{SrcTexDim.y}));
-
-        // convert 1-bit to 8-bit texture
-        for (size_t i = 0; i < MapData.size(); ++i)
-            MapData[i] = m_Map.MapData[i] ? 0xFF : 0;
-
-        TextureSubResData SubresData;
-        SubresData.pData       = MapData.data();
-        SubresData.Stride      = sizeof(MapData[0]) * SrcTexDim.x;
-        SubresData.DepthStride = static_cast<Uint32>(MapData.size());
-
-        pContext->UpdateTexture(pSrcTex, 0, 0, Box{0, SrcTexDim.x, 0, SrcTexDim.y}, SubresData, RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    }
-
-    // Compute SDF - for each pixel find the minimal distance from empty space to a wall or from the wall to empty space.
-    {
-        const uint2 LocalGroupSize = {8, 8};
-
-        pContext->SetPipelineState(pGenSdfPSO);
-        pContext->CommitShaderResources(pGenSdfSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-        DispatchComputeAttribs dispatchAttrs;
-        dispatchAttrs.ThreadGroupCountX = (DstTexDim.x + LocalGroupSize.x - 1) / LocalGroupSize.x;
-        dispatchAttrs.ThreadGroupCountY = (DstTexDim.y + LocalGroupSize.y - 1) / LocalGroupSize.y;
-
-        pContext->DispatchCompute(dispatchAttrs);
-    }
-
-    pContext->Flush();
+    const uint2 TexDim = Constants.SDFTexDim;
+
+    // Compute exact signed distance field (SDF) on the CPU. It is used for collision queries
+    // and to initialize the texture for ray marching.
+    ComputeSignedDistanceField(m_Map.MapData, Constants.MapTexDim, Constants.SDFTexScale, m_Map.SDF);
+    VERIFY_EXPR(m_Map.SDF.size() == (size_t{TexDim.x} * size_t{TexDim.y}));
+
+    // Limit the distance that can be added to position during ray marching
+    const float MaxDist = static_cast<float>(Constants.TexFilterRadius) / static_cast<float>(Constants.SDFTexScale);
+
+    // convert distances to 16-bit float texture
+    std::vector<Uint16> TexData(m_Map.SDF.size());
+    for (size_t i = 0; i < TexData.size(); ++i)
+        TexData[i] = Float16{clamp(m_Map.SDF[i], -MaxDist, MaxDist)}.Raw();
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "SDF Map texture";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = TexDim.x;
+    TexDesc.Height    = TexDim.y;
+    TexDesc.Format    = TEX_FORMAT_R16_FLOAT;
+    TexDesc.Usage     = USAGE_IMMUTABLE;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    TextureSubResData SubresData;
+    SubresData.pData  = TexData.data();
+    SubresData.Stride = sizeof(TexData[0]) * TexDim.x;
+
+    TextureData InitData{&SubresData, 1};
+
+    m_Map.pMapTex = nullptr;
+    GetDevice()->CreateTexture(TexDesc, &InitData, &m_Map.pMapTex);
+    CHECK_THROW(m_Map.pMapTex != nullptr);
 }
 
 void Game::CreatePipelineState()
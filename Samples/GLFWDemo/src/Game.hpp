@@ -51,6 +51,9 @@ private:
 
     void GetScreenTransform(float2& XRange, float2& YRange);
 
+    // Returns the distance in pixels from the given position on the map to the nearest wall
+    float ReadSDF(float2 Pos) const;
+
 private:
     struct
     {
@@ -71,6 +74,7 @@ private:
         float2                                TeleportPos; // pixels, player must reach this point to finish game
         float                                 TeleportWaveAnim = 0.0f;
         std::vector<bool>                     MapData; // 0 - empty, 1 - wall
+        std::vector<float>                    SDF;     // SDFTexDim texels, distance in pixels: positive - empty, negative - wall
         RefCntAutoPtr<ITexture>               pMapTex;
         RefCntAutoPtr<IPipelineState>         pPSO;
         RefCntAutoPtr<IShaderResourceBinding> pSRB;
@@ -79,13 +83,14 @@ private:
 
     struct
     {
-        const float PlayerRadius          = 0.25f; // pixels, must be less than 0.5, because we use 1 bit SDF
+        const float PlayerRadius          = 0.25f; // pixels
         const float AmbientLightRadius    = 4.0f;  // pixels
         const float FlshLightMaxDist      = 25.0f; // pixels
         const float PlayerVelocity        = 4.0f;  // pixels / second
         const float FlashLightAttenuation = 4.0f;  // power / second
         const float MaxDT                 = 1.0f / 30.0f;
         const uint  MaxCollisionSteps     = 8;
+        const float MinCollisionStep      = 0.0625f; // pixels
 
         const float TeleportRadius = 1.0f; // pixels
 
@@ -0,0 +1,367 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "GLTFTransformEvaluator.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+#    define GLTF_TRANSFORMS_USE_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define GLTF_TRANSFORMS_USE_NEON 1
+#endif
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Levels and skin lists with fewer items than this are processed on the calling thread
+constexpr size_t MinParallelItems = 256;
+constexpr size_t NodeBatchSize    = 64;
+constexpr size_t SkinBatchSize    = 4;
+
+// Computes C = A * B using row-vector convention.
+// C may not alias A or B.
+inline void MultiplyMatrices(const float4x4& A, const float4x4& B, float4x4& C)
+{
+#if GLTF_TRANSFORMS_USE_SSE
+    const __m128 B0 = _mm_loadu_ps(B[0]);
+    const __m128 B1 = _mm_loadu_ps(B[1]);
+    const __m128 B2 = _mm_loadu_ps(B[2]);
+    const __m128 B3 = _mm_loadu_ps(B[3]);
+    for (size_t r = 0; r < 4; ++r)
+    {
+        const float* a   = A[r];
+        __m128       Row = _mm_mul_ps(_mm_set1_ps(a[0]), B0);
+        Row              = _mm_add_ps(Row, _mm_mul_ps(_mm_set1_ps(a[1]), B1));
+        Row              = _mm_add_ps(Row, _mm_mul_ps(_mm_set1_ps(a[2]), B2));
+        Row              = _mm_add_ps(Row, _mm_mul_ps(_mm_set1_ps(a[3]), B3));
+        _mm_storeu_ps(C[r], Row);
+    }
+#elif GLTF_TRANSFORMS_USE_NEON
+    const float32x4_t B0 = vld1q_f32(B[0]);
+    const float32x4_t B1 = vld1q_f32(B[1]);
+    const float32x4_t B2 = vld1q_f32(B[2]);
+    const float32x4_t B3 = vld1q_f32(B[3]);
+    for (size_t r = 0; r < 4; ++r)
+    {
+        const float* a   = A[r];
+        float32x4_t  Row = vmulq_n_f32(B0, a[0]);
+        Row              = vmlaq_n_f32(Row, B1, a[1]);
+        Row              = vmlaq_n_f32(Row, B2, a[2]);
+        Row              = vmlaq_n_f32(Row, B3, a[3]);
+        vst1q_f32(C[r], Row);
+    }
+#else
+    C = A * B;
+#endif
+}
+
+inline bool MatricesEqual(const float4x4& A, const float4x4& B)
+{
+    return std::memcmp(&A, &B, sizeof(float4x4)) == 0;
+}
+
+} // namespace
+
+GLTFTransformEvaluator::GLTFTransformEvaluator(Uint32 NumWorkerThreads)
+{
+    m_WorkerThreads.reserve(NumWorkerThreads);
+    for (Uint32 i = 0; i < NumWorkerThreads; ++i)
+        m_WorkerThreads.emplace_back(&GLTFTransformEvaluator::WorkerThreadProc, this);
+}
+
+GLTFTransformEvaluator::~GLTFTransformEvaluator()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_JobMtx};
+        m_Job.Quit = true;
+    }
+    m_JobStartCV.notify_all();
+    for (auto& Thread : m_WorkerThreads)
+        Thread.join();
+}
+
+void GLTFTransformEvaluator::WorkerThreadProc()
+{
+    Uint64 LastJobId = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> Lock{m_JobMtx};
+            m_JobStartCV.wait(Lock, [&]() { return m_Job.Quit || m_Job.Id != LastJobId; });
+            if (m_Job.Quit)
+                return;
+            LastJobId = m_Job.Id;
+        }
+
+        ProcessJob();
+
+        {
+            std::lock_guard<std::mutex> Lock{m_JobMtx};
+            VERIFY_EXPR(m_Job.PendingWorkers > 0);
+            if (--m_Job.PendingWorkers == 0)
+                m_JobDoneCV.notify_one();
+        }
+    }
+}
+
+void GLTFTransformEvaluator::ProcessJob()
+{
+    const auto& Func = *m_Job.pFunc;
+    while (true)
+    {
+        const auto Start = m_Job.NextItem.fetch_add(m_Job.BatchSize);
+        if (Start >= m_Job.Count)
+            break;
+        Func(Start, std::min(Start + m_Job.BatchSize, m_Job.Count));
+    }
+}
+
+void GLTFTransformEvaluator::ParallelFor(size_t Count, size_t BatchSize, const std::function<void(size_t, size_t)>& Func)
+{
+    if (m_WorkerThreads.empty() || Count < MinParallelItems)
+    {
+        Func(0, Count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock{m_JobMtx};
+        m_Job.pFunc     = &Func;
+        m_Job.Count     = Count;
+        m_Job.BatchSize = BatchSize;
+        m_Job.NextItem.store(0);
+        // Every worker must acknowledge the job before the next one can be started
+        m_Job.PendingWorkers = static_cast<Uint32>(m_WorkerThreads.size());
+        ++m_Job.Id;
+    }
+    m_JobStartCV.notify_all();
+
+    ProcessJob();
+
+    std::unique_lock<std::mutex> Lock{m_JobMtx};
+    m_JobDoneCV.wait(Lock, [this]() { return m_Job.PendingWorkers == 0; });
+    m_Job.pFunc = nullptr;
+}
+
+void GLTFTransformEvaluator::Reset(const GLTF::Model& Model, Uint32 SceneIndex)
+{
+    m_pModel      = &Model;
+    m_SceneIndex  = SceneIndex;
+    m_ForceUpdate = true;
+
+    m_Nodes.clear();
+    m_LevelOffsets.clear();
+    m_SkinnedNodes.clear();
+    m_NodeToFlatIdx.assign(Model.Nodes.size(), InvalidIndex);
+
+    const auto& Scene = Model.Scenes[SceneIndex];
+
+    // Breadth-first traversal produces nodes sorted by depth
+    m_LevelOffsets.push_back(0);
+    for (const auto* pRoot : Scene.RootNodes)
+    {
+        m_NodeToFlatIdx[pRoot->Index] = static_cast<Uint32>(m_Nodes.size());
+        m_Nodes.push_back({pRoot, InvalidIndex});
+    }
+    while (m_LevelOffsets.back() < m_Nodes.size())
+    {
+        const auto LevelStart = m_LevelOffsets.back();
+        const auto LevelEnd   = static_cast<Uint32>(m_Nodes.size());
+        for (Uint32 ParentIdx = LevelStart; ParentIdx < LevelEnd; ++ParentIdx)
+        {
+            for (const auto* pChild : m_Nodes[ParentIdx].pNode->Children)
+            {
+                m_NodeToFlatIdx[pChild->Index] = static_cast<Uint32>(m_Nodes.size());
+                m_Nodes.push_back({pChild, ParentIdx});
+            }
+        }
+        m_LevelOffsets.push_back(LevelEnd);
+    }
+
+    m_NumSkinTransforms = 0;
+    for (Uint32 i = 0; i < m_Nodes.size(); ++i)
+    {
+        const auto* pNode = m_Nodes[i].pNode;
+        if (pNode->pMesh != nullptr && pNode->pSkin != nullptr && pNode->SkinTransformsIndex >= 0)
+        {
+            m_SkinnedNodes.push_back(i);
+            m_NumSkinTransforms = std::max(m_NumSkinTransforms, static_cast<size_t>(pNode->SkinTransformsIndex) + 1);
+        }
+    }
+
+    m_PrevLocalMatrices.resize(m_Nodes.size());
+    m_DirtyFlags.assign(m_Nodes.size(), 1);
+
+    m_Stats           = {};
+    m_Stats.NumNodes  = static_cast<Uint32>(m_Nodes.size());
+    m_Stats.NumLevels = static_cast<Uint32>(m_LevelOffsets.size() - 1);
+}
+
+void GLTFTransformEvaluator::ComputeTransforms(const GLTF::Model&     Model,
+                                               Uint32                 SceneIndex,
+                                               GLTF::ModelTransforms& Transforms,
+                                               const float4x4&        RootTransform,
+                                               Int32                  AnimationIndex,
+                                               float                  Time)
+{
+    if (m_pModel != &Model || m_SceneIndex != SceneIndex)
+        Reset(Model, SceneIndex);
+
+    if (!MatricesEqual(RootTransform, m_RootTransform))
+    {
+        m_RootTransform = RootTransform;
+        m_ForceUpdate   = true;
+    }
+
+    Transforms.NodeLocalMatrices.resize(Model.Nodes.size());
+    Transforms.NodeGlobalMatrices.resize(Model.Nodes.size());
+
+    if (AnimationIndex >= 0)
+    {
+        // Reset animation transforms to the static node transforms, so that nodes
+        // not affected by the current animation use their own transforms.
+        Transforms.NodeAnimations.resize(Model.Nodes.size());
+        ParallelFor(m_Nodes.size(), NodeBatchSize, [&](size_t Start, size_t End) {
+            for (size_t i = Start; i < End; ++i)
+            {
+                const auto* pNode    = m_Nodes[i].pNode;
+                auto&       AnimXfms = Transforms.NodeAnimations[pNode->Index];
+                AnimXfms.Translation = pNode->Translation;
+                AnimXfms.Rotation    = pNode->Rotation;
+                AnimXfms.Scale       = pNode->Scale;
+            }
+        });
+        // Animation sampling is cheap compared to the hierarchy evaluation and is performed by the model
+        Model.UpdateAnimation(SceneIndex, AnimationIndex, Time, Transforms);
+    }
+
+    // Local matrices. A node is dirty if its local matrix has changed.
+    ParallelFor(m_Nodes.size(), NodeBatchSize, [&](size_t Start, size_t End) {
+        for (size_t i = Start; i < End; ++i)
+        {
+            const auto* pNode = m_Nodes[i].pNode;
+
+            float3      Translation = pNode->Translation;
+            QuaternionF Rotation    = pNode->Rotation;
+            float3      Scale       = pNode->Scale;
+            if (AnimationIndex >= 0)
+            {
+                const auto& AnimXfms = Transforms.NodeAnimations[pNode->Index];
+                Translation          = AnimXfms.Translation;
+                Rotation             = AnimXfms.Rotation;
+                Scale                = AnimXfms.Scale;
+            }
+
+            // TRS properties and the matrix are mutually exclusive in glTF
+            float4x4 SR, SRT;
+            MultiplyMatrices(float4x4::Scale(Scale), Rotation.ToMatrix(), SR);
+            MultiplyMatrices(SR, float4x4::Translation(Translation), SRT);
+
+            auto& LocalMatrix = Transforms.NodeLocalMatrices[pNode->Index];
+            MultiplyMatrices(SRT, pNode->Matrix, LocalMatrix);
+
+            m_DirtyFlags[i]        = (m_ForceUpdate || !MatricesEqual(LocalMatrix, m_PrevLocalMatrices[i])) ? 1 : 0;
+            m_PrevLocalMatrices[i] = LocalMatrix;
+        }
+    });
+
+    // Global matrices, one hierarchy level at a time. Parents are always processed before their children,
+    // and a node is dirty if it or any of its ancestors is dirty.
+    for (size_t Level = 0; Level + 1 < m_LevelOffsets.size(); ++Level)
+    {
+        const size_t LevelStart = m_LevelOffsets[Level];
+        const size_t LevelSize  = m_LevelOffsets[Level + 1] - LevelStart;
+        ParallelFor(LevelSize, NodeBatchSize, [&](size_t Start, size_t End) {
+            for (size_t i = LevelStart + Start; i < LevelStart + End; ++i)
+            {
+                const auto& Node = m_Nodes[i];
+                if (Node.ParentIdx != InvalidIndex && m_DirtyFlags[Node.ParentIdx])
+                    m_DirtyFlags[i] = 1;
+
+                if (!m_DirtyFlags[i])
+                    continue;
+
+                const auto& ParentMatrix = Node.ParentIdx != InvalidIndex ?
+                    Transforms.NodeGlobalMatrices[m_Nodes[Node.ParentIdx].pNode->Index] :
+                    m_RootTransform;
+
+                const auto NodeIndex = Node.pNode->Index;
+                MultiplyMatrices(Transforms.NodeLocalMatrices[NodeIndex], ParentMatrix, Transforms.NodeGlobalMatrices[NodeIndex]);
+            }
+        });
+    }
+
+    // Joint matrices are only recomputed for skins where the mesh node or any joint is dirty
+    if (Transforms.Skins.size() < m_NumSkinTransforms)
+        Transforms.Skins.resize(m_NumSkinTransforms);
+    std::atomic<Uint32> NumJoints{0};
+    ParallelFor(m_SkinnedNodes.size(), SkinBatchSize, [&](size_t Start, size_t End) {
+        for (size_t s = Start; s < End; ++s)
+        {
+            const auto  NodeFlatIdx   = m_SkinnedNodes[s];
+            const auto* pNode         = m_Nodes[NodeFlatIdx].pNode;
+            const auto& Skin          = *pNode->pSkin;
+            auto&       JointMatrices = Transforms.Skins[pNode->SkinTransformsIndex].JointMatrices;
+
+            const auto NumSkinJoints = std::min(Skin.Joints.size(), Skin.InverseBindMatrices.size());
+            NumJoints.fetch_add(static_cast<Uint32>(NumSkinJoints), std::memory_order_relaxed);
+
+            bool IsDirty = m_DirtyFlags[NodeFlatIdx] != 0 || JointMatrices.size() != NumSkinJoints;
+            for (size_t j = 0; j < NumSkinJoints && !IsDirty; ++j)
+            {
+                const auto JointFlatIdx = m_NodeToFlatIdx[Skin.Joints[j]->Index];
+                IsDirty                 = JointFlatIdx == InvalidIndex || m_DirtyFlags[JointFlatIdx] != 0;
+            }
+            if (!IsDirty)
+                continue;
+
+            JointMatrices.resize(NumSkinJoints);
+            const auto InvNodeMatrix = Transforms.NodeGlobalMatrices[pNode->Index].Inverse();
+            for (size_t j = 0; j < NumSkinJoints; ++j)
+            {
+                float4x4 BindToWorld;
+                MultiplyMatrices(Skin.InverseBindMatrices[j], Transforms.NodeGlobalMatrices[Skin.Joints[j]->Index], BindToWorld);
+                MultiplyMatrices(BindToWorld, InvNodeMatrix, JointMatrices[j]);
+            }
+        }
+    });
+
+    m_ForceUpdate = false;
+
+    m_Stats.NumJoints     = NumJoints.load();
+    m_Stats.NumDirtyNodes = static_cast<Uint32>(std::count(m_DirtyFlags.begin(), m_DirtyFlags.end(), Uint8{1}));
+}
+
+} // namespace Diligent
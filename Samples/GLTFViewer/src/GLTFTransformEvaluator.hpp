@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+#include "GLTFLoader.hpp"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+/// Computes node and joint transforms of a GLTF scene in parallel.
+
+/// The scene hierarchy is flattened into an array of nodes sorted by depth,
+/// so that all nodes of one level can be processed concurrently once their
+/// parents are ready. Global matrices of nodes whose local transform and whose
+/// ancestors did not change since the previous frame are not recomputed.
+class GLTFTransformEvaluator
+{
+public:
+    explicit GLTFTransformEvaluator(Uint32 NumWorkerThreads);
+    ~GLTFTransformEvaluator();
+
+    // clang-format off
+    GLTFTransformEvaluator           (const GLTFTransformEvaluator&)  = delete;
+    GLTFTransformEvaluator           (      GLTFTransformEvaluator&&) = delete;
+    GLTFTransformEvaluator& operator=(const GLTFTransformEvaluator&)  = delete;
+    GLTFTransformEvaluator& operator=(      GLTFTransformEvaluator&&) = delete;
+    // clang-format on
+
+    /// Flattens the hierarchy of the given scene. Must be called when the model or the scene changes,
+    /// and after the transforms have been initialized by GLTF::Model::ComputeTransforms().
+    void Reset(const GLTF::Model& Model, Uint32 SceneIndex);
+
+    /// Same as GLTF::Model::ComputeTransforms(), but evaluates the hierarchy in parallel.
+    void ComputeTransforms(const GLTF::Model&     Model,
+                           Uint32                 SceneIndex,
+                           GLTF::ModelTransforms& Transforms,
+                           const float4x4&        RootTransform,
+                           Int32                  AnimationIndex,
+                           float                  Time);
+
+    struct Statistics
+    {
+        Uint32 NumNodes      = 0;
+        Uint32 NumLevels     = 0;
+        Uint32 NumDirtyNodes = 0;
+        Uint32 NumJoints     = 0;
+    };
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+    Uint32 GetNumWorkerThreads() const { return static_cast<Uint32>(m_WorkerThreads.size()); }
+
+private:
+    // Calls Func(Start, End) for batches of [0, Count) range on the worker threads and the calling thread.
+    void ParallelFor(size_t Count, size_t BatchSize, const std::function<void(size_t, size_t)>& Func);
+    void ProcessJob();
+    void WorkerThreadProc();
+
+    struct FlatNode
+    {
+        const GLTF::Node* pNode     = nullptr;
+        Uint32            ParentIdx = InvalidIndex; // Index of the parent in m_Nodes
+    };
+    static constexpr Uint32 InvalidIndex = ~0u;
+
+    // Nodes sorted by depth; level L occupies [m_LevelOffsets[L], m_LevelOffsets[L + 1])
+    std::vector<FlatNode> m_Nodes;
+    std::vector<Uint32>   m_LevelOffsets;
+    std::vector<float4x4> m_PrevLocalMatrices;
+    std::vector<Uint8>    m_DirtyFlags;
+
+    // Indices in m_Nodes of skinned mesh nodes
+    std::vector<Uint32> m_SkinnedNodes;
+    // Index in m_Nodes of every GLTF node of the scene, or InvalidIndex
+    std::vector<Uint32> m_NodeToFlatIdx;
+    size_t              m_NumSkinTransforms = 0;
+
+    const GLTF::Model* m_pModel        = nullptr;
+    Uint32             m_SceneIndex    = 0;
+    bool               m_ForceUpdate   = true;
+    float4x4           m_RootTransform = float4x4::Identity();
+
+    Statistics m_Stats;
+
+    std::vector<std::thread> m_WorkerThreads;
+    std::mutex               m_JobMtx;
+    std::condition_variable  m_JobStartCV;
+    std::condition_variable  m_JobDoneCV;
+
+    struct ParallelJob
+    {
+        // Protected by m_JobMtx
+        Uint64 Id             = 0;
+        Uint32 PendingWorkers = 0;
+        bool   Quit           = false;
+
+        const std::function<void(size_t, size_t)>* pFunc = nullptr;
+
+        size_t              Count     = 0;
+        size_t              BatchSize = 0;
+        std::atomic<size_t> NextItem{0};
+    };
+    ParallelJob m_Job;
+};
+
+} // namespace Diligent
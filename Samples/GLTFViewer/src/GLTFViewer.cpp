@@ -27,6 +27,7 @@
 
 #include <cmath>
 #include <array>
+#include <iomanip>
 
 #include "GLTFViewer.hpp"
 #include "MapHelper.hpp"
@@ -43,6 +44,12 @@
 #include "CommandLineParser.hpp"
 #include "GraphicsAccessories.hpp"
 #include "EnvMapRenderer.hpp"
+#include "AdvancedMath.hpp"
+#include "MemoryProfiler.hpp"
+#include "DataBlobImpl.hpp"
+#include "FileWrapper.hpp"
+
+#include "nlohmann/json.hpp"
 
 namespace Diligent
 {
@@ -56,6 +63,57 @@ namespace HLSL
 
 } // namespace HLSL
 
+namespace
+{
+
+// Must match InstancedDrawAttribs in InstancedModelStructures.fxh
+struct InstancedDrawAttribs
+{
+    float4x4 NodeMatrix;
+    float4   BaseColor;
+    float4   LightDirection;
+    float4   LightIntensity;
+
+    Uint32 FirstInstance       = 0;
+    Uint32 FirstJoint          = 0;
+    Uint32 ConvertOutputToSRGB = 0;
+    Uint32 Padding             = 0;
+};
+
+// Returns the transform that centers the model and scales it to fit into a unit cube
+float4x4 GetNormalizationTransform(const BoundBox& ModelAABB)
+{
+    float  MaxDim = 0;
+    float3 ModelDim{ModelAABB.Max - ModelAABB.Min};
+    MaxDim = std::max(MaxDim, ModelDim.x);
+    MaxDim = std::max(MaxDim, ModelDim.y);
+    MaxDim = std::max(MaxDim, ModelDim.z);
+
+    float    Scale     = (1.0f / std::max(MaxDim, 0.01f)) * 0.5f;
+    auto     Translate = -ModelAABB.Min - 0.5f * ModelDim;
+    float4x4 InvYAxis  = float4x4::Identity();
+    InvYAxis._22       = -1;
+
+    return float4x4::Translation(Translate) * float4x4::Scale(Scale) * InvYAxis;
+}
+
+// Places instances on a square grid in the XZ plane centered at Origin
+void AddGridInstances(Uint32 NumInstances, float Spacing, const float3& Origin, std::vector<float4x4>& InstanceTransforms)
+{
+    const auto GridSize = static_cast<Uint32>(std::ceil(std::sqrt(static_cast<float>(NumInstances))));
+    const auto Center   = static_cast<float>(GridSize - 1) * 0.5f;
+
+    InstanceTransforms.reserve(InstanceTransforms.size() + NumInstances);
+    for (Uint32 i = 0; i < NumInstances; ++i)
+    {
+        const auto Col = static_cast<float>(i % GridSize);
+        const auto Row = static_cast<float>(i / GridSize);
+        InstanceTransforms.emplace_back(float4x4::Translation(Origin + float3{Col - Center, 0, Row - Center} * Spacing));
+    }
+}
+
+} // namespace
+
 SampleBase* CreateSample()
 {
     return new GLTFViewer();
@@ -85,21 +143,72 @@ GLTFViewer::GLTFViewer()
 
 void GLTFViewer::LoadModel(const char* Path)
 {
-    if (m_Model)
+    if (m_CacheState.pPendingCache)
     {
-        m_PlayAnimation  = false;
-        m_AnimationIndex = 0;
-        m_AnimationTimers.clear();
+        // The compaction reloads the previous model and is superseded by the new one. Load the new model
+        // into the compacted cache so that it does not go back to the old one, but do not report the compaction.
+        RefCntAutoPtr<GLTF::ResourceManager> pCompactedCache = std::move(m_CacheState.pPendingCache);
+        LoadModel(Path, pCompactedCache);
+        return;
+    }
+
+    LoadModel(Path, m_pResourceMgr);
+}
+
+void GLTFViewer::LoadModel(const char* Path, GLTF::ResourceManager* pResourceMgr)
+{
+    if (m_Loader.Thread.joinable())
+    {
+        // Keep rendering the current model while the new one is being loaded.
+        // If another model is already queued, the new request replaces it.
+        {
+            std::lock_guard<std::mutex> Lock{m_Loader.Mtx};
+            m_Loader.RequestedPath        = Path;
+            m_Loader.RequestedResourceMgr = pResourceMgr;
+        }
+        m_Loader.CondVar.notify_one();
+        return;
     }
 
+    const auto StartTime = ModelLoader::ClockType::now();
+
     GLTF::ModelCreateInfo ModelCI;
     ModelCI.FileName             = Path;
-    ModelCI.pResourceManager     = m_bUseResourceCache ? m_pResourceMgr.RawPtr() : nullptr;
+    ModelCI.pResourceManager     = pResourceMgr;
     ModelCI.ComputeBoundingBoxes = m_bComputeBoundingBoxes;
 
-    m_Model.reset(new GLTF::Model{m_pDevice, m_pImmediateContext, ModelCI});
+    std::unique_ptr<GLTF::Model> pModel{new GLTF::Model{m_pDevice, m_pImmediateContext, ModelCI}};
+    const auto                   ParseEndTime = ModelLoader::ClockType::now();
+
+    m_ModelResourceBindings = m_GLTFRenderer->CreateResourceBindings(*pModel, m_FrameAttribsCB);
+    const auto EndTime      = ModelLoader::ClockType::now();
+
+    // Parsing and GPU upload are not separable in synchronous mode
+    m_Loader.ParseTime   = std::chrono::duration<double, std::milli>(ParseEndTime - StartTime).count();
+    m_Loader.UploadTime  = 0;
+    m_Loader.BindingTime = std::chrono::duration<double, std::milli>(EndTime - ParseEndTime).count();
+    m_Loader.TotalTime   = std::chrono::duration<double, std::milli>(EndTime - StartTime).count();
+
+    SetModel(std::move(pModel), Path, pResourceMgr);
+}
 
-    m_ModelResourceBindings = m_GLTFRenderer->CreateResourceBindings(*m_Model, m_FrameAttribsCB);
+void GLTFViewer::SetModel(std::unique_ptr<GLTF::Model>&& pModel, const std::string& Path, GLTF::ResourceManager* pResourceMgr)
+{
+    m_PlayAnimation  = false;
+    m_AnimationIndex = 0;
+    m_AnimationTimers.clear();
+
+    // Release the previous model first so that its allocations are returned to the cache
+    m_Model     = std::move(pModel);
+    m_ModelPath = Path;
+
+    if (pResourceMgr != m_pResourceMgr)
+    {
+        // The model was loaded into a new cache: release the old one and recreate cache bindings
+        m_pResourceMgr              = pResourceMgr;
+        m_CacheUseInfo.pResourceMgr = m_pResourceMgr;
+        m_CacheBindings             = {};
+    }
 
     m_RenderParams.SceneIndex = m_Model->DefaultSceneId;
     UpdateScene();
@@ -118,6 +227,159 @@ void GLTFViewer::LoadModel(const char* Path)
         if (node->pCamera != nullptr && node->pCamera->Type == GLTF::Camera::Projection::Perspective)
             m_CameraNodes.push_back(node);
     }
+
+    if (m_pResourceMgr && m_CacheState.pPendingCache == m_pResourceMgr)
+    {
+        // This is the model reloaded by the compaction
+        const auto CompactedSize    = GetResourceCacheCommittedSize();
+        m_CacheState.BytesReclaimed = m_CacheState.SizeBeforeCompaction > CompactedSize ? m_CacheState.SizeBeforeCompaction - CompactedSize : 0;
+        m_CacheState.pPendingCache.Release();
+        ++m_CacheState.NumCompactions;
+        LOG_INFO_MESSAGE("Compacted GLTF resource cache: ", m_CacheState.SizeBeforeCompaction >> 10, " KB -> ", CompactedSize >> 10, " KB");
+    }
+}
+
+void GLTFViewer::StartModelLoaderThread()
+{
+    VERIFY_EXPR(!m_Loader.Thread.joinable());
+    m_Loader.Quit   = false;
+    m_Loader.Thread = std::thread{&GLTFViewer::ModelLoaderThreadProc, this};
+}
+
+void GLTFViewer::StopModelLoaderThread()
+{
+    if (!m_Loader.Thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Loader.Mtx};
+        m_Loader.Quit = true;
+    }
+    m_Loader.CondVar.notify_one();
+    m_Loader.Thread.join();
+}
+
+void GLTFViewer::ModelLoaderThreadProc()
+{
+    MemoryProfiler::SetThreadName("Model loader");
+
+    while (true)
+    {
+        std::string Path;
+        {
+            std::unique_lock<std::mutex> Lock{m_Loader.Mtx};
+            // Only start a new load when the main thread has consumed the previous model
+            m_Loader.CondVar.wait(Lock, [this]() {
+                return m_Loader.Quit || (!m_Loader.RequestedPath.empty() && m_Loader.Phase.load() == LOAD_PHASE::Idle);
+            });
+            if (m_Loader.Quit)
+                break;
+
+            Path = std::move(m_Loader.RequestedPath);
+            m_Loader.RequestedPath.clear();
+            m_Loader.pModelCache        = std::move(m_Loader.RequestedResourceMgr);
+            m_Loader.LoadingResourceMgr = m_Loader.pModelCache;
+            m_Loader.LoadingPath        = Path;
+            m_Loader.StartTime          = ModelLoader::ClockType::now();
+            m_Loader.Phase.store(LOAD_PHASE::Parsing);
+        }
+
+        GLTF::ModelCreateInfo ModelCI;
+        ModelCI.FileName             = Path.c_str();
+        ModelCI.pResourceManager     = m_Loader.pModelCache;
+        ModelCI.ComputeBoundingBoxes = m_bComputeBoundingBoxes;
+
+        try
+        {
+            MemoryProfiler::Scope ProfilerScope{"Model parsing"};
+
+            // Passing null context makes the model skip GPU data initialization,
+            // which will be performed by the main thread in UpdateModelLoading().
+            m_Loader.pModel.reset(new GLTF::Model{m_pDevice, nullptr, ModelCI});
+            m_Loader.ParseTime = std::chrono::duration<double, std::milli>(ModelLoader::ClockType::now() - m_Loader.StartTime).count();
+            m_Loader.Phase.store(LOAD_PHASE::Parsed, std::memory_order_release);
+        }
+        catch (...)
+        {
+            LOG_ERROR_MESSAGE("Failed to load model '", Path, "'");
+            m_Loader.pModel.reset();
+            m_Loader.pModelCache.Release();
+
+            std::lock_guard<std::mutex> Lock{m_Loader.Mtx};
+            m_Loader.LoadingPath.clear();
+            m_Loader.LoadingResourceMgr = nullptr;
+            m_Loader.Phase.store(LOAD_PHASE::Idle, std::memory_order_release);
+        }
+    }
+}
+
+bool GLTFViewer::IsModelLoadPending(const GLTF::ResourceManager* pResourceMgr)
+{
+    std::lock_guard<std::mutex> Lock{m_Loader.Mtx};
+    if (pResourceMgr == nullptr)
+    {
+        // The main thread only sees the binding phase while it sets the loaded model
+        const auto Phase = m_Loader.Phase.load();
+        return !m_Loader.RequestedPath.empty() || (Phase != LOAD_PHASE::Idle && Phase != LOAD_PHASE::Binding);
+    }
+
+    return (!m_Loader.RequestedPath.empty() && m_Loader.RequestedResourceMgr == pResourceMgr) || m_Loader.LoadingResourceMgr == pResourceMgr;
+}
+
+void GLTFViewer::UpdateModelLoading()
+{
+    // The compaction load request is dropped if the model failed to load
+    if (m_CacheState.pPendingCache && m_Loader.Thread.joinable() && !IsModelLoadPending(m_CacheState.pPendingCache))
+    {
+        LOG_WARNING_MESSAGE("GLTF resource cache compaction failed: the model was not reloaded");
+        m_CacheState.pPendingCache.Release();
+    }
+
+    // Perform at most one main-thread load phase per frame to avoid long frame stalls
+    switch (m_Loader.Phase.load(std::memory_order_acquire))
+    {
+        case LOAD_PHASE::Parsed:
+        {
+            m_Loader.Phase.store(LOAD_PHASE::Uploading);
+
+            MemoryProfiler::Scope ProfilerScope{"Model upload"};
+
+            const auto StartTime = ModelLoader::ClockType::now();
+            m_Loader.pModel->PrepareGPUResources(m_pDevice, m_pImmediateContext);
+            m_Loader.UploadTime = std::chrono::duration<double, std::milli>(ModelLoader::ClockType::now() - StartTime).count();
+
+            m_Loader.Phase.store(LOAD_PHASE::Binding);
+            break;
+        }
+
+        case LOAD_PHASE::Binding:
+        {
+            const auto StartTime    = ModelLoader::ClockType::now();
+            m_ModelResourceBindings = m_GLTFRenderer->CreateResourceBindings(*m_Loader.pModel, m_FrameAttribsCB);
+            const auto EndTime      = ModelLoader::ClockType::now();
+
+            m_Loader.BindingTime = std::chrono::duration<double, std::milli>(EndTime - StartTime).count();
+            m_Loader.TotalTime   = std::chrono::duration<double, std::milli>(EndTime - m_Loader.StartTime).count();
+            LOG_INFO_MESSAGE("Loaded model '", m_Loader.LoadingPath, "' in ", std::fixed, std::setprecision(1), m_Loader.TotalTime,
+                             " ms (parse: ", m_Loader.ParseTime, " ms, upload: ", m_Loader.UploadTime, " ms, bindings: ", m_Loader.BindingTime, " ms)");
+
+            SetModel(std::move(m_Loader.pModel), m_Loader.LoadingPath, m_Loader.pModelCache);
+            m_Loader.pModelCache.Release();
+
+            {
+                std::lock_guard<std::mutex> Lock{m_Loader.Mtx};
+                m_Loader.LoadingPath.clear();
+                m_Loader.LoadingResourceMgr = nullptr;
+                m_Loader.Phase.store(LOAD_PHASE::Idle);
+            }
+            // Wake up the loader thread if another model has been requested in the meantime
+            m_Loader.CondVar.notify_one();
+            break;
+        }
+
+        default:
+            break;
+    }
 }
 
 void GLTFViewer::UpdateScene()
@@ -126,20 +388,368 @@ void GLTFViewer::UpdateScene()
     m_ModelAABB = m_Model->ComputeBoundingBox(m_RenderParams.SceneIndex, m_Transforms);
 
     // Center and scale model
-    float  MaxDim = 0;
-    float3 ModelDim{m_ModelAABB.Max - m_ModelAABB.Min};
-    MaxDim = std::max(MaxDim, ModelDim.x);
-    MaxDim = std::max(MaxDim, ModelDim.y);
-    MaxDim = std::max(MaxDim, ModelDim.z);
-
-    float    Scale     = (1.0f / std::max(MaxDim, 0.01f)) * 0.5f;
-    auto     Translate = -m_ModelAABB.Min - 0.5f * ModelDim;
-    float4x4 InvYAxis  = float4x4::Identity();
-    InvYAxis._22       = -1;
-
-    m_ModelTransform = float4x4::Translation(Translate) * float4x4::Scale(Scale) * InvYAxis;
+    m_ModelTransform = GetNormalizationTransform(m_ModelAABB);
     m_Model->ComputeTransforms(m_RenderParams.SceneIndex, m_Transforms, m_ModelTransform);
     m_ModelAABB = m_Model->ComputeBoundingBox(m_RenderParams.SceneIndex, m_Transforms);
+
+    if (m_TransformEvaluator)
+        m_TransformEvaluator->Reset(*m_Model, m_RenderParams.SceneIndex);
+}
+
+void GLTFViewer::UpdateInstances()
+{
+    m_Instances.NumInstances = std::max(m_Instances.NumInstances, 1);
+    m_Instances.GridTransforms.clear();
+    AddGridInstances(static_cast<Uint32>(m_Instances.NumInstances), m_Instances.Spacing, float3{}, m_Instances.GridTransforms);
+}
+
+bool GLTFViewer::LoadSceneLayout(const char* Path)
+{
+    auto pData = DataBlobImpl::Create();
+    {
+        FileWrapper File{Path};
+        if (!File || !File->Read(pData))
+        {
+            LOG_ERROR_MESSAGE("Failed to read scene layout file ", Path);
+            return false;
+        }
+    }
+
+    std::vector<InstancedModel> LayoutModels;
+    try
+    {
+        const auto* pChars = static_cast<const char*>(pData->GetConstDataPtr());
+        const auto  Layout = nlohmann::json::parse(pChars, pChars + pData->GetSize());
+
+        auto ReadFloat3 = [](const nlohmann::json& Json, const char* Name) {
+            float3 Value;
+            if (Json.contains(Name))
+            {
+                const auto& Array = Json.at(Name);
+                for (size_t i = 0; i < 3 && i < Array.size(); ++i)
+                    Value[i] = Array[i].get<float>();
+            }
+            return Value;
+        };
+
+        for (const auto& ModelJson : Layout.at("Models"))
+        {
+            const auto ModelPath = ModelJson.at("Path").get<std::string>();
+
+            InstancedModel Model;
+            if (ModelJson.contains("Grid"))
+            {
+                const auto& Grid = ModelJson.at("Grid");
+                AddGridInstances(Grid.value("Count", 1u), Grid.value("Spacing", 1.f), ReadFloat3(Grid, "Origin"), Model.InstanceTransforms);
+            }
+            if (ModelJson.contains("Instances"))
+            {
+                for (const auto& InstanceJson : ModelJson.at("Instances"))
+                {
+                    Model.InstanceTransforms.emplace_back(
+                        float4x4::Scale(InstanceJson.value("Scale", 1.f)) *
+                        float4x4::RotationY(InstanceJson.value("RotationY", 0.f) * PI_F / 180.f) *
+                        float4x4::Translation(ReadFloat3(InstanceJson, "Position")));
+                }
+            }
+            if (Model.InstanceTransforms.empty())
+            {
+                LOG_WARNING_MESSAGE("Scene layout model '", ModelPath, "' has no instances");
+                continue;
+            }
+
+            try
+            {
+                GLTF::ModelCreateInfo ModelCI;
+                ModelCI.FileName = ModelPath.c_str();
+                Model.pModel.reset(new GLTF::Model{m_pDevice, m_pImmediateContext, ModelCI});
+            }
+            catch (...)
+            {
+                LOG_ERROR_MESSAGE("Failed to load scene layout model '", ModelPath, "'");
+                continue;
+            }
+
+            const auto SceneIndex = static_cast<Uint32>(Model.pModel->DefaultSceneId);
+            Model.pModel->ComputeTransforms(SceneIndex, Model.Transforms);
+            Model.RootTransform = GetNormalizationTransform(Model.pModel->ComputeBoundingBox(SceneIndex, Model.Transforms));
+            Model.pModel->ComputeTransforms(SceneIndex, Model.Transforms, Model.RootTransform);
+            Model.AABB = Model.pModel->ComputeBoundingBox(SceneIndex, Model.Transforms);
+
+            Model.Bindings = m_GLTFRenderer->CreateResourceBindings(*Model.pModel, m_FrameAttribsCB);
+
+            LayoutModels.emplace_back(std::move(Model));
+        }
+    }
+    catch (const nlohmann::json::exception& Err)
+    {
+        LOG_ERROR_MESSAGE("Failed to parse scene layout file ", Path, ": ", Err.what());
+        return false;
+    }
+
+    if (LayoutModels.empty())
+    {
+        LOG_ERROR_MESSAGE("Scene layout file ", Path, " does not contain any models");
+        return false;
+    }
+
+    m_Instances.LayoutModels = std::move(LayoutModels);
+    m_Instances.LayoutPath   = Path;
+    return true;
+}
+
+void GLTFViewer::UpdateSceneLayout(float ElapsedTime)
+{
+    for (auto& Model : m_Instances.LayoutModels)
+    {
+        if (Model.pModel->Animations.empty())
+            continue;
+
+        const auto SceneIndex = static_cast<Uint32>(Model.pModel->DefaultSceneId);
+
+        Model.AnimationTime = std::fmod(Model.AnimationTime + ElapsedTime, Model.pModel->Animations[0].End);
+        Model.pModel->ComputeTransforms(SceneIndex, Model.Transforms, Model.RootTransform, 0, Model.AnimationTime);
+        // Cull instances against the bounds of the current pose
+        Model.AABB = Model.pModel->ComputeBoundingBox(SceneIndex, Model.Transforms);
+    }
+}
+
+void GLTFViewer::RenderModel(const float4x4& CameraViewProj)
+{
+    if (m_Instances.UseLayout || m_Instances.NumInstances > 1)
+    {
+        RenderInstances(CameraViewProj);
+        return;
+    }
+
+    if (m_pResourceMgr)
+    {
+        m_GLTFRenderer->Begin(m_pDevice, m_pImmediateContext, m_CacheUseInfo, m_CacheBindings, m_FrameAttribsCB);
+        m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_Transforms, m_RenderParams, nullptr, &m_CacheBindings);
+    }
+    else
+    {
+        m_GLTFRenderer->Begin(m_pImmediateContext);
+        m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_Transforms, m_RenderParams, &m_ModelResourceBindings);
+    }
+}
+
+void GLTFViewer::RenderInstances(const float4x4& CameraViewProj)
+{
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    ViewFrustumExt Frustum;
+    ExtractViewFrustumPlanesFromMatrix(CameraViewProj, Frustum, m_pDevice->GetDeviceInfo().IsGLDevice());
+
+    m_Instances.Batches.clear();
+    m_Instances.VisibleTransforms.clear();
+    m_Instances.JointTransforms.clear();
+    m_Instances.SkinJointOffsets.clear();
+
+    auto AddBatch = [&](const GLTF::Model&                        Model,
+                        const GLTF::ModelTransforms&              Transforms,
+                        GLTF_PBR_Renderer::ModelResourceBindings* pBindings,
+                        Uint32                                    SceneIndex,
+                        const BoundBox&                           AABB,
+                        const std::vector<float4x4>&              InstanceTransforms) {
+        InstanceBatch Batch;
+        Batch.pModel        = &Model;
+        Batch.pTransforms   = &Transforms;
+        Batch.pBindings     = pBindings;
+        Batch.SceneIndex    = SceneIndex;
+        Batch.FirstInstance = static_cast<Uint32>(m_Instances.VisibleTransforms.size());
+
+        for (const auto& InstanceTransform : InstanceTransforms)
+        {
+            // Rotate every instance around its own center
+            const auto WorldTransform = m_RenderParams.ModelTransform * InstanceTransform;
+            if (m_Instances.Culling && GetBoxVisibility(Frustum, AABB.Transform(WorldTransform), FRUSTUM_PLANE_FLAG_FULL_FRUSTUM) == BoxVisibility::Invisible)
+                continue;
+
+            m_Instances.VisibleTransforms.push_back(WorldTransform);
+        }
+        Batch.NumInstances = static_cast<Uint32>(m_Instances.VisibleTransforms.size()) - Batch.FirstInstance;
+        if (Batch.NumInstances == 0)
+            return;
+
+        // All instances of the model share the same animation pose
+        Batch.FirstSkin = static_cast<Uint32>(m_Instances.SkinJointOffsets.size());
+        if (m_Instances.FlatInstancing)
+        {
+            for (const auto& Skin : Transforms.Skins)
+            {
+                m_Instances.SkinJointOffsets.push_back(static_cast<Uint32>(m_Instances.JointTransforms.size()));
+                m_Instances.JointTransforms.insert(m_Instances.JointTransforms.end(), Skin.JointMatrices.begin(), Skin.JointMatrices.end());
+            }
+        }
+
+        m_Instances.Batches.push_back(Batch);
+    };
+
+    if (m_Instances.UseLayout)
+    {
+        for (auto& Model : m_Instances.LayoutModels)
+            AddBatch(*Model.pModel, Model.Transforms, &Model.Bindings, static_cast<Uint32>(Model.pModel->DefaultSceneId), Model.AABB, Model.InstanceTransforms);
+    }
+    else
+    {
+        AddBatch(*m_Model, m_Transforms, m_pResourceMgr ? nullptr : &m_ModelResourceBindings, static_cast<Uint32>(m_RenderParams.SceneIndex), m_ModelAABB, m_Instances.GridTransforms);
+    }
+
+    m_Instances.NumVisible = static_cast<Uint32>(m_Instances.VisibleTransforms.size());
+    m_Instances.NumDraws   = 0;
+
+    if (!m_Instances.Batches.empty())
+    {
+        if (m_Instances.FlatInstancing)
+            RenderFlatInstances();
+        else
+            RenderPBRInstances();
+    }
+
+    m_Instances.CPUTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+void GLTFViewer::RenderPBRInstances()
+{
+    // Layout models are not loaded into the resource cache and do not use the texture atlas
+    auto RenderParams = m_RenderParams;
+    if (m_Instances.UseLayout)
+        RenderParams.Flags &= ~GLTF_PBR_Renderer::PSO_FLAG_USE_TEXTURE_ATLAS;
+
+    if (m_pResourceMgr && !m_Instances.UseLayout)
+        m_GLTFRenderer->Begin(m_pDevice, m_pImmediateContext, m_CacheUseInfo, m_CacheBindings, m_FrameAttribsCB);
+    else
+        m_GLTFRenderer->Begin(m_pImmediateContext);
+
+    for (const auto& Batch : m_Instances.Batches)
+    {
+        // GLTF_PBR_Renderer issues one draw call for every primitive whose alpha mode is enabled
+        Uint32 NumPrimitives = 0;
+        for (const auto* pNode : Batch.pModel->Scenes[Batch.SceneIndex].LinearNodes)
+        {
+            if (pNode->pMesh == nullptr)
+                continue;
+            for (const auto& Primitive : pNode->pMesh->Primitives)
+            {
+                const auto AlphaModeFlag = 1u << static_cast<Uint32>(Batch.pModel->Materials[Primitive.MaterialId].Attribs.AlphaMode);
+                if ((static_cast<Uint32>(RenderParams.AlphaModes) & AlphaModeFlag) != 0)
+                    ++NumPrimitives;
+            }
+        }
+
+        for (Uint32 i = 0; i < Batch.NumInstances; ++i)
+        {
+            RenderParams.ModelTransform = m_Instances.VisibleTransforms[Batch.FirstInstance + i];
+            if (Batch.pBindings != nullptr)
+                m_GLTFRenderer->Render(m_pImmediateContext, *Batch.pModel, *Batch.pTransforms, RenderParams, Batch.pBindings);
+            else
+                m_GLTFRenderer->Render(m_pImmediateContext, *Batch.pModel, *Batch.pTransforms, RenderParams, nullptr, &m_CacheBindings);
+            m_Instances.NumDraws += NumPrimitives;
+        }
+    }
+}
+
+void GLTFViewer::RenderFlatInstances()
+{
+    // Structured buffers grow on demand and are rebound to all SRBs when recreated
+    auto UploadTransforms = [&](RefCntAutoPtr<IBuffer>& pBuffer, const char* Name, const char* VarName, const std::vector<float4x4>& Transforms) {
+        const auto DataSize = static_cast<Uint64>(Transforms.size() * sizeof(float4x4));
+        if (!pBuffer || pBuffer->GetDesc().Size < DataSize)
+        {
+            BufferDesc BuffDesc;
+            BuffDesc.Name              = Name;
+            BuffDesc.Usage             = USAGE_DYNAMIC;
+            BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+            BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+            BuffDesc.CPUAccessFlags    = CPU_ACCESS_WRITE;
+            BuffDesc.ElementByteStride = sizeof(float4x4);
+            BuffDesc.Size              = std::max(DataSize, pBuffer ? pBuffer->GetDesc().Size * 2 : Uint64{sizeof(float4x4) * 256});
+
+            pBuffer.Release();
+            m_pDevice->CreateBuffer(BuffDesc, nullptr, &pBuffer);
+            for (auto& pSRB : m_Instances.SRBs)
+            {
+                if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, VarName))
+                    pVar->Set(pBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+            }
+        }
+        if (!Transforms.empty())
+        {
+            // Shaders expect transposed matrices
+            MapHelper<float4x4> Data{m_pImmediateContext, pBuffer, MAP_WRITE, MAP_FLAG_DISCARD};
+            for (size_t i = 0; i < Transforms.size(); ++i)
+                Data[i] = Transforms[i].Transpose();
+        }
+    };
+    UploadTransforms(m_Instances.pInstanceBuffer, "Instance transforms", "g_InstanceTransforms", m_Instances.VisibleTransforms);
+    UploadTransforms(m_Instances.pJointBuffer, "Joint transforms", "g_JointTransforms", m_Instances.JointTransforms);
+
+    const auto LightIntensity = m_LightColor * m_LightIntensity;
+    const auto ConvertToSRGB  = (m_RenderParams.Flags & GLTF_PBR_Renderer::PSO_FLAG_CONVERT_OUTPUT_TO_SRGB) != 0;
+
+    int CurrPSOIdx = -1;
+    for (const auto& Batch : m_Instances.Batches)
+    {
+        const auto& Model      = *Batch.pModel;
+        const auto& Transforms = *Batch.pTransforms;
+
+        IBuffer* pVBs[] = {Model.GetVertexBuffer(0), nullptr};
+        m_pImmediateContext->SetIndexBuffer(Model.GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        const auto FirstIndexLocation = Model.GetFirstIndexLocation();
+        const auto BaseVertex         = Model.GetBaseVertex();
+
+        for (const auto* pNode : Model.Scenes[Batch.SceneIndex].LinearNodes)
+        {
+            if (pNode->pMesh == nullptr || pNode->pMesh->Primitives.empty())
+                continue;
+
+            const bool IsSkinned = pNode->pSkin != nullptr && pNode->SkinTransformsIndex >= 0 &&
+                static_cast<size_t>(pNode->SkinTransformsIndex) < Transforms.Skins.size();
+
+            const int PSOIdx = IsSkinned ? 1 : 0;
+            if (PSOIdx != CurrPSOIdx)
+            {
+                m_pImmediateContext->SetPipelineState(m_Instances.PSOs[PSOIdx]);
+                m_pImmediateContext->CommitShaderResources(m_Instances.SRBs[PSOIdx], RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                CurrPSOIdx = PSOIdx;
+            }
+            // Skinned primitives also read joints and weights from the second vertex buffer
+            if (IsSkinned && pVBs[1] == nullptr)
+                pVBs[1] = Model.GetVertexBuffer(1);
+            m_pImmediateContext->SetVertexBuffers(0, IsSkinned ? 2 : 1, pVBs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+
+            for (const auto& Primitive : pNode->pMesh->Primitives)
+            {
+                {
+                    MapHelper<InstancedDrawAttribs> Attribs{m_pImmediateContext, m_Instances.pDrawAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+                    Attribs->NodeMatrix          = Transforms.NodeGlobalMatrices[pNode->Index].Transpose();
+                    Attribs->BaseColor           = Model.Materials[Primitive.MaterialId].Attribs.BaseColorFactor;
+                    Attribs->LightDirection      = float4{m_LightDirection, 0};
+                    Attribs->LightIntensity      = LightIntensity;
+                    Attribs->FirstInstance       = Batch.FirstInstance;
+                    Attribs->FirstJoint          = IsSkinned ? m_Instances.SkinJointOffsets[Batch.FirstSkin + pNode->SkinTransformsIndex] : 0;
+                    Attribs->ConvertOutputToSRGB = ConvertToSRGB ? 1 : 0;
+                }
+
+                if (Primitive.IndexCount > 0)
+                {
+                    DrawIndexedAttribs DrawAttrs{Primitive.IndexCount, VT_UINT32, DRAW_FLAG_VERIFY_ALL, Batch.NumInstances};
+                    DrawAttrs.FirstIndexLocation = FirstIndexLocation + Primitive.FirstIndex;
+                    DrawAttrs.BaseVertex         = BaseVertex;
+                    m_pImmediateContext->DrawIndexed(DrawAttrs);
+                }
+                else
+                {
+                    DrawAttribs DrawAttrs{Primitive.VertexCount, DRAW_FLAG_VERIFY_ALL, Batch.NumInstances};
+                    DrawAttrs.StartVertexLocation = BaseVertex;
+                    m_pImmediateContext->Draw(DrawAttrs);
+                }
+                ++m_Instances.NumDraws;
+            }
+        }
+    }
 }
 
 GLTFViewer::CommandLineStatus GLTFViewer::ProcessCommandLine(int argc, const char* const* argv)
@@ -148,58 +758,77 @@ GLTFViewer::CommandLineStatus GLTFViewer::ProcessCommandLine(int argc, const cha
     ArgsParser.Parse("use_cache", m_bUseResourceCache);
     ArgsParser.Parse("model", m_InitialModelPath);
     ArgsParser.Parse("compute_bounds", m_bComputeBoundingBoxes);
+    ArgsParser.Parse("async_load", m_bAsyncModelLoading);
+    ArgsParser.Parse("parallel_transforms", m_bParallelTransforms);
+    ArgsParser.Parse("instances", m_Instances.NumInstances);
+    ArgsParser.Parse("instance_spacing", m_Instances.Spacing);
+    if (ArgsParser.Parse("scene", m_Instances.LayoutPath))
+        m_Instances.UseLayout = true;
+    ArgsParser.Parse("flat_instancing", m_Instances.FlatInstancing);
 
     return CommandLineStatus::OK;
 }
 
-void GLTFViewer::CreateGLTFResourceCache()
+RefCntAutoPtr<GLTF::ResourceManager> GLTFViewer::CreateGLTFResourceCache(const ResourceCacheSize& Size) const
 {
-    auto InputLayout = GLTF::VertexAttributesToInputLayout(GLTF::DefaultVertexAttributes.data(), static_cast<Uint32>(GLTF::DefaultVertexAttributes.size()));
-    auto Strides     = InputLayout.ResolveAutoOffsetsAndStrides();
-
     std::vector<VertexPoolElementDesc> VtxPoolElems;
-    VtxPoolElems.reserve(Strides.size());
-    m_CacheUseInfo.VtxLayoutKey.Elements.reserve(Strides.size());
-    for (const auto& Stride : Strides)
-    {
-        VtxPoolElems.emplace_back(Stride, BIND_VERTEX_BUFFER);
-        m_CacheUseInfo.VtxLayoutKey.Elements.emplace_back(Stride, BIND_VERTEX_BUFFER);
-    }
+    VtxPoolElems.reserve(m_CacheUseInfo.VtxLayoutKey.Elements.size());
+    for (const auto& Elem : m_CacheUseInfo.VtxLayoutKey.Elements)
+        VtxPoolElems.emplace_back(Elem.Size, Elem.BindFlags);
 
+    // All pools start with the requested size and grow on demand
     VertexPoolCreateInfo VtxPoolCI;
     VtxPoolCI.Desc.Name        = "GLTF vertex pool";
-    VtxPoolCI.Desc.VertexCount = 32768;
+    VtxPoolCI.Desc.VertexCount = Size.VertexCount;
     VtxPoolCI.Desc.pElements   = VtxPoolElems.data();
     VtxPoolCI.Desc.NumElements = static_cast<Uint32>(VtxPoolElems.size());
+    VtxPoolCI.ExtraVertexCount = std::max(Size.VertexCount / 2, 8192u);
 
     std::array<DynamicTextureAtlasCreateInfo, 1> Atlases;
-    Atlases[0].Desc.Name      = "GLTF texture atlas";
-    Atlases[0].Desc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
-    Atlases[0].Desc.Usage     = USAGE_DEFAULT;
-    Atlases[0].Desc.BindFlags = BIND_SHADER_RESOURCE;
-    Atlases[0].Desc.Format    = TEX_FORMAT_RGBA8_UNORM;
-    Atlases[0].Desc.Width     = 4096;
-    Atlases[0].Desc.Height    = 4096;
-    Atlases[0].Desc.MipLevels = 6;
+    Atlases[0].Desc.Name       = "GLTF texture atlas";
+    Atlases[0].Desc.Type       = RESOURCE_DIM_TEX_2D_ARRAY;
+    Atlases[0].Desc.Usage      = USAGE_DEFAULT;
+    Atlases[0].Desc.BindFlags  = BIND_SHADER_RESOURCE;
+    Atlases[0].Desc.Format     = TEX_FORMAT_RGBA8_UNORM;
+    Atlases[0].Desc.Width      = 4096;
+    Atlases[0].Desc.Height     = 4096;
+    Atlases[0].Desc.MipLevels  = 6;
+    Atlases[0].Desc.ArraySize  = Size.AtlasSlices;
+    Atlases[0].ExtraSliceCount = 1;
 
     GLTF::ResourceManager::CreateInfo ResourceMgrCI;
 
     ResourceMgrCI.IndexAllocatorCI.Desc.Name      = "GLTF index buffer";
     ResourceMgrCI.IndexAllocatorCI.Desc.BindFlags = BIND_INDEX_BUFFER;
     ResourceMgrCI.IndexAllocatorCI.Desc.Usage     = USAGE_DEFAULT;
-    ResourceMgrCI.IndexAllocatorCI.Desc.Size      = sizeof(Uint32) * 8 << 10;
+    ResourceMgrCI.IndexAllocatorCI.Desc.Size      = Uint64{sizeof(Uint32)} * Size.IndexCount;
+    ResourceMgrCI.IndexAllocatorCI.ExpansionSize  = static_cast<Uint32>(std::max(ResourceMgrCI.IndexAllocatorCI.Desc.Size / 2, Uint64{sizeof(Uint32) * 16384}));
 
     ResourceMgrCI.NumVertexPools = 1;
     ResourceMgrCI.pVertexPoolCIs = &VtxPoolCI;
 
-    ResourceMgrCI.DefaultAtlasDesc.Desc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
-    ResourceMgrCI.DefaultAtlasDesc.Desc.Usage     = USAGE_DEFAULT;
-    ResourceMgrCI.DefaultAtlasDesc.Desc.BindFlags = BIND_SHADER_RESOURCE;
-    ResourceMgrCI.DefaultAtlasDesc.Desc.Width     = 4096;
-    ResourceMgrCI.DefaultAtlasDesc.Desc.Height    = 4096;
-    ResourceMgrCI.DefaultAtlasDesc.Desc.MipLevels = 6;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.Type       = RESOURCE_DIM_TEX_2D_ARRAY;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.Usage      = USAGE_DEFAULT;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.BindFlags  = BIND_SHADER_RESOURCE;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.Width      = 4096;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.Height     = 4096;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.MipLevels  = 6;
+    ResourceMgrCI.DefaultAtlasDesc.Desc.ArraySize  = Size.AtlasSlices;
+    ResourceMgrCI.DefaultAtlasDesc.ExtraSliceCount = 1;
 
-    m_pResourceMgr = GLTF::ResourceManager::Create(m_pDevice, ResourceMgrCI);
+    return GLTF::ResourceManager::Create(m_pDevice, ResourceMgrCI);
+}
+
+void GLTFViewer::InitGLTFResourceCache()
+{
+    auto InputLayout = GLTF::VertexAttributesToInputLayout(GLTF::DefaultVertexAttributes.data(), static_cast<Uint32>(GLTF::DefaultVertexAttributes.size()));
+    auto Strides     = InputLayout.ResolveAutoOffsetsAndStrides();
+
+    m_CacheUseInfo.VtxLayoutKey.Elements.reserve(Strides.size());
+    for (const auto& Stride : Strides)
+        m_CacheUseInfo.VtxLayoutKey.Elements.emplace_back(Stride, BIND_VERTEX_BUFFER);
+
+    m_pResourceMgr = CreateGLTFResourceCache(ResourceCacheSize{});
 
     m_CacheUseInfo.pResourceMgr = m_pResourceMgr;
 
@@ -210,6 +839,86 @@ void GLTFViewer::CreateGLTFResourceCache()
     m_CacheUseInfo.EmissiveFormat     = TEX_FORMAT_RGBA8_UNORM;
 }
 
+Uint64 GLTFViewer::GetResourceCacheCommittedSize() const
+{
+    if (!m_pResourceMgr)
+        return 0;
+
+    const auto IdxStats   = m_pResourceMgr->GetIndexBufferUsageStats();
+    const auto VtxStats   = m_pResourceMgr->GetVertexPoolUsageStats(m_CacheUseInfo.VtxLayoutKey);
+    const auto AtlasStats = m_pResourceMgr->GetAtlasUsageStats(TEX_FORMAT_RGBA8_UNORM);
+    return IdxStats.CommittedSize + VtxStats.CommittedMemorySize + AtlasStats.Size;
+}
+
+void GLTFViewer::CompactGLTFResourceCache()
+{
+    if (!m_pResourceMgr || m_CacheState.pPendingCache || m_ModelPath.empty())
+        return;
+
+    // Do not replace a model load request with the compaction
+    if (m_Loader.Thread.joinable() && IsModelLoadPending(nullptr))
+        return;
+
+    // Size the new cache to fit the data that is currently in use
+    const auto IdxStats   = m_pResourceMgr->GetIndexBufferUsageStats();
+    const auto VtxStats   = m_pResourceMgr->GetVertexPoolUsageStats(m_CacheUseInfo.VtxLayoutKey);
+    const auto AtlasStats = m_pResourceMgr->GetAtlasUsageStats(TEX_FORMAT_RGBA8_UNORM);
+
+    ResourceCacheSize Size;
+    Size.VertexCount = std::max(Size.VertexCount, VtxStats.AllocatedVertexCount);
+    Size.IndexCount  = std::max(Size.IndexCount, static_cast<Uint32>(IdxStats.UsedSize / sizeof(Uint32)));
+    Size.AtlasSlices = std::max(Size.AtlasSlices, static_cast<Uint32>((AtlasStats.AllocatedArea + (4096ull * 4096ull - 1)) / (4096ull * 4096ull)));
+
+    m_CacheState.SizeBeforeCompaction = GetResourceCacheCommittedSize();
+    m_CacheState.pPendingCache        = CreateGLTFResourceCache(Size);
+
+    // The current model keeps rendering from the old cache until it is reloaded into the new one
+    try
+    {
+        RefCntAutoPtr<GLTF::ResourceManager> pNewCache = m_CacheState.pPendingCache;
+        LoadModel(m_ModelPath.c_str(), pNewCache);
+    }
+    catch (...)
+    {
+        LOG_ERROR_MESSAGE("GLTF resource cache compaction failed: failed to reload model '", m_ModelPath, "'");
+        m_CacheState.pPendingCache.Release();
+    }
+}
+
+void GLTFViewer::UpdateResourceCacheUI()
+{
+    if (!m_pResourceMgr)
+        return;
+
+    if (ImGui::TreeNode("Resource cache"))
+    {
+        const auto IdxStats   = m_pResourceMgr->GetIndexBufferUsageStats();
+        const auto VtxStats   = m_pResourceMgr->GetVertexPoolUsageStats(m_CacheUseInfo.VtxLayoutKey);
+        const auto AtlasStats = m_pResourceMgr->GetAtlasUsageStats(TEX_FORMAT_RGBA8_UNORM);
+
+        auto Occupancy = [](Uint64 Used, Uint64 Total) {
+            return Total > 0 ? static_cast<float>(static_cast<double>(Used) / static_cast<double>(Total)) : 0.f;
+        };
+
+        ImGui::Text("Vertex pool:   %u / %u vertices (%.1f MB)", VtxStats.AllocatedVertexCount, VtxStats.TotalVertexCount, static_cast<double>(VtxStats.CommittedMemorySize) / (1 << 20));
+        ImGui::ProgressBar(Occupancy(VtxStats.AllocatedVertexCount, VtxStats.TotalVertexCount));
+        ImGui::Text("Index buffer:  %.1f / %.1f MB", static_cast<double>(IdxStats.UsedSize) / (1 << 20), static_cast<double>(IdxStats.CommittedSize) / (1 << 20));
+        ImGui::ProgressBar(Occupancy(IdxStats.UsedSize, IdxStats.CommittedSize));
+        ImGui::Text("Texture atlas: %.1f MB, %u allocations", static_cast<double>(AtlasStats.Size) / (1 << 20), AtlasStats.AllocationCount);
+        ImGui::ProgressBar(Occupancy(AtlasStats.AllocatedArea, AtlasStats.TotalArea));
+        // Atlas fragmentation is the allocated area not covered by texture data
+        ImGui::Text("Atlas fragmentation: %.1f%%", 100.0 * (1.0 - Occupancy(AtlasStats.UsedArea, AtlasStats.AllocatedArea)));
+
+        ImGui::Text("Compactions: %u, last reclaimed %.1f MB", m_CacheState.NumCompactions, static_cast<double>(m_CacheState.BytesReclaimed) / (1 << 20));
+        if (ImGui::Button("Compact (full model reload)"))
+            CompactGLTFResourceCache();
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Creates a new cache sized to the current model and reloads the model from disk into it");
+
+        ImGui::TreePop();
+    }
+}
+
 void GLTFViewer::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
@@ -260,7 +969,13 @@ void GLTFViewer::Initialize(const SampleInitInfo& InitInfo)
     {
         RefCntAutoPtr<IShaderSourceInputStreamFactory> pStreamFactory;
         m_pEngineFactory->CreateDefaultShaderSourceStreamFactory("shaders", &pStreamFactory);
-        CreateRenderStateNotationLoader({m_pDevice, pRSNParser, pStreamFactory}, &pRSNLoader);
+
+        RenderStateNotationLoaderCreateInfo LoaderCI;
+        LoaderCI.pDevice        = m_pDevice;
+        LoaderCI.pParser        = pRSNParser;
+        LoaderCI.pStreamFactory = pStreamFactory;
+        LoaderCI.pStateCache    = m_pStateCache;
+        CreateRenderStateNotationLoader(LoaderCI, &pRSNLoader);
     }
 
 
@@ -276,13 +991,26 @@ void GLTFViewer::Initialize(const SampleInitInfo& InitInfo)
     }
 
     CreateBoundBoxPSO(pRSNLoader);
+    CreateInstancedModelPSOs(pRSNLoader);
 
     m_LightDirection = normalize(float3(0.5f, 0.6f, -0.2f));
 
     if (m_bUseResourceCache)
-        CreateGLTFResourceCache();
+        InitGLTFResourceCache();
 
+    UpdateInstances();
+    if (m_Instances.UseLayout)
+        m_Instances.UseLayout = LoadSceneLayout(m_Instances.LayoutPath.c_str());
+
+    m_TransformEvaluator = std::make_unique<GLTFTransformEvaluator>(std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+
+    // The initial model is loaded synchronously so that the very first frame
+    // (e.g. in golden image mode) always contains the model.
     LoadModel(!m_InitialModelPath.empty() ? m_InitialModelPath.c_str() : GLTFModels[m_SelectedModel].second);
+
+    // OpenGL resources can only be created in the thread that owns the GL context
+    if (m_bAsyncModelLoading && !m_pDevice->GetDeviceInfo().IsGLDevice())
+        StartModelLoaderThread();
 }
 
 void GLTFViewer::UpdateUI()
@@ -312,6 +1040,26 @@ void GLTFViewer::UpdateUI()
             }
         }
 #endif
+        {
+            const auto Phase = m_Loader.Phase.load();
+            if (Phase != LOAD_PHASE::Idle)
+            {
+                static constexpr const char* PhaseNames[] = {"Idle", "Parsing", "Uploading", "Uploading", "Creating bindings"};
+                static_assert(_countof(PhaseNames) == static_cast<size_t>(LOAD_PHASE::Count), "Please update PhaseNames array");
+
+                const auto Elapsed = std::chrono::duration<double>(ModelLoader::ClockType::now() - m_Loader.StartTime).count();
+                const auto Label   = std::string{PhaseNames[static_cast<size_t>(Phase)]} + "... (" + std::to_string(static_cast<int>(Elapsed * 1000)) + " ms)";
+                ImGui::ProgressBar(static_cast<float>(Phase) / static_cast<float>(LOAD_PHASE::Count), ImVec2{-1, 0}, Label.c_str());
+            }
+            else if (ImGui::TreeNode("Load timings"))
+            {
+                ImGui::Text("Parse:    %.1f ms", m_Loader.ParseTime);
+                ImGui::Text("Upload:   %.1f ms", m_Loader.UploadTime);
+                ImGui::Text("Bindings: %.1f ms", m_Loader.BindingTime);
+                ImGui::Text("Total:    %.1f ms", m_Loader.TotalTime);
+                ImGui::TreePop();
+            }
+        }
         if (m_Model->Scenes.size() > 1)
         {
             std::vector<std::pair<Uint32, std::string>> SceneList;
@@ -377,6 +1125,20 @@ void GLTFViewer::UpdateUI()
                 for (size_t i = 0; i < m_Model->Animations.size(); ++i)
                     Animations[i] = m_Model->Animations[i].Name.c_str();
                 ImGui::Combo("Active Animation", reinterpret_cast<int*>(&m_AnimationIndex), Animations.data(), static_cast<int>(Animations.size()));
+
+                if (ImGui::Checkbox("Parallel transforms", &m_bParallelTransforms))
+                {
+                    // Node transforms computed by the other path are not tracked by the evaluator,
+                    // so its cached matrices and dirty flags are stale.
+                    m_TransformEvaluator->Reset(*m_Model, m_RenderParams.SceneIndex);
+                }
+                ImGui::Text("Transform time: %.3f ms", m_TransformTimeMs);
+                if (m_bParallelTransforms)
+                {
+                    const auto& Stats = m_TransformEvaluator->GetStatistics();
+                    ImGui::Text("Nodes: %u (%u dirty), levels: %u, joints: %u", Stats.NumNodes, Stats.NumDirtyNodes, Stats.NumLevels, Stats.NumJoints);
+                    ImGui::Text("Worker threads: %u", m_TransformEvaluator->GetNumWorkerThreads());
+                }
                 ImGui::TreePop();
             }
         }
@@ -466,6 +1228,33 @@ void GLTFViewer::UpdateUI()
             ImGui::TreePop();
         }
 
+        UpdateResourceCacheUI();
+
+        if (ImGui::TreeNode("Instances"))
+        {
+            if (ImGui::Checkbox("Scene layout", &m_Instances.UseLayout) && m_Instances.UseLayout && m_Instances.LayoutModels.empty())
+                m_Instances.UseLayout = LoadSceneLayout(m_Instances.LayoutPath.c_str());
+            if (!m_Instances.UseLayout)
+            {
+                bool UpdateGrid = ImGui::SliderInt("Count", &m_Instances.NumInstances, 1, 1024);
+                UpdateGrid      = ImGui::SliderFloat("Spacing", &m_Instances.Spacing, 0.5f, 4.f) || UpdateGrid;
+                if (UpdateGrid)
+                    UpdateInstances();
+            }
+            ImGui::Checkbox("Frustum culling", &m_Instances.Culling);
+            ImGui::Checkbox("Flat instancing (non-PBR throughput test)", &m_Instances.FlatInstancing);
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Draws every primitive once for all visible instances with base color and one directional light.\n"
+                                  "Does not use GLTF_PBR_Renderer, textures, IBL or alpha modes.");
+            if (m_Instances.UseLayout || m_Instances.NumInstances > 1)
+            {
+                ImGui::Text("Visible instances: %u", m_Instances.NumVisible);
+                ImGui::Text("Draws issued:      %u", m_Instances.NumDraws);
+                ImGui::Text("CPU render time:   %.2f ms", m_Instances.CPUTimeMs);
+            }
+            ImGui::TreePop();
+        }
+
         if (ImGui::TreeNode("Alpha Modes"))
         {
             auto AlphaModeCheckbox = [&](const char* Name, GLTF_PBR_Renderer::RenderInfo::ALPHA_MODE_FLAGS Flag) {
@@ -501,8 +1290,51 @@ void GLTFViewer::CreateBoundBoxPSO(IRenderStateNotationLoader* pRSNLoader)
     m_BoundBoxPSO->CreateShaderResourceBinding(&m_BoundBoxSRB, true);
 }
 
+void GLTFViewer::CreateInstancedModelPSOs(IRenderStateNotationLoader* pRSNLoader)
+{
+    const auto             InputLayout = GLTF::VertexAttributesToInputLayout(GLTF::DefaultVertexAttributes.data(), static_cast<Uint32>(GLTF::DefaultVertexAttributes.size()));
+    const InputLayoutDesc& FullLayout  = InputLayout;
+
+    const char* PSONames[] = {"InstancedModel PSO", "InstancedSkinnedModel PSO"};
+    for (Uint32 i = 0; i < m_Instances.PSOs.size(); ++i)
+    {
+        // Non-skinned primitives only use the first vertex buffer, skinned primitives also use the second one
+        const Uint32     NumBuffers = i + 1;
+        InputLayoutDescX Layout;
+        for (Uint32 elem = 0; elem < FullLayout.NumElements; ++elem)
+        {
+            if (FullLayout.LayoutElements[elem].BufferSlot < NumBuffers)
+                Layout.Add(FullLayout.LayoutElements[elem]);
+        }
+
+        auto ModifyCI = MakeCallback([&](PipelineStateCreateInfo& PipelineCI) {
+            auto& GraphicsPipelineCI{static_cast<GraphicsPipelineStateCreateInfo&>(PipelineCI)};
+            GraphicsPipelineCI.GraphicsPipeline.RTVFormats[0]    = m_pSwapChain->GetDesc().ColorBufferFormat;
+            GraphicsPipelineCI.GraphicsPipeline.DSVFormat        = m_pSwapChain->GetDesc().DepthBufferFormat;
+            GraphicsPipelineCI.GraphicsPipeline.NumRenderTargets = 1;
+            GraphicsPipelineCI.GraphicsPipeline.InputLayout      = Layout;
+            // Instance and joint buffers are recreated when they grow
+            GraphicsPipelineCI.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+        });
+        pRSNLoader->LoadPipelineState({PSONames[i], PIPELINE_TYPE_GRAPHICS, true, ModifyCI, ModifyCI}, &m_Instances.PSOs[i]);
+        m_Instances.PSOs[i]->CreateShaderResourceBinding(&m_Instances.SRBs[i], true);
+    }
+
+    CreateUniformBuffer(m_pDevice, sizeof(InstancedDrawAttribs), "Instanced draw attribs CB", &m_Instances.pDrawAttribsCB);
+    for (auto& pSRB : m_Instances.SRBs)
+    {
+        pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "cbCameraAttribs")->Set(m_FrameAttribsCB);
+        for (auto ShaderType : {SHADER_TYPE_VERTEX, SHADER_TYPE_PIXEL})
+        {
+            if (auto* pVar = pSRB->GetVariableByName(ShaderType, "cbInstancedDrawAttribs"))
+                pVar->Set(m_Instances.pDrawAttribsCB);
+        }
+    }
+}
+
 GLTFViewer::~GLTFViewer()
 {
+    StopModelLoaderThread();
 }
 
 // Render a frame
@@ -613,16 +1445,7 @@ void GLTFViewer::Render()
         }
     }
 
-    if (m_pResourceMgr)
-    {
-        m_GLTFRenderer->Begin(m_pDevice, m_pImmediateContext, m_CacheUseInfo, m_CacheBindings, m_FrameAttribsCB);
-        m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_Transforms, m_RenderParams, nullptr, &m_CacheBindings);
-    }
-    else
-    {
-        m_GLTFRenderer->Begin(m_pImmediateContext);
-        m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_Transforms, m_RenderParams, &m_ModelResourceBindings);
-    }
+    RenderModel(CameraViewProj);
 
     if (m_BoundBoxMode != BoundBoxMode::None)
     {
@@ -680,6 +1503,7 @@ void GLTFViewer::Update(double CurrTime, double ElapsedTime)
     }
 
     SampleBase::Update(CurrTime, ElapsedTime);
+    UpdateModelLoading();
     UpdateUI();
 
     if (!m_Model->Animations.empty() && m_PlayAnimation)
@@ -687,8 +1511,24 @@ void GLTFViewer::Update(double CurrTime, double ElapsedTime)
         float& AnimationTimer = m_AnimationTimers[m_AnimationIndex];
         AnimationTimer += static_cast<float>(ElapsedTime);
         AnimationTimer = std::fmod(AnimationTimer, m_Model->Animations[m_AnimationIndex].End);
-        m_Model->ComputeTransforms(m_RenderParams.SceneIndex, m_Transforms, m_ModelTransform, m_AnimationIndex, AnimationTimer);
+
+        const auto StartTime = std::chrono::high_resolution_clock::now();
+        if (m_bParallelTransforms)
+            m_TransformEvaluator->ComputeTransforms(*m_Model, m_RenderParams.SceneIndex, m_Transforms, m_ModelTransform, m_AnimationIndex, AnimationTimer);
+        else
+            m_Model->ComputeTransforms(m_RenderParams.SceneIndex, m_Transforms, m_ModelTransform, m_AnimationIndex, AnimationTimer);
+        const auto EndTime = std::chrono::high_resolution_clock::now();
+
+        // Keep the bounding box in sync with the animation so that instances are culled against the current pose
+        m_ModelAABB = m_Model->ComputeBoundingBox(m_RenderParams.SceneIndex, m_Transforms);
+
+        // Smooth the timing to make it readable in the UI
+        const auto TimeMs = std::chrono::duration<float, std::milli>(EndTime - StartTime).count();
+        m_TransformTimeMs = m_TransformTimeMs > 0 ? m_TransformTimeMs * 0.95f + TimeMs * 0.05f : TimeMs;
     }
+
+    if (m_Instances.UseLayout)
+        UpdateSceneLayout(static_cast<float>(ElapsedTime));
 }
 
 } // namespace Diligent
@@ -28,12 +28,19 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include "SampleBase.hpp"
 #include "RenderStateNotationLoader.h"
 #include "GLTFLoader.hpp"
 #include "GLTF_PBR_Renderer.hpp"
 #include "BasicMath.hpp"
 #include "TrackballCamera.hpp"
+#include "GLTFTransformEvaluator.hpp"
 
 namespace Diligent
 {
@@ -56,9 +63,35 @@ public:
 private:
     void CreateBoundBoxPSO(IRenderStateNotationLoader* pRSNLoader);
     void LoadModel(const char* Path);
+    void LoadModel(const char* Path, GLTF::ResourceManager* pResourceMgr);
+    void SetModel(std::unique_ptr<GLTF::Model>&& pModel, const std::string& Path, GLTF::ResourceManager* pResourceMgr);
+    void UpdateModelLoading();
+    bool IsModelLoadPending(const GLTF::ResourceManager* pResourceMgr);
+    void StartModelLoaderThread();
+    void StopModelLoaderThread();
+    void ModelLoaderThreadProc();
     void UpdateScene();
+    void UpdateInstances();
+    bool LoadSceneLayout(const char* Path);
+    void UpdateSceneLayout(float ElapsedTime);
+    void CreateInstancedModelPSOs(IRenderStateNotationLoader* pRSNLoader);
+    void RenderModel(const float4x4& CameraViewProj);
+    void RenderInstances(const float4x4& CameraViewProj);
+    void RenderPBRInstances();
+    void RenderFlatInstances();
     void UpdateUI();
-    void CreateGLTFResourceCache();
+    void InitGLTFResourceCache();
+    void CompactGLTFResourceCache();
+    void UpdateResourceCacheUI();
+
+    struct ResourceCacheSize
+    {
+        Uint32 VertexCount = 8192;
+        Uint32 IndexCount  = 16384;
+        Uint32 AtlasSlices = 1;
+    };
+    RefCntAutoPtr<GLTF::ResourceManager> CreateGLTFResourceCache(const ResourceCacheSize& Size) const;
+    Uint64                               GetResourceCacheCommittedSize() const;
 
     enum class BackgroundMode : int
     {
@@ -105,6 +138,75 @@ private:
     int                m_AnimationIndex = 0;
     std::vector<float> m_AnimationTimers;
 
+    // Instanced scene mode renders multiple instances of the current model placed on a grid,
+    // or instances of several models described by a JSON scene layout. Visible instances are
+    // selected on the CPU and, by default, rendered by GLTF_PBR_Renderer with one Render call each.
+    // The flat instanced mode is a non-PBR geometry throughput test: instance transforms are uploaded
+    // to a structured buffer, and every primitive is drawn once with all visible instances of its model
+    // using base color and one directional light only.
+    struct InstancedModel
+    {
+        std::unique_ptr<GLTF::Model> pModel;
+        GLTF::ModelTransforms        Transforms;
+        float4x4                     RootTransform; // Centers and scales the model
+        BoundBox                     AABB;          // Bounding box in the current animation pose
+        float                        AnimationTime = 0;
+
+        GLTF_PBR_Renderer::ModelResourceBindings Bindings;
+
+        std::vector<float4x4> InstanceTransforms;
+    };
+
+    // Instances of one model visible in the current frame
+    struct InstanceBatch
+    {
+        const GLTF::Model*                        pModel        = nullptr;
+        const GLTF::ModelTransforms*              pTransforms   = nullptr;
+        GLTF_PBR_Renderer::ModelResourceBindings* pBindings     = nullptr; // Null if the model is in the resource cache
+        Uint32                                    SceneIndex    = 0;
+        Uint32                                    FirstInstance = 0; // Index of the first instance in VisibleTransforms
+        Uint32                                    NumInstances  = 0;
+        Uint32                                    FirstSkin     = 0; // Index of the first skin of the model in SkinJointOffsets
+    };
+
+    struct InstancedScene
+    {
+        int   NumInstances = 1;
+        float Spacing      = 1.25f;
+        bool  Culling      = true;
+        bool  UseLayout    = false;
+
+        // Use the flat instanced path instead of GLTF_PBR_Renderer
+        bool FlatInstancing = false;
+
+        std::vector<float4x4> GridTransforms;
+
+        std::string                 LayoutPath = "scenes/InstancedScene.json";
+        std::vector<InstancedModel> LayoutModels;
+
+        // Per-frame data. Instance and joint transforms are only uploaded by the flat instanced path.
+        std::vector<InstanceBatch> Batches;
+        std::vector<float4x4>      VisibleTransforms;
+        std::vector<float4x4>      JointTransforms;
+        std::vector<Uint32>        SkinJointOffsets;
+
+        RefCntAutoPtr<IBuffer>                               pInstanceBuffer;
+        RefCntAutoPtr<IBuffer>                               pJointBuffer;
+        RefCntAutoPtr<IBuffer>                               pDrawAttribsCB;
+        std::array<RefCntAutoPtr<IPipelineState>, 2>         PSOs; // Non-skinned and skinned
+        std::array<RefCntAutoPtr<IShaderResourceBinding>, 2> SRBs;
+
+        // Statistics of the last frame
+        Uint32 NumVisible = 0;
+        Uint32 NumDraws   = 0;
+        float  CPUTimeMs  = 0;
+    };
+    InstancedScene m_Instances;
+
+    std::unique_ptr<GLTFTransformEvaluator> m_TransformEvaluator;
+    bool                                    m_bParallelTransforms = true;
+    float                                   m_TransformTimeMs     = 0;
+
     std::unique_ptr<GLTF_PBR_Renderer>    m_GLTFRenderer;
     std::unique_ptr<GLTF::Model>          m_Model;
     GLTF::ModelTransforms                 m_Transforms;
@@ -124,6 +226,20 @@ private:
     GLTF_PBR_Renderer::ModelResourceBindings m_ModelResourceBindings;
     GLTF_PBR_Renderer::ResourceCacheBindings m_CacheBindings;
 
+    // Resource cache pools start small and grow on demand. Since pools never shrink, the cache is
+    // compacted on request by fully reloading the current model from disk into a new right-sized cache.
+    struct ResourceCacheState
+    {
+        // Cache the current model is being reloaded into. The compaction is complete when the model
+        // loaded into this cache is set, and is abandoned if the load fails or another model is requested.
+        RefCntAutoPtr<GLTF::ResourceManager> pPendingCache;
+
+        Uint64 SizeBeforeCompaction = 0;
+        Uint64 BytesReclaimed       = 0;
+        Uint32 NumCompactions       = 0;
+    };
+    ResourceCacheState m_CacheState;
+
     TrackballCamera<float> m_Camera;
 
     Uint32 m_CameraId = 0;
@@ -131,9 +247,55 @@ private:
     std::vector<const GLTF::Node*> m_CameraNodes;
 
     std::string m_InitialModelPath;
+    std::string m_ModelPath;
 
     bool m_bComputeBoundingBoxes = false;
     bool m_bWireframeSupported   = false;
+
+    // Background model loading.
+    // The loader thread parses the glTF file and decodes images without a device context.
+    // The main thread then uploads GPU data and creates resource bindings, one phase per frame,
+    // while the current model keeps rendering.
+    enum class LOAD_PHASE : Uint32
+    {
+        Idle,
+        Parsing,   // Loader thread: parsing the file and decoding images
+        Parsed,    // Model is parsed and waits for the main thread
+        Uploading, // Main thread: uploading GPU data
+        Binding,   // Main thread: creating resource bindings
+        Count
+    };
+    struct ModelLoader
+    {
+        std::thread             Thread;
+        std::mutex              Mtx;
+        std::condition_variable CondVar;
+
+        // The following members are protected by Mtx
+        bool                                 Quit = false;
+        std::string                          RequestedPath;                // Path the loader thread should load next
+        RefCntAutoPtr<GLTF::ResourceManager> RequestedResourceMgr;         // Resource cache to load the next model into
+        std::string                          LoadingPath;                  // Path being parsed or uploaded
+        const GLTF::ResourceManager*         LoadingResourceMgr = nullptr; // Resource cache LoadingPath is loaded into
+
+        // Owned by the loader thread in Parsing phase, and by the main thread in Parsed, Uploading and Binding phases
+        std::unique_ptr<GLTF::Model>         pModel;      // Parsed model waiting for GPU upload
+        RefCntAutoPtr<GLTF::ResourceManager> pModelCache; // Resource cache pModel was loaded into
+
+        std::atomic<LOAD_PHASE> Phase{LOAD_PHASE::Idle};
+
+        using ClockType = std::chrono::high_resolution_clock;
+        ClockType::time_point StartTime;
+
+        // Load phase timings of the last loaded model, in milliseconds
+        double ParseTime   = 0;
+        double UploadTime  = 0;
+        double BindingTime = 0;
+        double TotalTime   = 0;
+    };
+    ModelLoader m_Loader;
+
+    bool m_bAsyncModelLoading = true;
 };
 
 } // namespace Diligent
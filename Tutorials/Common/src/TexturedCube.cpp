@@ -181,8 +181,50 @@ RefCntAutoPtr<ITexture> LoadTexture(IRenderDevice* pDevice, const char* Path)
 }
 
 
+namespace
+{
+
+// Creates shaders and pipeline states through the render state cache, if one is provided,
+// or directly through the render device otherwise.
+class StateCreator
+{
+public:
+    explicit StateCreator(const CreatePSOInfo& CreateInfo) :
+        m_pDevice{CreateInfo.pDevice},
+        m_pStateCache{CreateInfo.pStateCache}
+    {}
+
+    RefCntAutoPtr<IShader> CreateShader(const ShaderCreateInfo& ShaderCI) const
+    {
+        RefCntAutoPtr<IShader> pShader;
+        if (m_pStateCache != nullptr)
+            m_pStateCache->CreateShader(ShaderCI, &pShader);
+        else
+            m_pDevice->CreateShader(ShaderCI, &pShader);
+        return pShader;
+    }
+
+    RefCntAutoPtr<IPipelineState> CreateGraphicsPipelineState(const GraphicsPipelineStateCreateInfo& PSOCreateInfo) const
+    {
+        RefCntAutoPtr<IPipelineState> pPSO;
+        if (m_pStateCache != nullptr)
+            m_pStateCache->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+        else
+            m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+        return pPSO;
+    }
+
+private:
+    IRenderDevice* const     m_pDevice;
+    IRenderStateCache* const m_pStateCache;
+};
+
+} // namespace
+
 RefCntAutoPtr<IPipelineState> CreatePipelineState(const CreatePSOInfo& CreateInfo, bool ConvertPSOutputToGamma)
 {
+    const StateCreator Creator{CreateInfo};
+
     GraphicsPipelineStateCreateInfo PSOCreateInfo;
     PipelineStateDesc&              PSODesc          = PSOCreateInfo.PSODesc;
     PipelineResourceLayoutDesc&     ResourceLayout   = PSODesc.ResourceLayout;
@@ -234,7 +276,7 @@ RefCntAutoPtr<IPipelineState> CreatePipelineState(const CreatePSOInfo& CreateInf
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Cube VS";
         ShaderCI.FilePath        = CreateInfo.VSFilePath;
-        CreateInfo.pDevice->CreateShader(ShaderCI, &pVS);
+        pVS                      = Creator.CreateShader(ShaderCI);
     }
 
     // Create a pixel shader
@@ -244,7 +286,7 @@ RefCntAutoPtr<IPipelineState> CreatePipelineState(const CreatePSOInfo& CreateInf
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Cube PS";
         ShaderCI.FilePath        = CreateInfo.PSFilePath;
-        CreateInfo.pDevice->CreateShader(ShaderCI, &pPS);
+        pPS                      = Creator.CreateShader(ShaderCI);
     }
 
     InputLayoutDescX InputLayout;
@@ -294,9 +336,7 @@ RefCntAutoPtr<IPipelineState> CreatePipelineState(const CreatePSOInfo& CreateInf
     ResourceLayout.ImmutableSamplers    = ImtblSamplers;
     ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
 
-    RefCntAutoPtr<IPipelineState> pPSO;
-    CreateInfo.pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
-    return pPSO;
+    return Creator.CreateGraphicsPipelineState(PSOCreateInfo);
 }
 
 } // namespace TexturedCube
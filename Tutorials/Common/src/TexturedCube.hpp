@@ -32,6 +32,7 @@
 #include "RenderDevice.h"
 #include "Buffer.h"
 #include "RefCntAutoPtr.hpp"
+#include "RenderStateCache.h"
 #include "BasicMath.hpp"
 
 namespace Diligent
@@ -70,6 +71,7 @@ RefCntAutoPtr<ITexture> LoadTexture(IRenderDevice* pDevice, const char* Path);
 struct CreatePSOInfo
 {
     IRenderDevice*                   pDevice                = nullptr;
+    IRenderStateCache*               pStateCache            = nullptr; // Optional render state cache
     TEXTURE_FORMAT                   RTVFormat              = TEX_FORMAT_UNKNOWN;
     TEXTURE_FORMAT                   DSVFormat              = TEX_FORMAT_UNKNOWN;
     IShaderSourceInputStreamFactory* pShaderSourceFactory   = nullptr;
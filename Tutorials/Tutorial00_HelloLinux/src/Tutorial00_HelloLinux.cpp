@@ -23,6 +23,10 @@
 
 #include <memory>
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
 
 #include <GL/glx.h>
 #include <GL/gl.h>
@@ -327,6 +331,163 @@ private:
     RENDER_DEVICE_TYPE            m_DeviceType = RENDER_DEVICE_TYPE_GL;
 };
 
+// Frame pacing settings
+struct FramePacingInfo
+{
+    // Maximum frame rate. Zero means no limit.
+    double TargetFPS = 0;
+
+    // Start every frame as late as possible so that it is presented right before
+    // the next vertical blank. This minimizes the input-to-present latency.
+    bool LowLatency = false;
+};
+
+// Simple frame pacer that limits the frame rate of the main loop and measures
+// the latency between an input event and the present of the frame that reflects it.
+class FramePacer
+{
+public:
+    using ClockType = std::chrono::steady_clock;
+
+    explicit FramePacer(const FramePacingInfo& Info) :
+        m_Info{Info}
+    {
+        m_LastReport = ClockType::now();
+    }
+
+    // Records the time of an input event. The latency is measured from the first
+    // input event received after the previous present until the next present.
+    void OnInput()
+    {
+        if (!m_HasPendingInput)
+        {
+            m_FirstInput      = ClockType::now();
+            m_HasPendingInput = true;
+        }
+    }
+
+    void BeginFrame()
+    {
+        m_FrameStart = ClockType::now();
+    }
+
+    void BeforePresent()
+    {
+        m_PresentStart = ClockType::now();
+
+        const double CPUTime = ToSeconds(m_PresentStart - m_FrameStart);
+        m_AvgCPUTime += (CPUTime - m_AvgCPUTime) * AvgWeight;
+    }
+
+    // Sleeps until the next frame should start
+    void EndFrame()
+    {
+        const auto PresentEnd = ClockType::now();
+
+        if (m_LastPresentEnd != ClockType::time_point{})
+        {
+            // Present blocks until the vertical blank, so the interval between blocking
+            // presents is an estimate of the display refresh interval.
+            const double FrameTime   = ToSeconds(PresentEnd - m_LastPresentEnd);
+            const double PresentTime = ToSeconds(PresentEnd - m_PresentStart);
+            if (PresentTime > SleepMargin && FrameTime > m_AvgRefreshInterval * 0.5 && FrameTime < m_AvgRefreshInterval * 1.5)
+                m_AvgRefreshInterval += (FrameTime - m_AvgRefreshInterval) * AvgWeight;
+        }
+        m_LastPresentEnd = PresentEnd;
+        ++m_NumFrames;
+
+        if (m_HasPendingInput)
+        {
+            const double Latency = ToSeconds(PresentEnd - m_FirstInput);
+            m_TotalInputLatency += Latency;
+            m_MaxInputLatency = std::max(m_MaxInputLatency, Latency);
+            ++m_NumInputLatencySamples;
+            m_HasPendingInput = false;
+        }
+
+        const double ReportTime = ToSeconds(PresentEnd - m_LastReport);
+        if (ReportTime >= 1.0)
+        {
+            // Statistics are only printed when frame pacing is enabled
+            if (m_Info.TargetFPS > 0 || m_Info.LowLatency)
+            {
+                std::cout << "FPS: " << m_NumFrames / ReportTime;
+                if (m_NumInputLatencySamples > 0)
+                {
+                    std::cout << ", input-to-present latency: " << m_TotalInputLatency / m_NumInputLatencySamples * 1000.0
+                              << " ms (max " << m_MaxInputLatency * 1000.0 << " ms)";
+                }
+                std::cout << std::endl;
+            }
+
+            m_LastReport             = PresentEnd;
+            m_NumFrames              = 0;
+            m_TotalInputLatency      = 0;
+            m_MaxInputLatency        = 0;
+            m_NumInputLatencySamples = 0;
+        }
+
+        auto NextFrameStart = PresentEnd;
+        if (m_Info.LowLatency)
+        {
+            // Present returns shortly after the vertical blank. Start the next frame as late as possible,
+            // leaving enough time to prepare it before the next vertical blank.
+            double Interval = m_AvgRefreshInterval;
+            if (m_Info.TargetFPS > 0)
+                Interval = std::max(Interval, 1.0 / m_Info.TargetFPS);
+            NextFrameStart = PresentEnd + FromSeconds(std::max(Interval - m_AvgCPUTime * 1.5 - SleepMargin, 0.0));
+        }
+        else if (m_Info.TargetFPS > 0)
+        {
+            // Advance the deadline by a fixed period so that the sleep error does not accumulate.
+            // If the loop fell behind by more than a frame, restart from the current time.
+            const auto Period = FromSeconds(1.0 / m_Info.TargetFPS);
+            NextFrameStart    = m_NextFrameStart + Period;
+            if (NextFrameStart + Period < PresentEnd)
+                NextFrameStart = PresentEnd;
+        }
+        m_NextFrameStart = NextFrameStart;
+
+        if (NextFrameStart > PresentEnd)
+            std::this_thread::sleep_until(NextFrameStart);
+    }
+
+private:
+    static constexpr double AvgWeight   = 0.1;
+    static constexpr double SleepMargin = 0.001;
+
+    static double ToSeconds(ClockType::duration Duration)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(Duration).count();
+    }
+
+    static ClockType::duration FromSeconds(double Seconds)
+    {
+        return std::chrono::duration_cast<ClockType::duration>(std::chrono::duration<double>{Seconds});
+    }
+
+    const FramePacingInfo m_Info;
+
+    ClockType::time_point m_FrameStart;
+    ClockType::time_point m_PresentStart;
+    ClockType::time_point m_LastPresentEnd;
+    ClockType::time_point m_NextFrameStart;
+    ClockType::time_point m_FirstInput;
+    ClockType::time_point m_LastReport;
+    bool                  m_HasPendingInput = false;
+
+    double m_AvgCPUTime         = 0;
+    double m_AvgRefreshInterval = 1.0 / 60.0;
+
+    Uint32 m_NumFrames              = 0;
+    Uint32 m_NumInputLatencySamples = 0;
+    double m_TotalInputLatency      = 0;
+    double m_MaxInputLatency        = 0;
+};
+
+constexpr double FramePacer::AvgWeight;
+constexpr double FramePacer::SleepMargin;
+
 using namespace Diligent;
 
 
@@ -360,7 +521,9 @@ XCBInfo InitXCBConnectionAndWindow()
 
     value_mask    = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
     value_list[0] = screen->black_pixel;
-    value_list[1] = XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    value_list[1] = XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
+        XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
+        XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE;
 
     xcb_create_window(info.connection, XCB_COPY_FROM_PARENT, info.window, screen->root, 0, 0, info.width, info.height, 0,
                       XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, value_mask, value_list);
@@ -410,7 +573,7 @@ void DestroyXCBConnectionAndWindow(XCBInfo& info)
     xcb_disconnect(info.connection);
 }
 
-int xcb_main()
+int xcb_main(const FramePacingInfo& PacingInfo)
 {
     std::unique_ptr<Tutorial00App> TheApp(new Tutorial00App);
 
@@ -418,15 +581,34 @@ int xcb_main()
     TheApp->InitVulkan(xcbInfo);
     TheApp->CreateResources();
     xcb_flush(xcbInfo.connection);
+
+    FramePacer Pacer{PacingInfo};
+    bool       Occluded = false;
     while (true)
     {
         xcb_generic_event_t* event;
 
         bool Quit = false;
-        while ((event = xcb_poll_for_event(xcbInfo.connection)) != nullptr)
+        // While the window is occluded, there is nothing to render, so
+        // block until the next event arrives instead of spinning the loop.
+        while (!Quit && (event = Occluded ? xcb_wait_for_event(xcbInfo.connection) : xcb_poll_for_event(xcbInfo.connection)) != nullptr)
         {
             switch (event->response_type & 0x7f)
             {
+                case XCB_KEY_PRESS:
+                case XCB_BUTTON_PRESS:
+                case XCB_BUTTON_RELEASE:
+                case XCB_MOTION_NOTIFY:
+                    Pacer.OnInput();
+                    break;
+
+                case XCB_VISIBILITY_NOTIFY:
+                    Occluded = reinterpret_cast<const xcb_visibility_notify_event_t*>(event)->state == XCB_VISIBILITY_FULLY_OBSCURED;
+                    break;
+
+                case XCB_MAP_NOTIFY: Occluded = false; break;
+                case XCB_UNMAP_NOTIFY: Occluded = true; break;
+
                 case XCB_CLIENT_MESSAGE:
                     if ((*(xcb_client_message_event_t*)event).data.data32[0] ==
                         (*xcbInfo.atom_wm_delete_window).atom)
@@ -437,6 +619,7 @@ int xcb_main()
 
                 case XCB_KEY_RELEASE:
                 {
+                    Pacer.OnInput();
                     const auto* keyEvent = reinterpret_cast<const xcb_key_release_event_t*>(event);
                     switch (keyEvent->detail)
                     {
@@ -473,11 +656,17 @@ int xcb_main()
             free(event);
         }
 
-        if (Quit)
+        if (Quit || xcb_connection_has_error(xcbInfo.connection))
             break;
 
+        if (Occluded)
+            continue;
+
+        Pacer.BeginFrame();
         TheApp->Render();
+        Pacer.BeforePresent();
         TheApp->Present();
+        Pacer.EndFrame();
     }
     TheApp.reset();
     DestroyXCBConnectionAndWindow(xcbInfo);
@@ -487,7 +676,7 @@ int xcb_main()
 #endif
 
 #if GL_SUPPORTED
-int x_main()
+int x_main(const FramePacingInfo& PacingInfo)
 {
     std::unique_ptr<Tutorial00App> TheApp(new Tutorial00App);
 
@@ -537,7 +726,8 @@ int x_main()
         KeyReleaseMask |
         ButtonPressMask |
         ButtonReleaseMask |
-        PointerMotionMask;
+        PointerMotionMask |
+        VisibilityChangeMask;
 
     Window win = XCreateWindow(display, RootWindow(display, vi->screen), 0, 0, 1024, 768, 0, vi->depth, InputOutput, vi->visual, CWBorderPixel | CWColormap | CWEventMask, &swa);
     if (!win)
@@ -603,17 +793,39 @@ int x_main()
     TheApp->OnGLContextCreated(display, win);
     TheApp->CreateResources();
     XStoreName(display, win, "Tutorial00: Hello Linux (OpenGL)");
+
+    FramePacer Pacer{PacingInfo};
+    bool       Occluded = false;
     while (true)
     {
         bool   EscPressed = false;
         XEvent xev;
-        // Handle all events in the queue
-        while (XCheckMaskEvent(display, 0xFFFFFFFF, &xev))
+        // Handle all events in the queue. While the window is occluded, there is nothing
+        // to render, so block until the next event arrives instead of spinning the loop.
+        while (!EscPressed && (Occluded || XCheckMaskEvent(display, 0xFFFFFFFF, &xev)))
         {
+            if (Occluded)
+                XMaskEvent(display, 0xFFFFFFFF, &xev);
+
             switch (xev.type)
             {
+                case KeyRelease:
+                case ButtonPress:
+                case ButtonRelease:
+                case MotionNotify:
+                    Pacer.OnInput();
+                    break;
+
+                case VisibilityNotify:
+                    Occluded = xev.xvisibility.state == VisibilityFullyObscured;
+                    break;
+
+                case MapNotify: Occluded = false; break;
+                case UnmapNotify: Occluded = true; break;
+
                 case KeyPress:
                 {
+                    Pacer.OnInput();
                     KeySym keysym;
                     char   buffer[80];
                     int    num_char = XLookupString((XKeyEvent*)&xev, buffer, _countof(buffer), &keysym, 0);
@@ -634,9 +846,11 @@ int x_main()
         if (EscPressed)
             break;
 
+        Pacer.BeginFrame();
         TheApp->Render();
-
+        Pacer.BeforePresent();
         TheApp->Present();
+        Pacer.EndFrame();
     }
 
     TheApp.reset();
@@ -694,17 +908,26 @@ int main(int argc, char** argv)
         }
     }
 
+    FramePacingInfo PacingInfo;
+    for (arg = 1; arg < argc; ++arg)
+    {
+        if (strcmp(argv[arg], "--fps") == 0 && arg + 1 < argc)
+            PacingInfo.TargetFPS = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "--latency") == 0)
+            PacingInfo.LowLatency = true;
+    }
+
 #if VULKAN_SUPPORTED
     if (DevType == RENDER_DEVICE_TYPE_VULKAN)
     {
-        return xcb_main();
+        return xcb_main(PacingInfo);
     }
 #endif
 
 #if GL_SUPPORTED
     if (DevType == RENDER_DEVICE_TYPE_GL)
     {
-        return x_main();
+        return x_main(PacingInfo);
     }
 #endif
 
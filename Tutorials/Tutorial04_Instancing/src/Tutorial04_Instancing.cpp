@@ -75,6 +75,7 @@ void Tutorial04_Instancing::CreatePipelineState()
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice                = m_pDevice;
+    CubePsoCI.pStateCache            = m_pStateCache;
     CubePsoCI.RTVFormat              = m_pSwapChain->GetDesc().ColorBufferFormat;
     CubePsoCI.DSVFormat              = m_pSwapChain->GetDesc().DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory   = pShaderSourceFactory;
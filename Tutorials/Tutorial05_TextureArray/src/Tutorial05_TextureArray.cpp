@@ -89,6 +89,7 @@ void Tutorial05_TextureArray::CreatePipelineState()
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice                = m_pDevice;
+    CubePsoCI.pStateCache            = m_pStateCache;
     CubePsoCI.RTVFormat              = m_pSwapChain->GetDesc().ColorBufferFormat;
     CubePsoCI.DSVFormat              = m_pSwapChain->GetDesc().DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory   = pShaderSourceFactory;
@@ -126,44 +127,11 @@ void Tutorial05_TextureArray::CreateInstanceBuffer()
     PopulateInstanceBuffer();
 }
 
-void Tutorial05_TextureArray::LoadTextures()
+void Tutorial05_TextureArray::LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders)
 {
-    std::vector<RefCntAutoPtr<ITextureLoader>> TexLoaders(NumTextures);
-    // Load textures
-    for (int tex = 0; tex < NumTextures; ++tex)
-    {
-        // Create loader for the current texture
-        std::stringstream FileNameSS;
-        FileNameSS << "DGLogo" << tex << ".png";
-        const auto      FileName = FileNameSS.str();
-        TextureLoadInfo LoadInfo;
-        LoadInfo.IsSRGB = true;
-
-        CreateTextureLoaderFromFile(FileName.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, LoadInfo, &TexLoaders[tex]);
-        VERIFY_EXPR(TexLoaders[tex]);
-        VERIFY(tex == 0 || TexLoaders[tex]->GetTextureDesc() == TexLoaders[0]->GetTextureDesc(), "All textures must be same size");
-    }
-
-    auto TexArrDesc      = TexLoaders[0]->GetTextureDesc();
-    TexArrDesc.ArraySize = NumTextures;
-    TexArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
-    TexArrDesc.Usage     = USAGE_DEFAULT;
-    TexArrDesc.BindFlags = BIND_SHADER_RESOURCE;
-
-    // Prepare initialization data
-    std::vector<TextureSubResData> SubresData(TexArrDesc.ArraySize * TexArrDesc.MipLevels);
-    for (Uint32 slice = 0; slice < TexArrDesc.ArraySize; ++slice)
-    {
-        for (Uint32 mip = 0; mip < TexArrDesc.MipLevels; ++mip)
-        {
-            SubresData[slice * TexArrDesc.MipLevels + mip] = TexLoaders[slice]->GetSubresourceData(mip, 0);
-        }
-    }
-    TextureData InitData{SubresData.data(), TexArrDesc.MipLevels * TexArrDesc.ArraySize};
-
-    // Create the texture array
-    RefCntAutoPtr<ITexture> pTexArray;
-    m_pDevice->CreateTexture(TexArrDesc, &InitData, &pTexArray);
+    // Wait for all textures to be decoded and create the texture array
+    RefCntAutoPtr<ITexture> pTexArray = m_TextureLoadService.CreateTextureArray(m_pDevice, TexLoaders, "Texture array");
+    VERIFY_EXPR(pTexArray);
 
     // Get shader resource view from the texture array
     m_TextureSRV = pTexArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
@@ -188,6 +156,11 @@ void Tutorial05_TextureArray::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
+    // Start decoding the textures on worker threads while the pipeline state and buffers are created
+    TextureLoadInfo LoadInfo;
+    LoadInfo.IsSRGB       = true;
+    const auto TexLoaders = m_TextureLoadService.LoadAsync("DGLogo%u.png", NumTextures, LoadInfo);
+
     CreatePipelineState();
 
     // Load cube vertex and index buffers
@@ -195,7 +168,7 @@ void Tutorial05_TextureArray::Initialize(const SampleInitInfo& InitInfo)
     m_CubeIndexBuffer  = TexturedCube::CreateIndexBuffer(m_pDevice);
 
     CreateInstanceBuffer();
-    LoadTextures();
+    LoadTextures(TexLoaders);
 }
 
 void Tutorial05_TextureArray::PopulateInstanceBuffer()
@@ -46,7 +46,7 @@ public:
 private:
     void CreatePipelineState();
     void CreateInstanceBuffer();
-    void LoadTextures();
+    void LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders);
     void UpdateUI();
     void PopulateInstanceBuffer();
 
@@ -72,6 +72,7 @@ void Tutorial06_Multithreading::CreatePipelineState(std::vector<StateTransitionD
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice              = m_pDevice;
+    CubePsoCI.pStateCache          = m_pStateCache;
     CubePsoCI.RTVFormat            = m_pSwapChain->GetDesc().ColorBufferFormat;
     CubePsoCI.DSVFormat            = m_pSwapChain->GetDesc().DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory = pShaderSourceFactory;
@@ -96,17 +97,14 @@ void Tutorial06_Multithreading::CreatePipelineState(std::vector<StateTransitionD
     m_pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "InstanceData")->Set(m_InstanceConstants);
 }
 
-void Tutorial06_Multithreading::LoadTextures(std::vector<StateTransitionDesc>& Barriers)
+void Tutorial06_Multithreading::LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders, std::vector<StateTransitionDesc>& Barriers)
 {
-    // Load textures
+    // Wait for the textures to be decoded and create them
+    const auto Textures = m_TextureLoadService.CreateTextures(m_pDevice, TexLoaders);
     for (int tex = 0; tex < NumTextures; ++tex)
     {
-        // Load current texture
-        std::stringstream FileNameSS;
-        FileNameSS << "DGLogo" << tex << ".png";
-        auto FileName = FileNameSS.str();
-
-        RefCntAutoPtr<ITexture> SrcTex = TexturedCube::LoadTexture(m_pDevice, FileName.c_str());
+        ITexture* SrcTex = Textures[tex];
+        VERIFY_EXPR(SrcTex);
         // Get shader resource view from the texture
         m_TextureSRV[tex] = SrcTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
         // Transition textures to shader resource state
@@ -152,6 +150,11 @@ void Tutorial06_Multithreading::Initialize(const SampleInitInfo& InitInfo)
     m_MaxThreads       = static_cast<int>(m_pDeferredContexts.size());
     m_NumWorkerThreads = std::min(4, m_MaxThreads);
 
+    // Start decoding the textures on worker threads while the pipeline state is created
+    TextureLoadInfo LoadInfo;
+    LoadInfo.IsSRGB       = true;
+    const auto TexLoaders = m_TextureLoadService.LoadAsync("DGLogo%u.png", NumTextures, LoadInfo);
+
     std::vector<StateTransitionDesc> Barriers;
 
     CreatePipelineState(Barriers);
@@ -162,7 +165,7 @@ void Tutorial06_Multithreading::Initialize(const SampleInitInfo& InitInfo)
     // Explicitly transition vertex and index buffers to required states
     Barriers.emplace_back(m_CubeVertexBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
     Barriers.emplace_back(m_CubeIndexBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
-    LoadTextures(Barriers);
+    LoadTextures(TexLoaders, Barriers);
 
     // Execute all barriers
     m_pImmediateContext->TransitionResourceStates(static_cast<Uint32>(Barriers.size()), Barriers.data());
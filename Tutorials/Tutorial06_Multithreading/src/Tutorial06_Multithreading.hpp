@@ -52,7 +52,7 @@ public:
 
 private:
     void CreatePipelineState(std::vector<StateTransitionDesc>& Barriers);
-    void LoadTextures(std::vector<StateTransitionDesc>& Barriers);
+    void LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders, std::vector<StateTransitionDesc>& Barriers);
     void UpdateUI();
     void PopulateInstanceData();
 
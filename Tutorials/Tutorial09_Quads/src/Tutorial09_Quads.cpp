@@ -265,25 +265,14 @@ void Tutorial09_Quads::CreatePipelineStates(std::vector<StateTransitionDesc>& Ba
     }
 }
 
-void Tutorial09_Quads::LoadTextures(std::vector<StateTransitionDesc>& Barriers)
+void Tutorial09_Quads::LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders, std::vector<StateTransitionDesc>& Barriers)
 {
-    std::vector<RefCntAutoPtr<ITextureLoader>> TexLoaders(NumTextures);
-    // Load textures
+    // Wait for the textures to be decoded and create them
+    const auto Textures = m_TextureLoadService.CreateTextures(m_pDevice, TexLoaders);
     for (int tex = 0; tex < NumTextures; ++tex)
     {
-        // Create loader for the current texture
-        std::stringstream FileNameSS;
-        FileNameSS << "DGLogo" << tex << ".png";
-        const auto      FileName = FileNameSS.str();
-        TextureLoadInfo LoadInfo;
-        LoadInfo.IsSRGB = true;
-
-        CreateTextureLoaderFromFile(FileName.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, LoadInfo, &TexLoaders[tex]);
-        VERIFY_EXPR(TexLoaders[tex]);
-        VERIFY(tex == 0 || TexLoaders[tex]->GetTextureDesc() == TexLoaders[0]->GetTextureDesc(), "All textures must be same size");
-
-        RefCntAutoPtr<ITexture> pTex;
-        TexLoaders[tex]->CreateTexture(m_pDevice, &pTex);
+        ITexture* pTex = Textures[tex];
+        VERIFY_EXPR(pTex);
 
         // Get shader resource view from the texture
         m_TextureSRV[tex] = pTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
@@ -292,26 +281,9 @@ void Tutorial09_Quads::LoadTextures(std::vector<StateTransitionDesc>& Barriers)
         Barriers.emplace_back(pTex, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE);
     }
 
-    auto TexArrDesc      = TexLoaders[0]->GetTextureDesc();
-    TexArrDesc.ArraySize = NumTextures;
-    TexArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
-    TexArrDesc.Usage     = USAGE_DEFAULT;
-    TexArrDesc.BindFlags = BIND_SHADER_RESOURCE;
-
-    // Prepare texture array initialization data
-    std::vector<TextureSubResData> SubresData(TexArrDesc.ArraySize * TexArrDesc.MipLevels);
-    for (Uint32 slice = 0; slice < TexArrDesc.ArraySize; ++slice)
-    {
-        for (Uint32 mip = 0; mip < TexArrDesc.MipLevels; ++mip)
-        {
-            SubresData[slice * TexArrDesc.MipLevels + mip] = TexLoaders[slice]->GetSubresourceData(mip, 0);
-        }
-    }
-    TextureData InitData{SubresData.data(), TexArrDesc.MipLevels * TexArrDesc.ArraySize};
-
-    // Create the texture array
-    RefCntAutoPtr<ITexture> pTexArray;
-    m_pDevice->CreateTexture(TexArrDesc, &InitData, &pTexArray);
+    // Create the texture array from the same decoded images
+    RefCntAutoPtr<ITexture> pTexArray = m_TextureLoadService.CreateTextureArray(m_pDevice, TexLoaders, "Texture array");
+    VERIFY_EXPR(pTexArray);
     m_TexArraySRV = pTexArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
 
     // Transition all textures to shader resource state
@@ -365,9 +337,14 @@ void Tutorial09_Quads::Initialize(const SampleInitInfo& InitInfo)
     m_MaxThreads       = static_cast<int>(m_pDeferredContexts.size());
     m_NumWorkerThreads = std::min(m_NumWorkerThreads, m_MaxThreads);
 
+    // Start decoding the textures on worker threads while the pipeline states are created
+    TextureLoadInfo LoadInfo;
+    LoadInfo.IsSRGB       = true;
+    const auto TexLoaders = m_TextureLoadService.LoadAsync("DGLogo%u.png", NumTextures, LoadInfo);
+
     std::vector<StateTransitionDesc> Barriers;
     CreatePipelineStates(Barriers);
-    LoadTextures(Barriers);
+    LoadTextures(TexLoaders, Barriers);
     m_pImmediateContext->TransitionResourceStates(static_cast<Uint32>(Barriers.size()), Barriers.data());
 
     InitializeQuads();
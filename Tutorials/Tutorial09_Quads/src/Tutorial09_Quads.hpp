@@ -56,7 +56,7 @@ public:
 
 private:
     void CreatePipelineStates(std::vector<StateTransitionDesc>& Barriers);
-    void LoadTextures(std::vector<StateTransitionDesc>& Barriers);
+    void LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders, std::vector<StateTransitionDesc>& Barriers);
     void UpdateUI();
 
     void InitializeQuads();
@@ -0,0 +1,324 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "TextureUpdateBatcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "MapHelper.hpp"
+#include "Align.hpp"
+#include "DebugUtilities.hpp"
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+TextureUpdateBatcher::TextureUpdateBatcher(IRenderDevice* pDevice, const TextureDesc& Desc, const TextureSubResData& InitData, UPDATE_METHOD Method) :
+    // clang-format off
+    m_pDevice      {pDevice},
+    m_Desc         {Desc},
+    m_BytesPerTexel{Uint32{GetTextureFormatAttribs(Desc.Format).ComponentSize} * Uint32{GetTextureFormatAttribs(Desc.Format).NumComponents}},
+    m_Method       {Method}
+// clang-format on
+{
+    VERIFY(GetTextureFormatAttribs(m_Desc.Format).ComponentType != COMPONENT_TYPE_COMPRESSED, "Compressed textures are not supported");
+    VERIFY(m_Desc.Type == RESOURCE_DIM_TEX_2D && m_Desc.MipLevels == 1, "Only single-mip 2D textures are supported");
+    VERIFY(InitData.pData != nullptr, "Initial data must be provided in CPU memory");
+
+    m_CPUStride = Uint64{m_Desc.Width} * m_BytesPerTexel;
+    m_CPUData.resize(static_cast<size_t>(m_CPUStride * m_Desc.Height));
+    for (Uint32 row = 0; row < m_Desc.Height; ++row)
+    {
+        const auto* pSrcRow = static_cast<const Uint8*>(InitData.pData) + row * InitData.Stride;
+        memcpy(&m_CPUData[static_cast<size_t>(row * m_CPUStride)], pSrcRow, static_cast<size_t>(m_CPUStride));
+    }
+
+    CreateTexture();
+
+    // The staging buffer is large enough to hold the entire texture, so that any region fits into it
+    BufferDesc BuffDesc;
+    BuffDesc.Name           = "Texture update staging buffer";
+    BuffDesc.Usage          = USAGE_DYNAMIC;
+    BuffDesc.BindFlags      = BIND_VERTEX_BUFFER; // We do not really bind the buffer, but D3D11 wants at least one bind flag bit
+    BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    BuffDesc.Size           = AlignUp(m_CPUStride, Uint64{StagingStrideAlignment}) * m_Desc.Height;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pStagingBuffer);
+}
+
+bool TextureUpdateBatcher::IsMethodSupported(RENDER_DEVICE_TYPE DeviceType, UPDATE_METHOD Method)
+{
+    switch (Method)
+    {
+        case UPDATE_METHOD::UpdateTexture:
+            return true;
+
+        case UPDATE_METHOD::MapDiscard:
+            return (DeviceType == RENDER_DEVICE_TYPE_D3D11 ||
+                    DeviceType == RENDER_DEVICE_TYPE_D3D12 ||
+                    DeviceType == RENDER_DEVICE_TYPE_VULKAN ||
+                    DeviceType == RENDER_DEVICE_TYPE_METAL);
+
+        case UPDATE_METHOD::StagingCopy:
+            return (DeviceType == RENDER_DEVICE_TYPE_D3D12 ||
+                    DeviceType == RENDER_DEVICE_TYPE_VULKAN);
+
+        default:
+            UNEXPECTED("Unexpected update method");
+            return false;
+    }
+}
+
+void TextureUpdateBatcher::CreateTexture()
+{
+    auto Desc = m_Desc;
+    if (m_Method == UPDATE_METHOD::MapDiscard)
+    {
+        Desc.Usage          = USAGE_DYNAMIC;
+        Desc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    }
+    else
+    {
+        Desc.Usage          = USAGE_DEFAULT;
+        Desc.CPUAccessFlags = CPU_ACCESS_NONE;
+    }
+
+    TextureSubResData SubresData{m_CPUData.data(), m_CPUStride};
+    TextureData       InitData{&SubresData, 1};
+    m_pTexture.Release();
+    m_pDevice->CreateTexture(Desc, &InitData, &m_pTexture);
+
+    // The CPU copy already contains all pending updates
+    m_DirtyRegions.clear();
+    m_BytesDirtied = 0;
+}
+
+bool TextureUpdateBatcher::SetMethod(UPDATE_METHOD Method)
+{
+    // Only mapping requires a dynamic texture
+    const bool RecreateTexture = (Method == UPDATE_METHOD::MapDiscard) != (m_Method == UPDATE_METHOD::MapDiscard);
+
+    m_Method = Method;
+    if (RecreateTexture)
+        CreateTexture();
+
+    return RecreateTexture;
+}
+
+Uint8* TextureUpdateBatcher::AddDirtyRegion(const Box& Region, Uint64& Stride)
+{
+    VERIFY(Region.MinX < Region.MaxX && Region.MaxX <= m_Desc.Width &&
+               Region.MinY < Region.MaxY && Region.MaxY <= m_Desc.Height,
+           "Region is out of texture bounds");
+
+    m_DirtyRegions.push_back(Region);
+    m_BytesDirtied += GetRegionSize(Region);
+
+    Stride = m_CPUStride;
+    return &m_CPUData[static_cast<size_t>(Region.MinY * m_CPUStride + Region.MinX * m_BytesPerTexel)];
+}
+
+void TextureUpdateBatcher::MergeRegions()
+{
+    // Merging two regions may make the result mergeable with a region that was
+    // checked earlier, so repeat until no more regions can be merged.
+    bool Merged = true;
+    while (Merged)
+    {
+        Merged = false;
+        for (size_t i = 0; i < m_DirtyRegions.size(); ++i)
+        {
+            for (size_t j = i + 1; j < m_DirtyRegions.size();)
+            {
+                const auto& R0 = m_DirtyRegions[i];
+                const auto& R1 = m_DirtyRegions[j];
+
+                // Regions must overlap or share an edge
+                if (R0.MinX > R1.MaxX || R1.MinX > R0.MaxX ||
+                    R0.MinY > R1.MaxY || R1.MinY > R0.MaxY)
+                {
+                    ++j;
+                    continue;
+                }
+
+                const Box Union{
+                    std::min(R0.MinX, R1.MinX),
+                    std::max(R0.MaxX, R1.MaxX),
+                    std::min(R0.MinY, R1.MinY),
+                    std::max(R0.MaxY, R1.MaxY)
+                };
+                // Do not merge if the union contains more texels than uploading the two regions separately
+                if (GetRegionSize(Union) > GetRegionSize(R0) + GetRegionSize(R1))
+                {
+                    ++j;
+                    continue;
+                }
+
+                m_DirtyRegions[i] = Union;
+                m_DirtyRegions[j] = m_DirtyRegions.back();
+                m_DirtyRegions.pop_back();
+                Merged = true;
+            }
+        }
+    }
+}
+
+void TextureUpdateBatcher::CopyRegion(const Box& Region, Uint8* pDst, Uint64 DstStride) const
+{
+    const auto  RowSize = static_cast<size_t>(Uint64{Region.Width()} * m_BytesPerTexel);
+    const auto* pSrc    = &m_CPUData[static_cast<size_t>(Region.MinY * m_CPUStride + Region.MinX * m_BytesPerTexel)];
+    for (Uint32 row = 0; row < Region.Height(); ++row)
+        memcpy(pDst + row * DstStride, pSrc + row * m_CPUStride, RowSize);
+}
+
+void TextureUpdateBatcher::FlushUpdateTexture(IDeviceContext* pContext, MethodStats& Stats)
+{
+    for (const auto& Region : m_DirtyRegions)
+    {
+        // The source data may use any stride, so the region is uploaded directly from the CPU copy
+        TextureSubResData SubresData{&m_CPUData[static_cast<size_t>(Region.MinY * m_CPUStride + Region.MinX * m_BytesPerTexel)], m_CPUStride};
+        pContext->UpdateTexture(m_pTexture, 0, 0, Region, SubresData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        Stats.BytesUploaded += GetRegionSize(Region);
+    }
+    Stats.NumCommands += static_cast<Uint32>(m_DirtyRegions.size());
+}
+
+void TextureUpdateBatcher::FlushMapDiscard(IDeviceContext* pContext, MethodStats& Stats)
+{
+    if (m_pDevice->GetDeviceInfo().Type == RENDER_DEVICE_TYPE_D3D11)
+    {
+        // Direct3D11 can only discard the entire texture, so all texels have to be written
+        const Box                FullRegion{0, m_Desc.Width, 0, m_Desc.Height};
+        MappedTextureSubresource MappedSubres;
+        pContext->MapTextureSubresource(m_pTexture, 0, 0, MAP_WRITE, MAP_FLAG_DISCARD, nullptr, MappedSubres);
+        CopyRegion(FullRegion, static_cast<Uint8*>(MappedSubres.pData), MappedSubres.Stride);
+        pContext->UnmapTextureSubresource(m_pTexture, 0, 0);
+        Stats.BytesUploaded += GetRegionSize(FullRegion);
+        Stats.NumCommands   += 1;
+        return;
+    }
+
+    for (const auto& Region : m_DirtyRegions)
+    {
+        MappedTextureSubresource MappedSubres;
+        pContext->MapTextureSubresource(m_pTexture, 0, 0, MAP_WRITE, MAP_FLAG_DISCARD, &Region, MappedSubres);
+        CopyRegion(Region, static_cast<Uint8*>(MappedSubres.pData), MappedSubres.Stride);
+        pContext->UnmapTextureSubresource(m_pTexture, 0, 0);
+        Stats.BytesUploaded += GetRegionSize(Region);
+    }
+    Stats.NumCommands += static_cast<Uint32>(m_DirtyRegions.size());
+}
+
+void TextureUpdateBatcher::FlushStagingCopy(IDeviceContext* pContext, MethodStats& Stats)
+{
+    const auto BufferSize = m_pStagingBuffer->GetDesc().Size;
+
+    auto GetStagingStride = [this](const Box& Region) {
+        return AlignUp(Uint64{Region.Width()} * m_BytesPerTexel, Uint64{StagingStrideAlignment});
+    };
+
+    size_t FirstRegion = 0;
+    while (FirstRegion < m_DirtyRegions.size())
+    {
+        // Pack as many regions as fit into the staging buffer. Every map with MAP_FLAG_DISCARD
+        // allocates new memory, so the buffer can be refilled if the regions do not fit.
+        size_t EndRegion = FirstRegion;
+        {
+            MapHelper<Uint8> StagingData{pContext, m_pStagingBuffer, MAP_WRITE, MAP_FLAG_DISCARD};
+
+            Uint64 Offset = 0;
+            for (; EndRegion < m_DirtyRegions.size(); ++EndRegion)
+            {
+                const auto& Region = m_DirtyRegions[EndRegion];
+                const auto  Stride = GetStagingStride(Region);
+                if (Offset + Stride * Region.Height() > BufferSize)
+                    break;
+
+                CopyRegion(Region, static_cast<Uint8*>(StagingData) + Offset, Stride);
+                Offset = AlignUp(Offset + Stride * Region.Height(), Uint64{StagingOffsetAlignment});
+            }
+            VERIFY(EndRegion > FirstRegion, "The staging buffer must fit at least one region");
+        }
+
+        // Copy the regions from the staging buffer to the texture
+        Uint64 Offset = 0;
+        for (size_t r = FirstRegion; r < EndRegion; ++r)
+        {
+            const auto& Region = m_DirtyRegions[r];
+            const auto  Stride = GetStagingStride(Region);
+
+            TextureSubResData SubresData;
+            SubresData.pSrcBuffer = m_pStagingBuffer;
+            SubresData.SrcOffset  = Offset;
+            SubresData.Stride     = Stride;
+            pContext->UpdateTexture(m_pTexture, 0, 0, Region, SubresData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+            Offset = AlignUp(Offset + Stride * Region.Height(), Uint64{StagingOffsetAlignment});
+            Stats.BytesUploaded += GetRegionSize(Region);
+        }
+        Stats.NumCommands += static_cast<Uint32>(EndRegion - FirstRegion);
+
+        FirstRegion = EndRegion;
+    }
+}
+
+void TextureUpdateBatcher::Flush(IDeviceContext* pContext)
+{
+    if (m_DirtyRegions.empty())
+        return;
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    auto& Stats = m_Stats[static_cast<size_t>(m_Method)];
+    Stats.NumFlushes   += 1;
+    Stats.NumRegions   += static_cast<Uint32>(m_DirtyRegions.size());
+    Stats.BytesDirtied += m_BytesDirtied;
+
+    if (m_MergeRegions)
+        MergeRegions();
+
+    switch (m_Method)
+    {
+        case UPDATE_METHOD::UpdateTexture: FlushUpdateTexture(pContext, Stats); break;
+        case UPDATE_METHOD::MapDiscard: FlushMapDiscard(pContext, Stats); break;
+        case UPDATE_METHOD::StagingCopy: FlushStagingCopy(pContext, Stats); break;
+        default: UNEXPECTED("Unexpected update method");
+    }
+
+    m_DirtyRegions.clear();
+    m_BytesDirtied = 0;
+
+    Stats.CPUTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+void TextureUpdateBatcher::ResetStats()
+{
+    for (auto& Stats : m_Stats)
+        Stats = {};
+}
+
+} // namespace Diligent
@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Collects dirty regions of a single-mip 2D uncompressed texture over a frame and uploads them in one batch.
+// The batcher keeps a CPU copy of the texture and owns the GPU texture. The application writes new
+// texels to the CPU copy through AddDirtyRegion(), and Flush() uploads the dirty regions using the
+// selected update method. Overlapping or adjacent regions are merged when the merged region does not
+// contain more texels than the two original regions together.
+class TextureUpdateBatcher
+{
+public:
+    enum class UPDATE_METHOD : int
+    {
+        // One IDeviceContext::UpdateTexture() call per region
+        UpdateTexture,
+
+        // Map every region of a dynamic texture with MAP_FLAG_DISCARD.
+        // Direct3D11 only allows discarding the entire texture.
+        MapDiscard,
+
+        // Pack all regions into one dynamic staging buffer and copy them to the texture.
+        // Only supported in Direct3D12 and Vulkan.
+        StagingCopy,
+
+        Count
+    };
+
+    // Accumulated statistics of one update method
+    struct MethodStats
+    {
+        Uint32 NumFlushes    = 0;
+        Uint32 NumRegions    = 0; // Dirty regions added by the application
+        Uint32 NumCommands   = 0; // Update, map or copy commands issued
+        Uint64 BytesDirtied  = 0;
+        Uint64 BytesUploaded = 0;
+        double CPUTime       = 0; // Total CPU time spent in Flush(), in milliseconds
+    };
+
+    TextureUpdateBatcher(IRenderDevice* pDevice, const TextureDesc& Desc, const TextureSubResData& InitData, UPDATE_METHOD Method);
+
+    static bool IsMethodSupported(RENDER_DEVICE_TYPE DeviceType, UPDATE_METHOD Method);
+
+    // Switches to the new update method. If the method requires different texture usage, the texture is
+    // recreated from the CPU copy and the application must rebind it.
+    // Returns true if the texture has been recreated.
+    bool SetMethod(UPDATE_METHOD Method);
+
+    UPDATE_METHOD GetMethod() const { return m_Method; }
+
+    void SetMergeRegions(bool MergeRegions) { m_MergeRegions = MergeRegions; }
+    bool GetMergeRegions() const { return m_MergeRegions; }
+
+    // Marks the region as dirty and returns the pointer to its first texel in the CPU copy.
+    // The application must write Region.Width() x Region.Height() texels using the returned row stride.
+    Uint8* AddDirtyRegion(const Box& Region, Uint64& Stride);
+
+    // Uploads all dirty regions to the texture
+    void Flush(IDeviceContext* pContext);
+
+    ITexture* GetTexture() const { return m_pTexture; }
+
+    const MethodStats& GetStats(UPDATE_METHOD Method) const { return m_Stats[static_cast<size_t>(Method)]; }
+
+    void ResetStats();
+
+private:
+    void CreateTexture();
+    void MergeRegions();
+
+    void FlushUpdateTexture(IDeviceContext* pContext, MethodStats& Stats);
+    void FlushMapDiscard(IDeviceContext* pContext, MethodStats& Stats);
+    void FlushStagingCopy(IDeviceContext* pContext, MethodStats& Stats);
+
+    // Copies the region from the CPU copy to the destination memory
+    void CopyRegion(const Box& Region, Uint8* pDst, Uint64 DstStride) const;
+
+    Uint64 GetRegionSize(const Box& Region) const { return Uint64{Region.Width()} * Uint64{Region.Height()} * m_BytesPerTexel; }
+
+    // Direct3D12 requires row pitch and offset of buffer-to-texture copies to be aligned
+    static constexpr Uint32 StagingStrideAlignment = 256;
+    static constexpr Uint32 StagingOffsetAlignment = 512;
+
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+    RefCntAutoPtr<ITexture>      m_pTexture;
+    RefCntAutoPtr<IBuffer>       m_pStagingBuffer;
+
+    TextureDesc        m_Desc;
+    const Uint32       m_BytesPerTexel;
+    std::vector<Uint8> m_CPUData;
+    Uint64             m_CPUStride = 0;
+
+    std::vector<Box> m_DirtyRegions;
+    Uint64           m_BytesDirtied = 0;
+
+    UPDATE_METHOD m_Method       = UPDATE_METHOD::UpdateTexture;
+    bool          m_MergeRegions = true;
+
+    std::array<MethodStats, static_cast<size_t>(UPDATE_METHOD::Count)> m_Stats;
+};
+
+} // namespace Diligent
@@ -27,12 +27,14 @@
 
 #include <math.h>
 #include <cmath>
+#include <vector>
 
 #include "Tutorial11_ResourceUpdates.hpp"
 #include "MapHelper.hpp"
 #include "GraphicsUtilities.h"
 #include "TextureUtilities.h"
 #include "ColorConversion.h"
+#include "imgui.h"
 
 namespace Diligent
 {
@@ -311,7 +313,20 @@ void Tutorial11_ResourceUpdates::LoadTextures()
         }
 
         auto& Tex = m_Textures[i];
-        CreateTextureFromFile(FileName.c_str(), loadInfo, m_pDevice, &Tex);
+        if (i == 2)
+        {
+            // Texture update batcher keeps a CPU copy of the texture, so load the data to memory first
+            RefCntAutoPtr<ITextureLoader> pTexLoader;
+            CreateTextureLoaderFromFile(FileName.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, loadInfo, &pTexLoader);
+            VERIFY_EXPR(pTexLoader);
+            m_TextureUpdateBatcher = std::make_unique<TextureUpdateBatcher>(m_pDevice, pTexLoader->GetTextureDesc(), pTexLoader->GetSubresourceData(0, 0),
+                                                                            TextureUpdateBatcher::UPDATE_METHOD::UpdateTexture);
+            Tex = m_TextureUpdateBatcher->GetTexture();
+        }
+        else
+        {
+            CreateTextureFromFile(FileName.c_str(), loadInfo, m_pDevice, &Tex);
+        }
         // Get shader resource view from the texture
         auto TextureSRV = Tex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
 
@@ -332,16 +347,6 @@ void Tutorial11_ResourceUpdates::Initialize(const SampleInitInfo& InitInfo)
     CreateVertexBuffers();
     CreateIndexBuffer();
     LoadTextures();
-
-    {
-        BufferDesc VertBuffDesc;
-        VertBuffDesc.Name           = "Texture update buffer";
-        VertBuffDesc.Usage          = USAGE_DYNAMIC;
-        VertBuffDesc.BindFlags      = BIND_VERTEX_BUFFER; // We do not really bind the buffer, but D3D11 wants at least one bind flag bit
-        VertBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-        VertBuffDesc.Size           = MaxUpdateRegionSize * MaxUpdateRegionSize * 4;
-        m_pDevice->CreateBuffer(VertBuffDesc, nullptr, &m_TextureUpdateBuffer);
-    }
 }
 
 void Tutorial11_ResourceUpdates::DrawCube(const float4x4& WVPMatrix, Diligent::IBuffer* pVertexBuffer, Diligent::IShaderResourceBinding* pSRB)
@@ -436,33 +441,25 @@ void Tutorial11_ResourceUpdates::WriteDiamondPattern(Uint8* pData, Uint32 Width,
     }
 }
 
-void Tutorial11_ResourceUpdates::UpdateTexture(Uint32 TexIndex)
+void Tutorial11_ResourceUpdates::UpdateTexture()
 {
-    auto& Texture = *m_Textures[TexIndex];
-
-    static constexpr const Uint32 NumUpdates = 3;
-    for (Uint32 update = 0; update < NumUpdates; ++update)
+    const auto& TexDesc = m_TextureUpdateBatcher->GetTexture()->GetDesc();
+    for (int update = 0; update < m_NumTextureUpdateRegions; ++update)
     {
-        const auto& TexDesc = Texture.GetDesc();
-
         Uint32 Width  = std::uniform_int_distribution<Uint32>{2, MaxUpdateRegionSize}(m_gen);
         Uint32 Height = std::uniform_int_distribution<Uint32>{2, MaxUpdateRegionSize}(m_gen);
 
-        std::vector<Uint8> Data(size_t{Width} * size_t{Height} * 4u);
-        WriteStripPattern(Data.data(), Width, Height, size_t{Width} * 4u);
-
         Box UpdateBox;
         UpdateBox.MinX = std::uniform_int_distribution<Uint32>{0, TexDesc.Width - Width}(m_gen);
         UpdateBox.MinY = std::uniform_int_distribution<Uint32>{0, TexDesc.Height - Height}(m_gen);
         UpdateBox.MaxX = UpdateBox.MinX + Width;
         UpdateBox.MaxY = UpdateBox.MinY + Height;
 
-        TextureSubResData SubresData;
-        SubresData.Stride = size_t{Width} * 4u;
-        SubresData.pData  = Data.data();
-        Uint32 MipLevel   = 0;
-        Uint32 ArraySlice = 0;
-        m_pImmediateContext->UpdateTexture(&Texture, MipLevel, ArraySlice, UpdateBox, SubresData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        // Write the pattern directly to the CPU copy of the texture. The batcher
+        // uploads all dirty regions when it is flushed at the end of the frame.
+        Uint64 Stride = 0;
+        auto*  pData  = m_TextureUpdateBatcher->AddDirtyRegion(UpdateBox, Stride);
+        WriteStripPattern(pData, Width, Height, Stride);
     }
 }
 
@@ -527,9 +524,74 @@ void Tutorial11_ResourceUpdates::MapDynamicBuffer(Diligent::Uint32 BufferIndex)
 }
 
 
+void Tutorial11_ResourceUpdates::UpdateUI()
+{
+    using UPDATE_METHOD = TextureUpdateBatcher::UPDATE_METHOD;
+
+    static constexpr const char* MethodNames[] = {"UpdateTexture", "Map discard", "Staging copy"};
+    static_assert(_countof(MethodNames) == static_cast<size_t>(UPDATE_METHOD::Count), "Please update the method names");
+
+    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Texture updates", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        const auto DeviceType = m_pDevice->GetDeviceInfo().Type;
+
+        std::vector<const char*>   SupportedMethodNames;
+        std::vector<UPDATE_METHOD> SupportedMethods;
+        int                        SelectedMethod = 0;
+        for (int i = 0; i < static_cast<int>(UPDATE_METHOD::Count); ++i)
+        {
+            const auto Method = static_cast<UPDATE_METHOD>(i);
+            if (!TextureUpdateBatcher::IsMethodSupported(DeviceType, Method))
+                continue;
+            if (Method == m_TextureUpdateBatcher->GetMethod())
+                SelectedMethod = static_cast<int>(SupportedMethods.size());
+            SupportedMethodNames.push_back(MethodNames[i]);
+            SupportedMethods.push_back(Method);
+        }
+        if (ImGui::Combo("Update method", &SelectedMethod, SupportedMethodNames.data(), static_cast<int>(SupportedMethodNames.size())))
+        {
+            if (m_TextureUpdateBatcher->SetMethod(SupportedMethods[SelectedMethod]))
+            {
+                // The batcher created a texture with different usage
+                m_Textures[2] = m_TextureUpdateBatcher->GetTexture();
+                m_SRBs[2]->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(m_Textures[2]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+            }
+        }
+
+        bool MergeRegions = m_TextureUpdateBatcher->GetMergeRegions();
+        if (ImGui::Checkbox("Merge regions", &MergeRegions))
+            m_TextureUpdateBatcher->SetMergeRegions(MergeRegions);
+
+        ImGui::SliderInt("Regions per update", &m_NumTextureUpdateRegions, 1, 64);
+        ImGui::Checkbox("Update every frame", &m_UpdateTextureEveryFrame);
+
+        ImGui::Separator();
+        for (int i = 0; i < static_cast<int>(UPDATE_METHOD::Count); ++i)
+        {
+            const auto& Stats = m_TextureUpdateBatcher->GetStats(static_cast<UPDATE_METHOD>(i));
+            if (Stats.NumFlushes == 0)
+                continue;
+
+            // Report average values per update
+            const double NumFlushes = Stats.NumFlushes;
+            ImGui::Text("%s (%d updates)", MethodNames[i], static_cast<int>(Stats.NumFlushes));
+            ImGui::Text("  Regions: %.1f, commands: %.1f", Stats.NumRegions / NumFlushes, Stats.NumCommands / NumFlushes);
+            ImGui::Text("  Dirtied: %.1f KB, uploaded: %.1f KB (%.0f%%)",
+                        Stats.BytesDirtied / NumFlushes / 1024.0, Stats.BytesUploaded / NumFlushes / 1024.0,
+                        Stats.BytesDirtied > 0 ? 100.0 * Stats.BytesUploaded / Stats.BytesDirtied : 0.0);
+            ImGui::Text("  CPU time: %.1f us", Stats.CPUTime * 1000.0 / NumFlushes);
+        }
+        if (ImGui::Button("Reset statistics"))
+            m_TextureUpdateBatcher->ResetStats();
+    }
+    ImGui::End();
+}
+
 void Tutorial11_ResourceUpdates::Update(double CurrTime, double ElapsedTime)
 {
     SampleBase::Update(CurrTime, ElapsedTime);
+    UpdateUI();
 
     m_CurrTime = CurrTime;
 
@@ -543,11 +605,13 @@ void Tutorial11_ResourceUpdates::Update(double CurrTime, double ElapsedTime)
     MapDynamicBuffer(2);
 
     static constexpr const double UpdateTexturePeriod = 0.5;
-    if (CurrTime - m_LastTextureUpdateTime > UpdateTexturePeriod)
+    if (m_UpdateTextureEveryFrame || CurrTime - m_LastTextureUpdateTime > UpdateTexturePeriod)
     {
         m_LastTextureUpdateTime = CurrTime;
-        UpdateTexture(2);
+        UpdateTexture();
     }
+    // Upload all texture regions that were updated during this frame
+    m_TextureUpdateBatcher->Flush(m_pImmediateContext);
 
     static constexpr const double MapTexturePeriod = 0.05;
     const auto&                   deviceType       = m_pDevice->GetDeviceInfo().Type;
@@ -29,8 +29,10 @@
 
 #include <array>
 #include <random>
+#include <memory>
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "TextureUpdateBatcher.hpp"
 
 namespace Diligent
 {
@@ -50,11 +52,12 @@ private:
     void CreateVertexBuffers();
     void CreateIndexBuffer();
     void LoadTextures();
+    void UpdateUI();
 
     void WriteStripPattern(Uint8*, Uint32 Width, Uint32 Height, Uint64 Stride);
     void WriteDiamondPattern(Uint8*, Uint32 Width, Uint32 Height, Uint64 Stride);
 
-    void UpdateTexture(Uint32 TexIndex);
+    void UpdateTexture();
     void MapTexture(Uint32 TexIndex, bool MapEntireTexture);
     void UpdateBuffer(Uint32 BufferIndex);
     void MapDynamicBuffer(Uint32 BufferIndex);
@@ -63,7 +66,6 @@ private:
     RefCntAutoPtr<IBuffer>        m_CubeVertexBuffer[3];
     RefCntAutoPtr<IBuffer>        m_CubeIndexBuffer;
     RefCntAutoPtr<IBuffer>        m_VSConstants;
-    RefCntAutoPtr<IBuffer>        m_TextureUpdateBuffer;
 
     void DrawCube(const float4x4& WVPMatrix, IBuffer* pVertexBuffer, IShaderResourceBinding* pSRB);
 
@@ -74,6 +76,13 @@ private:
     std::array<RefCntAutoPtr<ITexture>, NumTextures>               m_Textures;
     std::array<RefCntAutoPtr<IShaderResourceBinding>, NumTextures> m_SRBs;
 
+    // Collects texture updates over a frame and uploads them in one batch.
+    // The batcher owns the texture that is updated by UpdateTexture().
+    std::unique_ptr<TextureUpdateBatcher> m_TextureUpdateBatcher;
+
+    int  m_NumTextureUpdateRegions = 3;
+    bool m_UpdateTextureEveryFrame = false;
+
     double       m_LastTextureUpdateTime = 0;
     double       m_LastBufferUpdateTime  = 0;
     double       m_LastMapTime           = 0;
@@ -57,6 +57,7 @@ void Tutorial12_RenderTarget::CreateCubePSO()
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice              = m_pDevice;
+    CubePsoCI.pStateCache          = m_pStateCache;
     CubePsoCI.RTVFormat            = RenderTargetFormat;
     CubePsoCI.DSVFormat            = DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory = pShaderSourceFactory;
@@ -53,6 +53,7 @@ void Tutorial13_ShadowMap::CreateCubePSO()
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice              = m_pDevice;
+    CubePsoCI.pStateCache          = m_pStateCache;
     CubePsoCI.RTVFormat            = m_pSwapChain->GetDesc().ColorBufferFormat;
     CubePsoCI.DSVFormat            = m_pSwapChain->GetDesc().DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory = pShaderSourceFactory;
@@ -107,7 +108,7 @@ void Tutorial13_ShadowMap::CreateCubePSO()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Cube Shadow VS";
         ShaderCI.FilePath        = "cube_shadow.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pShadowVS);
+        pShadowVS = CreateShader(ShaderCI);
     }
     PSOCreateInfo.pVS = pShadowVS;
 
@@ -140,7 +141,7 @@ void Tutorial13_ShadowMap::CreateCubePSO()
         PSOCreateInfo.GraphicsPipeline.RasterizerDesc.DepthClipEnable = False;
     }
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pCubeShadowPSO);
+    m_pCubeShadowPSO = CreateGraphicsPipelineState(PSOCreateInfo);
     m_pCubeShadowPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_VSConstants);
     m_pCubeShadowPSO->CreateShaderResourceBinding(&m_CubeShadowSRB, true);
 }
@@ -149,7 +150,8 @@ void Tutorial13_ShadowMap::ModifyEngineInitInfo(const ModifyEngineInitInfoAttrib
 {
     SampleBase::ModifyEngineInitInfo(Attribs);
 
-    Attribs.EngineCI.Features.DepthClamp = DEVICE_FEATURE_STATE_OPTIONAL;
+    Attribs.EngineCI.Features.DepthClamp       = DEVICE_FEATURE_STATE_OPTIONAL;
+    Attribs.EngineCI.Features.TimestampQueries = DEVICE_FEATURE_STATE_OPTIONAL;
 }
 
 void Tutorial13_ShadowMap::CreatePlanePSO()
@@ -204,7 +206,7 @@ void Tutorial13_ShadowMap::CreatePlanePSO()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Plane VS";
         ShaderCI.FilePath        = "plane.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pPlaneVS);
+        pPlaneVS = CreateShader(ShaderCI);
     }
 
     // Create plane pixel shader
@@ -214,7 +216,7 @@ void Tutorial13_ShadowMap::CreatePlanePSO()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Plane PS";
         ShaderCI.FilePath        = "plane.psh";
-        m_pDevice->CreateShader(ShaderCI, &pPlanePS);
+        pPlanePS = CreateShader(ShaderCI);
     }
 
     PSOCreateInfo.pVS = pPlaneVS;
@@ -249,7 +251,7 @@ void Tutorial13_ShadowMap::CreatePlanePSO()
     PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
     PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPlanePSO);
+    m_pPlanePSO = CreateGraphicsPipelineState(PSOCreateInfo);
 
     // Since we did not explicitly specify the type for 'Constants' variable, default
     // type (SHADER_RESOURCE_VARIABLE_TYPE_STATIC) will be used. Static variables never
@@ -307,7 +309,7 @@ void Tutorial13_ShadowMap::CreateShadowMapVisPSO()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Shadow Map Vis VS";
         ShaderCI.FilePath        = "shadow_map_vis.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pShadowMapVisVS);
+        pShadowMapVisVS = CreateShader(ShaderCI);
     }
 
     // Create shadow map visualization pixel shader
@@ -317,7 +319,7 @@ void Tutorial13_ShadowMap::CreateShadowMapVisPSO()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Shadow Map Vis PS";
         ShaderCI.FilePath        = "shadow_map_vis.psh";
-        m_pDevice->CreateShader(ShaderCI, &pShadowMapVisPS);
+        pShadowMapVisPS = CreateShader(ShaderCI);
     }
 
     PSOCreateInfo.pVS = pShadowMapVisVS;
@@ -340,7 +342,7 @@ void Tutorial13_ShadowMap::CreateShadowMapVisPSO()
     PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
     PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pShadowMapVisPSO);
+    m_pShadowMapVisPSO = CreateGraphicsPipelineState(PSOCreateInfo);
 }
 
 void Tutorial13_ShadowMap::UpdateUI()
@@ -355,12 +357,24 @@ void Tutorial13_ShadowMap::UpdateUI()
         if (ImGui::Combo("Shadow map size", &ShadowMapComboId,
                          "256\0"
                          "512\0"
-                         "1024\0\0"))
+                         "1024\0"
+                         "2048\0\0"))
         {
             m_ShadowMapSize = MinShadowMapSize << ShadowMapComboId;
             CreateShadowMap();
         }
         ImGui::gizmo3D("##LightDirection", m_LightDirection, ImGui::GetTextLineHeight() * 10);
+
+        if (ImGui::SliderInt("Static cubes", &m_NumStaticCubes, 0, 16))
+            InitStaticCubes();
+
+        if (ImGui::Checkbox("Cache static shadows", &m_CacheStaticShadows))
+            m_StaticShadowMapDirty = true;
+
+        if (m_pShadowPassTimer)
+            ImGui::Text("Shadow pass: %.3f ms", m_ShadowPassTime);
+        if (m_CacheStaticShadows)
+            ImGui::Text("Static shadow map updates: %u", m_NumStaticShadowUpdates);
     }
     ImGui::End();
 }
@@ -395,6 +409,10 @@ void Tutorial13_ShadowMap::Initialize(const SampleInitInfo& InitInfo)
     Barriers.emplace_back(CubeTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE);
 
     CreateShadowMap();
+    InitStaticCubes();
+
+    if (m_pDevice->GetDeviceInfo().Features.TimestampQueries)
+        m_pShadowPassTimer = std::make_unique<DurationQueryHelper>(m_pDevice, 4);
 
     m_pImmediateContext->TransitionResourceStates(static_cast<Uint32>(Barriers.size()), Barriers.data());
 }
@@ -413,6 +431,14 @@ void Tutorial13_ShadowMap::CreateShadowMap()
     m_ShadowMapSRV = ShadowMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
     m_ShadowMapDSV = ShadowMap->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
 
+    // The static shadow map is only rendered to and copied from
+    SMDesc.Name      = "Static shadow map";
+    SMDesc.BindFlags = BIND_DEPTH_STENCIL;
+    RefCntAutoPtr<ITexture> StaticShadowMap;
+    m_pDevice->CreateTexture(SMDesc, nullptr, &StaticShadowMap);
+    m_StaticShadowMapDSV   = StaticShadowMap->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+    m_StaticShadowMapDirty = true;
+
     // Create SRBs that use shadow map as mutable variable
     m_PlaneSRB.Release();
     m_pPlanePSO->CreateShaderResourceBinding(&m_PlaneSRB, true);
@@ -423,7 +449,23 @@ void Tutorial13_ShadowMap::CreateShadowMap()
     m_ShadowMapVisSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapSRV);
 }
 
-void Tutorial13_ShadowMap::RenderShadowMap()
+void Tutorial13_ShadowMap::InitStaticCubes()
+{
+    m_StaticCubeWorldMatrices.resize(m_NumStaticCubes);
+    for (int i = 0; i < m_NumStaticCubes; ++i)
+    {
+        const float Angle = 2.f * PI_F * static_cast<float>(i) / static_cast<float>(m_NumStaticCubes);
+        // Tall boxes standing on the plane
+        m_StaticCubeWorldMatrices[i] =
+            float4x4::Scale(0.5f, 1.f, 0.5f) *
+            float4x4::RotationY(Angle) *
+            float4x4::Translation(StaticCubeRingRadius * std::cos(Angle), -1.f, StaticCubeRingRadius * std::sin(Angle));
+    }
+
+    m_StaticShadowMapDirty = true;
+}
+
+void Tutorial13_ShadowMap::UpdateShadowMatrices()
 {
     float3 f3LightSpaceX, f3LightSpaceY, f3LightSpaceZ;
     f3LightSpaceZ = normalize(m_LightDirection);
@@ -448,6 +490,11 @@ void Tutorial13_ShadowMap::RenderShadowMap()
 
     float3 f3SceneCenter = float3(0, 0, 0);
     float  SceneRadius   = std::sqrt(3.f);
+    if (!m_StaticCubeWorldMatrices.empty())
+    {
+        // Extend the bounds to include the ring of static cubes
+        SceneRadius += StaticCubeRingRadius;
+    }
     float3 f3MinXYZ      = f3SceneCenter - float3(SceneRadius, SceneRadius, SceneRadius);
     float3 f3MaxXYZ      = f3SceneCenter + float3(SceneRadius, SceneRadius, SceneRadius * 5);
     float3 f3SceneExtent = f3MaxXYZ - f3MinXYZ;
@@ -472,18 +519,53 @@ void Tutorial13_ShadowMap::RenderShadowMap()
     float4x4 ShadowProjMatr = ScaleMatrix * ScaledBiasMatrix;
 
     // Adjust the world to light space transformation matrix
-    float4x4 WorldToLightProjSpaceMatr = WorldToLightViewSpaceMatr * ShadowProjMatr;
+    m_WorldToLightProjSpaceMatr = WorldToLightViewSpaceMatr * ShadowProjMatr;
 
     const auto& NDCAttribs    = DevInfo.GetNDCAttribs();
     float4x4    ProjToUVScale = float4x4::Scale(0.5f, NDCAttribs.YtoVScale, NDCAttribs.ZtoDepthScale);
     float4x4    ProjToUVBias  = float4x4::Translation(0.5f, 0.5f, NDCAttribs.GetZtoDepthBias());
 
-    m_WorldToShadowMapUVDepthMatr = WorldToLightProjSpaceMatr * ProjToUVScale * ProjToUVBias;
+    m_WorldToShadowMapUVDepthMatr = m_WorldToLightProjSpaceMatr * ProjToUVScale * ProjToUVBias;
+}
 
-    RenderCube(WorldToLightProjSpaceMatr, true);
+void Tutorial13_ShadowMap::RenderShadowMap()
+{
+    UpdateShadowMatrices();
+
+    if (m_CacheStaticShadows)
+    {
+        if (m_StaticShadowMapDirty || m_LightDirection != m_StaticShadowLightDir)
+        {
+            // The light or static casters have changed - re-render the static shadow map
+            m_pImmediateContext->SetRenderTargets(0, nullptr, m_StaticShadowMapDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_pImmediateContext->ClearDepthStencil(m_StaticShadowMapDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            for (const auto& WorldMatrix : m_StaticCubeWorldMatrices)
+                RenderCube(WorldMatrix, m_WorldToLightProjSpaceMatr, true);
+
+            m_StaticShadowLightDir = m_LightDirection;
+            m_StaticShadowMapDirty = false;
+            ++m_NumStaticShadowUpdates;
+        }
+
+        // Start from the static shadows and render dynamic casters on top
+        CopyTextureAttribs CopyAttribs{m_StaticShadowMapDSV->GetTexture(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                       m_ShadowMapDSV->GetTexture(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+        m_pImmediateContext->CopyTexture(CopyAttribs);
+        m_pImmediateContext->SetRenderTargets(0, nullptr, m_ShadowMapDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    else
+    {
+        m_pImmediateContext->SetRenderTargets(0, nullptr, m_ShadowMapDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pImmediateContext->ClearDepthStencil(m_ShadowMapDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        for (const auto& WorldMatrix : m_StaticCubeWorldMatrices)
+            RenderCube(WorldMatrix, m_WorldToLightProjSpaceMatr, true);
+    }
+
+    // The animated cube is the only dynamic caster
+    RenderCube(m_CubeWorldMatrix, m_WorldToLightProjSpaceMatr, true);
 }
 
-void Tutorial13_ShadowMap::RenderCube(const float4x4& CameraViewProj, bool IsShadowPass)
+void Tutorial13_ShadowMap::RenderCube(const float4x4& WorldMatrix, const float4x4& CameraViewProj, bool IsShadowPass)
 {
     // Update constant buffer
     {
@@ -495,8 +577,8 @@ void Tutorial13_ShadowMap::RenderCube(const float4x4& CameraViewProj, bool IsSha
         };
         // Map the buffer and write current world-view-projection matrix
         MapHelper<Constants> CBConstants(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        CBConstants->WorldViewProj = (m_CubeWorldMatrix * CameraViewProj).Transpose();
-        auto NormalMatrix          = m_CubeWorldMatrix.RemoveTranslation().Inverse();
+        CBConstants->WorldViewProj = (WorldMatrix * CameraViewProj).Transpose();
+        auto NormalMatrix          = WorldMatrix.RemoveTranslation().Inverse();
         // We need to do inverse-transpose, but we also need to transpose the matrix
         // before writing it to the buffer
         CBConstants->NormalTranform = NormalMatrix;
@@ -563,10 +645,15 @@ void Tutorial13_ShadowMap::RenderShadowMapVis()
 void Tutorial13_ShadowMap::Render()
 {
     // Render shadow map
-    m_pImmediateContext->SetRenderTargets(0, nullptr, m_ShadowMapDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->ClearDepthStencil(m_ShadowMapDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    if (m_pShadowPassTimer)
+        m_pShadowPassTimer->Begin(m_pImmediateContext);
+
     RenderShadowMap();
 
+    double Duration = 0;
+    if (m_pShadowPassTimer && m_pShadowPassTimer->End(m_pImmediateContext, Duration))
+        m_ShadowPassTime = Duration * 1000.0;
+
     // Bind main back buffer
     auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
     auto* pDSV = m_pSwapChain->GetDepthBufferDSV();
@@ -581,7 +668,9 @@ void Tutorial13_ShadowMap::Render()
     m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    RenderCube(m_CameraViewProjMatrix, false);
+    RenderCube(m_CubeWorldMatrix, m_CameraViewProjMatrix, false);
+    for (const auto& WorldMatrix : m_StaticCubeWorldMatrices)
+        RenderCube(WorldMatrix, m_CameraViewProjMatrix, false);
     RenderPlane();
     RenderShadowMapVis();
 }
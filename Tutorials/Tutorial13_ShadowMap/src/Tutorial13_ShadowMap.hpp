@@ -27,8 +27,12 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "DurationQueryHelper.hpp"
 
 namespace Diligent
 {
@@ -51,8 +55,10 @@ private:
     void CreateShadowMapVisPSO();
     void UpdateUI();
     void CreateShadowMap();
+    void InitStaticCubes();
+    void UpdateShadowMatrices();
     void RenderShadowMap();
-    void RenderCube(const float4x4& CameraViewProj, bool IsShadowPass);
+    void RenderCube(const float4x4& WorldMatrix, const float4x4& CameraViewProj, bool IsShadowPass);
     void RenderPlane();
     void RenderShadowMapVis();
 
@@ -71,12 +77,30 @@ private:
     RefCntAutoPtr<ITextureView>           m_ShadowMapDSV;
     RefCntAutoPtr<ITextureView>           m_ShadowMapSRV;
 
+    // Static casters are rendered into this texture only when the light or the casters change.
+    // Every frame, it is copied into the shadow map, and dynamic casters are rendered on top.
+    RefCntAutoPtr<ITextureView> m_StaticShadowMapDSV;
+
     float4x4       m_CubeWorldMatrix;
     float4x4       m_CameraViewProjMatrix;
+    float4x4       m_WorldToLightProjSpaceMatr;
     float4x4       m_WorldToShadowMapUVDepthMatr;
     float3         m_LightDirection  = normalize(float3(-0.49f, -0.60f, 0.64f));
     Uint32         m_ShadowMapSize   = 512;
     TEXTURE_FORMAT m_ShadowMapFormat = TEX_FORMAT_D16_UNORM;
+
+    // Static cubes placed in a ring around the animated cube
+    static constexpr float StaticCubeRingRadius = 3.5f;
+    std::vector<float4x4>  m_StaticCubeWorldMatrices;
+    int                    m_NumStaticCubes = 0;
+
+    bool   m_CacheStaticShadows     = true;
+    bool   m_StaticShadowMapDirty   = true;
+    float3 m_StaticShadowLightDir   = {}; // Light direction the static shadow map was rendered with
+    Uint32 m_NumStaticShadowUpdates = 0;
+
+    std::unique_ptr<DurationQueryHelper> m_pShadowPassTimer;
+    double                               m_ShadowPassTime = 0; // GPU time of the shadow pass, in milliseconds
 };
 
 } // namespace Diligent
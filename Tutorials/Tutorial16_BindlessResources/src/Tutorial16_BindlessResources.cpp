@@ -420,22 +420,16 @@ void Tutorial16_BindlessResources::CreateInstanceBuffer()
     PopulateInstanceBuffer();
 }
 
-void Tutorial16_BindlessResources::LoadTextures()
+void Tutorial16_BindlessResources::LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders)
 {
     // Load a texture array
-    IDeviceObject*          pTexSRVs[NumTextures] = {};
-    RefCntAutoPtr<ITexture> pTex[NumTextures];
-    StateTransitionDesc     Barriers[NumTextures];
+    // Wait for the textures to be decoded and create them
+    const auto          pTex                  = m_TextureLoadService.CreateTextures(m_pDevice, TexLoaders);
+    IDeviceObject*      pTexSRVs[NumTextures] = {};
+    StateTransitionDesc Barriers[NumTextures];
     for (int tex = 0; tex < NumTextures; ++tex)
     {
-        // Load current texture
-        TextureLoadInfo loadInfo;
-        loadInfo.IsSRGB = true;
-
-        std::stringstream FileNameSS;
-        FileNameSS << "DGLogo" << tex << ".png";
-        auto FileName = FileNameSS.str();
-        CreateTextureFromFile(FileName.c_str(), loadInfo, m_pDevice, &pTex[tex]);
+        VERIFY_EXPR(pTex[tex]);
 
         // Get shader resource view from the texture
         auto* pTextureSRV = pTex[tex]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
@@ -479,10 +473,15 @@ void Tutorial16_BindlessResources::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
+    // Start decoding the textures on worker threads while the pipeline state and buffers are created
+    TextureLoadInfo LoadInfo;
+    LoadInfo.IsSRGB       = true;
+    const auto TexLoaders = m_TextureLoadService.LoadAsync("DGLogo%u.png", NumTextures, LoadInfo);
+
     CreatePipelineState();
     CreateGeometryBuffers();
     CreateInstanceBuffer();
-    LoadTextures();
+    LoadTextures(TexLoaders);
 }
 
 void Tutorial16_BindlessResources::PopulateInstanceBuffer()
@@ -57,7 +57,7 @@ private:
     void CreatePipelineState();
     void CreateGeometryBuffers();
     void CreateInstanceBuffer();
-    void LoadTextures();
+    void LoadTextures(const std::vector<TextureLoadService::LoaderFuture>& TexLoaders);
     void UpdateUI();
     void PopulateInstanceBuffer();
 
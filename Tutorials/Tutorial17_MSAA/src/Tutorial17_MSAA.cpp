@@ -52,6 +52,7 @@ void Tutorial17_MSAA::CreateCubePSO()
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice              = m_pDevice;
+    CubePsoCI.pStateCache          = m_pStateCache;
     CubePsoCI.RTVFormat            = m_pSwapChain->GetDesc().ColorBufferFormat;
     CubePsoCI.DSVFormat            = DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory = pShaderSourceFactory;
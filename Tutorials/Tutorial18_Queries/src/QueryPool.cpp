@@ -0,0 +1,263 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "QueryPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+template <typename QueryDataType>
+Uint32 InitQueryData(std::vector<Uint8>& Data, Uint32 Count)
+{
+    // Query data structures are initialized with their query type
+    Data.resize(sizeof(QueryDataType) * Count);
+    for (Uint32 i = 0; i < Count; ++i)
+        new (&Data[sizeof(QueryDataType) * i]) QueryDataType{};
+    return sizeof(QueryDataType);
+}
+
+// Initializes Count query data structures of the given type and returns the size of one structure
+Uint32 InitQueryData(QUERY_TYPE Type, std::vector<Uint8>& Data, Uint32 Count)
+{
+    static_assert(QUERY_TYPE_NUM_TYPES == 6, "Please handle the new query type below");
+    switch (Type)
+    {
+        case QUERY_TYPE_OCCLUSION: return InitQueryData<QueryDataOcclusion>(Data, Count);
+        case QUERY_TYPE_BINARY_OCCLUSION: return InitQueryData<QueryDataBinaryOcclusion>(Data, Count);
+        case QUERY_TYPE_TIMESTAMP: return InitQueryData<QueryDataTimestamp>(Data, Count);
+        case QUERY_TYPE_PIPELINE_STATISTICS: return InitQueryData<QueryDataPipelineStatistics>(Data, Count);
+        case QUERY_TYPE_DURATION: return InitQueryData<QueryDataDuration>(Data, Count);
+
+        default:
+            UNEXPECTED("Unexpected query type");
+            return 0;
+    }
+}
+
+} // namespace
+
+QueryPool::QueryPool(IRenderDevice* pDevice, Uint32 MaxFramesInFlight) :
+    // clang-format off
+    m_pDevice          {pDevice},
+    m_MaxFramesInFlight{std::max(MaxFramesInFlight, 2u)}
+// clang-format on
+{
+    FenceDesc FDesc;
+    FDesc.Name = "Query pool frame fence";
+    m_pDevice->CreateFence(FDesc, &m_pFence);
+}
+
+void QueryPool::BeginFrame()
+{
+    VERIFY(!m_pCurrFrame, "EndFrame() has not been called for the previous frame");
+
+    ++m_FrameNumber;
+
+    // Resolve frames in order as long as the GPU has completed them
+    const auto CompletedFrame = m_pFence->GetCompletedValue();
+    while (!m_PendingFrames.empty() && m_PendingFrames.front()->FrameNumber <= CompletedFrame)
+    {
+        if (!ResolveFrame(*m_PendingFrames.front()))
+            break;
+        auto pFrame = std::move(m_PendingFrames.front());
+        m_PendingFrames.pop_front();
+        ReleaseFrame(std::move(pFrame));
+    }
+
+    // The current frame also counts as in flight
+    if (m_PendingFrames.size() + 1 > m_MaxFramesInFlight)
+    {
+        // The GPU is too far behind - wait for the oldest frame
+        auto pOldestFrame = std::move(m_PendingFrames.front());
+        m_PendingFrames.pop_front();
+        m_pFence->Wait(pOldestFrame->FrameNumber);
+        ++m_Stats.NumStalls;
+
+        if (!ResolveFrame(*pOldestFrame))
+        {
+            // Some query data is still not available - drop the results of the frame
+            for (size_t Type = 0; Type < NumQueryTypes; ++Type)
+            {
+                for (Uint32 i = 0; i < pOldestFrame->NumUsed[Type]; ++i)
+                    pOldestFrame->Queries[Type][i]->Invalidate();
+            }
+        }
+        ReleaseFrame(std::move(pOldestFrame));
+    }
+
+    if (!m_FreeFrames.empty())
+    {
+        m_pCurrFrame = std::move(m_FreeFrames.back());
+        m_FreeFrames.pop_back();
+    }
+    else
+    {
+        m_pCurrFrame = std::make_unique<FrameQueries>();
+    }
+    m_pCurrFrame->FrameNumber = m_FrameNumber;
+    m_pCurrFrame->NumUsed.fill(0);
+
+    m_Stats.NumFramesInFlight = static_cast<Uint32>(m_PendingFrames.size() + m_FreeFrames.size() + 1);
+}
+
+void QueryPool::EndFrame(IDeviceContext* pContext)
+{
+    VERIFY(m_pCurrFrame, "BeginFrame() has not been called");
+
+    // The frame's queries are resolved once the GPU has passed this signal
+    pContext->EnqueueSignal(m_pFence, m_pCurrFrame->FrameNumber);
+    m_PendingFrames.emplace_back(std::move(m_pCurrFrame));
+}
+
+IQuery* QueryPool::AllocateQuery(QUERY_TYPE Type, Uint32& Index)
+{
+    VERIFY(m_pCurrFrame, "Queries can only be allocated between BeginFrame() and EndFrame()");
+
+    auto& Queries = m_pCurrFrame->Queries[Type];
+    Index         = m_pCurrFrame->NumUsed[Type]++;
+    if (Index == Queries.size())
+    {
+        QueryDesc Desc;
+        Desc.Name = "Query pool query";
+        Desc.Type = Type;
+
+        RefCntAutoPtr<IQuery> pQuery;
+        m_pDevice->CreateQuery(Desc, &pQuery);
+        VERIFY_EXPR(pQuery);
+        Queries.emplace_back(std::move(pQuery));
+        ++m_Stats.NumQueriesAllocated;
+    }
+    return Queries[Index];
+}
+
+Uint32 QueryPool::BeginQuery(IDeviceContext* pContext, QUERY_TYPE Type)
+{
+    VERIFY(Type != QUERY_TYPE_TIMESTAMP, "Use WriteTimestamp() for timestamp queries");
+
+    Uint32 Index  = 0;
+    auto*  pQuery = AllocateQuery(Type, Index);
+    pContext->BeginQuery(pQuery);
+    return Index;
+}
+
+void QueryPool::EndQuery(IDeviceContext* pContext, QUERY_TYPE Type, Uint32 Index)
+{
+    VERIFY_EXPR(m_pCurrFrame && Index < m_pCurrFrame->NumUsed[Type]);
+    pContext->EndQuery(m_pCurrFrame->Queries[Type][Index]);
+}
+
+Uint32 QueryPool::WriteTimestamp(IDeviceContext* pContext)
+{
+    // Timestamp queries are only ended
+    Uint32 Index  = 0;
+    auto*  pQuery = AllocateQuery(QUERY_TYPE_TIMESTAMP, Index);
+    pContext->EndQuery(pQuery);
+    return Index;
+}
+
+bool QueryPool::ResolveFrame(FrameQueries& Frame)
+{
+    for (size_t Type = 0; Type < NumQueryTypes; ++Type)
+    {
+        const auto NumUsed = Frame.NumUsed[Type];
+        auto&      Data    = m_ScratchResults[Type];
+        if (NumUsed == 0)
+        {
+            Data.clear();
+            continue;
+        }
+
+        const auto DataSize = InitQueryData(static_cast<QUERY_TYPE>(Type), Data, NumUsed);
+
+        for (Uint32 i = 0; i < NumUsed; ++i)
+        {
+            // Do not invalidate the queries until the data of the whole frame is available
+            if (!Frame.Queries[Type][i]->GetData(&Data[size_t{DataSize} * i], DataSize, false))
+                return false;
+        }
+    }
+
+    Uint32 NumQueries = 0;
+    for (size_t Type = 0; Type < NumQueryTypes; ++Type)
+    {
+        for (Uint32 i = 0; i < Frame.NumUsed[Type]; ++i)
+            Frame.Queries[Type][i]->Invalidate();
+        NumQueries += Frame.NumUsed[Type];
+    }
+    std::swap(m_Results, m_ScratchResults);
+    m_ResultCounts = Frame.NumUsed;
+
+    const auto Latency = static_cast<Uint32>(m_FrameNumber - Frame.FrameNumber);
+    m_LatencyHistory.push_back(Latency);
+    if (m_LatencyHistory.size() > LatencyWindow)
+        m_LatencyHistory.pop_front();
+    m_MaxRecentLatency = *std::max_element(m_LatencyHistory.begin(), m_LatencyHistory.end());
+
+    m_Stats.NumQueriesPerFrame = NumQueries;
+    m_Stats.Latency            = Latency;
+
+    return true;
+}
+
+void QueryPool::ReleaseFrame(std::unique_ptr<FrameQueries>&& pFrame)
+{
+    // Keep enough frames to cover the recent GPU latency plus one frame to absorb jitter.
+    // Frames above this number are released to shrink the pool when the latency goes down.
+    const auto NumFrames   = m_PendingFrames.size() + m_FreeFrames.size();
+    const auto TargetCount = std::min<size_t>(m_MaxRecentLatency + 1, m_MaxFramesInFlight);
+    if (NumFrames < TargetCount)
+    {
+        m_FreeFrames.emplace_back(std::move(pFrame));
+    }
+    else
+    {
+        for (const auto& Queries : pFrame->Queries)
+            m_Stats.NumQueriesAllocated -= static_cast<Uint32>(Queries.size());
+        pFrame.reset();
+    }
+}
+
+bool QueryPool::GetResult(QUERY_TYPE Type, Uint32 Index, void* pData, Uint32 DataSize) const
+{
+    if (Index >= m_ResultCounts[Type])
+        return false;
+
+    const auto& Data = m_Results[Type];
+    VERIFY(Data.size() == size_t{DataSize} * m_ResultCounts[Type], "Data size does not match the query type");
+    memcpy(pData, &Data[size_t{DataSize} * Index], DataSize);
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <deque>
+#include <memory>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Query.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Allocates queries of all types in bulk for every frame and resolves them in batches.
+//
+// Every frame owns a set of queries that grows on demand to the largest number of queries used
+// in a frame. When a frame ends, the pool signals a fence, and the frame's queries are read back
+// together once the GPU has passed the fence. Frames that are not yet resolved stay in flight, so
+// a new set of queries is allocated when the GPU falls behind. The number of frames kept in flight
+// follows the observed GPU latency and is limited by MaxFramesInFlight, after which the pool waits
+// for the oldest frame.
+class QueryPool
+{
+public:
+    QueryPool(IRenderDevice* pDevice, Uint32 MaxFramesInFlight = 8);
+
+    // Starts a new frame. Resolves all frames whose GPU work has completed, and waits
+    // for the oldest frame if MaxFramesInFlight frames would otherwise be in flight.
+    void BeginFrame();
+
+    // Ends the current frame. All queries of the frame must be ended.
+    void EndFrame(IDeviceContext* pContext);
+
+    // Begins a query of the given type in the current frame and returns its index.
+    // The index identifies the query result in GetResult() once the frame is resolved.
+    Uint32 BeginQuery(IDeviceContext* pContext, QUERY_TYPE Type);
+
+    // Ends the query with the given index returned by BeginQuery().
+    void EndQuery(IDeviceContext* pContext, QUERY_TYPE Type, Uint32 Index);
+
+    // Writes a timestamp and returns the index of the timestamp query
+    Uint32 WriteTimestamp(IDeviceContext* pContext);
+
+    // Returns true if the last resolved frame contains the result of the query with the given
+    // index, and copies the result to pData. DataSize must match the query data structure size.
+    bool GetResult(QUERY_TYPE Type, Uint32 Index, void* pData, Uint32 DataSize) const;
+
+    // Returns the number of queries of the given type in the last resolved frame
+    Uint32 GetResultCount(QUERY_TYPE Type) const { return m_ResultCounts[Type]; }
+
+    struct Statistics
+    {
+        Uint32 NumQueriesPerFrame  = 0; // Queries used in the last resolved frame
+        Uint32 NumQueriesAllocated = 0;
+        Uint32 NumFramesInFlight   = 0; // Frames allocated by the pool, including the current one
+        Uint32 Latency             = 0; // GPU latency of the last resolved frame, in frames
+        Uint32 NumStalls           = 0; // Number of times the pool had to wait for the GPU
+    };
+    const Statistics& GetStats() const { return m_Stats; }
+
+private:
+    static constexpr size_t NumQueryTypes = QUERY_TYPE_NUM_TYPES;
+
+    // Number of resolved frames over which the maximum GPU latency is tracked
+    static constexpr size_t LatencyWindow = 64;
+
+    struct FrameQueries
+    {
+        Uint64 FrameNumber = 0;
+
+        std::array<std::vector<RefCntAutoPtr<IQuery>>, NumQueryTypes> Queries;
+        std::array<Uint32, NumQueryTypes>                             NumUsed = {};
+    };
+
+    // Reads back all queries of the frame. Returns false if some query data is not yet available.
+    bool ResolveFrame(FrameQueries& Frame);
+
+    IQuery* AllocateQuery(QUERY_TYPE Type, Uint32& Index);
+
+    void ReleaseFrame(std::unique_ptr<FrameQueries>&& pFrame);
+
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+    RefCntAutoPtr<IFence>        m_pFence;
+
+    const Uint32 m_MaxFramesInFlight;
+
+    Uint64 m_FrameNumber = 0;
+
+    std::unique_ptr<FrameQueries>              m_pCurrFrame;
+    std::deque<std::unique_ptr<FrameQueries>>  m_PendingFrames;
+    std::vector<std::unique_ptr<FrameQueries>> m_FreeFrames;
+
+    std::deque<Uint32> m_LatencyHistory;
+    Uint32             m_MaxRecentLatency = 0;
+
+    // Query data of the last resolved frame, tightly packed for every query type
+    std::array<std::vector<Uint8>, NumQueryTypes> m_Results;
+    std::array<Uint32, NumQueryTypes>             m_ResultCounts = {};
+    std::array<std::vector<Uint8>, NumQueryTypes> m_ScratchResults;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
@@ -26,6 +26,8 @@
  */
 
 #include <sstream>
+#include <cmath>
+#include <algorithm>
 
 #include "Tutorial18_Queries.hpp"
 #include "MapHelper.hpp"
@@ -52,6 +54,7 @@ void Tutorial18_Queries::CreateCubePSO()
 
     TexturedCube::CreatePSOInfo CubePsoCI;
     CubePsoCI.pDevice              = m_pDevice;
+    CubePsoCI.pStateCache          = m_pStateCache;
     CubePsoCI.RTVFormat            = m_pSwapChain->GetDesc().ColorBufferFormat;
     CubePsoCI.DSVFormat            = m_pSwapChain->GetDesc().DepthBufferFormat;
     CubePsoCI.pShaderSourceFactory = pShaderSourceFactory;
@@ -84,6 +87,28 @@ void Tutorial18_Queries::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs&
     Attribs.EngineCI.Features.TimestampQueries          = DEVICE_FEATURE_STATE_OPTIONAL;
     Attribs.EngineCI.Features.PipelineStatisticsQueries = DEVICE_FEATURE_STATE_OPTIONAL;
     Attribs.EngineCI.Features.DurationQueries           = DEVICE_FEATURE_STATE_OPTIONAL;
+
+#if D3D12_SUPPORTED || VULKAN_SUPPORTED
+    // Every frame in flight may use one occlusion query for the main cube and one for every test cube.
+    // Default query pool sizes are much smaller than that, so increase them. One extra frame accounts
+    // for the queries that have been released, but not yet returned to the pool.
+    const auto SetQueryPoolSizes = [](Uint32* QueryPoolSizes) {
+        constexpr Uint32 NumFrames = MaxQueryFramesInFlight + 1;
+
+        QueryPoolSizes[QUERY_TYPE_OCCLUSION]           = std::max(QueryPoolSizes[QUERY_TYPE_OCCLUSION], (MaxTestCubes + 1) * NumFrames);
+        QueryPoolSizes[QUERY_TYPE_PIPELINE_STATISTICS] = std::max(QueryPoolSizes[QUERY_TYPE_PIPELINE_STATISTICS], NumFrames);
+        QueryPoolSizes[QUERY_TYPE_TIMESTAMP]           = std::max(QueryPoolSizes[QUERY_TYPE_TIMESTAMP], 2 * NumFrames);
+        QueryPoolSizes[QUERY_TYPE_DURATION]            = std::max(QueryPoolSizes[QUERY_TYPE_DURATION], NumFrames);
+    };
+#endif
+#if D3D12_SUPPORTED
+    if (Attribs.DeviceType == RENDER_DEVICE_TYPE_D3D12)
+        SetQueryPoolSizes(static_cast<EngineD3D12CreateInfo&>(Attribs.EngineCI).QueryPoolSizes);
+#endif
+#if VULKAN_SUPPORTED
+    if (Attribs.DeviceType == RENDER_DEVICE_TYPE_VULKAN)
+        SetQueryPoolSizes(static_cast<EngineVkCreateInfo&>(Attribs.EngineCI).QueryPoolSizes);
+#endif
 }
 
 void Tutorial18_Queries::Initialize(const SampleInitInfo& InitInfo)
@@ -99,36 +124,9 @@ void Tutorial18_Queries::Initialize(const SampleInitInfo& InitInfo)
     // Set cube texture SRV in the SRB
     m_pCubeSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(m_CubeTextureSRV);
 
-    // Check query support
-    const auto& Features = m_pDevice->GetDeviceInfo().Features;
-    if (Features.PipelineStatisticsQueries)
-    {
-        QueryDesc queryDesc;
-        queryDesc.Name = "Pipeline statistics query";
-        queryDesc.Type = QUERY_TYPE_PIPELINE_STATISTICS;
-        m_pPipelineStatsQuery.reset(new ScopedQueryHelper{m_pDevice, queryDesc, 2});
-    }
-
-    if (Features.OcclusionQueries)
-    {
-        QueryDesc queryDesc;
-        queryDesc.Name = "Occlusion query";
-        queryDesc.Type = QUERY_TYPE_OCCLUSION;
-        m_pOcclusionQuery.reset(new ScopedQueryHelper{m_pDevice, queryDesc, 2});
-    }
-
-    if (Features.DurationQueries)
-    {
-        QueryDesc queryDesc;
-        queryDesc.Name = "Duration query";
-        queryDesc.Type = QUERY_TYPE_DURATION;
-        m_pDurationQuery.reset(new ScopedQueryHelper{m_pDevice, queryDesc, 2});
-    }
-
-    if (Features.TimestampQueries)
-    {
-        m_pDurationFromTimestamps.reset(new DurationQueryHelper{m_pDevice, 2});
-    }
+    // Query pool allocates queries of all supported types for every frame
+    // and keeps as many frames in flight as the GPU latency requires.
+    m_pQueryPool = std::make_unique<QueryPool>(m_pDevice, MaxQueryFramesInFlight);
 }
 
 void Tutorial18_Queries::UpdateUI()
@@ -136,10 +134,11 @@ void Tutorial18_Queries::UpdateUI()
     ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
     if (ImGui::Begin("Query data", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
-        if (m_pPipelineStatsQuery || m_pOcclusionQuery || m_pDurationQuery || m_pDurationFromTimestamps)
+        const auto& Features = m_pDevice->GetDeviceInfo().Features;
+        if (Features.PipelineStatisticsQueries || Features.OcclusionQueries || Features.DurationQueries || Features.TimestampQueries)
         {
             std::stringstream params_ss, values_ss;
-            if (m_pPipelineStatsQuery)
+            if (Features.PipelineStatisticsQueries)
             {
                 params_ss << "Input vertices" << std::endl
                           << "Input primitives" << std::endl
@@ -156,13 +155,13 @@ void Tutorial18_Queries::UpdateUI()
                           << m_PipelineStatsData.PSInvocations << std::endl;
             }
 
-            if (m_pOcclusionQuery)
+            if (Features.OcclusionQueries)
             {
                 params_ss << "Samples rendered" << std::endl;
                 values_ss << m_OcclusionData.NumSamples << std::endl;
             }
 
-            if (m_pDurationQuery)
+            if (Features.DurationQueries)
             {
                 if (m_DurationData.Frequency > 0)
                 {
@@ -176,7 +175,7 @@ void Tutorial18_Queries::UpdateUI()
                 }
             }
 
-            if (m_pDurationFromTimestamps)
+            if (Features.TimestampQueries)
             {
                 params_ss << "Duration from TS (mus)" << std::endl;
                 values_ss << static_cast<int>(m_DurationFromTimestamps * 1000000) << std::endl;
@@ -185,6 +184,19 @@ void Tutorial18_Queries::UpdateUI()
             ImGui::TextDisabled("%s", params_ss.str().c_str());
             ImGui::SameLine();
             ImGui::TextDisabled("%s", values_ss.str().c_str());
+
+            if (Features.OcclusionQueries)
+            {
+                ImGui::Separator();
+                ImGui::SliderInt("Test cubes", &m_NumTestCubes, 0, MaxTestCubes);
+                ImGui::Text("Visible test cubes: %d / %d", static_cast<int>(m_NumVisibleTestCubes), static_cast<int>(m_NumTestCubeResults));
+            }
+
+            const auto& PoolStats = m_pQueryPool->GetStats();
+            ImGui::Separator();
+            ImGui::Text("Queries per frame: %d (allocated: %d)", static_cast<int>(PoolStats.NumQueriesPerFrame), static_cast<int>(PoolStats.NumQueriesAllocated));
+            ImGui::Text("Frames in flight: %d, GPU latency: %d", static_cast<int>(PoolStats.NumFramesInFlight), static_cast<int>(PoolStats.Latency));
+            ImGui::Text("Stalls: %d", static_cast<int>(PoolStats.NumStalls));
         }
         else
         {
@@ -194,9 +206,65 @@ void Tutorial18_Queries::UpdateUI()
     ImGui::End();
 }
 
+void Tutorial18_Queries::ReadQueryResults()
+{
+    // The queries of the main cube are always the first queries of their type in the frame
+    m_pQueryPool->GetResult(QUERY_TYPE_PIPELINE_STATISTICS, 0, &m_PipelineStatsData, sizeof(m_PipelineStatsData));
+    m_pQueryPool->GetResult(QUERY_TYPE_OCCLUSION, 0, &m_OcclusionData, sizeof(m_OcclusionData));
+    m_pQueryPool->GetResult(QUERY_TYPE_DURATION, 0, &m_DurationData, sizeof(m_DurationData));
+
+    QueryDataTimestamp StartTimestamp, EndTimestamp;
+    if (m_pQueryPool->GetResult(QUERY_TYPE_TIMESTAMP, 0, &StartTimestamp, sizeof(StartTimestamp)) &&
+        m_pQueryPool->GetResult(QUERY_TYPE_TIMESTAMP, 1, &EndTimestamp, sizeof(EndTimestamp)) &&
+        EndTimestamp.Frequency > 0)
+    {
+        m_DurationFromTimestamps = static_cast<double>(EndTimestamp.Counter - StartTimestamp.Counter) / static_cast<double>(EndTimestamp.Frequency);
+    }
+
+    // The remaining occlusion queries belong to the test cubes
+    const auto NumOcclusionQueries = m_pQueryPool->GetResultCount(QUERY_TYPE_OCCLUSION);
+    m_NumTestCubeResults           = NumOcclusionQueries > 0 ? NumOcclusionQueries - 1 : 0;
+    m_NumVisibleTestCubes          = 0;
+    for (Uint32 i = 1; i < NumOcclusionQueries; ++i)
+    {
+        QueryDataOcclusion OcclusionData;
+        if (m_pQueryPool->GetResult(QUERY_TYPE_OCCLUSION, i, &OcclusionData, sizeof(OcclusionData)) && OcclusionData.NumSamples > 0)
+            ++m_NumVisibleTestCubes;
+    }
+}
+
+void Tutorial18_Queries::DrawTestCubes()
+{
+    // Place the cubes on a square grid behind the main cube
+    const int   GridSize = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(m_NumTestCubes))));
+    const float Spacing  = 5.f / static_cast<float>(std::max(GridSize, 1));
+
+    DrawIndexedAttribs DrawAttrs;
+    DrawAttrs.IndexType  = VT_UINT32;
+    DrawAttrs.NumIndices = 36;
+    DrawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL;
+    for (int i = 0; i < m_NumTestCubes; ++i)
+    {
+        const float x = (static_cast<float>(i % GridSize) + 0.5f) * Spacing - 2.5f;
+        const float y = (static_cast<float>(i / GridSize) + 0.5f) * Spacing - 2.5f;
+        {
+            MapHelper<float4x4> CBConstants(m_pImmediateContext, m_CubeVSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+            *CBConstants = (float4x4::Scale(Spacing * 0.3f) * float4x4::Translation(x, y, 2.f) * m_ViewProjMatrix).Transpose();
+        }
+
+        const auto Query = m_pQueryPool->BeginQuery(m_pImmediateContext, QUERY_TYPE_OCCLUSION);
+        m_pImmediateContext->DrawIndexed(DrawAttrs);
+        m_pQueryPool->EndQuery(m_pImmediateContext, QUERY_TYPE_OCCLUSION, Query);
+    }
+}
+
 // Render a frame
 void Tutorial18_Queries::Render()
 {
+    // Start a new query frame and read the results of the most recently resolved one
+    m_pQueryPool->BeginFrame();
+    ReadQueryResults();
+
     auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
     auto* pDSV = m_pSwapChain->GetDepthBufferDSV();
     // Clear the back buffer
@@ -233,29 +301,38 @@ void Tutorial18_Queries::Render()
     DrawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL; // Verify the state of vertex and index buffers
 
     // Begin supported queries
-    if (m_pPipelineStatsQuery)
-        m_pPipelineStatsQuery->Begin(m_pImmediateContext);
-    if (m_pOcclusionQuery)
-        m_pOcclusionQuery->Begin(m_pImmediateContext);
-    if (m_pDurationFromTimestamps)
-        m_pDurationFromTimestamps->Begin(m_pImmediateContext);
-    if (m_pDurationQuery)
-        m_pDurationQuery->Begin(m_pImmediateContext);
+    const auto& Features           = m_pDevice->GetDeviceInfo().Features;
+    Uint32      PipelineStatsQuery = 0;
+    Uint32      OcclusionQuery     = 0;
+    Uint32      DurationQuery      = 0;
+    if (Features.PipelineStatisticsQueries)
+        PipelineStatsQuery = m_pQueryPool->BeginQuery(m_pImmediateContext, QUERY_TYPE_PIPELINE_STATISTICS);
+    if (Features.OcclusionQueries)
+        OcclusionQuery = m_pQueryPool->BeginQuery(m_pImmediateContext, QUERY_TYPE_OCCLUSION);
+    if (Features.TimestampQueries)
+        m_pQueryPool->WriteTimestamp(m_pImmediateContext);
+    if (Features.DurationQueries)
+        DurationQuery = m_pQueryPool->BeginQuery(m_pImmediateContext, QUERY_TYPE_DURATION);
 
     m_pImmediateContext->DrawIndexed(DrawAttrs);
 
     // End queries
-    if (m_pDurationFromTimestamps)
-        m_pDurationFromTimestamps->End(m_pImmediateContext, m_DurationFromTimestamps);
+    if (Features.TimestampQueries)
+        m_pQueryPool->WriteTimestamp(m_pImmediateContext);
     // Note that recording the query itself may take measurable amount of time, so
-    // if m_pDurationFromTimestamps and m_pDurationQuery queries are nested, the results
-    // may noticeably differ.
-    if (m_pDurationQuery)
-        m_pDurationQuery->End(m_pImmediateContext, &m_DurationData, sizeof(m_DurationData));
-    if (m_pOcclusionQuery)
-        m_pOcclusionQuery->End(m_pImmediateContext, &m_OcclusionData, sizeof(m_OcclusionData));
-    if (m_pPipelineStatsQuery)
-        m_pPipelineStatsQuery->End(m_pImmediateContext, &m_PipelineStatsData, sizeof(m_PipelineStatsData));
+    // if timestamp and duration queries are nested, the results may noticeably differ.
+    if (Features.DurationQueries)
+        m_pQueryPool->EndQuery(m_pImmediateContext, QUERY_TYPE_DURATION, DurationQuery);
+    if (Features.OcclusionQueries)
+        m_pQueryPool->EndQuery(m_pImmediateContext, QUERY_TYPE_OCCLUSION, OcclusionQuery);
+    if (Features.PipelineStatisticsQueries)
+        m_pQueryPool->EndQuery(m_pImmediateContext, QUERY_TYPE_PIPELINE_STATISTICS, PipelineStatsQuery);
+
+    // Draw the test cubes after the main cube so that it occludes some of them
+    if (Features.OcclusionQueries)
+        DrawTestCubes();
+
+    m_pQueryPool->EndFrame(m_pImmediateContext);
 }
 
 void Tutorial18_Queries::Update(double CurrTime, double ElapsedTime)
@@ -276,7 +353,8 @@ void Tutorial18_Queries::Update(double CurrTime, double ElapsedTime)
     auto Proj = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
 
     // Compute world-view-projection matrix
-    m_WorldViewProjMatrix = CubeModelTransform * View * SrfPreTransform * Proj;
+    m_ViewProjMatrix      = View * SrfPreTransform * Proj;
+    m_WorldViewProjMatrix = CubeModelTransform * m_ViewProjMatrix;
 }
 
 } // namespace Diligent
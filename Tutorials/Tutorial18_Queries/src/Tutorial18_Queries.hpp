@@ -27,10 +27,11 @@
 
 #pragma once
 
+#include <memory>
+
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
-#include "ScopedQueryHelper.hpp"
-#include "DurationQueryHelper.hpp"
+#include "QueryPool.hpp"
 
 namespace Diligent
 {
@@ -50,6 +51,8 @@ public:
 private:
     void CreateCubePSO();
     void UpdateUI();
+    void ReadQueryResults();
+    void DrawTestCubes();
 
     RefCntAutoPtr<IPipelineState>         m_pCubePSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pCubeSRB;
@@ -58,17 +61,26 @@ private:
     RefCntAutoPtr<IBuffer>                m_CubeVSConstants;
     RefCntAutoPtr<ITextureView>           m_CubeTextureSRV;
 
-    std::unique_ptr<ScopedQueryHelper>   m_pPipelineStatsQuery;
-    std::unique_ptr<ScopedQueryHelper>   m_pOcclusionQuery;
-    std::unique_ptr<ScopedQueryHelper>   m_pDurationQuery;
-    std::unique_ptr<DurationQueryHelper> m_pDurationFromTimestamps;
+    std::unique_ptr<QueryPool> m_pQueryPool;
 
     QueryDataPipelineStatistics m_PipelineStatsData;
     QueryDataOcclusion          m_OcclusionData;
     QueryDataDuration           m_DurationData;
     double                      m_DurationFromTimestamps = 0;
 
+    // Occlusion culling experiment: a grid of small cubes behind the main cube,
+    // every cube is drawn inside its own occlusion query
+    static constexpr int MaxTestCubes = 4096;
+
+    // Maximum number of frames the query pool keeps in flight
+    static constexpr Uint32 MaxQueryFramesInFlight = 8;
+
+    int    m_NumTestCubes        = 0;
+    Uint32 m_NumTestCubeResults  = 0;
+    Uint32 m_NumVisibleTestCubes = 0;
+
     float4x4 m_WorldViewProjMatrix;
+    float4x4 m_ViewProjMatrix;
 };
 
 } // namespace Diligent
@@ -51,6 +51,19 @@ struct ShaderConstants
     int      ShowLightVolumes;
 };
 
+struct ClusterConstants
+{
+    uint4  Grid;
+    float4 Scale;
+    Uint32 LightsCount;
+    int    ShowHeatmap;
+    float  HeatmapScale;
+    float  Padding;
+};
+
+// Must match THREAD_GROUP_SIZE in the light binning shaders
+constexpr Uint32 BinningThreadGroupSize = 64;
+
 } // namespace
 
 SampleBase* CreateSample()
@@ -64,6 +77,10 @@ void Tutorial19_RenderPasses::ModifyEngineInitInfo(const ModifyEngineInitInfoAtt
 
     // We do not need the depth buffer from the swap chain in this sample
     Attribs.SCDesc.DepthBufferFormat = TEX_FORMAT_UNKNOWN;
+
+    // Clustered lighting requires compute shaders, GPU timings require timestamp queries
+    Attribs.EngineCI.Features.ComputeShaders   = DEVICE_FEATURE_STATE_OPTIONAL;
+    Attribs.EngineCI.Features.TimestampQueries = DEVICE_FEATURE_STATE_OPTIONAL;
 }
 
 
@@ -338,6 +355,146 @@ void Tutorial19_RenderPasses::CreateAmbientLightPSO(IShaderSourceInputStreamFact
     VERIFY_EXPR(m_pAmbientLightPSO != nullptr);
 }
 
+void Tutorial19_RenderPasses::CreateClusteredLightingPSOs(IShaderSourceInputStreamFactory* pShaderSourceFactory)
+{
+    CreateUniformBuffer(m_pDevice, sizeof(ClusterConstants), "Cluster constants CB", &m_Clusters.pConstantsCB);
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage = SHADER_SOURCE_LANGUAGE_HLSL;
+
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+
+    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}};
+    ShaderCI.Macros      = {Macros, _countof(Macros)};
+
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    // Create light binning compute shaders
+    RefCntAutoPtr<IShader> pClearClustersCS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Clear clusters CS";
+        ShaderCI.FilePath        = "clear_clusters.csh";
+        m_pDevice->CreateShader(ShaderCI, &pClearClustersCS);
+        VERIFY_EXPR(pClearClustersCS != nullptr);
+    }
+
+    RefCntAutoPtr<IShader> pBinLightsCS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Bin lights CS";
+        ShaderCI.FilePath        = "bin_lights.csh";
+        m_pDevice->CreateShader(ShaderCI, &pBinLightsCS);
+        VERIFY_EXPR(pBinLightsCS != nullptr);
+    }
+
+    {
+        ComputePipelineStateCreateInfo PSOCreateInfo;
+        PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+        PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+
+        PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+        // clang-format off
+        ShaderResourceVariableDesc Vars[] = 
+        {
+            {SHADER_TYPE_COMPUTE, "ShaderConstants",  SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+            {SHADER_TYPE_COMPUTE, "ClusterConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+        };
+        // clang-format on
+        PSODesc.ResourceLayout.Variables    = Vars;
+        PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+        PSODesc.Name      = "Clear clusters PSO";
+        PSOCreateInfo.pCS = pClearClustersCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_Clusters.pClearPSO);
+        VERIFY_EXPR(m_Clusters.pClearPSO != nullptr);
+        m_Clusters.pClearPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "ClusterConstants")->Set(m_Clusters.pConstantsCB);
+
+        PSODesc.Name      = "Bin lights PSO";
+        PSOCreateInfo.pCS = pBinLightsCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_Clusters.pBinLightsPSO);
+        VERIFY_EXPR(m_Clusters.pBinLightsPSO != nullptr);
+        m_Clusters.pBinLightsPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "ShaderConstants")->Set(m_pShaderConstantsCB);
+        m_Clusters.pBinLightsPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "ClusterConstants")->Set(m_Clusters.pConstantsCB);
+    }
+
+    GraphicsPipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&              PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name = "Clustered lighting PSO";
+
+    PSOCreateInfo.GraphicsPipeline.pRenderPass  = m_pRenderPass;
+    PSOCreateInfo.GraphicsPipeline.SubpassIndex = 1; // This PSO will be used within the second subpass
+
+    PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = False; // Disable depth
+
+    // Add the lighting to the ambient term
+    auto& RT0Blend          = PSOCreateInfo.GraphicsPipeline.BlendDesc.RenderTargets[0];
+    RT0Blend.BlendEnable    = True;
+    RT0Blend.BlendOp        = BLEND_OPERATION_ADD;
+    RT0Blend.SrcBlend       = BLEND_FACTOR_ONE;
+    RT0Blend.DestBlend      = BLEND_FACTOR_ONE;
+    RT0Blend.SrcBlendAlpha  = BLEND_FACTOR_ZERO;
+    RT0Blend.DestBlendAlpha = BLEND_FACTOR_ONE;
+
+    // Use the ambient light vertex shader to draw a full-screen quad
+    RefCntAutoPtr<IShader> pVS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Clustered lighting VS";
+        ShaderCI.FilePath        = "ambient_light.vsh";
+        m_pDevice->CreateShader(ShaderCI, &pVS);
+        VERIFY_EXPR(pVS != nullptr);
+    }
+
+    // Create a pixel shader
+    RefCntAutoPtr<IShader> pPS;
+    {
+        // For Vulkan and Metal, we will use a special GLSL shader that uses native input attachments
+        const auto UseGLSL =
+            m_pDevice->GetDeviceInfo().IsVulkanDevice() ||
+            m_pDevice->GetDeviceInfo().IsMetalDevice();
+
+        ShaderCI.SourceLanguage  = UseGLSL ? SHADER_SOURCE_LANGUAGE_GLSL : SHADER_SOURCE_LANGUAGE_HLSL;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Clustered lighting PS";
+        ShaderCI.FilePath        = UseGLSL ? "clustered_light_glsl.psh" : "clustered_light_hlsl.psh";
+        m_pDevice->CreateShader(ShaderCI, &pPS);
+        VERIFY_EXPR(pPS != nullptr);
+    }
+
+    PSOCreateInfo.pVS = pVS;
+    PSOCreateInfo.pPS = pPS;
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_PIXEL, "g_SubpassInputColor",   SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_SubpassInputDepthZ",  SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_Lights",              SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_ClusterLightCounts",  SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_ClusterLightIndices", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_Clusters.pLightingPSO);
+    VERIFY_EXPR(m_Clusters.pLightingPSO != nullptr);
+
+    m_Clusters.pLightingPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "ShaderConstants")->Set(m_pShaderConstantsCB);
+    m_Clusters.pLightingPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "ClusterConstants")->Set(m_Clusters.pConstantsCB);
+}
+
 
 void Tutorial19_RenderPasses::CreateRenderPass()
 {
@@ -450,6 +607,103 @@ void Tutorial19_RenderPasses::CreateLightsBuffer()
     VertBuffDesc.Size           = sizeof(LightAttribs) * m_LightsCount;
 
     m_pDevice->CreateBuffer(VertBuffDesc, nullptr, &m_pLightsBuffer);
+
+    if (m_pDevice->GetDeviceInfo().Features.ComputeShaders)
+    {
+        // Clustered lighting reads the lights in shaders, and vertex buffers can't
+        // be accessed through shader resource views on all backends.
+        m_Clusters.pLightsBuffer.Release();
+
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "Clustered lights buffer";
+        BuffDesc.Usage             = USAGE_DYNAMIC;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+        BuffDesc.CPUAccessFlags    = CPU_ACCESS_WRITE;
+        BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+        BuffDesc.ElementByteStride = sizeof(float4);
+        BuffDesc.Size              = sizeof(float4) * 2 * m_LightsCount;
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_Clusters.pLightsBuffer);
+
+        // Cluster resource bindings reference the lights buffer and need to be recreated
+        ReleaseClusterBuffers();
+    }
+}
+
+void Tutorial19_RenderPasses::CreateClusterBuffers()
+{
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+
+    m_Clusters.NumTilesX = (SCDesc.Width + ClusteredLighting::TileSize - 1) / ClusteredLighting::TileSize;
+    m_Clusters.NumTilesY = (SCDesc.Height + ClusteredLighting::TileSize - 1) / ClusteredLighting::TileSize;
+
+    const Uint32 NumClusters = m_Clusters.NumTilesX * m_Clusters.NumTilesY * ClusteredLighting::NumDepthSlices;
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Cluster light counts buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = Uint64{BuffDesc.ElementByteStride} * NumClusters;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_Clusters.pLightCounts);
+
+    BuffDesc.Name = "Cluster light indices buffer";
+    BuffDesc.Size = Uint64{BuffDesc.ElementByteStride} * NumClusters * ClusteredLighting::MaxLightsPerCluster;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_Clusters.pLightIndices);
+
+    RefCntAutoPtr<IBufferView> pLightCountsUAV;
+    RefCntAutoPtr<IBufferView> pLightIndicesUAV;
+    RefCntAutoPtr<IBufferView> pLightCountsSRV;
+    RefCntAutoPtr<IBufferView> pLightIndicesSRV;
+    {
+        BufferViewDesc ViewDesc;
+        ViewDesc.ViewType             = BUFFER_VIEW_UNORDERED_ACCESS;
+        ViewDesc.Format.ValueType     = VT_UINT32;
+        ViewDesc.Format.NumComponents = 1;
+        m_Clusters.pLightCounts->CreateView(ViewDesc, &pLightCountsUAV);
+        m_Clusters.pLightIndices->CreateView(ViewDesc, &pLightIndicesUAV);
+
+        ViewDesc.ViewType = BUFFER_VIEW_SHADER_RESOURCE;
+        m_Clusters.pLightCounts->CreateView(ViewDesc, &pLightCountsSRV);
+        m_Clusters.pLightIndices->CreateView(ViewDesc, &pLightIndicesSRV);
+    }
+
+    RefCntAutoPtr<IBufferView> pLightsSRV;
+    {
+        BufferViewDesc ViewDesc;
+        ViewDesc.ViewType             = BUFFER_VIEW_SHADER_RESOURCE;
+        ViewDesc.Format.ValueType     = VT_FLOAT32;
+        ViewDesc.Format.NumComponents = 4;
+        m_Clusters.pLightsBuffer->CreateView(ViewDesc, &pLightsSRV);
+    }
+
+    m_Clusters.pClearPSO->CreateShaderResourceBinding(&m_Clusters.pClearSRB, true);
+    m_Clusters.pClearSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ClusterLightCounts")->Set(pLightCountsUAV);
+
+    m_Clusters.pBinLightsPSO->CreateShaderResourceBinding(&m_Clusters.pBinLightsSRB, true);
+    m_Clusters.pBinLightsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Lights")->Set(pLightsSRV);
+    m_Clusters.pBinLightsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ClusterLightCounts")->Set(pLightCountsUAV);
+    m_Clusters.pBinLightsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ClusterLightIndices")->Set(pLightIndicesUAV);
+
+    // The G-buffer is created with the framebuffer, which must be requested first
+    VERIFY_EXPR(m_GBuffer.pColorBuffer && m_GBuffer.pDepthZBuffer);
+    m_Clusters.pLightingPSO->CreateShaderResourceBinding(&m_Clusters.pLightingSRB, true);
+    if (auto* pInputColor = m_Clusters.pLightingSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_SubpassInputColor"))
+        pInputColor->Set(m_GBuffer.pColorBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    if (auto* pInputDepthZ = m_Clusters.pLightingSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_SubpassInputDepthZ"))
+        pInputDepthZ->Set(m_GBuffer.pDepthZBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    m_Clusters.pLightingSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Lights")->Set(pLightsSRV);
+    m_Clusters.pLightingSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusterLightCounts")->Set(pLightCountsSRV);
+    m_Clusters.pLightingSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusterLightIndices")->Set(pLightIndicesSRV);
+}
+
+void Tutorial19_RenderPasses::ReleaseClusterBuffers()
+{
+    m_Clusters.pLightCounts.Release();
+    m_Clusters.pLightIndices.Release();
+    m_Clusters.pClearSRB.Release();
+    m_Clusters.pBinLightsSRB.Release();
+    m_Clusters.pLightingSRB.Release();
 }
 
 void Tutorial19_RenderPasses::UpdateUI()
@@ -465,8 +719,28 @@ void Tutorial19_RenderPasses::UpdateUI()
             CreateLightsBuffer();
         }
 
-        ImGui::Checkbox("Show light volumes", &m_ShowLightVolumes);
+        if (m_Clusters.pLightingPSO)
+            ImGui::Combo("Lighting", reinterpret_cast<int*>(&m_LightingMode), "Light volumes\0Clustered\0\0");
+
+        if (m_LightingMode == LIGHTING_MODE::LightVolumes)
+        {
+            ImGui::Checkbox("Show light volumes", &m_ShowLightVolumes);
+        }
+        else
+        {
+            ImGui::Checkbox("Show cluster heatmap", &m_Clusters.ShowHeatmap);
+            if (m_Clusters.ShowHeatmap)
+                ImGui::SliderInt("Heatmap range", &m_Clusters.HeatmapRange, 1, static_cast<int>(ClusteredLighting::MaxLightsPerCluster));
+        }
         ImGui::Checkbox("Animate lights", &m_AnimateLights);
+
+        if (m_pRenderPassTimer)
+        {
+            ImGui::Separator();
+            if (m_LightingMode == LIGHTING_MODE::Clustered)
+                ImGui::Text("Light binning: %.2f ms", m_BinningTime);
+            ImGui::Text("Render pass:   %.2f ms", m_RenderPassTime);
+        }
     }
     ImGui::End();
 }
@@ -493,6 +767,14 @@ void Tutorial19_RenderPasses::Initialize(const SampleInitInfo& InitInfo)
     CreateCubePSO(pShaderSourceFactory);
     CreateLightVolumePSO(pShaderSourceFactory);
     CreateAmbientLightPSO(pShaderSourceFactory);
+    if (m_pDevice->GetDeviceInfo().Features.ComputeShaders)
+        CreateClusteredLightingPSOs(pShaderSourceFactory);
+
+    if (m_pDevice->GetDeviceInfo().Features.TimestampQueries)
+    {
+        m_pBinningTimer    = std::make_unique<DurationQueryHelper>(m_pDevice, 4);
+        m_pRenderPassTimer = std::make_unique<DurationQueryHelper>(m_pDevice, 4);
+    }
 
     // Transition all resources to required states as no transitions are allowed within the render pass.
     StateTransitionDesc Barriers[] = //
@@ -509,10 +791,16 @@ void Tutorial19_RenderPasses::Initialize(const SampleInitInfo& InitInfo)
 
 void Tutorial19_RenderPasses::ReleaseWindowResources()
 {
-    m_GBuffer = {};
+    // Return G-buffer textures to the pool. The pool destroys them at the end
+    // of the frame once the G-buffer of the new size has been created
+    m_TransientTextures.Release(m_GBuffer.pColorBuffer);
+    m_TransientTextures.Release(m_GBuffer.pOpenGLOffsreenColorBuffer);
+    m_TransientTextures.Release(m_GBuffer.pDepthZBuffer);
+    m_TransientTextures.Release(m_GBuffer.pDepthBuffer);
     m_FramebufferCache.clear();
     m_pLightVolumeSRB.Release();
     m_pAmbientLightSRB.Release();
+    ReleaseClusterBuffers();
 }
 
 void Tutorial19_RenderPasses::PreWindowResize()
@@ -566,7 +854,7 @@ RefCntAutoPtr<IFramebuffer> Tutorial19_RenderPasses::CreateFramebuffer(ITextureV
     TexDesc.ClearValue.Color[3] = 1.f;
 
     if (!m_GBuffer.pColorBuffer)
-        m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pColorBuffer);
+        m_GBuffer.pColorBuffer = m_TransientTextures.Acquire(m_pDevice, TexDesc);
 
     // OpenGL does not allow combining swap chain render target with any
     // other render target, so we have to create an auxiliary texture.
@@ -575,7 +863,8 @@ RefCntAutoPtr<IFramebuffer> Tutorial19_RenderPasses::CreateFramebuffer(ITextureV
         TexDesc.Name      = "OpenGL Offscreen Render Target";
         TexDesc.Format    = SCDesc.ColorBufferFormat;
         TexDesc.MiscFlags = MISC_TEXTURE_FLAG_NONE;
-        m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pOpenGLOffsreenColorBuffer);
+        m_TransientTextures.Release(m_GBuffer.pOpenGLOffsreenColorBuffer);
+        m_GBuffer.pOpenGLOffsreenColorBuffer = m_TransientTextures.Acquire(m_pDevice, TexDesc);
         pDstRenderTarget = m_GBuffer.pOpenGLOffsreenColorBuffer->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
     }
 
@@ -594,7 +883,7 @@ RefCntAutoPtr<IFramebuffer> Tutorial19_RenderPasses::CreateFramebuffer(ITextureV
     TexDesc.ClearValue.Color[3] = 1.f;
 
     if (!m_GBuffer.pDepthZBuffer)
-        m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pDepthZBuffer);
+        m_GBuffer.pDepthZBuffer = m_TransientTextures.Acquire(m_pDevice, TexDesc);
 
 
     TexDesc.Name      = "Depth buffer";
@@ -610,7 +899,7 @@ RefCntAutoPtr<IFramebuffer> Tutorial19_RenderPasses::CreateFramebuffer(ITextureV
     TexDesc.ClearValue.DepthStencil.Stencil = 0;
 
     if (!m_GBuffer.pDepthBuffer)
-        m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pDepthBuffer);
+        m_GBuffer.pDepthBuffer = m_TransientTextures.Acquire(m_pDevice, TexDesc);
 
 
     ITextureView* pAttachments[] = //
@@ -713,6 +1002,19 @@ void Tutorial19_RenderPasses::ApplyLighting()
         m_pImmediateContext->Draw(DrawAttrs);
     }
 
+    if (m_LightingMode == LIGHTING_MODE::Clustered)
+    {
+        // Shade every pixel against the lights of its cluster with a single full-screen draw
+        m_pImmediateContext->SetPipelineState(m_Clusters.pLightingPSO);
+        m_pImmediateContext->CommitShaderResources(m_Clusters.pLightingSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+        DrawAttribs DrawAttrs;
+        DrawAttrs.NumVertices = 4;
+        DrawAttrs.Flags       = DRAW_FLAG_VERIFY_ALL;
+        m_pImmediateContext->Draw(DrawAttrs);
+        return;
+    }
+
     {
         // Map the cube's constant buffer and fill it in with its view-projection matrix
         MapHelper<LightAttribs> LightsData(m_pImmediateContext, m_pLightsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
@@ -742,6 +1044,67 @@ void Tutorial19_RenderPasses::ApplyLighting()
     }
 }
 
+void Tutorial19_RenderPasses::BinLights()
+{
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+
+    const Uint32 NumClusters = m_Clusters.NumTilesX * m_Clusters.NumTilesY * ClusteredLighting::NumDepthSlices;
+
+    {
+        // The camera is static, so depth slices only need to cover the volume the lights move in
+        constexpr float MinDepth = CameraDistance - GridDim - 0.5f;
+        constexpr float MaxDepth = CameraDistance + GridDim + 0.5f;
+
+        MapHelper<ClusterConstants> Constants(m_pImmediateContext, m_Clusters.pConstantsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+        Constants->Grid = uint4{
+            m_Clusters.NumTilesX,
+            m_Clusters.NumTilesY,
+            ClusteredLighting::NumDepthSlices,
+            ClusteredLighting::MaxLightsPerCluster //
+        };
+        Constants->Scale = float4{
+            static_cast<float>(SCDesc.Width) / static_cast<float>(ClusteredLighting::TileSize),
+            static_cast<float>(SCDesc.Height) / static_cast<float>(ClusteredLighting::TileSize),
+            MinDepth,
+            static_cast<float>(ClusteredLighting::NumDepthSlices) / (MaxDepth - MinDepth) //
+        };
+        Constants->LightsCount  = static_cast<Uint32>(m_LightsCount);
+        Constants->ShowHeatmap  = m_Clusters.ShowHeatmap ? 1 : 0;
+        Constants->HeatmapScale = 1.f / static_cast<float>(std::max(m_Clusters.HeatmapRange, 1));
+    }
+
+    {
+        MapHelper<float4> LightsData(m_pImmediateContext, m_Clusters.pLightsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+        float4*           pLights = LightsData;
+        for (const auto& Light : m_Lights)
+        {
+            *(pLights++) = float4{Light.Location, Light.Size};
+            *(pLights++) = float4{Light.Color, 0.f};
+        }
+    }
+
+    DispatchComputeAttribs DispatchAttribs;
+
+    DispatchAttribs.ThreadGroupCountX = (NumClusters + BinningThreadGroupSize - 1) / BinningThreadGroupSize;
+    m_pImmediateContext->SetPipelineState(m_Clusters.pClearPSO);
+    m_pImmediateContext->CommitShaderResources(m_Clusters.pClearSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->DispatchCompute(DispatchAttribs);
+
+    DispatchAttribs.ThreadGroupCountX = (static_cast<Uint32>(m_LightsCount) + BinningThreadGroupSize - 1) / BinningThreadGroupSize;
+    m_pImmediateContext->SetPipelineState(m_Clusters.pBinLightsPSO);
+    m_pImmediateContext->CommitShaderResources(m_Clusters.pBinLightsSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->DispatchCompute(DispatchAttribs);
+
+    // No state transitions are allowed inside the render pass, so transition
+    // the cluster buffers for reading in the lighting subpass now.
+    StateTransitionDesc Barriers[] = //
+        {
+            {m_Clusters.pLightCounts, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE},
+            {m_Clusters.pLightIndices, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE} //
+        };
+    m_pImmediateContext->TransitionResourceStates(_countof(Barriers), Barriers);
+}
+
 void Tutorial19_RenderPasses::UpdateLights(float fElapsedTime)
 {
     float3 VolumeMin{-static_cast<float>(GridDim), -static_cast<float>(GridDim), -static_cast<float>(GridDim)};
@@ -812,6 +1175,24 @@ void Tutorial19_RenderPasses::Render()
 
     auto* pFramebuffer = GetCurrentFramebuffer();
 
+    if (m_LightingMode == LIGHTING_MODE::Clustered)
+    {
+        if (!m_Clusters.pLightCounts)
+            CreateClusterBuffers();
+
+        if (m_pBinningTimer)
+            m_pBinningTimer->Begin(m_pImmediateContext);
+
+        BinLights();
+
+        double Duration = 0;
+        if (m_pBinningTimer && m_pBinningTimer->End(m_pImmediateContext, Duration))
+            m_BinningTime = Duration * 1000.0;
+    }
+
+    if (m_pRenderPassTimer)
+        m_pRenderPassTimer->Begin(m_pImmediateContext);
+
     BeginRenderPassAttribs RPBeginInfo;
     RPBeginInfo.pRenderPass  = m_pRenderPass;
     RPBeginInfo.pFramebuffer = pFramebuffer;
@@ -856,6 +1237,10 @@ void Tutorial19_RenderPasses::Render()
 
     m_pImmediateContext->EndRenderPass();
 
+    double Duration = 0;
+    if (m_pRenderPassTimer && m_pRenderPassTimer->End(m_pImmediateContext, Duration))
+        m_RenderPassTime = Duration * 1000.0;
+
     if (m_pDevice->GetDeviceInfo().IsGLDevice())
     {
         // In OpenGL we now have to copy our off-screen buffer to the default framebuffer
@@ -876,7 +1261,7 @@ void Tutorial19_RenderPasses::Update(double CurrTime, double ElapsedTime)
     if (m_AnimateLights)
         UpdateLights(static_cast<float>(ElapsedTime));
 
-    float4x4 View = float4x4::Translation(0.0f, 0.0f, 25.0f);
+    float4x4 View = float4x4::Translation(0.0f, 0.0f, CameraDistance);
 
     // Get pretransform matrix that rotates the scene according the surface orientation
     auto SrfPreTransform = GetSurfacePretransformMatrix(float3{0, 0, 1});
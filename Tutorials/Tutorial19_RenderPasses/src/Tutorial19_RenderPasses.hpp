@@ -27,11 +27,13 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "DurationQueryHelper.hpp"
 
 namespace Diligent
 {
@@ -55,6 +57,10 @@ private:
     void CreateCubePSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
     void CreateLightVolumePSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
     void CreateAmbientLightPSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
+    void CreateClusteredLightingPSOs(IShaderSourceInputStreamFactory* pShaderSourceFactory);
+    void CreateClusterBuffers();
+    void ReleaseClusterBuffers();
+    void BinLights();
     void UpdateUI();
     void CreateRenderPass();
     void DrawScene();
@@ -92,6 +98,46 @@ private:
     RefCntAutoPtr<IPipelineState>         m_pAmbientLightPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pAmbientLightSRB;
 
+    enum class LIGHTING_MODE : int
+    {
+        LightVolumes, // Draw one light volume instance per light
+        Clustered     // Bin lights into clusters and shade every pixel with a single full-screen draw
+    };
+    LIGHTING_MODE m_LightingMode = LIGHTING_MODE::LightVolumes;
+
+    // Clustered lighting resources. A compute pass bins the lights into screen tiles x depth slices,
+    // and the lighting subpass loops over the lights of the pixel's cluster only.
+    struct ClusteredLighting
+    {
+        static constexpr Uint32 TileSize            = 32;
+        static constexpr Uint32 NumDepthSlices      = 16;
+        static constexpr Uint32 MaxLightsPerCluster = 128;
+
+        Uint32 NumTilesX = 0;
+        Uint32 NumTilesY = 0;
+
+        RefCntAutoPtr<IBuffer> pConstantsCB;
+        RefCntAutoPtr<IBuffer> pLightsBuffer; // Every light is packed into two float4 elements: location and size, color
+        RefCntAutoPtr<IBuffer> pLightCounts;  // Number of lights in every cluster
+        RefCntAutoPtr<IBuffer> pLightIndices; // MaxLightsPerCluster light indices for every cluster
+
+        RefCntAutoPtr<IPipelineState>         pClearPSO;
+        RefCntAutoPtr<IShaderResourceBinding> pClearSRB;
+        RefCntAutoPtr<IPipelineState>         pBinLightsPSO;
+        RefCntAutoPtr<IShaderResourceBinding> pBinLightsSRB;
+        RefCntAutoPtr<IPipelineState>         pLightingPSO;
+        RefCntAutoPtr<IShaderResourceBinding> pLightingSRB;
+
+        bool ShowHeatmap  = false;
+        int  HeatmapRange = 32; // Number of lights in a cluster that maps to the hottest color
+    } m_Clusters;
+
+    // GPU time of the light binning compute pass and of the whole render pass, in milliseconds
+    std::unique_ptr<DurationQueryHelper> m_pBinningTimer;
+    std::unique_ptr<DurationQueryHelper> m_pRenderPassTimer;
+    double                               m_BinningTime    = 0;
+    double                               m_RenderPassTime = 0;
+
     struct GBuffer
     {
         RefCntAutoPtr<ITexture> pColorBuffer;
@@ -110,7 +156,8 @@ private:
     bool m_ShowLightVolumes = false;
     bool m_AnimateLights    = true;
 
-    constexpr static int GridDim = 7;
+    constexpr static int   GridDim        = 7;
+    constexpr static float CameraDistance = 25.f;
 
     std::unordered_map<ITextureView*, RefCntAutoPtr<IFramebuffer>> m_FramebufferCache;
 
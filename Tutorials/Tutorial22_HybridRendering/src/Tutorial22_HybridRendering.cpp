@@ -420,20 +420,20 @@ void Tutorial22_HybridRendering::UpdateTLAS()
         m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_Scene.TLASInstancesBuffer);
     }
 
-    // Setup instances
-    std::vector<TLASBuildInstanceData> Instances(NumInstances);
-    std::vector<String>                InstanceNames(NumInstances);
+    // Setup instances.
+    // Instance data and names are only needed until the TLAS is built, so they are
+    // allocated from the frame arena to avoid heap allocations every frame.
+    auto& Arena = FrameArena::GetThreadArena();
+
+    FrameVector<TLASBuildInstanceData> Instances(NumInstances);
     for (Uint32 i = 0; i < NumInstances; ++i)
     {
         const auto& Obj      = m_Scene.Objects[i];
         auto&       Inst     = Instances[i];
-        auto&       Name     = InstanceNames[i];
         const auto& Mesh     = m_Scene.Meshes[Obj.MeshId];
         const auto  ModelMat = Obj.ModelMat.Transpose();
 
-        Name = Mesh.Name + " Instance (" + std::to_string(i) + ")";
-
-        Inst.InstanceName = Name.c_str();
+        Inst.InstanceName = Arena.Format("%s Instance (%u)", Mesh.Name.c_str(), i);
         Inst.pBLAS        = Mesh.BLAS;
         Inst.Mask         = 0xFF;
 
@@ -550,7 +550,7 @@ void Tutorial22_HybridRendering::CreateRasterizationPSO(IShaderSourceInputStream
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Rasterization VS";
         ShaderCI.FilePath        = "Rasterization.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pVS);
+        pVS = CreateShader(ShaderCI);
     }
 
     RefCntAutoPtr<IShader> pPS;
@@ -559,7 +559,7 @@ void Tutorial22_HybridRendering::CreateRasterizationPSO(IShaderSourceInputStream
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Rasterization PS";
         ShaderCI.FilePath        = "Rasterization.psh";
-        m_pDevice->CreateShader(ShaderCI, &pPS);
+        pPS = CreateShader(ShaderCI);
     }
 
     PSOCreateInfo.pVS = pVS;
@@ -577,7 +577,7 @@ void Tutorial22_HybridRendering::CreateRasterizationPSO(IShaderSourceInputStream
     PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType        = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
     PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableMergeStages = SHADER_TYPE_VERTEX | SHADER_TYPE_PIXEL;
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_RasterizationPSO);
+    m_RasterizationPSO = CreateGraphicsPipelineState(PSOCreateInfo);
 
     m_RasterizationPSO->CreateShaderResourceBinding(&m_RasterizationSRB);
     m_RasterizationSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_Constants")->Set(m_Constants);
@@ -632,7 +632,7 @@ void Tutorial22_HybridRendering::CreatePostProcessPSO(IShaderSourceInputStreamFa
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Post process VS";
         ShaderCI.FilePath        = "PostProcess.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pVS);
+        pVS = CreateShader(ShaderCI);
     }
 
     RefCntAutoPtr<IShader> pPS;
@@ -641,13 +641,13 @@ void Tutorial22_HybridRendering::CreatePostProcessPSO(IShaderSourceInputStreamFa
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Post process PS";
         ShaderCI.FilePath        = "PostProcess.psh";
-        m_pDevice->CreateShader(ShaderCI, &pPS);
+        pPS = CreateShader(ShaderCI);
     }
 
     PSOCreateInfo.pVS = pVS;
     PSOCreateInfo.pPS = pPS;
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_PostProcessPSO);
+    m_PostProcessPSO = CreateGraphicsPipelineState(PSOCreateInfo);
 }
 
 void Tutorial22_HybridRendering::CreateRayTracingPSO(IShaderSourceInputStreamFactory* pShaderSourceFactory)
@@ -750,11 +750,11 @@ void Tutorial22_HybridRendering::CreateRayTracingPSO(IShaderSourceInputStreamFac
         ShaderCI.CompileFlags = SHADER_COMPILE_FLAG_SKIP_REFLECTION;
     }
     RefCntAutoPtr<IShader> pCS;
-    m_pDevice->CreateShader(ShaderCI, &pCS);
+    pCS = CreateShader(ShaderCI);
     PSOCreateInfo.pCS = pCS;
 
     PSOCreateInfo.PSODesc.Name = "Ray tracing PSO";
-    m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_RayTracingPSO);
+    m_RayTracingPSO = CreateComputePipelineState(PSOCreateInfo);
     VERIFY_EXPR(m_RayTracingPSO);
 
     // Initialize SRB containing scene resources
@@ -986,7 +986,12 @@ void Tutorial22_HybridRendering::WindowResize(Uint32 Width, Uint32 Height)
         m_GBuffer.Color->GetDesc().Height == Height)
         return;
 
-    m_GBuffer = {};
+    // Return the previous textures to the pool. Textures whose size depends on the window
+    // are replaced by new ones and are destroyed at the end of the frame.
+    m_TransientTextures.Release(m_GBuffer.Color);
+    m_TransientTextures.Release(m_GBuffer.Normal);
+    m_TransientTextures.Release(m_GBuffer.Depth);
+    m_TransientTextures.Release(m_RayTracedTex);
 
     // Create window-size G-buffer textures.
     TextureDesc RTDesc;
@@ -996,23 +1001,22 @@ void Tutorial22_HybridRendering::WindowResize(Uint32 Width, Uint32 Height)
     RTDesc.Height    = Height;
     RTDesc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
     RTDesc.Format    = m_ColorTargetFormat;
-    m_pDevice->CreateTexture(RTDesc, nullptr, &m_GBuffer.Color);
+    m_GBuffer.Color  = m_TransientTextures.Acquire(m_pDevice, RTDesc);
 
     RTDesc.Name      = "GBuffer Normal";
     RTDesc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
     RTDesc.Format    = m_NormalTargetFormat;
-    m_pDevice->CreateTexture(RTDesc, nullptr, &m_GBuffer.Normal);
+    m_GBuffer.Normal = m_TransientTextures.Acquire(m_pDevice, RTDesc);
 
     RTDesc.Name      = "GBuffer Depth";
     RTDesc.BindFlags = BIND_DEPTH_STENCIL | BIND_SHADER_RESOURCE;
     RTDesc.Format    = m_DepthTargetFormat;
-    m_pDevice->CreateTexture(RTDesc, nullptr, &m_GBuffer.Depth);
+    m_GBuffer.Depth  = m_TransientTextures.Acquire(m_pDevice, RTDesc);
 
     RTDesc.Name      = "Ray traced shadow & reflection";
     RTDesc.BindFlags = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
     RTDesc.Format    = m_RayTracedTexFormat;
-    m_RayTracedTex.Release();
-    m_pDevice->CreateTexture(RTDesc, nullptr, &m_RayTracedTex);
+    m_RayTracedTex   = m_TransientTextures.Acquire(m_pDevice, RTDesc);
 
 
     // Create post-processing SRB
@@ -99,7 +99,7 @@ void Tutorial23_CommandQueues::CreatePostProcessPSO(IShaderSourceInputStreamFact
         ShaderCI.Desc       = {"Post process VS", SHADER_TYPE_VERTEX, true};
         ShaderCI.EntryPoint = "main";
         ShaderCI.FilePath   = "PostProcess.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pVS);
+        pVS = CreateShader(ShaderCI);
     }
 
     RefCntAutoPtr<IShader> pPS;
@@ -108,13 +108,13 @@ void Tutorial23_CommandQueues::CreatePostProcessPSO(IShaderSourceInputStreamFact
         ShaderCI.EntryPoint = "main";
         ShaderCI.FilePath   = "PostProcess.psh";
         ShaderCI.Macros     = Macros;
-        m_pDevice->CreateShader(ShaderCI, &pPS);
+        pPS = CreateShader(ShaderCI);
     }
 
     PSOCreateInfo.pVS = pVS;
     PSOCreateInfo.pPS = pPS;
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_PostProcessPSO[0]);
+    m_PostProcessPSO[0] = CreateGraphicsPipelineState(PSOCreateInfo);
 
 
     Macros.UpdateMacro("GLOW", 0);
@@ -125,12 +125,12 @@ void Tutorial23_CommandQueues::CreatePostProcessPSO(IShaderSourceInputStreamFact
         ShaderCI.EntryPoint = "main";
         ShaderCI.FilePath   = "PostProcess.psh";
         ShaderCI.Macros     = Macros;
-        m_pDevice->CreateShader(ShaderCI, &pPSnoGlow);
+        pPSnoGlow = CreateShader(ShaderCI);
     }
     PSOCreateInfo.pPS          = pPSnoGlow;
     PSOCreateInfo.PSODesc.Name = "Post process without glow PSO";
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_PostProcessPSO[1]);
+    m_PostProcessPSO[1] = CreateGraphicsPipelineState(PSOCreateInfo);
 
 
     RefCntAutoPtr<IShader> pDownSamplePS;
@@ -138,7 +138,7 @@ void Tutorial23_CommandQueues::CreatePostProcessPSO(IShaderSourceInputStreamFact
         ShaderCI.Desc       = {"Down sample PS", SHADER_TYPE_PIXEL, true};
         ShaderCI.EntryPoint = "main";
         ShaderCI.FilePath   = "DownSample.psh";
-        m_pDevice->CreateShader(ShaderCI, &pDownSamplePS);
+        pDownSamplePS = CreateShader(ShaderCI);
     }
     PSOCreateInfo.pPS = pDownSamplePS;
 
@@ -148,7 +148,7 @@ void Tutorial23_CommandQueues::CreatePostProcessPSO(IShaderSourceInputStreamFact
     PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = nullptr;
     PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = 0;
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_DownSamplePSO);
+    m_DownSamplePSO = CreateGraphicsPipelineState(PSOCreateInfo);
 }
 
 void Tutorial23_CommandQueues::DownSample()
@@ -651,6 +651,10 @@ void Tutorial23_CommandQueues::WindowResize(Uint32 Width, Uint32 Height)
         m_GBuffer.Color->GetDesc().Height == Height)
         return;
 
+    // Return the previous textures to the pool, which destroys them at the end
+    // of the frame when the textures of the new size are created
+    m_TransientTextures.Release(m_GBuffer.Color);
+    m_TransientTextures.Release(m_GBuffer.Depth);
     m_GBuffer = {};
 
     // Create window-size G-buffer textures.
@@ -662,7 +666,7 @@ void Tutorial23_CommandQueues::WindowResize(Uint32 Width, Uint32 Height)
     RTDesc.MipLevels = DownSampleFactor;
     RTDesc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
     RTDesc.Format    = m_ColorTargetFormat;
-    m_pDevice->CreateTexture(RTDesc, nullptr, &m_GBuffer.Color);
+    m_GBuffer.Color  = m_TransientTextures.Acquire(m_pDevice, RTDesc);
 
     // Create texture view
     for (Uint32 Mip = 0; Mip < DownSampleFactor; ++Mip)
@@ -683,7 +687,7 @@ void Tutorial23_CommandQueues::WindowResize(Uint32 Width, Uint32 Height)
     RTDesc.MipLevels = 1;
     RTDesc.BindFlags = BIND_DEPTH_STENCIL | BIND_SHADER_RESOURCE;
     RTDesc.Format    = m_DepthTargetFormat;
-    m_pDevice->CreateTexture(RTDesc, nullptr, &m_GBuffer.Depth);
+    m_GBuffer.Depth  = m_TransientTextures.Acquire(m_pDevice, RTDesc);
 
     // Create post-processing SRB
     {
@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "PipelineUnpacker.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+Uint32 PipelineUnpacker::AddPipeline(const char*                Name,
+                                     PIPELINE_TYPE              Type,
+                                     ModifyPipelineCallbackType ModifyPipeline,
+                                     std::vector<Uint32>        Dependencies)
+{
+    const auto Index = static_cast<Uint32>(m_Pipelines.size());
+    for (auto Dependency : Dependencies)
+    {
+        // Dependencies must be added first, which also rules out cycles
+        VERIFY(Dependency < Index, "Pipeline '", Name, "' depends on pipeline ", Dependency, " that has not been added yet");
+        m_Pipelines[Dependency].Dependents.push_back(Index);
+    }
+
+    PipelineInfo Info;
+    Info.Name           = Name;
+    Info.Type           = Type;
+    Info.ModifyPipeline = std::move(ModifyPipeline);
+    Info.Dependencies   = std::move(Dependencies);
+    m_Pipelines.emplace_back(std::move(Info));
+
+    return Index;
+}
+
+void PipelineUnpacker::UnpackPipeline(Uint32 Index, IDearchiver* pDearchiver, IRenderDevice* pDevice)
+{
+    auto& Info = m_Pipelines[Index];
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    PipelineStateUnpackInfo UnpackInfo;
+    UnpackInfo.pDevice      = pDevice;
+    UnpackInfo.PipelineType = Info.Type;
+    UnpackInfo.Name         = Info.Name.c_str();
+    if (Info.ModifyPipeline)
+    {
+        UnpackInfo.ModifyPipelineStateCreateInfo = [](PipelineStateCreateInfo& PSODesc, void* pUserData) {
+            (*static_cast<const ModifyPipelineCallbackType*>(pUserData))(PSODesc);
+        };
+        UnpackInfo.pUserData = &Info.ModifyPipeline;
+    }
+    pDearchiver->UnpackPipelineState(UnpackInfo, &Info.pPSO);
+    if (!Info.pPSO)
+        LOG_ERROR_MESSAGE("Failed to unpack pipeline state '", Info.Name, "'");
+
+    Info.UnpackTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+bool PipelineUnpacker::Unpack(IDearchiver* pDearchiver, IRenderDevice* pDevice, Uint32 NumThreads)
+{
+    const auto StartTime    = std::chrono::high_resolution_clock::now();
+    const auto NumPipelines = GetNumPipelines();
+
+    std::mutex              Mtx;
+    std::condition_variable CondVar;
+
+    // The following variables are protected by Mtx
+    std::deque<Uint32>  ReadyQueue;
+    std::vector<Uint32> NumPendingDeps(NumPipelines);
+    Uint32              NumUnpacked = 0;
+
+    for (Uint32 i = 0; i < NumPipelines; ++i)
+    {
+        auto& Info = m_Pipelines[i];
+        Info.pPSO.Release();
+        Info.UnpackTime = 0;
+
+        NumPendingDeps[i] = static_cast<Uint32>(Info.Dependencies.size());
+        if (NumPendingDeps[i] == 0)
+            ReadyQueue.push_back(i);
+    }
+
+    const auto WorkerProc = [&]() {
+        std::unique_lock<std::mutex> Lock{Mtx};
+        while (true)
+        {
+            CondVar.wait(Lock, [&]() {
+                return !ReadyQueue.empty() || NumUnpacked == NumPipelines;
+            });
+            if (ReadyQueue.empty())
+                break;
+
+            const auto Index = ReadyQueue.front();
+            ReadyQueue.pop_front();
+
+            Lock.unlock();
+            UnpackPipeline(Index, pDearchiver, pDevice);
+            Lock.lock();
+
+            // Dependents are unpacked even if this pipeline failed to let the application handle the error
+            for (auto Dependent : m_Pipelines[Index].Dependents)
+            {
+                VERIFY_EXPR(NumPendingDeps[Dependent] > 0);
+                if (--NumPendingDeps[Dependent] == 0)
+                    ReadyQueue.push_back(Dependent);
+            }
+            ++NumUnpacked;
+            CondVar.notify_all();
+        }
+    };
+
+    // Do not start more threads than there are pipelines
+    NumThreads = std::max(std::min(NumThreads, NumPipelines), 1u);
+
+    std::vector<std::thread> Threads;
+    Threads.reserve(NumThreads - 1);
+    for (Uint32 i = 1; i < NumThreads; ++i)
+        Threads.emplace_back(WorkerProc);
+    // The calling thread is a worker too
+    WorkerProc();
+    for (auto& Thread : Threads)
+        Thread.join();
+
+    m_TotalUnpackTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+    bool AllUnpacked = true;
+    for (const auto& Info : m_Pipelines)
+        AllUnpacked = AllUnpacked && Info.pPSO != nullptr;
+    return AllUnpacked;
+}
+
+} // namespace Diligent
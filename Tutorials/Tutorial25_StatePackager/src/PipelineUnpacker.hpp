@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2019-2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "Dearchiver.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Unpacks a batch of pipeline states from the archive using multiple threads.
+// Every pipeline may depend on pipelines that were added to the batch before it, and is only
+// unpacked after all its dependencies have been unpacked. Independent pipelines are unpacked
+// concurrently.
+class PipelineUnpacker
+{
+public:
+    using ModifyPipelineCallbackType = std::function<void(PipelineStateCreateInfo&)>;
+
+    // Adds the pipeline to the batch and returns its index.
+    // ModifyPipeline is called before the pipeline is created and may be called from a worker thread.
+    // Dependencies are the indices of the pipelines that must be unpacked first.
+    Uint32 AddPipeline(const char*                Name,
+                       PIPELINE_TYPE              Type,
+                       ModifyPipelineCallbackType ModifyPipeline = nullptr,
+                       std::vector<Uint32>        Dependencies   = {});
+
+    // Unpacks all pipelines in the batch using NumThreads threads, including the calling thread,
+    // and waits until they are ready. Returns false if any pipeline failed to unpack.
+    bool Unpack(IDearchiver* pDearchiver, IRenderDevice* pDevice, Uint32 NumThreads);
+
+    Uint32 GetNumPipelines() const { return static_cast<Uint32>(m_Pipelines.size()); }
+
+    IPipelineState* GetPipeline(Uint32 Index) const { return m_Pipelines[Index].pPSO; }
+    const char*     GetPipelineName(Uint32 Index) const { return m_Pipelines[Index].Name.c_str(); }
+
+    // Time it took to unpack the pipeline, in milliseconds
+    double GetUnpackTime(Uint32 Index) const { return m_Pipelines[Index].UnpackTime; }
+
+    // Total time of the last Unpack() call, in milliseconds
+    double GetTotalUnpackTime() const { return m_TotalUnpackTime; }
+
+private:
+    void UnpackPipeline(Uint32 Index, IDearchiver* pDearchiver, IRenderDevice* pDevice);
+
+    struct PipelineInfo
+    {
+        std::string                Name;
+        PIPELINE_TYPE              Type = PIPELINE_TYPE_INVALID;
+        ModifyPipelineCallbackType ModifyPipeline;
+        std::vector<Uint32>        Dependencies;
+        std::vector<Uint32>        Dependents;
+
+        RefCntAutoPtr<IPipelineState> pPSO;
+        double                        UnpackTime = 0;
+    };
+    std::vector<PipelineInfo> m_Pipelines;
+
+    double m_TotalUnpackTime = 0;
+};
+
+} // namespace Diligent
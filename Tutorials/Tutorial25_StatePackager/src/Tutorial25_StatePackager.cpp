@@ -27,13 +27,15 @@
 #include "Tutorial25_StatePackager.hpp"
 
 #include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 
 #include "MapHelper.hpp"
 #include "GraphicsUtilities.h"
 #include "Dearchiver.h"
 #include "FileWrapper.hpp"
 #include "DataBlobImpl.hpp"
-#include "CallbackWrapper.hpp"
 #include "imgui.h"
 
 namespace Diligent
@@ -111,6 +113,16 @@ void Tutorial25_StatePackager::UpdateUI()
             m_SampleCount       = 0;
             m_LastFrameViewProj = {}; // Need to update G-buffer
         }
+
+        if (ImGui::TreeNode("Startup timings"))
+        {
+            ImGui::Text("Archive load: %.2f ms", m_ArchiveLoadTime);
+            ImGui::Text("Pipeline unpacking: %.2f ms", m_PipelineUnpacker.GetTotalUnpackTime());
+            for (Uint32 i = 0; i < m_PipelineUnpacker.GetNumPipelines(); ++i)
+                ImGui::Text("  %s: %.2f ms", m_PipelineUnpacker.GetPipelineName(i), m_PipelineUnpacker.GetUnpackTime(i));
+            ImGui::Text("Total startup: %.2f ms", m_StartupTime);
+            ImGui::TreePop();
+        }
     }
     ImGui::End();
 }
@@ -119,6 +131,10 @@ void Tutorial25_StatePackager::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
+    using ClockType = std::chrono::high_resolution_clock;
+
+    const auto StartTime = ClockType::now();
+
     CreateUniformBuffer(m_pDevice, sizeof(HLSL::ShaderConstants), "Shader constants CB", &m_pShaderConstantsCB);
 
     // Create the dearchiver object
@@ -127,88 +143,86 @@ void Tutorial25_StatePackager::Initialize(const SampleInitInfo& InitInfo)
     m_pEngineFactory->CreateDearchiver(DearchiverCI, &pDearchiver);
 
     // Load archive data from file
-    FileWrapper pArchive{"StateArchive.bin"};
-    VERIFY_EXPR(pArchive);
-    auto pArchiveData = DataBlobImpl::Create();
-    pArchive->Read(pArchiveData);
-    VERIFY_EXPR(pArchiveData);
-    // Load the archive contents into dearchiver
-    pDearchiver->LoadArchive(pArchiveData);
-
-    // Unpack G-buffer PSO
     {
-        PipelineStateUnpackInfo UnpackInfo;
-        UnpackInfo.pDevice      = m_pDevice;
-        UnpackInfo.PipelineType = PIPELINE_TYPE_GRAPHICS;
-        UnpackInfo.Name         = "G-Buffer PSO";
-
-        // Define the callback that is called by the dearchiver before creating
-        // the pipeline to let the application modify some parameters. We will use
-        // it to set the render target formats.
-        auto ModifyGBufferPSODesc = MakeCallback(
-            [](PipelineStateCreateInfo& PSODesc) {
-                auto& GraphicsPSOCI    = static_cast<GraphicsPipelineStateCreateInfo&>(PSODesc);
-                auto& GraphicsPipeline = GraphicsPSOCI.GraphicsPipeline;
-
-                GraphicsPipeline.NumRenderTargets = 4;
-
-                GraphicsPipeline.RTVFormats[0] = GBuffer::AlbedoFormat;
-                GraphicsPipeline.RTVFormats[1] = GBuffer::NormalFormat;
-                GraphicsPipeline.RTVFormats[2] = GBuffer::EmittanceFormat;
-                GraphicsPipeline.RTVFormats[3] = GBuffer::DepthFormat;
-                GraphicsPipeline.DSVFormat     = TEX_FORMAT_UNKNOWN;
-            });
-
-        UnpackInfo.ModifyPipelineStateCreateInfo = ModifyGBufferPSODesc;
-        UnpackInfo.pUserData                     = ModifyGBufferPSODesc;
-        pDearchiver->UnpackPipelineState(UnpackInfo, &m_pGBufferPSO);
-        VERIFY_EXPR(m_pGBufferPSO);
-
-        m_pGBufferPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbConstants")->Set(m_pShaderConstantsCB);
-        m_pGBufferPSO->CreateShaderResourceBinding(&m_pGBufferSRB, true);
-        VERIFY_EXPR(m_pGBufferSRB);
-    }
+        const auto LoadStartTime = ClockType::now();
 
-    // Unpack the path trace PSO
-    {
-        PipelineStateUnpackInfo UnpackInfo;
-        UnpackInfo.pDevice      = m_pDevice;
-        UnpackInfo.PipelineType = PIPELINE_TYPE_COMPUTE;
-        UnpackInfo.Name         = "Path Trace PSO";
-        pDearchiver->UnpackPipelineState(UnpackInfo, &m_pPathTracePSO);
-        VERIFY_EXPR(m_pPathTracePSO);
-
-        m_pPathTracePSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbConstants")->Set(m_pShaderConstantsCB);
-    }
+        FileWrapper pArchive{"StateArchive.bin"};
+        VERIFY_EXPR(pArchive);
+        auto pArchiveData = DataBlobImpl::Create();
+        pArchive->Read(pArchiveData);
+        VERIFY_EXPR(pArchiveData);
+        // Load the archive contents into dearchiver
+        pDearchiver->LoadArchive(pArchiveData);
 
-    // Unpack the resolve PSO
-    {
-        PipelineStateUnpackInfo UnpackInfo;
-        UnpackInfo.pDevice      = m_pDevice;
-        UnpackInfo.PipelineType = PIPELINE_TYPE_GRAPHICS;
-        UnpackInfo.Name         = "Resolve PSO";
-
-        // Define the callback to set the render target and depth stencil formats.
-        // These formats are only known at run time, so we can't define them in the
-        // render state notation file.
-        auto ModifyResolvePSODesc = MakeCallback(
-            [this](PipelineStateCreateInfo& PSODesc) {
-                auto& GraphicsPSOCI    = static_cast<GraphicsPipelineStateCreateInfo&>(PSODesc);
-                auto& GraphicsPipeline = GraphicsPSOCI.GraphicsPipeline;
-
-                GraphicsPipeline.NumRenderTargets = 1;
-                GraphicsPipeline.RTVFormats[0]    = m_pSwapChain->GetDesc().ColorBufferFormat;
-                GraphicsPipeline.DSVFormat        = m_pSwapChain->GetDesc().DepthBufferFormat;
-            });
-
-        UnpackInfo.ModifyPipelineStateCreateInfo = ModifyResolvePSODesc;
-        UnpackInfo.pUserData                     = ModifyResolvePSODesc;
-        pDearchiver->UnpackPipelineState(UnpackInfo, &m_pResolvePSO);
-        VERIFY_EXPR(m_pResolvePSO);
-
-        m_pResolvePSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbConstants")->Set(m_pShaderConstantsCB);
+        m_ArchiveLoadTime = std::chrono::duration<double, std::milli>(ClockType::now() - LoadStartTime).count();
     }
 
+    // Add all pipelines to the batch and unpack them concurrently.
+    // None of the pipelines in this tutorial depend on each other.
+
+    // G-buffer PSO
+    // Define the callback that is called by the dearchiver before creating
+    // the pipeline to let the application modify some parameters. We will use
+    // it to set the render target formats.
+    const auto GBufferPSOIdx = m_PipelineUnpacker.AddPipeline(
+        "G-Buffer PSO", PIPELINE_TYPE_GRAPHICS,
+        [](PipelineStateCreateInfo& PSODesc) {
+            auto& GraphicsPSOCI    = static_cast<GraphicsPipelineStateCreateInfo&>(PSODesc);
+            auto& GraphicsPipeline = GraphicsPSOCI.GraphicsPipeline;
+
+            GraphicsPipeline.NumRenderTargets = 4;
+
+            GraphicsPipeline.RTVFormats[0] = GBuffer::AlbedoFormat;
+            GraphicsPipeline.RTVFormats[1] = GBuffer::NormalFormat;
+            GraphicsPipeline.RTVFormats[2] = GBuffer::EmittanceFormat;
+            GraphicsPipeline.RTVFormats[3] = GBuffer::DepthFormat;
+            GraphicsPipeline.DSVFormat     = TEX_FORMAT_UNKNOWN;
+        });
+
+    // Path trace PSO
+    const auto PathTracePSOIdx = m_PipelineUnpacker.AddPipeline("Path Trace PSO", PIPELINE_TYPE_COMPUTE);
+
+    // Resolve PSO
+    // Define the callback to set the render target and depth stencil formats.
+    // These formats are only known at run time, so we can't define them in the
+    // render state notation file.
+    const auto ResolvePSOIdx = m_PipelineUnpacker.AddPipeline(
+        "Resolve PSO", PIPELINE_TYPE_GRAPHICS,
+        [this](PipelineStateCreateInfo& PSODesc) {
+            auto& GraphicsPSOCI    = static_cast<GraphicsPipelineStateCreateInfo&>(PSODesc);
+            auto& GraphicsPipeline = GraphicsPSOCI.GraphicsPipeline;
+
+            GraphicsPipeline.NumRenderTargets = 1;
+            GraphicsPipeline.RTVFormats[0]    = m_pSwapChain->GetDesc().ColorBufferFormat;
+            GraphicsPipeline.DSVFormat        = m_pSwapChain->GetDesc().DepthBufferFormat;
+        });
+
+    // OpenGL does not support creating resources from multiple threads
+    const auto NumThreads = m_pDevice->GetDeviceInfo().IsGLDevice() ? 1u : std::max(std::thread::hardware_concurrency(), 1u);
+    if (!m_PipelineUnpacker.Unpack(pDearchiver, m_pDevice, NumThreads))
+        LOG_ERROR_MESSAGE("Failed to unpack some pipeline states from the archive");
+
+    m_pGBufferPSO = m_PipelineUnpacker.GetPipeline(GBufferPSOIdx);
+    VERIFY_EXPR(m_pGBufferPSO);
+    m_pGBufferPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbConstants")->Set(m_pShaderConstantsCB);
+    m_pGBufferPSO->CreateShaderResourceBinding(&m_pGBufferSRB, true);
+    VERIFY_EXPR(m_pGBufferSRB);
+
+    m_pPathTracePSO = m_PipelineUnpacker.GetPipeline(PathTracePSOIdx);
+    VERIFY_EXPR(m_pPathTracePSO);
+    m_pPathTracePSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbConstants")->Set(m_pShaderConstantsCB);
+
+    m_pResolvePSO = m_PipelineUnpacker.GetPipeline(ResolvePSOIdx);
+    VERIFY_EXPR(m_pResolvePSO);
+    m_pResolvePSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbConstants")->Set(m_pShaderConstantsCB);
+
+    m_StartupTime = std::chrono::duration<double, std::milli>(ClockType::now() - StartTime).count();
+
+    LOG_INFO_MESSAGE("Archive loaded in ", m_ArchiveLoadTime, " ms. ", m_PipelineUnpacker.GetNumPipelines(), " pipelines unpacked by ", NumThreads,
+                     " threads in ", m_PipelineUnpacker.GetTotalUnpackTime(), " ms. Total startup time: ", m_StartupTime, " ms.");
+    for (Uint32 i = 0; i < m_PipelineUnpacker.GetNumPipelines(); ++i)
+        LOG_INFO_MESSAGE("  ", m_PipelineUnpacker.GetPipelineName(i), ": ", m_PipelineUnpacker.GetUnpackTime(i), " ms");
+
     m_Camera.SetPos(float3{0.0f, 1.0f, -20.0f});
     m_Camera.SetRotationSpeed(0.002f);
     m_Camera.SetMoveSpeed(5.f);
@@ -217,10 +231,15 @@ void Tutorial25_StatePackager::Initialize(const SampleInitInfo& InitInfo)
 
 void Tutorial25_StatePackager::WindowResize(Uint32 Width, Uint32 Height)
 {
-    m_GBuffer = {};
+    // Return window-size textures to the pool. They are destroyed at the end
+    // of the frame after the textures of the new size have been created
+    m_TransientTextures.Release(m_GBuffer.pAlbedo);
+    m_TransientTextures.Release(m_GBuffer.pNormal);
+    m_TransientTextures.Release(m_GBuffer.pEmittance);
+    m_TransientTextures.Release(m_GBuffer.pDepth);
+    m_TransientTextures.Release(m_pRadianceAccumulationBuffer);
     m_pPathTraceSRB.Release();
     m_pResolveSRB.Release();
-    m_pRadianceAccumulationBuffer.Release();
 
     float NearPlane   = 0.1f;
     float FarPlane    = 50.f;
@@ -243,17 +262,17 @@ void Tutorial25_StatePackager::CreateGBuffer()
     TexDesc.Height    = SCDesc.Height;
     TexDesc.MipLevels = 1;
 
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pAlbedo);
+    m_GBuffer.pAlbedo = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pAlbedo);
 
     TexDesc.Name   = "G-buffer normal";
     TexDesc.Format = GBuffer::NormalFormat;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pNormal);
+    m_GBuffer.pNormal = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pNormal);
 
     TexDesc.Name   = "G-buffer emittance";
     TexDesc.Format = GBuffer::EmittanceFormat;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pEmittance);
+    m_GBuffer.pEmittance = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pEmittance);
 
     // Note that since we are generating our G-buffer by ray tracing the scene,
@@ -261,14 +280,14 @@ void Tutorial25_StatePackager::CreateGBuffer()
     TexDesc.Name      = "G-buffer depth";
     TexDesc.Format    = GBuffer::DepthFormat;
     TexDesc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pDepth);
+    m_GBuffer.pDepth = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pDepth);
 
     // Create the radiance accumulation buffer
     TexDesc.Name      = "Radiance accumulation buffer";
     TexDesc.Format    = RadianceAccumulationFormat;
     TexDesc.BindFlags = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_pRadianceAccumulationBuffer);
+    m_pRadianceAccumulationBuffer = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_pRadianceAccumulationBuffer);
 
     m_pPathTraceSRB.Release();
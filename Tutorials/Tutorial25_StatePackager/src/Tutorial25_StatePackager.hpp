@@ -29,6 +29,7 @@
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
 #include "FirstPersonCamera.hpp"
+#include "PipelineUnpacker.hpp"
 
 namespace Diligent
 {
@@ -96,6 +97,11 @@ private:
 
     FirstPersonCamera m_Camera;
     MouseState        m_LastMouseState;
+
+    // Startup timings, in milliseconds
+    PipelineUnpacker m_PipelineUnpacker;
+    double           m_ArchiveLoadTime = 0;
+    double           m_StartupTime     = 0;
 };
 
 } // namespace Diligent
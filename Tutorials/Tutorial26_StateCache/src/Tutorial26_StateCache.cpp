@@ -27,6 +27,16 @@
 #include "Tutorial26_StateCache.hpp"
 
 #include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+#    include "WinHPreface.h"
+#    include <Windows.h>
+#    include "WinHPostface.h"
+#endif
 
 #include "MapHelper.hpp"
 #include "GraphicsUtilities.h"
@@ -35,6 +45,7 @@
 #include "GraphicsAccessories.hpp"
 #include "DataBlobImpl.hpp"
 #include "ShaderMacroHelper.hpp"
+#include "CommandLineParser.hpp"
 #include "imgui.h"
 
 namespace Diligent
@@ -50,6 +61,9 @@ namespace HLSL
 
 }
 
+constexpr const char* BRDFSamplingModeNames[] = {"Cosine-weighted", "Importance Sampling"};
+constexpr const char* NEEModeNames[]          = {"Sample Light", "Sample BRDF", "MIS", "MIS - Light part", "MIS - BRDF part"};
+
 } // namespace
 
 SampleBase* CreateSample()
@@ -127,6 +141,15 @@ Tutorial26_StateCache::Tutorial26_StateCache() :
     }
 }
 
+Tutorial26_StateCache::CommandLineStatus Tutorial26_StateCache::ProcessCommandLine(int argc, const char* const* argv)
+{
+    CommandLineParser ArgsParser{argc, argv};
+    ArgsParser.Parse("async_pso", m_AsyncPSOCompilation);
+    ArgsParser.Parse("prewarm_pso", m_PrewarmPSOs);
+
+    return CommandLineStatus::OK;
+}
+
 void Tutorial26_StateCache::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
 {
     SampleBase::ModifyEngineInitInfo(Attribs);
@@ -159,7 +182,7 @@ void Tutorial26_StateCache::UpdateUI()
         if (ImGui::Combo("BRDF Sampling mode", &m_BRDFSamplingMode, "Cosine-weighted\0"
                                                                     "Importance Sampling\0"))
         {
-            CreatePathTracePSO();
+            RequestPathTracePSO();
             m_SampleCount = 0;
         }
 
@@ -171,7 +194,7 @@ void Tutorial26_StateCache::UpdateUI()
                                                      "MIS - Light part\0"
                                                      "MIS - BRDF part\0"))
             {
-                CreatePathTracePSO();
+                RequestPathTracePSO();
                 m_SampleCount = 0;
             }
 
@@ -187,7 +210,7 @@ void Tutorial26_StateCache::UpdateUI()
 
         if (ImGui::Checkbox("Full BRDF reflectance term (debugging)", &m_FullBRDFReflectance))
         {
-            CreatePathTracePSO();
+            RequestPathTracePSO();
             m_SampleCount = 0;
         }
 
@@ -283,23 +306,83 @@ void Tutorial26_StateCache::UpdateUI()
 
         ImGui::Separator();
 
-        if (m_pStateCache)
+        if (ImGui::TreeNode("Path trace permutations"))
         {
-            if (ImGui::Button("Reload states"))
+            if (m_PendingPathTracePermutation != ~0u)
+                ImGui::TextDisabled("Compiling the requested permutation...");
+
+            if (ImGui::Button("Prewarm all permutations"))
+                PrewarmPathTracePSOs();
+
+            std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+
+            ImGui::Text("Compiler threads: %d, queued: %d", static_cast<int>(m_PSOCompiler.Threads.size()), static_cast<int>(m_PSOCompiler.Queue.size()));
+            for (Uint32 Permutation = 0; Permutation < NumPathTracePermutations; ++Permutation)
             {
-                m_pStateCache->Reload();
-                m_SampleCount       = 0;
-                m_LastFrameViewProj = {}; // Need to update G-buffer
+                const auto& Info = m_PSOCompiler.Permutations[Permutation];
+                if (Info.Status != PERMUTATION_STATUS_READY && Info.Status != PERMUTATION_STATUS_COMPILING)
+                    continue;
+
+                const auto* BRDFSamplingMode = BRDFSamplingModeNames[Permutation / 2 / NEE_MODE_COUNT];
+                const auto* NEEMode          = NEEModeNames[(Permutation / 2) % NEE_MODE_COUNT];
+                const auto* FullBRDF         = (Permutation & 1) != 0 ? ", full BRDF" : "";
+                if (Info.Status == PERMUTATION_STATUS_COMPILING)
+                    ImGui::TextDisabled("%s, %s%s: compiling", BRDFSamplingMode, NEEMode, FullBRDF);
+                else
+                    ImGui::Text("%s, %s%s: %.1f ms", BRDFSamplingMode, NEEMode, FullBRDF, Info.CompileTimeMs);
             }
+
+            ImGui::TreePop();
         }
 
-        if (!m_StateCachePath.empty())
+        if (m_pStateCache)
         {
-            if (ImGui::Button("Delete cache file"))
+            // The compiler threads create pipelines through the cache, so the cache may only be reloaded
+            // or reset while no permutation is being compiled. Holding the mutex keeps the threads from
+            // starting new permutations until the buttons are processed.
+            std::unique_lock<std::mutex> CompilerLock{m_PSOCompiler.Mtx};
+
+            bool IsCompiling = false;
+            for (const auto& Info : m_PSOCompiler.Permutations)
+                IsCompiling = IsCompiling || Info.Status == PERMUTATION_STATUS_COMPILING;
+
+            if (IsCompiling)
             {
-                FileSystem::DeleteFile(m_StateCachePath.c_str());
-                m_pStateCache->Reset();
+                CompilerLock.unlock();
+                ImGui::TextDisabled("Reload states / Delete cache file: waiting for compilation");
             }
+            else
+            {
+                if (ImGui::Button("Reload states"))
+                {
+                    m_pStateCache->Reload();
+                    m_SampleCount       = 0;
+                    m_LastFrameViewProj = {}; // Need to update G-buffer
+                }
+
+                if (!m_StateCachePath.empty() && ImGui::Button("Delete cache file"))
+                {
+                    if (m_StateCacheWriter.joinable())
+                        m_StateCacheWriter.join();
+                    FileSystem::DeleteFile(m_StateCachePath.c_str());
+                    m_pStateCache->Reset();
+
+                    std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+                    m_CacheStats.CacheFileLoaded = false;
+                }
+            }
+        }
+
+        if (ImGui::TreeNode("Cache statistics"))
+        {
+            std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+            if (m_CacheStats.CacheFileLoaded)
+                ImGui::Text("File read: %.1f ms, load: %.1f ms", m_CacheStats.FileReadTimeMs, m_CacheStats.LoadTimeMs);
+            else
+                ImGui::TextDisabled("Cache file is not loaded");
+            ImGui::Text("Hits: %d, misses: %d", static_cast<int>(m_CacheStats.NumHits), static_cast<int>(m_CacheStats.NumMisses));
+            ImGui::Text("Time saved: %.1f ms", m_CacheStats.TimeSavedMs);
+            ImGui::TreePop();
         }
     }
     ImGui::End();
@@ -309,8 +392,11 @@ void Tutorial26_StateCache::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
-    // Create render state cache
+    // Create render state cache. This tutorial manages its own cache file and enables hot reload,
+    // so it replaces the cache shared by the sample application.
     {
+        m_pStateCache.Release();
+
         RenderStateCacheCreateInfo CacheCI;
         CacheCI.pDevice  = m_pDevice;
         CacheCI.LogLevel = RENDER_STATE_CACHE_LOG_LEVEL_VERBOSE;
@@ -321,82 +407,12 @@ void Tutorial26_StateCache::Initialize(const SampleInitInfo& InitInfo)
     }
 
     // Try to load the state cache data
-    {
-        // Note: there is GetRenderStateCacheFilePath() function that can be used to get the path to the cache file.
-
-        // Get local application data directory.
-        m_StateCachePath = FileSystem::GetLocalAppDataDirectory("DiligentEngine-Tutorial26");
-        if (!FileSystem::PathExists(m_StateCachePath.c_str()))
-        {
-            // Create the directory if it does not exist
-            FileSystem::CreateDirectory(m_StateCachePath.c_str());
-        }
-
-        if (!FileSystem::IsSlash(m_StateCachePath.back()))
-            m_StateCachePath.push_back(FileSystem::SlashSymbol);
-
-        m_StateCachePath += "state_cache_";
-        // Use different cache files for each device type. This is not required, but is more convenient.
-        m_StateCachePath += GetRenderDeviceTypeShortString(m_pDevice->GetDeviceInfo().Type);
-
-        // Use different cache files for debug and release. This is not required, but is more convenient.
-#ifdef DILIGENT_DEBUG
-        m_StateCachePath += "_d";
-#else
-        m_StateCachePath += "_r";
-#endif
-        m_StateCachePath += ".bin";
-
-        if (FileSystem::FileExists(m_StateCachePath.c_str()))
-        {
-            FileWrapper CacheDataFile{m_StateCachePath.c_str()};
-            auto        pCacheData = DataBlobImpl::Create();
-            if (CacheDataFile->Read(pCacheData))
-            {
-                if (m_pStateCache->Load(pCacheData))
-                    LOG_INFO_MESSAGE("Successfully loaded state cache file ", m_StateCachePath);
-                else
-                    LOG_ERROR_MESSAGE("Failed to load state cache file ", m_StateCachePath);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Failed to read state cache file ", m_StateCachePath);
-            }
-        }
-        else
-        {
-            LOG_INFO_MESSAGE("State cache file ", m_StateCachePath, " does not exist");
-        }
-    }
+    LoadStateCache();
 
     CreateUniformBuffer(m_pDevice, sizeof(HLSL::ShaderConstants), "Shader constants CB", &m_pShaderConstantsCB);
 
-    // Create a shader source stream factory to load shaders and DRSN files
-    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
-    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
-
-    // Create render state notation parser
-    {
-        RenderStateNotationParserCreateInfo ParserCI;
-        // Enable state reloading in the parser
-        ParserCI.EnableReload = true;
-        CreateRenderStateNotationParser(ParserCI, &m_pRSNParser);
-        VERIFY(m_pRSNParser != nullptr, "Failed to create RSN parser");
-        // Parse the render state notation file
-        auto res = m_pRSNParser->ParseFile("RenderStates.json", pShaderSourceFactory);
-        VERIFY(res, "Failed to parse render states file");
-    }
-
-    // Create render state notation loader
-    {
-        RenderStateNotationLoaderCreateInfo LoaderCI;
-        LoaderCI.pDevice        = m_pDevice;
-        LoaderCI.pParser        = m_pRSNParser;
-        LoaderCI.pStateCache    = m_pStateCache;
-        LoaderCI.pStreamFactory = pShaderSourceFactory;
-        CreateRenderStateNotationLoader(LoaderCI, &m_pRSNLoader);
-        VERIFY(m_pRSNLoader, "Failed to create render state loader");
-    }
+    // Create render state notation parser and loader. Enable state reloading in the parser.
+    CreateRSNLoader(true, m_pRSNParser, m_pRSNLoader);
 
     // Load G-buffer PSO
     {
@@ -424,16 +440,28 @@ void Tutorial26_StateCache::Initialize(const SampleInitInfo& InitInfo)
 
         LoadInfo.ModifyPipeline      = ModifyGBufferPSODesc;
         LoadInfo.pModifyPipelineData = ModifyGBufferPSODesc;
-        m_pRSNLoader->LoadPipelineState(LoadInfo, &m_pGBufferPSO);
+
+        const auto StartTime = std::chrono::high_resolution_clock::now();
+        const auto IsHit     = LoadPipelineState(m_pRSNLoader, LoadInfo, &m_pGBufferPSO);
         VERIFY_EXPR(m_pGBufferPSO);
+        RecordPipelineCreation(LoadInfo.Name, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count(), IsHit);
 
         m_pGBufferPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbConstants")->Set(m_pShaderConstantsCB);
         m_pGBufferPSO->CreateShaderResourceBinding(&m_pGBufferSRB, true);
         VERIFY_EXPR(m_pGBufferSRB);
     }
 
-    // Load the path trace PSO
-    CreatePathTracePSO();
+    // Load the path trace PSO. The initial permutation is compiled synchronously,
+    // all subsequent permutations are compiled by the background threads.
+    RequestPathTracePSO();
+    VERIFY_EXPR(m_pPathTracePSO);
+
+    // OpenGL does not support creating resources from multiple threads
+    if (m_AsyncPSOCompilation && !m_pDevice->GetDeviceInfo().IsGLDevice())
+        StartPSOCompilerThreads();
+
+    if (m_PrewarmPSOs)
+        PrewarmPathTracePSOs();
 
     // Load the resolve PSO
     {
@@ -456,33 +484,309 @@ void Tutorial26_StateCache::Initialize(const SampleInitInfo& InitInfo)
 
         LoadInfo.ModifyPipeline      = ModifyResolvePSODesc;
         LoadInfo.pModifyPipelineData = ModifyResolvePSODesc;
-        m_pRSNLoader->LoadPipelineState(LoadInfo, &m_pResolvePSO);
+
+        const auto StartTime = std::chrono::high_resolution_clock::now();
+        const auto IsHit     = LoadPipelineState(m_pRSNLoader, LoadInfo, &m_pResolvePSO);
         VERIFY_EXPR(m_pResolvePSO);
+        RecordPipelineCreation(LoadInfo.Name, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count(), IsHit);
 
         m_pResolvePSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbConstants")->Set(m_pShaderConstantsCB);
     }
 
+    {
+        std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+        LOG_INFO_MESSAGE("State cache startup: ", m_CacheStats.NumHits, " hits, ", m_CacheStats.NumMisses, " misses, ",
+                         static_cast<int>(m_CacheStats.TimeSavedMs), " ms saved compared to the cold start");
+    }
+
     m_Camera.SetPos(float3{0.0f, 1.0f, -20.0f});
     m_Camera.SetRotationSpeed(0.002f);
     m_Camera.SetMoveSpeed(5.f);
     m_Camera.SetSpeedUpScales(5.f, 10.f);
 }
 
-void Tutorial26_StateCache::CreatePathTracePSO()
+void Tutorial26_StateCache::LoadStateCache()
+{
+    // Note: there is GetRenderStateCacheFilePath() function that can be used to get the path to the cache file.
+
+    // Get local application data directory.
+    m_StateCachePath = FileSystem::GetLocalAppDataDirectory("DiligentEngine-Tutorial26");
+    if (!FileSystem::PathExists(m_StateCachePath.c_str()))
+    {
+        // Create the directory if it does not exist
+        FileSystem::CreateDirectory(m_StateCachePath.c_str());
+    }
+
+    if (!FileSystem::IsSlash(m_StateCachePath.back()))
+        m_StateCachePath.push_back(FileSystem::SlashSymbol);
+
+    m_StateCachePath += "state_cache_";
+    // Use different cache files for each device type. This is not required, but is more convenient.
+    m_StateCachePath += GetRenderDeviceTypeShortString(m_pDevice->GetDeviceInfo().Type);
+
+    // Use different cache files for debug and release. This is not required, but is more convenient.
+#ifdef DILIGENT_DEBUG
+    m_StateCachePath += "_d";
+#else
+    m_StateCachePath += "_r";
+#endif
+    m_StateCachePath += ".bin";
+
+    // Remove the temporary file that may have been left if the application crashed while writing it.
+    // The cache file itself is only ever replaced in a single step, so it is still intact.
+    const auto TmpFilePath = m_StateCachePath + ".tmp";
+    if (FileSystem::FileExists(TmpFilePath.c_str()))
+        FileSystem::DeleteFile(TmpFilePath.c_str());
+
+    LoadStateCacheStats();
+
+    if (!FileSystem::FileExists(m_StateCachePath.c_str()))
+    {
+        LOG_INFO_MESSAGE("State cache file ", m_StateCachePath, " does not exist");
+        return;
+    }
+
+    using ClockType = std::chrono::high_resolution_clock;
+
+    auto StartTime  = ClockType::now();
+    auto pCacheData = DataBlobImpl::Create();
+    {
+        FileWrapper CacheDataFile{m_StateCachePath.c_str()};
+        if (!CacheDataFile->Read(pCacheData))
+        {
+            LOG_ERROR_MESSAGE("Failed to read state cache file ", m_StateCachePath);
+            return;
+        }
+    }
+    m_CacheStats.FileReadTimeMs = std::chrono::duration<double, std::milli>(ClockType::now() - StartTime).count();
+
+    // The cache only parses the archive header when the data is loaded. Individual shaders
+    // and pipelines are unpacked from the archive on demand when they are first requested.
+    StartTime = ClockType::now();
+    if (m_pStateCache->Load(pCacheData))
+    {
+        m_CacheStats.LoadTimeMs = std::chrono::duration<double, std::milli>(ClockType::now() - StartTime).count();
+        {
+            std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+            m_CacheStats.CacheFileLoaded = true;
+        }
+        LOG_INFO_MESSAGE("Successfully loaded state cache file ", m_StateCachePath, " (", FormatMemorySize(pCacheData->GetSize()),
+                         "). Read time: ", static_cast<int>(m_CacheStats.FileReadTimeMs), " ms, load time: ", static_cast<int>(m_CacheStats.LoadTimeMs), " ms");
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("Failed to load state cache file ", m_StateCachePath);
+    }
+}
+
+void Tutorial26_StateCache::SaveStateCache(bool Async)
+{
+    if (!m_pStateCache || m_StateCachePath.empty())
+        return;
+
+    // Wait until the previous snapshot is written
+    if (m_StateCacheWriter.joinable())
+        m_StateCacheWriter.join();
+
+    RefCntAutoPtr<IDataBlob> pCacheData;
+    {
+        // The compiler threads add pipelines to the cache, so only take the snapshot when no permutation
+        // is being compiled. Holding the mutex keeps the threads from starting new permutations meanwhile.
+        std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+        for (const auto& Info : m_PSOCompiler.Permutations)
+        {
+            // The cache stays dirty, so the snapshot is retried later
+            if (Info.Status == PERMUTATION_STATUS_COMPILING)
+                return;
+        }
+
+        m_StateCacheDirty.store(false);
+        if (!m_pStateCache->WriteToBlob(0, &pCacheData) || !pCacheData)
+            return;
+    }
+
+    SaveStateCacheStats();
+
+    if (Async)
+        m_StateCacheWriter = std::thread{&Tutorial26_StateCache::WriteStateCacheFile, this, std::move(pCacheData)};
+    else
+        WriteStateCacheFile(std::move(pCacheData));
+}
+
+void Tutorial26_StateCache::WriteStateCacheFile(RefCntAutoPtr<IDataBlob> pCacheData) const
+{
+    const auto TmpFilePath = m_StateCachePath + ".tmp";
+    {
+        FileWrapper CacheDataFile{TmpFilePath.c_str(), EFileAccessMode::Overwrite};
+        if (!CacheDataFile->Write(pCacheData->GetConstDataPtr(), pCacheData->GetSize()))
+        {
+            LOG_ERROR_MESSAGE("Failed to write state cache file ", TmpFilePath);
+            return;
+        }
+    }
+
+    // Replace the cache file with the new one in a single step, so that there is always a complete cache file.
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+    // std::rename fails on Windows if the destination exists
+    const auto Replaced = MoveFileExA(TmpFilePath.c_str(), m_StateCachePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+#else
+    // Renaming is atomic on POSIX systems
+    const auto Replaced = std::rename(TmpFilePath.c_str(), m_StateCachePath.c_str()) == 0;
+#endif
+    if (!Replaced)
+    {
+        LOG_ERROR_MESSAGE("Failed to replace state cache file ", m_StateCachePath);
+        return;
+    }
+
+    LOG_INFO_MESSAGE("Successfully saved state cache file ", m_StateCachePath, " (", FormatMemorySize(pCacheData->GetSize()), ").");
+}
+
+void Tutorial26_StateCache::LoadStateCacheStats()
+{
+    std::ifstream StatsFile{m_StateCachePath + ".stats"};
+    if (!StatsFile)
+        return;
+
+    // Every line contains the cold creation time in milliseconds followed by the pipeline name
+    std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+
+    double      ColdTimeMs = 0;
+    std::string Name;
+    while (StatsFile >> ColdTimeMs && std::getline(StatsFile >> std::ws, Name))
+        m_CacheStats.ColdCreateTimes[Name] = ColdTimeMs;
+}
+
+void Tutorial26_StateCache::SaveStateCacheStats()
+{
+    std::ofstream StatsFile{m_StateCachePath + ".stats", std::ios::trunc};
+    if (!StatsFile)
+        return;
+
+    std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+    for (const auto& it : m_CacheStats.ColdCreateTimes)
+        StatsFile << it.second << ' ' << it.first << '\n';
+}
+
+// Loads the pipeline with the given loader and returns true if the pipeline was found in the render state cache.
+// This method is called by the PSO compiler threads as well as by the main thread.
+bool Tutorial26_StateCache::LoadPipelineState(IRenderStateNotationLoader* pLoader, const LoadPipelineStateInfo& LoadInfo, IPipelineState** ppPSO)
 {
+    if (!m_pStateCache)
+    {
+        pLoader->LoadPipelineState(LoadInfo, ppPSO);
+        return false;
+    }
+
+    // The loader does not report whether the pipeline was found in the cache, so we look up the final
+    // create info in the cache ourselves before the loader creates the pipeline. The pipeline is kept
+    // alive until the loader requests it, so the loader gets the same object from the cache.
+    RefCntAutoPtr<IPipelineState> pCachedPSO;
+    bool                          IsHit = false;
+
+    auto LookUpPipeline = MakeCallback(
+        [&](PipelineStateCreateInfo& PSODesc) {
+            if (LoadInfo.ModifyPipeline != nullptr)
+                LoadInfo.ModifyPipeline(PSODesc, LoadInfo.pModifyPipelineData);
+
+            if (LoadInfo.PipelineType == PIPELINE_TYPE_GRAPHICS)
+                IsHit = m_pStateCache->CreateGraphicsPipelineState(static_cast<GraphicsPipelineStateCreateInfo&>(PSODesc), &pCachedPSO);
+            else if (LoadInfo.PipelineType == PIPELINE_TYPE_COMPUTE)
+                IsHit = m_pStateCache->CreateComputePipelineState(static_cast<ComputePipelineStateCreateInfo&>(PSODesc), &pCachedPSO);
+        });
+
+    auto CacheLoadInfo                = LoadInfo;
+    CacheLoadInfo.ModifyPipeline      = LookUpPipeline;
+    CacheLoadInfo.pModifyPipelineData = LookUpPipeline;
+    pLoader->LoadPipelineState(CacheLoadInfo, ppPSO);
+
+    return IsHit && *ppPSO != nullptr;
+}
+
+// This method is called by the PSO compiler threads as well as by the main thread.
+void Tutorial26_StateCache::RecordPipelineCreation(const std::string& Name, double CreateTimeMs, bool IsHit)
+{
+    std::lock_guard<std::mutex> Lock{m_CacheStats.Mtx};
+
+    if (IsHit)
+    {
+        ++m_CacheStats.NumHits;
+        // Pipelines that were cached before the statistics were collected have no cold time
+        const auto ColdTimeIt = m_CacheStats.ColdCreateTimes.find(Name);
+        if (ColdTimeIt != m_CacheStats.ColdCreateTimes.end())
+            m_CacheStats.TimeSavedMs += std::max(ColdTimeIt->second - CreateTimeMs, 0.0);
+    }
+    else
+    {
+        ++m_CacheStats.NumMisses;
+        // Keep the cold time measured first, so that the statistics are stable between runs
+        m_CacheStats.ColdCreateTimes.emplace(Name, CreateTimeMs);
+        // New states were added to the cache
+        m_StateCacheDirty.store(true);
+    }
+}
+
+Uint32 Tutorial26_StateCache::GetPathTracePermutation() const
+{
+    return (static_cast<Uint32>(m_BRDFSamplingMode) * NEE_MODE_COUNT + static_cast<Uint32>(m_NEEMode)) * 2 + (m_FullBRDFReflectance ? 1 : 0);
+}
+
+void Tutorial26_StateCache::CreateRSNLoader(bool                                       EnableReload,
+                                            RefCntAutoPtr<IRenderStateNotationParser>& pParser,
+                                            RefCntAutoPtr<IRenderStateNotationLoader>& pLoader) const
+{
+    // Create a shader source stream factory to load shaders and DRSN files
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+
+    // Create render state notation parser
+    {
+        RenderStateNotationParserCreateInfo ParserCI;
+        ParserCI.EnableReload = EnableReload;
+        CreateRenderStateNotationParser(ParserCI, &pParser);
+        VERIFY(pParser != nullptr, "Failed to create RSN parser");
+        // Parse the render state notation file
+        auto res = pParser->ParseFile("RenderStates.json", pShaderSourceFactory);
+        VERIFY(res, "Failed to parse render states file");
+    }
+
+    // Create render state notation loader
+    {
+        RenderStateNotationLoaderCreateInfo LoaderCI;
+        LoaderCI.pDevice        = m_pDevice;
+        LoaderCI.pParser        = pParser;
+        LoaderCI.pStateCache    = m_pStateCache;
+        LoaderCI.pStreamFactory = pShaderSourceFactory;
+        CreateRenderStateNotationLoader(LoaderCI, &pLoader);
+        VERIFY(pLoader, "Failed to create render state loader");
+    }
+}
+
+// Creates the path trace pipeline permutation and records the result in m_PSOCompiler.
+// This method is called by the PSO compiler threads as well as by the main thread, and
+// every thread must use its own loader.
+RefCntAutoPtr<IPipelineState> Tutorial26_StateCache::CreatePathTracePSO(Uint32 Permutation, IRenderStateNotationLoader* pLoader)
+{
+    VERIFY_EXPR(Permutation < NumPathTracePermutations);
+    const auto BRDFSamplingMode    = static_cast<int>(Permutation / 2 / NEE_MODE_COUNT);
+    const auto NEEMode             = static_cast<int>((Permutation / 2) % NEE_MODE_COUNT);
+    const auto FullBRDFReflectance = (Permutation & 1) != 0;
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
     ShaderMacroHelper Macros;
     Macros.AddShaderMacro("BRDF_SAMPLING_MODE_COS_WEIGHTED", BRDF_SAMPLING_MODE_COS_WEIGHTED);
     Macros.AddShaderMacro("BRDF_SAMPLING_MODE_IMPORTANCE_SAMPLING", BRDF_SAMPLING_MODE_IMPORTANCE_SAMPLING);
-    Macros.AddShaderMacro("BRDF_SAMPLING_MODE", m_BRDFSamplingMode);
+    Macros.AddShaderMacro("BRDF_SAMPLING_MODE", BRDFSamplingMode);
 
     Macros.AddShaderMacro("NEE_MODE_LIGHT", NEE_MODE_LIGHT);
     Macros.AddShaderMacro("NEE_MODE_BRDF", NEE_MODE_BRDF);
     Macros.AddShaderMacro("NEE_MODE_MIS", NEE_MODE_MIS);
     Macros.AddShaderMacro("NEE_MODE_MIS_LIGHT", NEE_MODE_MIS_LIGHT);
     Macros.AddShaderMacro("NEE_MODE_MIS_BRDF", NEE_MODE_MIS_BRDF);
-    Macros.AddShaderMacro("NEE_MODE", m_NEEMode);
+    Macros.AddShaderMacro("NEE_MODE", NEEMode);
 
-    Macros.AddShaderMacro("OPTIMIZED_BRDF_REFLECTANCE", !m_FullBRDFReflectance);
+    Macros.AddShaderMacro("OPTIMIZED_BRDF_REFLECTANCE", !FullBRDFReflectance);
 
     auto ModifyShaderCI = MakeCallback(
         [&](ShaderCreateInfo& ShaderCI, SHADER_TYPE Type, bool& AddToLoaderCache) {
@@ -499,24 +803,209 @@ void Tutorial26_StateCache::CreatePathTracePSO()
     LoadInfo.PipelineType      = PIPELINE_TYPE_COMPUTE;
     LoadInfo.Name              = "Path Trace PSO";
     // The loader has its own cache that holds objects previously created by the application and
-    // uses the object name as the key. In this example we recompile the path tracing
-    // pipeline at run time when some of the settings change. The pipeline uses the same name, and
-    // we don't want to get old pipeline from the cache, so we set `LoadInfo.AddToCache = false`. Note
-    // that the pipeline is always added to the render state cache.
+    // uses the object name as the key. In this example we compile multiple permutations of the path
+    // tracing pipeline that use the same name, and we don't want to get the wrong permutation from the
+    // cache, so we set `LoadInfo.AddToCache = false`. Note that the pipeline is always added to the
+    // render state cache, so permutations compiled in previous runs are loaded from the cache file.
     LoadInfo.AddToCache = false;
-    m_pPathTracePSO.Release();
-    m_pRSNLoader->LoadPipelineState(LoadInfo, &m_pPathTracePSO);
-    VERIFY_EXPR(m_pPathTracePSO);
 
-    m_pPathTracePSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbConstants")->Set(m_pShaderConstantsCB);
+    RefCntAutoPtr<IPipelineState> pPSO;
+    const auto                    IsHit = LoadPipelineState(pLoader, LoadInfo, &pPSO);
+    if (pPSO)
+        pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbConstants")->Set(m_pShaderConstantsCB);
+
+    const auto CompileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    if (pPSO)
+    {
+        RecordPipelineCreation("Path Trace PSO " + std::to_string(Permutation), CompileTimeMs, IsHit);
+        LOG_INFO_MESSAGE("Path trace PSO permutation ", Permutation, " (", BRDFSamplingModeNames[BRDFSamplingMode], ", ", NEEModeNames[NEEMode],
+                         (FullBRDFReflectance ? ", full BRDF" : ""), ") created in ", static_cast<int>(CompileTimeMs), " ms");
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("Failed to create path trace PSO permutation ", Permutation);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+
+        auto& Info         = m_PSOCompiler.Permutations[Permutation];
+        Info.Status        = pPSO ? PERMUTATION_STATUS_READY : PERMUTATION_STATUS_FAILED;
+        Info.pPSO          = pPSO;
+        Info.CompileTimeMs = CompileTimeMs;
+    }
+
+    return pPSO;
+}
+
+void Tutorial26_StateCache::RequestPathTracePSO()
+{
+    const auto Permutation = GetPathTracePermutation();
+    if (Permutation == m_PathTracePermutation)
+    {
+        // Cancel the pending request, if any
+        m_PendingPathTracePermutation = ~0u;
+        return;
+    }
+
+    if (m_PSOCompiler.Threads.empty())
+    {
+        bool IsReady = false;
+        {
+            std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+            IsReady = m_PSOCompiler.Permutations[Permutation].Status == PERMUTATION_STATUS_READY;
+        }
+        if (!IsReady)
+            CreatePathTracePSO(Permutation, m_pRSNLoader);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+
+        auto& Info = m_PSOCompiler.Permutations[Permutation];
+        if (Info.Status == PERMUTATION_STATUS_NOT_REQUESTED || Info.Status == PERMUTATION_STATUS_FAILED)
+        {
+            // Requested permutation goes ahead of the prewarming permutations
+            Info.Status = PERMUTATION_STATUS_QUEUED;
+            m_PSOCompiler.Queue.push_front(Permutation);
+            m_PSOCompiler.CondVar.notify_one();
+        }
+        else if (Info.Status == PERMUTATION_STATUS_QUEUED)
+        {
+            auto& Queue = m_PSOCompiler.Queue;
+            Queue.erase(std::find(Queue.begin(), Queue.end(), Permutation));
+            Queue.push_front(Permutation);
+        }
+    }
+
+    m_PendingPathTracePermutation = Permutation;
+    UpdatePathTracePSO();
+}
+
+void Tutorial26_StateCache::UpdatePathTracePSO()
+{
+    if (m_PendingPathTracePermutation == ~0u)
+        return;
+
+    RefCntAutoPtr<IPipelineState> pPSO;
+    {
+        std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+
+        const auto& Info = m_PSOCompiler.Permutations[m_PendingPathTracePermutation];
+        if (Info.Status == PERMUTATION_STATUS_FAILED)
+        {
+            // Keep rendering with the current pipeline
+            m_PendingPathTracePermutation = ~0u;
+            return;
+        }
+        if (Info.Status != PERMUTATION_STATUS_READY)
+            return;
+
+        pPSO = Info.pPSO;
+    }
+
+    m_pPathTracePSO               = std::move(pPSO);
+    m_PathTracePermutation        = m_PendingPathTracePermutation;
+    m_PendingPathTracePermutation = ~0u;
+    if (m_GBuffer)
+        CreatePathTraceSRB();
+    m_SampleCount = 0;
+}
+
+void Tutorial26_StateCache::PrewarmPathTracePSOs()
+{
+    if (m_PSOCompiler.Threads.empty())
+    {
+        for (Uint32 Permutation = 0; Permutation < NumPathTracePermutations; ++Permutation)
+        {
+            bool IsRequested = false;
+            {
+                std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+                IsRequested = m_PSOCompiler.Permutations[Permutation].Status != PERMUTATION_STATUS_NOT_REQUESTED;
+            }
+            if (!IsRequested)
+                CreatePathTracePSO(Permutation, m_pRSNLoader);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+    for (Uint32 Permutation = 0; Permutation < NumPathTracePermutations; ++Permutation)
+    {
+        auto& Info = m_PSOCompiler.Permutations[Permutation];
+        if (Info.Status == PERMUTATION_STATUS_NOT_REQUESTED)
+        {
+            Info.Status = PERMUTATION_STATUS_QUEUED;
+            m_PSOCompiler.Queue.push_back(Permutation);
+        }
+    }
+    m_PSOCompiler.CondVar.notify_all();
+}
+
+void Tutorial26_StateCache::StartPSOCompilerThreads()
+{
+    VERIFY_EXPR(m_PSOCompiler.Threads.empty());
+
+    // Leave one core to the main thread
+    const auto NumThreads = std::min(std::max(std::thread::hardware_concurrency(), 2u) - 1u, 4u);
+    for (Uint32 i = 0; i < NumThreads; ++i)
+        m_PSOCompiler.Threads.emplace_back(&Tutorial26_StateCache::PSOCompilerThreadProc, this);
+}
+
+void Tutorial26_StateCache::StopPSOCompilerThreads()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_PSOCompiler.Mtx};
+        m_PSOCompiler.Quit = true;
+    }
+    m_PSOCompiler.CondVar.notify_all();
+
+    for (auto& Thread : m_PSOCompiler.Threads)
+        Thread.join();
+    m_PSOCompiler.Threads.clear();
+}
+
+void Tutorial26_StateCache::PSOCompilerThreadProc()
+{
+    // The render state notation parser and loader are not documented to be thread-safe, so every
+    // compiler thread uses its own instances. Only the device and the render state cache, which
+    // support creating objects from multiple threads, are shared with the other threads.
+    RefCntAutoPtr<IRenderStateNotationParser> pParser;
+    RefCntAutoPtr<IRenderStateNotationLoader> pLoader;
+    CreateRSNLoader(false, pParser, pLoader);
+
+    while (true)
+    {
+        Uint32 Permutation = 0;
+        {
+            std::unique_lock<std::mutex> Lock{m_PSOCompiler.Mtx};
+            m_PSOCompiler.CondVar.wait(Lock, [this]() {
+                return m_PSOCompiler.Quit || !m_PSOCompiler.Queue.empty();
+            });
+            if (m_PSOCompiler.Quit)
+                break;
+
+            Permutation = m_PSOCompiler.Queue.front();
+            m_PSOCompiler.Queue.pop_front();
+            m_PSOCompiler.Permutations[Permutation].Status = PERMUTATION_STATUS_COMPILING;
+        }
+
+        CreatePathTracePSO(Permutation, pLoader);
+    }
 }
 
 void Tutorial26_StateCache::WindowResize(Uint32 Width, Uint32 Height)
 {
-    m_GBuffer = {};
+    // Return window-size textures to the pool. The pool destroys them at the
+    // end of the frame, once the textures of the new size have been created
+    m_TransientTextures.Release(m_GBuffer.pBaseColor);
+    m_TransientTextures.Release(m_GBuffer.pNormal);
+    m_TransientTextures.Release(m_GBuffer.pEmittance);
+    m_TransientTextures.Release(m_GBuffer.pPhysDesc);
+    m_TransientTextures.Release(m_GBuffer.pDepth);
+    m_TransientTextures.Release(m_pRadianceAccumulationBuffer);
     m_pPathTraceSRB.Release();
     m_pResolveSRB.Release();
-    m_pRadianceAccumulationBuffer.Release();
 
     float NearPlane   = 0.1f;
     float FarPlane    = 50.f;
@@ -539,22 +1028,22 @@ void Tutorial26_StateCache::CreateGBuffer()
     TexDesc.Height    = SCDesc.Height;
     TexDesc.MipLevels = 1;
 
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pBaseColor);
+    m_GBuffer.pBaseColor = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pBaseColor);
 
     TexDesc.Name   = "G-buffer normal";
     TexDesc.Format = GBuffer::NormalFormat;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pNormal);
+    m_GBuffer.pNormal = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pNormal);
 
     TexDesc.Name   = "G-buffer emittance";
     TexDesc.Format = GBuffer::EmittanceFormat;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pEmittance);
+    m_GBuffer.pEmittance = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pEmittance);
 
     TexDesc.Name   = "G-buffer physical description";
     TexDesc.Format = GBuffer::PhysDescFormat;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pPhysDesc);
+    m_GBuffer.pPhysDesc = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pPhysDesc);
 
     // Note that since we are generating our G-buffer by ray tracing the scene,
@@ -562,16 +1051,28 @@ void Tutorial26_StateCache::CreateGBuffer()
     TexDesc.Name      = "G-buffer depth";
     TexDesc.Format    = GBuffer::DepthFormat;
     TexDesc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_GBuffer.pDepth);
+    m_GBuffer.pDepth = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_GBuffer.pDepth);
 
     // Create the radiance accumulation buffer
     TexDesc.Name      = "Radiance accumulation buffer";
     TexDesc.Format    = RadianceAccumulationFormat;
     TexDesc.BindFlags = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
-    m_pDevice->CreateTexture(TexDesc, nullptr, &m_pRadianceAccumulationBuffer);
+    m_pRadianceAccumulationBuffer = m_TransientTextures.Acquire(m_pDevice, TexDesc);
     VERIFY_EXPR(m_pRadianceAccumulationBuffer);
 
+    CreatePathTraceSRB();
+
+    m_pResolveSRB.Release();
+    m_pResolvePSO->CreateShaderResourceBinding(&m_pResolveSRB, true);
+    m_pResolveSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Radiance")->Set(m_pRadianceAccumulationBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+
+    m_SampleCount       = 0;
+    m_LastFrameViewProj = {};
+}
+
+void Tutorial26_StateCache::CreatePathTraceSRB()
+{
     m_pPathTraceSRB.Release();
     m_pPathTracePSO->CreateShaderResourceBinding(&m_pPathTraceSRB, true);
     m_pPathTraceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_BaseColor")->Set(m_GBuffer.pBaseColor->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
@@ -580,13 +1081,6 @@ void Tutorial26_StateCache::CreateGBuffer()
     m_pPathTraceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_PhysDesc")->Set(m_GBuffer.pPhysDesc->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
     m_pPathTraceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Depth")->Set(m_GBuffer.pDepth->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
     m_pPathTraceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Radiance")->Set(m_pRadianceAccumulationBuffer->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
-
-    m_pResolveSRB.Release();
-    m_pResolvePSO->CreateShaderResourceBinding(&m_pResolveSRB, true);
-    m_pResolveSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Radiance")->Set(m_pRadianceAccumulationBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
-
-    m_SampleCount       = 0;
-    m_LastFrameViewProj = {};
 }
 
 // Render a frame
@@ -696,8 +1190,18 @@ void Tutorial26_StateCache::Render()
 void Tutorial26_StateCache::Update(double CurrTime, double ElapsedTime)
 {
     SampleBase::Update(CurrTime, ElapsedTime);
+    UpdatePathTracePSO();
     UpdateUI();
 
+    // Save new states shortly after they were added to the cache, but not too often
+    // to avoid serializing the cache every time a permutation is compiled during prewarming.
+    constexpr double StateCacheSaveInterval = 2.0;
+    if (m_StateCacheDirty.load() && CurrTime - m_LastStateCacheSaveTime > StateCacheSaveInterval)
+    {
+        SaveStateCache(/*Async = */ true);
+        m_LastStateCacheSaveTime = CurrTime;
+    }
+
     m_Camera.Update(m_InputController, static_cast<float>(ElapsedTime));
     {
         const auto& mouseState = m_InputController.GetMouseState();
@@ -726,20 +1230,11 @@ void Tutorial26_StateCache::Update(double CurrTime, double ElapsedTime)
 
 Tutorial26_StateCache::~Tutorial26_StateCache()
 {
+    // Wait for the permutations being compiled to be added to the cache
+    StopPSOCompilerThreads();
+
     // Save cache data
-    if (m_pStateCache && !m_StateCachePath.empty())
-    {
-        RefCntAutoPtr<IDataBlob> pCacheData;
-        if (m_pStateCache->WriteToBlob(0, &pCacheData))
-        {
-            if (pCacheData)
-            {
-                FileWrapper CacheDataFile{m_StateCachePath.c_str(), EFileAccessMode::Overwrite};
-                if (CacheDataFile->Write(pCacheData->GetConstDataPtr(), pCacheData->GetSize()))
-                    LOG_INFO_MESSAGE("Successfully saved state cache file ", m_StateCachePath, " (", FormatMemorySize(pCacheData->GetSize()), ").");
-            }
-        }
-    }
+    SaveStateCache(/*Async = */ false);
 }
 
 } // namespace Diligent
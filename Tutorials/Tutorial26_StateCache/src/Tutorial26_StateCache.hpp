@@ -28,6 +28,14 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <array>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_map>
 
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
@@ -49,6 +57,8 @@ struct SceneAttribs;
 class Tutorial26_StateCache final : public SampleBase
 {
 public:
+    virtual CommandLineStatus ProcessCommandLine(int argc, const char* const* argv) override final;
+
     virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
 
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
@@ -66,11 +76,31 @@ public:
 private:
     void UpdateUI();
     void CreateGBuffer();
-    void CreatePathTracePSO();
+    void CreatePathTraceSRB();
+    void LoadStateCache();
+    void SaveStateCache(bool Async);
+    void WriteStateCacheFile(RefCntAutoPtr<IDataBlob> pCacheData) const;
+    void LoadStateCacheStats();
+    void SaveStateCacheStats();
+    bool LoadPipelineState(IRenderStateNotationLoader* pLoader, const LoadPipelineStateInfo& LoadInfo, IPipelineState** ppPSO);
+    void RecordPipelineCreation(const std::string& Name, double CreateTimeMs, bool IsHit);
+    void CreateRSNLoader(bool                                       EnableReload,
+                         RefCntAutoPtr<IRenderStateNotationParser>& pParser,
+                         RefCntAutoPtr<IRenderStateNotationLoader>& pLoader) const;
+
+    // Path trace pipeline permutation index
+    Uint32 GetPathTracePermutation() const;
+
+    RefCntAutoPtr<IPipelineState> CreatePathTracePSO(Uint32 Permutation, IRenderStateNotationLoader* pLoader);
+    void                          RequestPathTracePSO();
+    void                          UpdatePathTracePSO();
+    void                          PrewarmPathTracePSOs();
+    void                          StartPSOCompilerThreads();
+    void                          StopPSOCompilerThreads();
+    void                          PSOCompilerThreadProc();
 
     RefCntAutoPtr<IRenderStateNotationParser> m_pRSNParser;
     RefCntAutoPtr<IRenderStateNotationLoader> m_pRSNLoader;
-    RefCntAutoPtr<IRenderStateCache>          m_pStateCache;
 
     RefCntAutoPtr<IBuffer> m_pShaderConstantsCB;
 
@@ -83,6 +113,33 @@ private:
 
     std::string m_StateCachePath;
 
+    // The state cache file is rewritten shortly after new states are added to the cache, so that
+    // the application does not lose compiled states. The file is written to a temporary file first,
+    // which then replaces the cache file in a single step, so that a crash never leaves a corrupted cache.
+    std::atomic<bool> m_StateCacheDirty{false};
+    double            m_LastStateCacheSaveTime = 0;
+    std::thread       m_StateCacheWriter;
+
+    // Pipeline creation statistics. Hits and misses are reported by the render state cache. Creation times
+    // of pipelines that were not found in the cache (cold times) are stored next to the cache file and are
+    // used to estimate the time saved by the cache.
+    struct StateCacheStats
+    {
+        std::mutex Mtx;
+
+        double FileReadTimeMs = 0;
+        double LoadTimeMs     = 0;
+
+        // The following members are protected by Mtx
+        bool   CacheFileLoaded = false;
+        Uint32 NumHits         = 0;
+        Uint32 NumMisses       = 0;
+        double TimeSavedMs     = 0;
+
+        std::unordered_map<std::string, double> ColdCreateTimes;
+    };
+    StateCacheStats m_CacheStats;
+
     struct GBuffer
     {
         explicit operator bool() const
@@ -110,7 +167,8 @@ private:
     enum BRDF_SAMPLING_MODE
     {
         BRDF_SAMPLING_MODE_COS_WEIGHTED = 0,
-        BRDF_SAMPLING_MODE_IMPORTANCE_SAMPLING
+        BRDF_SAMPLING_MODE_IMPORTANCE_SAMPLING,
+        BRDF_SAMPLING_MODE_COUNT
     };
     int m_BRDFSamplingMode = BRDF_SAMPLING_MODE_IMPORTANCE_SAMPLING;
 
@@ -120,10 +178,48 @@ private:
         NEE_MODE_BRDF,      // Sample BRDF
         NEE_MODE_MIS,       // Multiple importance sampling
         NEE_MODE_MIS_LIGHT, // MIS - light component
-        NEE_MODE_MIS_BRDF   // MIS - BRDF component
+        NEE_MODE_MIS_BRDF,  // MIS - BRDF component
+        NEE_MODE_COUNT
     };
     int m_NEEMode = NEE_MODE_MIS;
 
+    // Path trace pipeline permutations are compiled by a pool of background threads
+    // through the render state cache. The current pipeline keeps rendering until
+    // the requested permutation is ready.
+    static constexpr Uint32 NumPathTracePermutations = BRDF_SAMPLING_MODE_COUNT * NEE_MODE_COUNT * 2;
+
+    enum PERMUTATION_STATUS : Uint8
+    {
+        PERMUTATION_STATUS_NOT_REQUESTED = 0,
+        PERMUTATION_STATUS_QUEUED,
+        PERMUTATION_STATUS_COMPILING,
+        PERMUTATION_STATUS_READY,
+        PERMUTATION_STATUS_FAILED
+    };
+    struct PathTracePermutationInfo
+    {
+        PERMUTATION_STATUS            Status = PERMUTATION_STATUS_NOT_REQUESTED;
+        RefCntAutoPtr<IPipelineState> pPSO;
+        double                        CompileTimeMs = 0;
+    };
+    struct PSOCompiler
+    {
+        std::vector<std::thread> Threads;
+        std::mutex               Mtx;
+        std::condition_variable  CondVar;
+
+        // The following members are protected by Mtx
+        bool                                                           Quit = false;
+        std::deque<Uint32>                                             Queue; // Permutations waiting for compilation
+        std::array<PathTracePermutationInfo, NumPathTracePermutations> Permutations;
+    };
+    PSOCompiler m_PSOCompiler;
+
+    Uint32 m_PathTracePermutation        = ~0u; // Permutation of m_pPathTracePSO
+    Uint32 m_PendingPathTracePermutation = ~0u; // Permutation that will replace m_pPathTracePSO when ready
+    bool   m_AsyncPSOCompilation         = true;
+    bool   m_PrewarmPSOs                 = false;
+
     int   m_NumBounces             = 4;
     int   m_NumSamplesPerFrame     = 4;
     bool  m_ShowOnlyLastBounce     = false;